@@ -421,7 +421,9 @@ public:
 
 		ensure(m_compiler);
 
-		fs::file module_file(name, fs::rewrite);
+		// Write to a temporary file first, other emulator instances may be loading the same cache
+		fs::pending_file pending(name);
+		fs::file& module_file = pending.file;
 
 		if (!module_file)
 		{
@@ -441,15 +443,21 @@ public:
 		if (!zip(obj.getBufferStart(), obj.getBufferSize(), module_file))
 		{
 			jit_log.error("LLVM: Failed to compress module: %s", _module->getName().data());
-			module_file.close();
-			fs::remove_file(name);
+			return;
+		}
+
+		const u64 file_size = module_file.size();
+
+		if (!pending.commit())
+		{
+			jit_log.error("LLVM: Failed to write module file: %s (%s)", name, fs::g_tls_error);
 			return;
 		}
 
 		jit_log.trace("LLVM: Created module: %s", _module->getName().data());
 
 		// Restore space that was overestimated
-		ensure(m_compiler->add_sub_disk_space(max_size - module_file.size()));
+		ensure(m_compiler->add_sub_disk_space(max_size - file_size));
 	}
 
 	static std::unique_ptr<llvm::MemoryBuffer> load(const std::string& path)
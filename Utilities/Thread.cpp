@@ -9,6 +9,7 @@
 #include "Thread.h"
 #include "Utilities/JIT.h"
 #include <thread>
+#include <bit>
 #include <cfenv>
 
 #ifdef ARCH_ARM64
@@ -2913,8 +2914,87 @@ void thread_ctrl::detect_cpu_layout()
 	}
 }
 
+// Pick a single cache domain of performance cores for the emulation threads (PPU, SPU and RSX)
+static u64 get_topology_emulation_mask()
+{
+	static const u64 mask = []() -> u64
+	{
+		const auto& topology = utils::get_cpu_topology();
+		const u64 all_cores_mask = thread_ctrl::get_process_affinity_mask();
+
+		u64 perf_mask = 0;
+
+		for (const auto& cpu : topology.cpus)
+		{
+			if (!cpu.low_performance && (all_cores_mask & (u64{1} << cpu.id)))
+			{
+				perf_mask |= u64{1} << cpu.id;
+			}
+		}
+
+		if (!perf_mask)
+		{
+			// Only low-performance cores are available to the process
+			perf_mask = all_cores_mask;
+		}
+
+		// The domain with the most usable cores, ties are resolved in favour of the first one
+		u64 best_domain = 0;
+		u32 best_node = 0;
+
+		for (const auto& cpu : topology.cpus)
+		{
+			const u64 domain = topology.cache_domains[cpu.cache_domain] & perf_mask;
+
+			if (std::popcount(domain) > std::popcount(best_domain))
+			{
+				best_domain = domain;
+				best_node = cpu.numa_node;
+			}
+		}
+
+		u64 result = best_domain;
+
+		// Too few threads in a single domain: grow the mask with domains of the same NUMA node
+		if (std::popcount(result) < 8)
+		{
+			for (const auto& cpu : topology.cpus)
+			{
+				if (cpu.numa_node == best_node)
+				{
+					result |= topology.cache_domains[cpu.cache_domain] & perf_mask;
+				}
+			}
+		}
+
+		if (std::popcount(result) < 8)
+		{
+			result = perf_mask;
+		}
+
+		sig_log.notice("CPU topology: %s", utils::get_cpu_topology_string());
+		sig_log.notice("Topology scheduler: emulation threads use CPU mask 0x%x (process mask 0x%x)", result, all_cores_mask);
+		return result ? result : all_cores_mask;
+	}();
+
+	return mask;
+}
+
 u64 thread_ctrl::get_affinity_mask(thread_class group)
 {
+	if (g_cfg.core.thread_scheduler == thread_scheduler_mode::topology)
+	{
+		switch (group)
+		{
+		case thread_class::ppu:
+		case thread_class::spu:
+		case thread_class::rsx:
+			return get_topology_emulation_mask();
+		default:
+			return process_affinity_mask;
+		}
+	}
+
 	detect_cpu_layout();
 
 	if (const auto thread_count = utils::get_thread_count())
@@ -29,8 +29,11 @@
  */
 
 #include "sha1.h"
+#include "sha_hw.h"
 #include "utils.h"
 
+#include <algorithm>
+
 /*
  * 32-bit integer manipulation macros (big endian)
  */
@@ -73,6 +76,12 @@ void sha1_process( sha1_context *ctx, const unsigned char data[64] )
 {
     uint32_t temp, W[16], A, B, C, D, E;
 
+    if( sha_hw_supported() )
+    {
+        sha1_process_hw( ctx->state, data, 1 );
+        return;
+    }
+
     GET_UINT32_BE( W[ 0], data,  0 );
     GET_UINT32_BE( W[ 1], data,  4 );
     GET_UINT32_BE( W[ 2], data,  8 );
@@ -255,6 +264,13 @@ void sha1_update( sha1_context *ctx, const unsigned char *input, size_t ilen )
         left = 0;
     }
 
+    if( ilen >= 64 && sha_hw_supported() )
+    {
+        sha1_process_hw( ctx->state, input, ilen / 64 );
+        input += ilen & ~static_cast<size_t>(63);
+        ilen  &= 63;
+    }
+
     while( ilen >= 64 )
     {
         sha1_process( ctx, input );
@@ -317,6 +333,46 @@ void sha1( const unsigned char *input, size_t ilen, unsigned char output[20] )
     mbedtls_zeroize( &ctx, sizeof( sha1_context ) );
 }
 
+/*
+ * output[i] = SHA-1( input[i] ) for a batch of buffers
+ */
+void sha1_multi( const unsigned char* const *input, const size_t *ilen, unsigned char (*output)[20], size_t count )
+{
+    size_t i = 0;
+
+    if( sha_hw_supported() )
+    {
+        // Hash the whole blocks both buffers of a pair have in lockstep, then finish them separately
+        for( ; i + 1 < count; i += 2 )
+        {
+            sha1_context ctx[2];
+            const size_t blocks = std::min( ilen[i], ilen[i + 1] ) / 64;
+
+            sha1_starts( &ctx[0] );
+            sha1_starts( &ctx[1] );
+            sha1_process_hw_x2( ctx[0].state, input[i], ctx[1].state, input[i + 1], blocks );
+
+            for( size_t j = 0; j < 2; j++ )
+            {
+                const uint64_t done = blocks * 64;
+
+                ctx[j].total[0] = static_cast<uint32_t>( done );
+                ctx[j].total[1] = static_cast<uint32_t>( done >> 32 );
+
+                sha1_update( &ctx[j], input[i + j] + done, ilen[i + j] - done );
+                sha1_finish( &ctx[j], output[i + j] );
+            }
+
+            mbedtls_zeroize( ctx, sizeof( ctx ) );
+        }
+    }
+
+    for( ; i < count; i++ )
+    {
+        sha1( input[i], ilen[i], output[i] );
+    }
+}
+
 /*
  * SHA-1 HMAC context setup
  */
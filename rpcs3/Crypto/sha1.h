@@ -112,6 +112,19 @@ void sha1( const unsigned char *input, size_t ilen, unsigned char output[20] );
  */
 int sha1_file( const char *path, unsigned char output[20] );
 
+/**
+ * \brief          Output[i] = SHA-1( input[i] ) for count independent buffers
+ *
+ *                 Faster than separate sha1() calls when hardware SHA is
+ *                 available, as pairs of buffers are hashed interleaved.
+ *
+ * \param input    array of buffers holding the data
+ * \param ilen     array of lengths of the input data
+ * \param output   array of SHA-1 checksum results
+ * \param count    number of buffers
+ */
+void sha1_multi( const unsigned char* const *input, const size_t *ilen, unsigned char (*output)[20], size_t count );
+
 /**
  * \brief          SHA-1 HMAC context setup
  *
@@ -27,6 +27,7 @@
  */
 
 #include "sha256.h"
+#include "sha_hw.h"
 #include "utils.h"
 
 #include <string.h>
@@ -201,6 +202,12 @@ int mbedtls_internal_sha256_process( mbedtls_sha256_context *ctx,
     SHA256_VALIDATE_RET( ctx != NULL );
     SHA256_VALIDATE_RET( (const unsigned char *)data != NULL );
 
+    if( sha_hw_supported() )
+    {
+        sha256_process_hw( ctx->state, data, 1 );
+        return( 0 );
+    }
+
     for( i = 0; i < 8; i++ )
         A[i] = ctx->state[i];
 
@@ -299,6 +306,13 @@ int mbedtls_sha256_update_ret( mbedtls_sha256_context *ctx,
         left = 0;
     }
 
+    if( ilen >= 64 && sha_hw_supported() )
+    {
+        sha256_process_hw( ctx->state, input, ilen / 64 );
+        input += ilen & ~static_cast<size_t>(63);
+        ilen  &= 63;
+    }
+
     while( ilen >= 64 )
     {
         if( ( ret = mbedtls_internal_sha256_process( ctx, input ) ) != 0 )
@@ -0,0 +1,407 @@
+#include "sha_hw.h"
+#include "util/sysinfo.hpp"
+#include "Utilities/StrFmt.h"
+
+#include <utility>
+
+#if defined(ARCH_X64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#elif defined(ARCH_ARM64) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define SHA_HW_ARM64 1
+#include <arm_neon.h>
+#endif
+
+#if defined(ARCH_X64) && !defined(_MSC_VER)
+#define SHA_FUNC __attribute__((__target__("sse4.1,sha")))
+#else
+#define SHA_FUNC
+#endif
+
+[[maybe_unused]] static constexpr u32 s_sha1_k[4] =
+{
+	0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6
+};
+
+[[maybe_unused]] static constexpr u32 s_sha256_k[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+bool sha_hw_supported()
+{
+#if defined(ARCH_X64)
+	return utils::has_sha();
+#elif defined(SHA_HW_ARM64)
+	return true;
+#else
+	return false;
+#endif
+}
+
+#if defined(ARCH_X64)
+
+namespace
+{
+	template <usz N>
+	struct sha1_ni_lanes
+	{
+		__m128i abcd[N];
+		__m128i e0[N];
+		__m128i e1[N];
+		__m128i msg[N][4];
+	};
+}
+
+// Rounds 4*G to 4*G+3 with the message schedule interleaved, see Intel's SHA extensions white paper.
+// Every step is done for all lanes before moving on, so independent streams fill each other's latency.
+template <int G, usz N>
+SHA_FUNC static inline void sha1_ni_rounds(sha1_ni_lanes<N>& s)
+{
+	for (usz l = 0; l < N; l++)
+	{
+		__m128i& e_in = G % 2 ? s.e1[l] : s.e0[l];
+		__m128i& e_out = G % 2 ? s.e0[l] : s.e1[l];
+		__m128i* msg = s.msg[l];
+
+		if constexpr (G == 0)
+		{
+			e_in = _mm_add_epi32(e_in, msg[0]);
+		}
+		else
+		{
+			e_in = _mm_sha1nexte_epu32(e_in, msg[G % 4]);
+		}
+
+		e_out = s.abcd[l];
+
+		if constexpr (G >= 3 && G <= 18)
+		{
+			msg[(G + 1) % 4] = _mm_sha1msg2_epu32(msg[(G + 1) % 4], msg[G % 4]);
+		}
+
+		s.abcd[l] = _mm_sha1rnds4_epu32(s.abcd[l], e_in, G / 5);
+
+		if constexpr (G >= 1 && G <= 16)
+		{
+			msg[(G + 3) % 4] = _mm_sha1msg1_epu32(msg[(G + 3) % 4], msg[G % 4]);
+		}
+
+		if constexpr (G >= 2 && G <= 17)
+		{
+			msg[(G + 2) % 4] = _mm_xor_si128(msg[(G + 2) % 4], msg[G % 4]);
+		}
+	}
+}
+
+template <usz N, int... G>
+SHA_FUNC static inline void sha1_ni_block(sha1_ni_lanes<N>& s, std::integer_sequence<int, G...>)
+{
+	(sha1_ni_rounds<G>(s), ...);
+}
+
+template <usz N>
+SHA_FUNC static void sha1_ni(u32* const* state, const u8* const* data, usz blocks)
+{
+	const __m128i mask = _mm_set_epi64x(0x0001020304050607ull, 0x08090a0b0c0d0e0full);
+
+	sha1_ni_lanes<N> s;
+
+	for (usz l = 0; l < N; l++)
+	{
+		s.abcd[l] = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state[l])), 0x1b);
+		s.e0[l] = _mm_set_epi32(state[l][4], 0, 0, 0);
+	}
+
+	for (usz i = 0; i < blocks; i++)
+	{
+		__m128i abcd_save[N];
+		__m128i e0_save[N];
+
+		for (usz l = 0; l < N; l++)
+		{
+			abcd_save[l] = s.abcd[l];
+			e0_save[l] = s.e0[l];
+
+			for (usz j = 0; j < 4; j++)
+			{
+				s.msg[l][j] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data[l] + i * 64 + j * 16)), mask);
+			}
+		}
+
+		sha1_ni_block(s, std::make_integer_sequence<int, 20>{});
+
+		for (usz l = 0; l < N; l++)
+		{
+			s.e0[l] = _mm_sha1nexte_epu32(s.e0[l], e0_save[l]);
+			s.abcd[l] = _mm_add_epi32(s.abcd[l], abcd_save[l]);
+		}
+	}
+
+	for (usz l = 0; l < N; l++)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state[l]), _mm_shuffle_epi32(s.abcd[l], 0x1b));
+		state[l][4] = _mm_extract_epi32(s.e0[l], 3);
+	}
+}
+
+template <int G>
+SHA_FUNC static inline void sha256_ni_rounds(__m128i& state0, __m128i& state1, __m128i (&msg)[4])
+{
+	const __m128i cur = msg[G % 4];
+
+	__m128i wk = _mm_add_epi32(cur, _mm_loadu_si128(reinterpret_cast<const __m128i*>(s_sha256_k + G * 4)));
+	state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+
+	if constexpr (G >= 3 && G <= 14)
+	{
+		const __m128i tmp = _mm_alignr_epi8(cur, msg[(G + 3) % 4], 4);
+		msg[(G + 1) % 4] = _mm_sha256msg2_epu32(_mm_add_epi32(msg[(G + 1) % 4], tmp), cur);
+	}
+
+	wk = _mm_shuffle_epi32(wk, 0x0e);
+	state0 = _mm_sha256rnds2_epu32(state0, state1, wk);
+
+	if constexpr (G >= 1 && G <= 12)
+	{
+		msg[(G + 3) % 4] = _mm_sha256msg1_epu32(msg[(G + 3) % 4], cur);
+	}
+}
+
+template <int... G>
+SHA_FUNC static inline void sha256_ni_block(__m128i& state0, __m128i& state1, __m128i (&msg)[4], std::integer_sequence<int, G...>)
+{
+	(sha256_ni_rounds<G>(state0, state1, msg), ...);
+}
+
+SHA_FUNC static void sha256_ni(u32* state, const u8* data, usz blocks)
+{
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+
+	// Rearrange to the ABEF/CDGH layout used by sha256rnds2
+	const __m128i dcba = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xb1);
+	const __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1b);
+
+	__m128i state0 = _mm_alignr_epi8(dcba, efgh, 8);
+	__m128i state1 = _mm_blend_epi16(efgh, dcba, 0xf0);
+
+	for (usz i = 0; i < blocks; i++)
+	{
+		const __m128i abef_save = state0;
+		const __m128i cdgh_save = state1;
+
+		__m128i msg[4];
+
+		for (usz j = 0; j < 4; j++)
+		{
+			msg[j] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 64 + j * 16)), mask);
+		}
+
+		sha256_ni_block(state0, state1, msg, std::make_integer_sequence<int, 16>{});
+
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+	}
+
+	const __m128i feba = _mm_shuffle_epi32(state0, 0x1b);
+	const __m128i dchg = _mm_shuffle_epi32(state1, 0xb1);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xf0));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+void sha1_process_hw(u32 state[5], const u8* data, usz blocks)
+{
+	u32* const states[1]{state};
+	const u8* const inputs[1]{data};
+	sha1_ni<1>(states, inputs, blocks);
+}
+
+void sha1_process_hw_x2(u32 state0[5], const u8* data0, u32 state1[5], const u8* data1, usz blocks)
+{
+	u32* const states[2]{state0, state1};
+	const u8* const inputs[2]{data0, data1};
+	sha1_ni<2>(states, inputs, blocks);
+}
+
+void sha256_process_hw(u32 state[8], const u8* data, usz blocks)
+{
+	sha256_ni(state, data, blocks);
+}
+
+#elif defined(SHA_HW_ARM64)
+
+// Rounds 4*G to 4*G+3, following the ARMv8 crypto extension reference sequence
+template <int G>
+static inline void sha1_arm_rounds(uint32x4_t& abcd, u32& e0, u32& e1, uint32x4_t& tmp0, uint32x4_t& tmp1, uint32x4_t (&msg)[4])
+{
+	u32& e_in = G % 2 ? e1 : e0;
+	u32& e_out = G % 2 ? e0 : e1;
+	uint32x4_t& wk = G % 2 ? tmp1 : tmp0;
+
+	e_out = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+
+	if constexpr (G < 5)
+	{
+		abcd = vsha1cq_u32(abcd, e_in, wk);
+	}
+	else if constexpr (G >= 10 && G < 15)
+	{
+		abcd = vsha1mq_u32(abcd, e_in, wk);
+	}
+	else
+	{
+		abcd = vsha1pq_u32(abcd, e_in, wk);
+	}
+
+	if constexpr (G <= 17)
+	{
+		wk = vaddq_u32(msg[(G + 2) % 4], vdupq_n_u32(s_sha1_k[(G + 2) / 5]));
+	}
+
+	if constexpr (G >= 1 && G <= 16)
+	{
+		msg[(G + 3) % 4] = vsha1su1q_u32(msg[(G + 3) % 4], msg[(G + 2) % 4]);
+	}
+
+	if constexpr (G <= 15)
+	{
+		msg[G % 4] = vsha1su0q_u32(msg[G % 4], msg[(G + 1) % 4], msg[(G + 2) % 4]);
+	}
+}
+
+template <int... G>
+static inline void sha1_arm_block(uint32x4_t& abcd, u32& e0, u32& e1, uint32x4_t& tmp0, uint32x4_t& tmp1, uint32x4_t (&msg)[4], std::integer_sequence<int, G...>)
+{
+	(sha1_arm_rounds<G>(abcd, e0, e1, tmp0, tmp1, msg), ...);
+}
+
+template <int G>
+static inline void sha256_arm_rounds(uint32x4_t& state0, uint32x4_t& state1, uint32x4_t& tmp0, uint32x4_t& tmp1, uint32x4_t (&msg)[4])
+{
+	uint32x4_t& wk = G % 2 ? tmp1 : tmp0;
+	uint32x4_t& wk_next = G % 2 ? tmp0 : tmp1;
+
+	if constexpr (G <= 11)
+	{
+		msg[G % 4] = vsha256su0q_u32(msg[G % 4], msg[(G + 1) % 4]);
+	}
+
+	const uint32x4_t abcd = state0;
+
+	if constexpr (G <= 14)
+	{
+		wk_next = vaddq_u32(msg[(G + 1) % 4], vld1q_u32(s_sha256_k + (G + 1) * 4));
+	}
+
+	state0 = vsha256hq_u32(state0, state1, wk);
+	state1 = vsha256h2q_u32(state1, abcd, wk);
+
+	if constexpr (G <= 11)
+	{
+		msg[G % 4] = vsha256su1q_u32(msg[G % 4], msg[(G + 2) % 4], msg[(G + 3) % 4]);
+	}
+}
+
+template <int... G>
+static inline void sha256_arm_block(uint32x4_t& state0, uint32x4_t& state1, uint32x4_t& tmp0, uint32x4_t& tmp1, uint32x4_t (&msg)[4], std::integer_sequence<int, G...>)
+{
+	(sha256_arm_rounds<G>(state0, state1, tmp0, tmp1, msg), ...);
+}
+
+void sha1_process_hw(u32 state[5], const u8* data, usz blocks)
+{
+	uint32x4_t abcd = vld1q_u32(state);
+	u32 e0 = state[4];
+
+	for (usz i = 0; i < blocks; i++)
+	{
+		const uint32x4_t abcd_save = abcd;
+		const u32 e0_save = e0;
+
+		uint32x4_t msg[4];
+
+		for (usz j = 0; j < 4; j++)
+		{
+			msg[j] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 64 + j * 16)));
+		}
+
+		uint32x4_t tmp0 = vaddq_u32(msg[0], vdupq_n_u32(s_sha1_k[0]));
+		uint32x4_t tmp1 = vaddq_u32(msg[1], vdupq_n_u32(s_sha1_k[0]));
+		u32 e1 = 0;
+
+		sha1_arm_block(abcd, e0, e1, tmp0, tmp1, msg, std::make_integer_sequence<int, 20>{});
+
+		e0 += e0_save;
+		abcd = vaddq_u32(abcd, abcd_save);
+	}
+
+	vst1q_u32(state, abcd);
+	state[4] = e0;
+}
+
+void sha1_process_hw_x2(u32 state0[5], const u8* data0, u32 state1[5], const u8* data1, usz blocks)
+{
+	// Not interleaved yet, hash the streams one after another
+	sha1_process_hw(state0, data0, blocks);
+	sha1_process_hw(state1, data1, blocks);
+}
+
+void sha256_process_hw(u32 state[8], const u8* data, usz blocks)
+{
+	uint32x4_t state0 = vld1q_u32(state);
+	uint32x4_t state1 = vld1q_u32(state + 4);
+
+	for (usz i = 0; i < blocks; i++)
+	{
+		const uint32x4_t abcd_save = state0;
+		const uint32x4_t efgh_save = state1;
+
+		uint32x4_t msg[4];
+
+		for (usz j = 0; j < 4; j++)
+		{
+			msg[j] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 64 + j * 16)));
+		}
+
+		uint32x4_t tmp0 = vaddq_u32(msg[0], vld1q_u32(s_sha256_k));
+		uint32x4_t tmp1;
+
+		sha256_arm_block(state0, state1, tmp0, tmp1, msg, std::make_integer_sequence<int, 16>{});
+
+		state0 = vaddq_u32(state0, abcd_save);
+		state1 = vaddq_u32(state1, efgh_save);
+	}
+
+	vst1q_u32(state, state0);
+	vst1q_u32(state + 4, state1);
+}
+
+#else
+
+void sha1_process_hw(u32[5], const u8*, usz)
+{
+	fmt::throw_exception("Unsupported");
+}
+
+void sha1_process_hw_x2(u32[5], const u8*, u32[5], const u8*, usz)
+{
+	fmt::throw_exception("Unsupported");
+}
+
+void sha256_process_hw(u32[8], const u8*, usz)
+{
+	fmt::throw_exception("Unsupported");
+}
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "util/types.hpp"
+
+// Hardware SHA-1/SHA-256 block functions (SHA-NI on x86-64, crypto extensions on AArch64).
+// The state arrays use the layout of sha1_context and mbedtls_sha256_context, data must hold whole 64-byte blocks.
+
+// Check whether the block functions below can be used on this CPU
+bool sha_hw_supported();
+
+void sha1_process_hw(u32 state[5], const u8* data, usz blocks);
+
+// Process two independent streams of the same number of blocks, interleaving them to hide instruction latency
+void sha1_process_hw_x2(u32 state0[5], const u8* data0, u32 state1[5], const u8* data1, usz blocks);
+
+void sha256_process_hw(u32 state[8], const u8* data, usz blocks);
@@ -1,8 +1,11 @@
 #include "stdafx.h"
 #include "aes.h"
+#include "sha1.h"
 #include "unself.h"
 #include "util/asm.hpp"
 #include "Emu/System.h"
+#include "Emu/system_config.h"
+#include "Emu/event_trace.hpp"
 #include "Emu/system_utils.hpp"
 #include "Crypto/unzip.h"
 
@@ -1226,6 +1229,33 @@ bool SELFDecrypter::DecryptData()
 	return true;
 }
 
+std::string SELFDecrypter::GetCacheKey() const
+{
+	// The headers (including the encrypted metadata) identify the image, the decrypted data keys identify the key used
+	std::vector<u8> headers(std::min<u64>(sce_hdr.se_hsize, self_f.size()));
+	self_f.read_at(0, headers.data(), headers.size());
+
+	const u64 file_size = self_f.size();
+
+	sha1_context ctx;
+	u8 output[20];
+
+	sha1_starts(&ctx);
+	sha1_update(&ctx, headers.data(), headers.size());
+	sha1_update(&ctx, reinterpret_cast<const u8*>(&file_size), sizeof(file_size));
+	sha1_update(&ctx, data_keys.get(), data_keys_length);
+	sha1_finish(&ctx, output);
+
+	std::string key;
+
+	for (const u8 b : output)
+	{
+		fmt::append(key, "%02x", b);
+	}
+
+	return key;
+}
+
 fs::file SELFDecrypter::MakeElf(bool isElf32)
 {
 	// Create a new ELF file.
@@ -1360,6 +1390,143 @@ static bool CheckDebugSelf(fs::file& s)
 	return false;
 }
 
+namespace
+{
+	constexpr u64 self_cache_magic = "RPCSELFC"_u64;
+	constexpr u32 self_cache_version = 2;
+
+	struct self_cache_header
+	{
+		u64 magic;
+		u32 version;
+		u32 has_exec_hash;
+		u64 size;
+		s64 mtime; // Modification time given to the entry, checked with its size instead of hashing the image on every boot
+		u8 exec_hash[20]; // PPU executable hash of the image, memoized by ppu_load_exec
+		u8 pad[4];
+	};
+
+	// Decrypted images are stored unencrypted in cache/self_cache/, entries are never evicted
+	std::string get_self_cache_path(const std::string& key)
+	{
+		return rpcs3::utils::get_cache_dir() + "self_cache/" + key + ".elf";
+	}
+
+	// Read the header of an entry which was not modified since it was written
+	bool read_self_cache_header(const fs::file& f, self_cache_header& header)
+	{
+		if (f.read_at(0, &header, sizeof(header)) != sizeof(header) || header.magic != self_cache_magic || header.version != self_cache_version)
+		{
+			return false;
+		}
+
+		const fs::stat_t stat = f.get_stat();
+		return stat.size == header.size + sizeof(header) && stat.mtime == header.mtime;
+	}
+
+	// Write the header and restore the modification time it records
+	bool write_self_cache_header(const std::string& path, fs::file& f, const self_cache_header& header)
+	{
+		if (f.write(&header, sizeof(header)) != sizeof(header))
+		{
+			return false;
+		}
+
+		f.close();
+		return fs::utime(path, header.mtime, header.mtime);
+	}
+
+	fs::file load_cached_elf(const std::string& path)
+	{
+		const fs::file f(path);
+
+		if (!f)
+		{
+			return {};
+		}
+
+		self_cache_header header{};
+
+		if (!read_self_cache_header(f, header))
+		{
+			self_log.warning("Ignoring invalid or modified decrypted executable cache entry '%s'", path);
+			return {};
+		}
+
+		std::vector<u8> data(header.size);
+
+		if (f.read_at(sizeof(header), data.data(), data.size()) != data.size())
+		{
+			return {};
+		}
+
+		self_log.notice("Loaded decrypted executable from cache (%s)", path);
+		return fs::make_stream(std::move(data));
+	}
+
+	bool save_cached_elf(const std::string& path, const fs::file& elf)
+	{
+		const std::vector<u8> data = elf.to_vector<u8>();
+
+		self_cache_header header{};
+		header.magic = self_cache_magic;
+		header.version = self_cache_version;
+		header.size = data.size();
+		header.mtime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+		fs::create_path(fs::get_parent_dir(path));
+
+		fs::pending_file temp(path);
+
+		if (!temp.file || temp.file.write(&header, sizeof(header)) < sizeof(header) || temp.file.write(data.data(), data.size()) < data.size() || !temp.commit())
+		{
+			self_log.error("Failed to save decrypted executable cache entry '%s' (%s)", path, fs::g_tls_error);
+			return false;
+		}
+
+		if (!fs::utime(path, header.mtime, header.mtime))
+		{
+			self_log.error("Failed to set the time of decrypted executable cache entry '%s' (%s)", path, fs::g_tls_error);
+			return false;
+		}
+
+		return true;
+	}
+}
+
+bool load_self_cache_exec_hash(const std::string& cache_path, u8 (&hash)[20])
+{
+	const fs::file f(cache_path);
+	self_cache_header header{};
+
+	if (!f || !read_self_cache_header(f, header) || !header.has_exec_hash)
+	{
+		return false;
+	}
+
+	std::memcpy(hash, header.exec_hash, sizeof(hash));
+	return true;
+}
+
+void save_self_cache_exec_hash(const std::string& cache_path, const u8 (&hash)[20])
+{
+	fs::file f(cache_path, fs::read + fs::write);
+	self_cache_header header{};
+
+	if (!f || !read_self_cache_header(f, header))
+	{
+		return;
+	}
+
+	header.has_exec_hash = 1;
+	std::memcpy(header.exec_hash, hash, sizeof(hash));
+
+	if (!write_self_cache_header(cache_path, f, header))
+	{
+		self_log.error("Failed to update decrypted executable cache entry '%s' (%s)", cache_path, fs::g_tls_error);
+	}
+}
+
 fs::file decrypt_self(fs::file elf_or_self, u8* klic_key, SelfAdditionalInfo* out_info, bool require_encrypted)
 {
 	if (out_info)
@@ -1383,6 +1550,8 @@ fs::file decrypt_self(fs::file elf_or_self, u8* klic_key, SelfAdditionalInfo* ou
 			return elf_or_self;
 		}
 
+		trace_scope trace0("decrypt_self", "boot", elf_or_self.size());
+
 		// Check the ELF file class (32 or 64 bit).
 		const bool isElf32 = IsSelfElf32(elf_or_self);
 
@@ -1403,6 +1572,22 @@ fs::file decrypt_self(fs::file elf_or_self, u8* klic_key, SelfAdditionalInfo* ou
 			return fs::file{};
 		}
 
+		// Reuse the image decrypted by a previous boot if it is intact
+		const std::string cache_path = g_cfg.core.cache_decrypted_executables ? get_self_cache_path(self_dec.GetCacheKey()) : std::string{};
+
+		if (!cache_path.empty())
+		{
+			if (fs::file elf = load_cached_elf(cache_path))
+			{
+				if (out_info)
+				{
+					out_info->cache_path = cache_path;
+				}
+
+				return elf;
+			}
+		}
+
 		// Decrypt the SELF file data.
 		if (!self_dec.DecryptData())
 		{
@@ -1411,7 +1596,14 @@ fs::file decrypt_self(fs::file elf_or_self, u8* klic_key, SelfAdditionalInfo* ou
 		}
 
 		// Make a new ELF file from this SELF.
-		return self_dec.MakeElf(isElf32);
+		fs::file elf = self_dec.MakeElf(isElf32);
+
+		if (!cache_path.empty() && elf && save_cached_elf(cache_path, elf) && out_info)
+		{
+			out_info->cache_path = cache_path;
+		}
+
+		return elf;
 	}
 
 	if (require_encrypted)
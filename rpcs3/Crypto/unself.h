@@ -402,6 +402,7 @@ struct SelfAdditionalInfo
 	bool valid = false;
 	std::vector<supplemental_header> supplemental_hdr;
 	program_identification_header prog_id_hdr;
+	std::string cache_path; // Decrypted executable cache entry of the image (empty if not cached)
 };
 
 class SCEDecrypter
@@ -480,6 +481,7 @@ public:
 	bool DecryptData();
 	bool DecryptNPDRM(u8 *metadata, u32 metadata_size);
 	const NPD_HEADER* GetNPDHeader() const;
+	std::string GetCacheKey() const;
 	static bool GetKeyFromRap(const char *content_id, u8 *npdrm_key);
 
 private:
@@ -563,4 +565,8 @@ fs::file decrypt_self(fs::file elf_or_self, u8* klic_key = nullptr, SelfAddition
 bool verify_npdrm_self_headers(const fs::file& self, u8* klic_key = nullptr, NPD_HEADER* npd_out = nullptr);
 bool get_npdrm_self_header(const fs::file& self, NPD_HEADER& npd);
 
+// PPU executable hash memoized in a decrypted executable cache entry (SelfAdditionalInfo::cache_path)
+bool load_self_cache_exec_hash(const std::string& cache_path, u8 (&hash)[20]);
+void save_self_cache_exec_hash(const std::string& cache_path, const u8 (&hash)[20]);
+
 u128 get_default_self_klic();
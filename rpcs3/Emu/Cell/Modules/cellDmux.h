@@ -294,6 +294,15 @@ using DmuxNotifyProgEndCode = error_code(vm::ptr<void>, vm::ptr<void>);
 using DmuxEsNotifyAuFound = error_code(vm::ptr<void>, vm::cptr<void>, vm::ptr<void>);
 using DmuxEsNotifyFlushDone = error_code(vm::ptr<void>, vm::ptr<void>);
 
+// Access unit information passed from the demuxer core to cellDmux
+struct DmuxAuInfo
+{
+	CellDmuxAuInfo info;
+	vm::bptr<void> specific_info;
+	be_t<u32> specific_info_size;
+	b8 is_rap;
+};
+
 using CellDmuxCoreOpQueryAttr = error_code(vm::cptr<void>, vm::ptr<CellDmuxPamfAttr>);
 using CellDmuxCoreOpOpen = error_code(vm::cptr<void>, vm::cptr<CellDmuxResource>, vm::cptr<CellDmuxResourceSpurs>, vm::cptr<DmuxCb<DmuxNotifyDemuxDone>>, vm::cptr<DmuxCb<DmuxNotifyProgEndCode>>, vm::cptr<DmuxCb<DmuxNotifyFatalErr>>, vm::pptr<void>);
 using CellDmuxCoreOpClose = error_code(vm::ptr<void>);
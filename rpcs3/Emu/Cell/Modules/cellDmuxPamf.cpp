@@ -1,9 +1,20 @@
 #include "stdafx.h"
+#include "Emu/perf_meter.hpp"
 #include "Emu/Cell/PPUModule.h"
+#include "Emu/Cell/lv2/sys_sync.h"
+#include "Emu/Cell/lv2/sys_ppu_thread.h"
+#include "Emu/Cell/lv2/sys_mutex.h"
+#include "Emu/Cell/lv2/sys_cond.h"
 #include "Emu/IdManager.h"
+#include "Emu/savestate_utils.hpp"
+#include "sysPrxForUser.h"
+#include "util/asm.hpp"
 
 #include "cellDmux.h"
 #include "cellDmuxPamf.h"
+#include "cellPamf.h"
+
+#include <optional>
 
 
 vm::gvar<CellDmuxCoreOps> g_cell_dmux_core_ops_pamf;
@@ -11,107 +22,1225 @@ vm::gvar<CellDmuxCoreOps> g_cell_dmux_core_ops_raw_es;
 
 LOG_CHANNEL(cellDmuxPamf)
 
+namespace
+{
+	// AC-3 bit rates in kbit/s, indexed by frmsizecod / 2
+	constexpr u16 ac3_bit_rates[19] = { 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 576, 640 };
+
+	// AC-3 sampling rates, indexed by fscod
+	constexpr u32 ac3_sampling_rates[3] = { 48000, 44100, 32000 };
+
+	struct dmux_pamf_es_params
+	{
+		u32 au_max_size;
+		u32 au_buf_size;
+		u32 au_queue_max_size;
+		u32 specific_info_size;
+	};
+
+	std::optional<DmuxPamfStreamType> get_stream_type(const CellCodecEsFilterId& filter_id)
+	{
+		if ((filter_id.filterIdMajor & 0xf0) == 0xe0)
+		{
+			return filter_id.supplementalInfo1 ? DmuxPamfStreamType::avc : DmuxPamfStreamType::m2v;
+		}
+
+		if (filter_id.filterIdMajor != 0xbd)
+		{
+			return std::nullopt;
+		}
+
+		switch (filter_id.filterIdMinor & 0xf0)
+		{
+		case 0x00: return DmuxPamfStreamType::atracx;
+		case 0x20: return DmuxPamfStreamType::user_data;
+		case 0x30: return DmuxPamfStreamType::ac3;
+		case 0x40: return DmuxPamfStreamType::lpcm;
+		default: return std::nullopt;
+		}
+	}
+
+	// The access unit buffer also has to fit one packet payload on top of the largest access unit
+	dmux_pamf_es_params get_es_params(DmuxPamfStreamType type, vm::cptr<void> es_specific_info)
+	{
+		switch (type)
+		{
+		case DmuxPamfStreamType::avc:
+		{
+			const u32 level = es_specific_info ? +vm::static_ptr_cast<const CellDmuxPamfEsSpecificInfoAvc>(es_specific_info)->level : +CELL_DMUX_PAMF_AVC_LEVEL_4P2;
+			const u32 au_max_size = level >= CELL_DMUX_PAMF_AVC_LEVEL_4P1 ? 0xc0000 : 0x60000;
+			return { au_max_size, au_max_size * 2, 0x20, sizeof(CellDmuxPamfAuSpecificInfoAvc) };
+		}
+		case DmuxPamfStreamType::m2v:
+		{
+			const u32 profile_level = es_specific_info ? +vm::static_ptr_cast<const CellDmuxPamfEsSpecificInfoM2v>(es_specific_info)->profileLevel : +CELL_DMUX_PAMF_M2V_MP_HL;
+			const u32 au_max_size = profile_level >= CELL_DMUX_PAMF_M2V_MP_H14 ? 0xc0000 : 0x60000;
+			return { au_max_size, au_max_size * 2, 0x20, sizeof(CellDmuxPamfAuSpecificInfoM2v) };
+		}
+		case DmuxPamfStreamType::atracx: return { 0x4000, 0x10000, 0x40, sizeof(CellDmuxPamfAuSpecificInfoAtrac3plus) };
+		case DmuxPamfStreamType::lpcm: return { 0x4000, 0x10000, 0x40, sizeof(CellDmuxPamfAuSpecificInfoLpcm) };
+		case DmuxPamfStreamType::ac3: return { 0x4000, 0x10000, 0x40, sizeof(CellDmuxPamfAuSpecificInfoAc3) };
+		case DmuxPamfStreamType::user_data: return { 0x4000, 0x10000, 0x40, sizeof(CellDmuxPamfAuSpecificInfoUserData) };
+		}
+
+		fmt::throw_exception("Unreachable");
+	}
+
+	u32 get_es_mem_size(const dmux_pamf_es_params& params)
+	{
+		return utils::align(static_cast<u32>(sizeof(DmuxPamfElementaryStream)), 0x80) + params.au_buf_size + 0x7f;
+	}
+
+	u64 get_pes_timestamp(const u8* data)
+	{
+		return (u64{data[0]} & 0x0e) << 29 | u64{data[1]} << 22 | (u64{data[2]} & 0xfe) << 14 | u64{data[3]} << 7 | u64{data[4]} >> 1;
+	}
+}
+
+void DmuxPamfElementaryStream::reset()
+{
+	free_pos = 0;
+	wrap_pos = u32{umax};
+	delivered_size = 0;
+	au_start = 0;
+	au_size = 0;
+	scan_pos = 0;
+	au_pts = u64{umax};
+	au_dts = u64{umax};
+	pes_pts = u64{umax};
+	pes_dts = u64{umax};
+	pes_ts_pos = 0;
+	pes_ts_pending = false;
+	user_data = 0;
+	au_started = false;
+	au_has_picture = false;
+	au_is_rap = false;
+	rap_pending = false;
+	flush_requested = false;
+	reset_requested = false;
+	au_pending = false;
+	pending_size = 0;
+}
+
+void DmuxPamfElementaryStream::discard_au()
+{
+	// The pending access unit was already reported and has to stay intact
+	au_size = au_pending ? +pending_size : 0;
+	scan_pos = 0;
+	pes_ts_pending = false;
+
+	if (!au_pending)
+	{
+		au_started = false;
+	}
+}
+
+bool DmuxPamfElementaryStream::reserve(u32 size)
+{
+	if (au_size + size > au_max_size)
+	{
+		cellDmuxPamf.error("Access unit is too large, discarding it (stream_id=0x%x, private_stream_id=0x%x, size=0x%x)", stream_id, private_stream_id, au_size + size);
+		discard_au();
+	}
+
+	const u32 new_size = au_size + size;
+
+	if (!delivered_size)
+	{
+		// Everything before the access unit being assembled was released
+		free_pos = au_start;
+		wrap_pos = u32{umax};
+	}
+
+	if (au_start < free_pos)
+	{
+		// The buffer already wrapped around, the free space ends at the oldest delivered access unit
+		return au_start + new_size <= free_pos;
+	}
+
+	if (au_start + new_size <= au_buf_size)
+	{
+		return true;
+	}
+
+	if (delivered_size && new_size > free_pos)
+	{
+		return false;
+	}
+
+	// Move the partial access unit to the start of the buffer, access units have to be contiguous
+	std::memmove(au_buf.get_ptr(), au_buf.get_ptr() + au_start, au_size);
+
+	wrap_pos = delivered_size ? +au_start : u32{umax};
+	au_start = 0;
+
+	if (!delivered_size)
+	{
+		free_pos = 0;
+	}
+
+	return true;
+}
+
+void DmuxPamfElementaryStream::release(u32 addr, u32 size)
+{
+	if (addr < au_buf.addr() || addr + size > au_buf.addr() + au_buf_size)
+	{
+		cellDmuxPamf.error("release(): Invalid memory range (addr=0x%x, size=0x%x)", addr, size);
+		return;
+	}
+
+	// The access unit may have been delivered before the elementary stream was reset
+	delivered_size = delivered_size > size ? delivered_size - size : 0;
+	free_pos = addr - au_buf.addr() + size;
+
+	if (free_pos == wrap_pos)
+	{
+		free_pos = 0;
+		wrap_pos = u32{umax};
+	}
+
+	if (!delivered_size)
+	{
+		free_pos = au_start;
+		wrap_pos = u32{umax};
+	}
+}
+
+void DmuxPamfElementaryStream::push_payload(const u8* data, u32 size, bool has_ts, u64 pts, u64 dts, u64 user_data)
+{
+	if (has_ts)
+	{
+		pes_pts = pts;
+		pes_dts = dts;
+		pes_ts_pos = au_size;
+		pes_ts_pending = true;
+	}
+
+	this->user_data = user_data;
+
+	const bool was_empty = !au_size;
+
+	std::memcpy(au_buf.get_ptr() + au_start + au_size, data, size);
+	au_size += size;
+
+	// Video access units start with the first start code found
+	if (was_empty && type != DmuxPamfStreamType::avc && type != DmuxPamfStreamType::m2v)
+	{
+		start_au();
+	}
+
+	find_au();
+}
+
+void DmuxPamfElementaryStream::start_au()
+{
+	au_pts = u64{umax};
+	au_dts = u64{umax};
+	au_has_picture = false;
+	au_is_rap = rap_pending;
+	rap_pending = false;
+
+	if (pes_ts_pending && pes_ts_pos == 0u)
+	{
+		au_pts = pes_pts;
+		au_dts = pes_dts;
+		pes_ts_pending = false;
+	}
+}
+
+void DmuxPamfElementaryStream::skip(u32 size)
+{
+	u8* const data = au_buf.get_ptr() + au_start;
+
+	std::memmove(data, data + size, au_size - size);
+
+	au_size -= size;
+	scan_pos = scan_pos > size ? scan_pos - size : 0;
+	pes_ts_pos = pes_ts_pos > size ? pes_ts_pos - size : 0;
+}
+
+void DmuxPamfElementaryStream::find_au()
+{
+	if (au_pending || !au_size)
+	{
+		return;
+	}
+
+	const u8* const data = au_buf.get_ptr() + au_start;
+
+	switch (type)
+	{
+	case DmuxPamfStreamType::avc:
+	case DmuxPamfStreamType::m2v:
+	{
+		// Only the newly added data is searched
+		for (u32 i = scan_pos; i + 3 < au_size; i++)
+		{
+			if (data[i + 2] > 1)
+			{
+				i += 2;
+				continue;
+			}
+
+			if (data[i] != 0 || data[i + 1] != 0 || data[i + 2] != 1)
+			{
+				continue;
+			}
+
+			const u8 code = data[i + 3];
+
+			u32 pos = i;
+			bool boundary;
+
+			if (type == DmuxPamfStreamType::avc)
+			{
+				// Access unit delimiter, including the preceding zero_byte
+				boundary = (code & 0x1f) == 9;
+
+				if (boundary && i > 0 && data[i - 1] == 0)
+				{
+					pos--;
+				}
+			}
+			else
+			{
+				// Sequence header, GOP header or picture start code after the picture data of the current access unit
+				boundary = (code == 0xb3 || code == 0xb8 || code == 0x00) && au_has_picture;
+			}
+
+			if (!au_started)
+			{
+				if (pos)
+				{
+					cellDmuxPamf.warning("Skipping 0x%x bytes before the first start code (stream_id=0x%x)", pos, stream_id);
+					skip(pos);
+					i -= pos;
+				}
+
+				au_started = true;
+				start_au();
+			}
+			else if (boundary && pos)
+			{
+				// Resume at this start code once the access unit was accepted
+				scan_pos = i;
+				set_pending(pos);
+				return;
+			}
+
+			if (type == DmuxPamfStreamType::avc)
+			{
+				if ((code & 0x1f) == 5)
+				{
+					au_is_rap = true;
+				}
+			}
+			else if (code == 0x00)
+			{
+				au_has_picture = true;
+			}
+			else if ((code == 0xb3 || code == 0xb8) && !au_has_picture)
+			{
+				au_is_rap = true;
+			}
+
+			i += 3;
+		}
+
+		scan_pos = std::max<u32>(scan_pos, au_size > 3 ? au_size - 3 : 0);
+		return;
+	}
+	case DmuxPamfStreamType::atracx:
+	{
+		while (au_size >= 8)
+		{
+			// ATS header
+			if (data[0] != 0x0f || data[1] != 0xd0)
+			{
+				u32 pos = 1;
+
+				while (pos + 1 < au_size && (data[pos] != 0x0f || data[pos + 1] != 0xd0))
+				{
+					pos++;
+				}
+
+				cellDmuxPamf.error("Invalid ATS header, skipping 0x%x bytes (stream_id=0x%x, private_stream_id=0x%x)", pos, stream_id, private_stream_id);
+				skip(pos);
+				continue;
+			}
+
+			const u32 frame_size = ((((data[2] & 3) << 8) | data[3]) * 8 + 8) + 8;
+
+			if (au_size >= frame_size)
+			{
+				set_pending(frame_size);
+			}
+
+			return;
+		}
+
+		return;
+	}
+	case DmuxPamfStreamType::ac3:
+	{
+		while (au_size >= 5)
+		{
+			const u8 fscod = data[4] >> 6;
+			const u8 frmsizecod = data[4] & 0x3f;
+
+			// Sync word
+			if (data[0] != 0x0b || data[1] != 0x77 || fscod == 3 || frmsizecod >= 38)
+			{
+				u32 pos = 1;
+
+				while (pos + 1 < au_size && (data[pos] != 0x0b || data[pos + 1] != 0x77))
+				{
+					pos++;
+				}
+
+				cellDmuxPamf.error("Invalid AC3 sync frame, skipping 0x%x bytes (stream_id=0x%x, private_stream_id=0x%x)", pos, stream_id, private_stream_id);
+				skip(pos);
+				continue;
+			}
+
+			// Frames at 44.1 kHz are padded with one word depending on the lowest bit of frmsizecod
+			const u32 frame_size = (ac3_bit_rates[frmsizecod / 2] * 96'000 / ac3_sampling_rates[fscod] + (fscod == 1 && (frmsizecod & 1))) * 2;
+
+			if (au_size >= frame_size)
+			{
+				set_pending(frame_size);
+			}
+
+			return;
+		}
+
+		return;
+	}
+	case DmuxPamfStreamType::lpcm:
+	case DmuxPamfStreamType::user_data:
+	{
+		// Every PES packet contains one access unit
+		set_pending(au_size);
+		return;
+	}
+	}
+}
+
+void DmuxPamfElementaryStream::set_pending(u32 size)
+{
+	au_pending = true;
+	pending_size = size;
+
+	au_info.info.auAddr = au_buf.addr() + au_start;
+	au_info.info.auSize = size;
+	au_info.info.auMaxSize = au_max_size;
+	au_info.info.userData = user_data;
+	au_info.info.ptsUpper = au_pts == umax ? CODEC_TS_INVALID : static_cast<u32>(au_pts >> 32);
+	au_info.info.ptsLower = au_pts == umax ? CODEC_TS_INVALID : static_cast<u32>(au_pts);
+	au_info.info.dtsUpper = au_dts == umax ? CODEC_TS_INVALID : static_cast<u32>(au_dts >> 32);
+	au_info.info.dtsLower = au_dts == umax ? CODEC_TS_INVALID : static_cast<u32>(au_dts);
+
+	if (type == DmuxPamfStreamType::lpcm)
+	{
+		const auto specific_info = reinterpret_cast<CellDmuxPamfAuSpecificInfoLpcm*>(au_specific_info);
+		specific_info->channelAssignmentInfo = static_cast<u8>(lpcm_info.numOfChannels == 1u ? CELL_DMUX_PAMF_LPCM_CH_M1 : lpcm_info.numOfChannels == 2u ? CELL_DMUX_PAMF_LPCM_CH_LR : lpcm_info.numOfChannels == 6u ? CELL_DMUX_PAMF_LPCM_CH_LRCLSRSLFE : CELL_DMUX_PAMF_LPCM_CH_LRCLSCS1CS2RSLFE);
+		specific_info->samplingFreqInfo = CELL_DMUX_PAMF_LPCM_FS_48K;
+		specific_info->bitsPerSample = static_cast<u8>(lpcm_info.bitsPerSample == 24u ? CELL_DMUX_PAMF_LPCM_BITS_PER_SAMPLE_24 : CELL_DMUX_PAMF_LPCM_BITS_PER_SAMPLE_16);
+		au_info.specific_info_size = sizeof(CellDmuxPamfAuSpecificInfoLpcm);
+	}
+	else
+	{
+		write_to_ptr<be_t<u32>>(au_specific_info, 0);
+		au_info.specific_info_size = sizeof(be_t<u32>);
+	}
+
+	au_info.specific_info.set(vm::get_addr(au_specific_info));
+
+	// Every audio frame can be decoded on its own
+	au_info.is_rap = (type != DmuxPamfStreamType::avc && type != DmuxPamfStreamType::m2v) || au_is_rap;
+}
+
+void DmuxPamfElementaryStream::commit_pending()
+{
+	delivered_size += pending_size;
+	au_start += pending_size;
+	au_size -= pending_size;
+	scan_pos = scan_pos > pending_size ? scan_pos - pending_size : 0;
+
+	if (pes_ts_pending)
+	{
+		// The time stamps belong to the next access unit if the PES packet started within the previous one
+		pes_ts_pos = pes_ts_pos > pending_size ? pes_ts_pos - pending_size : 0;
+	}
+
+	au_pending = false;
+	pending_size = 0;
+
+	if (au_size || au_started)
+	{
+		start_au();
+	}
+
+	find_au();
+}
+
+bool DmuxPamfContext::has_pending_au() const
+{
+	return std::any_of(std::begin(elementary_streams), std::end(elementary_streams), [](const vm::bptr<DmuxPamfElementaryStream>& es)
+	{
+		return es && es->au_pending;
+	});
+}
+
+bool DmuxPamfContext::has_work() const
+{
+	if (!run_thread || reset_stream_requested || demux_done_pending || prog_end_pending || fatal_error_pending)
+	{
+		return true;
+	}
+
+	for (const auto& es : elementary_streams)
+	{
+		if (es && (es->reset_requested || (es->flush_requested && !stream_active)))
+		{
+			return true;
+		}
+	}
+
+	return !waiting_for_consumer && (stream_active || has_pending_au());
+}
+
+vm::ptr<DmuxPamfElementaryStream> DmuxPamfContext::find_es(u32 stream_id, u32 private_stream_id) const
+{
+	for (const auto& es : elementary_streams)
+	{
+		if (es && es->stream_id == stream_id && es->private_stream_id == private_stream_id)
+		{
+			return es;
+		}
+	}
+
+	return vm::null;
+}
+
+bool DmuxPamfContext::demux_packet()
+{
+	const u8* const data = stream_addr.get_ptr() + stream_pos;
+	const u32 remaining = stream_size - stream_pos;
+
+	const auto invalid_stream = [&](std::string_view reason)
+	{
+		cellDmuxPamf.error("Invalid stream at offset 0x%x: %s", stream_pos, reason);
+		fatal_error_pending = true;
+		stream_pos = stream_size;
+		return true;
+	};
+
+	if (remaining < 4)
+	{
+		return invalid_stream("truncated start code");
+	}
+
+	const u32 start_code = read_from_ptr<be_t<u32>>(data);
+
+	switch (start_code)
+	{
+	case DMUX_PAMF_PACK_START_CODE:
+	{
+		if (remaining < 14)
+		{
+			return invalid_stream("truncated pack header");
+		}
+
+		stream_pos += 14 + (data[13] & 7);
+		return true;
+	}
+	case DMUX_PAMF_PROGRAM_END_CODE:
+	{
+		prog_end_pending = prog_end_code_cb;
+		stream_pos += 4;
+		return true;
+	}
+	default:
+	{
+		if ((start_code >> 8) != 1u)
+		{
+			return invalid_stream("start code not found");
+		}
+	}
+	}
+
+	if (remaining < 6)
+	{
+		return invalid_stream("truncated packet header");
+	}
+
+	const u32 packet_size = 6 + read_from_ptr<be_t<u16>>(data + 4);
+
+	if (packet_size > remaining)
+	{
+		return invalid_stream("truncated packet");
+	}
+
+	if (start_code == DMUX_PAMF_PRIVATE_STREAM_2)
+	{
+		// Entry point, the next video access unit is a random access point
+		for (const auto& es : elementary_streams)
+		{
+			if (es && (es->type == DmuxPamfStreamType::avc || es->type == DmuxPamfStreamType::m2v))
+			{
+				es->rap_pending = true;
+			}
+		}
+
+		stream_pos += packet_size;
+		return true;
+	}
+
+	if (start_code != DMUX_PAMF_PRIVATE_STREAM_1 && (start_code & 0xf0) != 0xe0)
+	{
+		// System header, padding and unknown streams
+		stream_pos += packet_size;
+		return true;
+	}
+
+	if (packet_size < 9 || (data[6] & 0xc0) != 0x80)
+	{
+		return invalid_stream("invalid PES header");
+	}
+
+	u32 payload_offset = 9 + data[8];
+
+	const bool has_pts = data[7] & 0x80;
+	const bool has_dts = data[7] & 0x40;
+
+	if (payload_offset > packet_size || (has_pts && payload_offset < 14) || (has_dts && payload_offset < 19))
+	{
+		return invalid_stream("invalid PES header length");
+	}
+
+	const u64 pts = has_pts ? get_pes_timestamp(data + 9) : umax;
+	const u64 dts = has_dts ? get_pes_timestamp(data + 14) : pts;
+
+	u32 private_stream_id = 0;
+
+	if (start_code == DMUX_PAMF_PRIVATE_STREAM_1)
+	{
+		// Private stream id followed by three bytes of private header
+		if (payload_offset + 4 > packet_size)
+		{
+			return invalid_stream("truncated private stream header");
+		}
+
+		private_stream_id = data[payload_offset];
+		payload_offset += 4;
+	}
+
+	const auto es = find_es(start_code & 0xff, private_stream_id);
+
+	if (!es)
+	{
+		stream_pos += packet_size;
+		return true;
+	}
+
+	const u32 payload_size = packet_size - payload_offset;
+
+	if (!es->reserve(payload_size))
+	{
+		waiting_for_consumer = true;
+		return false;
+	}
+
+	es->push_payload(data + payload_offset, payload_size, has_pts, pts, dts, stream_user_data);
+
+	stream_pos += packet_size;
+	return true;
+}
+
+bool DmuxPamfContext::demux_raw_es()
+{
+	const auto it = std::find_if(std::begin(elementary_streams), std::end(elementary_streams), [](const vm::bptr<DmuxPamfElementaryStream>& es) { return !!es; });
+
+	if (it == std::end(elementary_streams))
+	{
+		// Nothing to demux to
+		stream_pos = stream_size;
+		return true;
+	}
+
+	const auto& es = *it;
+	const u32 size = std::min<u32>(stream_size - stream_pos, DMUX_PAMF_PACKET_SIZE);
+
+	if (!es->reserve(size))
+	{
+		waiting_for_consumer = true;
+		return false;
+	}
+
+	es->push_payload(stream_addr.get_ptr() + stream_pos, size, false, umax, umax, stream_user_data);
+
+	stream_pos += size;
+	return true;
+}
+
+void DmuxPamfContext::exec(ppu_thread& ppu)
+{
+	perf_meter<"DMUXPAMF"_u64> perf0;
+
+	const vm::ptr<DmuxPamfContext> _this = vm::ptr<DmuxPamfContext>::make(vm::get_addr(this));
+
+	switch (savestate)
+	{
+	case dmux_pamf_state::initial: break;
+	case dmux_pamf_state::waiting_for_work: goto label1_wait_for_work_state;
+	}
+
+	for (;;)
+	{
+		savestate = dmux_pamf_state::initial;
+
+		ensure(sys_mutex_lock(ppu, mutex, 0) == CELL_OK);
+
+		if (ppu.state & cpu_flag::again)
+		{
+			return;
+		}
+
+		while (!has_work())
+		{
+			savestate = dmux_pamf_state::waiting_for_work;
+			label1_wait_for_work_state:
+
+			ensure(sys_cond_wait(ppu, work_available, 0) == CELL_OK);
+
+			if (ppu.state & cpu_flag::again)
+			{
+				return;
+			}
+		}
+
+		if (!run_thread)
+		{
+			ensure(sys_mutex_unlock(ppu, mutex) == CELL_OK);
+			return;
+		}
+
+		// Block savestate creation until the callbacks were sent, the requests must not be consumed before this point
+		std::unique_lock savestate_lock{g_fxo->get<hle_locks_t>(), std::try_to_lock};
+
+		if (!savestate_lock.owns_lock())
+		{
+			ensure(sys_mutex_unlock(ppu, mutex) == CELL_OK);
+			ppu.state += cpu_flag::again;
+			return;
+		}
+
+		waiting_for_consumer = false;
+
+		const bool stream_was_reset = reset_stream_requested;
+
+		if (reset_stream_requested)
+		{
+			reset_stream_requested = false;
+
+			if (stream_active)
+			{
+				stream_active = false;
+				demux_done_pending = true;
+			}
+		}
+
+		for (const auto& es : elementary_streams)
+		{
+			if (es && es->reset_requested)
+			{
+				es->reset();
+			}
+		}
+
+		// Parse packets until an access unit is complete, the payload is copied only once into the access unit buffer
+		while (stream_active && !waiting_for_consumer && !has_pending_au())
+		{
+			if (stream_pos >= stream_size)
+			{
+				stream_active = false;
+				demux_done_pending = true;
+				break;
+			}
+
+			if (!(raw_es ? demux_raw_es() : demux_packet()))
+			{
+				break;
+			}
+		}
+
+		// Deliver the remaining data as the last access unit once the stream was consumed
+		std::vector<vm::ptr<DmuxPamfElementaryStream>> flushed_es;
+
+		for (const auto& es : elementary_streams)
+		{
+			if (!es || !es->flush_requested || stream_active || es->au_pending)
+			{
+				continue;
+			}
+
+			if (es->au_size)
+			{
+				es->set_pending(es->au_size);
+				continue;
+			}
+
+			es->flush_requested = false;
+			es->au_started = false;
+			flushed_es.push_back(es);
+		}
+
+		// The elementary streams can be disabled while the mutex is released for the callbacks
+		std::vector<std::pair<u32, vm::ptr<DmuxPamfElementaryStream>>> pending_es;
+
+		for (u32 i = 0; i < std::size(elementary_streams); i++)
+		{
+			if (const vm::ptr<DmuxPamfElementaryStream> es = elementary_streams[i]; es && es->au_pending)
+			{
+				pending_es.emplace_back(i, es);
+			}
+		}
+
+		ensure(sys_mutex_unlock(ppu, mutex) == CELL_OK);
+
+		for (const auto& [index, es] : pending_es)
+		{
+			const error_code ret = es->notify_au_found.cbFunc(ppu, es, es.ptr(&DmuxPamfElementaryStream::au_info), vm::ptr<void>::make(es->notify_au_found.cbArg));
+
+			ensure(sys_mutex_lock(ppu, mutex, 0) == CELL_OK);
+
+			// Skip the stream if it was disabled or reset during the callback
+			if (elementary_streams[index] != es || !es->au_pending)
+			{
+				ensure(sys_mutex_unlock(ppu, mutex) == CELL_OK);
+				continue;
+			}
+
+			if (ret == CELL_OK)
+			{
+				es->commit_pending();
+			}
+			else
+			{
+				// The access unit queue of cellDmux is full, try again after it released something
+				waiting_for_consumer = true;
+			}
+
+			ensure(sys_mutex_unlock(ppu, mutex) == CELL_OK);
+		}
+
+		for (const auto& es : flushed_es)
+		{
+			es->notify_flush_done.cbFunc(ppu, es, vm::ptr<void>::make(es->notify_flush_done.cbArg));
+		}
+
+		if (fatal_error_pending)
+		{
+			fatal_error_pending = false;
+			notify_fatal_err.cbFunc(ppu, _this, CELL_DMUX_ERROR_FATAL, vm::ptr<void>::make(notify_fatal_err.cbArg));
+		}
+
+		if (prog_end_pending)
+		{
+			prog_end_pending = false;
+			notify_prog_end_code.cbFunc(ppu, _this, vm::ptr<void>::make(notify_prog_end_code.cbArg));
+		}
+
+		if (demux_done_pending)
+		{
+			demux_done_pending = false;
+			notify_demux_done.cbFunc(ppu, _this, 0, vm::ptr<void>::make(notify_demux_done.cbArg));
+		}
+
+		if (stream_was_reset)
+		{
+			ensure(sys_mutex_lock(ppu, mutex, 0) == CELL_OK);
+			// Another reset may have been requested while the callbacks were sent
+			reset_stream_pending = reset_stream_requested;
+			ensure(sys_cond_signal_all(ppu, stream_reset) == CELL_OK);
+			ensure(sys_mutex_unlock(ppu, mutex) == CELL_OK);
+		}
+	}
+}
+
+template <typename F>
+error_code DmuxPamfContext::send_request(ppu_thread& ppu, F&& func)
+{
+	auto& savestate = *ppu.optional_savestate_state;
+	const bool signal = savestate.try_read<bool>().second;
+	savestate.clear();
+
+	if (!signal)
+	{
+		ensure(sys_mutex_lock(ppu, mutex, 0) == CELL_OK);
+
+		if (ppu.state & cpu_flag::again)
+		{
+			return {};
+		}
+
+		if (const error_code ret = func(); ret != CELL_OK)
+		{
+			ensure(sys_mutex_unlock(ppu, mutex) == CELL_OK);
+			return ret;
+		}
+
+		ensure(sys_mutex_unlock(ppu, mutex) == CELL_OK);
+	}
+
+	ensure(sys_cond_signal(ppu, work_available) == CELL_OK);
+
+	if (ppu.state & cpu_flag::again)
+	{
+		savestate(true);
+	}
+
+	return CELL_OK;
+}
+
+void dmuxPamfEntry(ppu_thread& ppu, vm::ptr<DmuxPamfContext> dmux)
+{
+	dmux->exec(ppu);
+
+	if (ppu.state & cpu_flag::again)
+	{
+		// For savestates, save argument
+		ppu.syscall_args[0] = dmux.addr();
+
+		return;
+	}
+
+	ppu_execute<&sys_ppu_thread_exit>(ppu, CELL_OK);
+}
+
 error_code _CellDmuxCoreOpQueryAttr(vm::cptr<CellDmuxPamfSpecificInfo> pamfSpecificInfo, vm::ptr<CellDmuxPamfAttr> pamfAttr)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpQueryAttr(pamfSpecificInfo=*0x%x, pamfAttr=*0x%x)", pamfSpecificInfo, pamfAttr);
+	cellDmuxPamf.notice("_CellDmuxCoreOpQueryAttr(pamfSpecificInfo=*0x%x, pamfAttr=*0x%x)", pamfSpecificInfo, pamfAttr);
+
+	ensure(!!pamfAttr); // Not checked on LLE
+
+	pamfAttr->maxEnabledEsNum = DMUX_PAMF_MAX_ENABLED_ES_NUM;
+	pamfAttr->version = DMUX_PAMF_VERSION;
+	pamfAttr->memSize = sizeof(DmuxPamfContext) + 0x7f;
 
 	return CELL_OK;
 }
 
-error_code _CellDmuxCoreOpOpen(vm::cptr<CellDmuxPamfSpecificInfo> pamfSpecificInfo, vm::cptr<CellDmuxResource> demuxerResource, vm::cptr<CellDmuxResourceSpurs> demuxerResourceSpurs, vm::cptr<DmuxCb<DmuxNotifyDemuxDone>> notifyDemuxDone,
+error_code _CellDmuxCoreOpOpen(ppu_thread& ppu, vm::cptr<CellDmuxPamfSpecificInfo> pamfSpecificInfo, vm::cptr<CellDmuxResource> demuxerResource, vm::cptr<CellDmuxResourceSpurs> demuxerResourceSpurs, vm::cptr<DmuxCb<DmuxNotifyDemuxDone>> notifyDemuxDone,
 	vm::cptr<DmuxCb<DmuxNotifyProgEndCode>> notifyProgEndCode, vm::cptr<DmuxCb<DmuxNotifyFatalErr>> notifyFatalErr, vm::pptr<void> handle)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpOpen(pamfSpecificInfo=*0x%x, demuxerResource=*0x%x, demuxerResourceSpurs=*0x%x, notifyDemuxDone=*0x%x, notifyProgEndCode=*0x%x, notifyFatalErr=*0x%x, handle=**0x%x)",
+	std::unique_lock savestate_lock{g_fxo->get<hle_locks_t>(), std::try_to_lock};
+
+	if (!savestate_lock.owns_lock())
+	{
+		ppu.state += cpu_flag::again;
+		return {};
+	}
+
+	cellDmuxPamf.notice("_CellDmuxCoreOpOpen(pamfSpecificInfo=*0x%x, demuxerResource=*0x%x, demuxerResourceSpurs=*0x%x, notifyDemuxDone=*0x%x, notifyProgEndCode=*0x%x, notifyFatalErr=*0x%x, handle=**0x%x)",
 		pamfSpecificInfo, demuxerResource, demuxerResourceSpurs, notifyDemuxDone, notifyProgEndCode, notifyFatalErr, handle);
 
+	ensure(!!demuxerResource && !!notifyDemuxDone && !!notifyProgEndCode && !!notifyFatalErr && !!handle); // Not checked on LLE
+	ensure(demuxerResource->memSize >= sizeof(DmuxPamfContext) + 0x7f);
+
+	const auto dmux = vm::ptr<DmuxPamfContext>::make(utils::align(+demuxerResource->memAddr, 0x80));
+
+	write_to_ptr(dmux.get_ptr(), DmuxPamfContext(*notifyDemuxDone, *notifyProgEndCode, *notifyFatalErr, pamfSpecificInfo && pamfSpecificInfo->programEndCodeCb,
+		demuxerResource->ppuThreadPriority, demuxerResource->ppuThreadStackSize));
+
+	const vm::var<sys_mutex_attribute_t> mutex_attr{{ SYS_SYNC_PRIORITY, SYS_SYNC_NOT_RECURSIVE, SYS_SYNC_NOT_PROCESS_SHARED, SYS_SYNC_NOT_ADAPTIVE, 0, 0, 0, { "_dxp001"_u64 } }};
+	const vm::var<sys_cond_attribute_t> cond_attr{{ SYS_SYNC_NOT_PROCESS_SHARED, 0, 0, { "_dxp002"_u64 } }};
+
+	ensure(sys_mutex_create(ppu, dmux.ptr(&DmuxPamfContext::mutex), mutex_attr) == CELL_OK);
+	ensure(sys_cond_create(ppu, dmux.ptr(&DmuxPamfContext::work_available), dmux->mutex, cond_attr) == CELL_OK);
+
+	cond_attr->name_u64 = "_dxp003"_u64;
+
+	ensure(sys_cond_create(ppu, dmux.ptr(&DmuxPamfContext::stream_reset), dmux->mutex, cond_attr) == CELL_OK);
+
+	*handle = dmux;
+
 	return CELL_OK;
 }
 
-error_code _CellDmuxCoreOpClose(vm::ptr<void> handle)
+error_code _CellDmuxCoreOpClose(ppu_thread& ppu, vm::ptr<DmuxPamfContext> handle)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpClose(handle=*0x%x)", handle);
+	cellDmuxPamf.notice("_CellDmuxCoreOpClose(handle=*0x%x)", handle);
 
-	return CELL_OK;
+	ensure(!!handle); // Not checked on LLE
+
+	error_code ret = sys_cond_destroy(ppu, handle->work_available);
+	ret = ret ? ret : sys_cond_destroy(ppu, handle->stream_reset);
+	ret = ret ? ret : sys_mutex_destroy(ppu, handle->mutex);
+
+	return ret != CELL_OK ? static_cast<error_code>(CELL_DMUX_ERROR_FATAL) : CELL_OK;
 }
 
-error_code _CellDmuxCoreOpResetStream(vm::ptr<void> handle)
+error_code _CellDmuxCoreOpResetStream(ppu_thread& ppu, vm::ptr<DmuxPamfContext> handle)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpResetStream(handle=*0x%x)", handle);
+	cellDmuxPamf.notice("_CellDmuxCoreOpResetStream(handle=*0x%x)", handle);
 
-	return CELL_OK;
+	ensure(!!handle); // Not checked on LLE
+
+	return handle->send_request(ppu, [&]() -> error_code
+	{
+		handle->reset_stream_requested = true;
+		handle->reset_stream_pending = true;
+		return CELL_OK;
+	});
 }
 
-error_code _CellDmuxCoreOpCreateThread(vm::ptr<void> handle)
+error_code _CellDmuxCoreOpCreateThread(ppu_thread& ppu, vm::ptr<DmuxPamfContext> handle)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpCreateThread(handle=*0x%x)", handle);
+	cellDmuxPamf.notice("_CellDmuxCoreOpCreateThread(handle=*0x%x)", handle);
+
+	ensure(!!handle); // Not checked on LLE
+
+	const vm::var<char[]> _name = vm::make_str("HLE PAMF demuxer");
+	const auto entry = g_fxo->get<ppu_function_manager>().func_addr(FIND_FUNC(dmuxPamfEntry));
+	ppu_execute<&sys_ppu_thread_create>(ppu, handle.ptr(&DmuxPamfContext::thread_id), entry, handle.addr(), +handle->ppu_thread_priority, +handle->ppu_thread_stack_size, SYS_PPU_THREAD_CREATE_JOINABLE, +_name);
 
 	return CELL_OK;
 }
 
-error_code _CellDmuxCoreOpJoinThread(vm::ptr<void> handle)
+error_code _CellDmuxCoreOpJoinThread(ppu_thread& ppu, vm::ptr<DmuxPamfContext> handle)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpJoinThread(handle=*0x%x)", handle);
+	std::unique_lock savestate_lock{g_fxo->get<hle_locks_t>(), std::try_to_lock};
 
-	return CELL_OK;
+	if (!savestate_lock.owns_lock())
+	{
+		ppu.state += cpu_flag::again;
+		return {};
+	}
+
+	cellDmuxPamf.notice("_CellDmuxCoreOpJoinThread(handle=*0x%x)", handle);
+
+	ensure(!!handle); // Not checked on LLE
+
+	ensure(sys_mutex_lock(ppu, handle->mutex, 0) == CELL_OK);
+	handle->run_thread = false;
+	ensure(sys_mutex_unlock(ppu, handle->mutex) == CELL_OK);
+	ensure(sys_cond_signal(ppu, handle->work_available) == CELL_OK);
+
+	vm::var<u64> thread_ret;
+	return sys_ppu_thread_join(ppu, static_cast<u32>(handle->thread_id), +thread_ret) != CELL_OK ? static_cast<error_code>(CELL_DMUX_ERROR_FATAL) : CELL_OK;
 }
 
 template <bool raw_es>
-error_code _CellDmuxCoreOpSetStream(vm::ptr<void> handle, vm::cptr<void> streamAddress, u32 streamSize, b8 discontinuity, u64 userData)
+error_code _CellDmuxCoreOpSetStream(ppu_thread& ppu, vm::ptr<DmuxPamfContext> handle, vm::cptr<u8> streamAddress, u32 streamSize, b8 discontinuity, u64 userData)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpSetStream<raw_es=%d>(handle=*0x%x, streamAddress=*0x%x, streamSize=0x%x, discontinuity=%d, userData=0x%llx)", raw_es, handle, streamAddress, streamSize, +discontinuity, userData);
+	cellDmuxPamf.trace("_CellDmuxCoreOpSetStream<raw_es=%d>(handle=*0x%x, streamAddress=*0x%x, streamSize=0x%x, discontinuity=%d, userData=0x%llx)", raw_es, handle, streamAddress, streamSize, +discontinuity, userData);
 
-	return CELL_OK;
+	ensure(!!handle && !!streamAddress); // Not checked on LLE
+
+	return handle->send_request(ppu, [&]() -> error_code
+	{
+		if (handle->stream_active)
+		{
+			return CELL_DMUX_ERROR_BUSY;
+		}
+
+		if (discontinuity)
+		{
+			for (const auto& es : handle->elementary_streams)
+			{
+				if (es)
+				{
+					es->discard_au();
+				}
+			}
+		}
+
+		handle->stream_addr = streamAddress;
+		handle->stream_size = streamSize;
+		handle->stream_pos = 0;
+		handle->stream_user_data = userData;
+		handle->raw_es = raw_es;
+		handle->stream_active = true;
+		handle->waiting_for_consumer = false;
+		return CELL_OK;
+	});
 }
 
-error_code _CellDmuxCoreOpFreeMemory(vm::ptr<void> esHandle, vm::ptr<void> memAddr, u32 memSize)
+error_code _CellDmuxCoreOpFreeMemory(ppu_thread& ppu, vm::ptr<DmuxPamfElementaryStream> esHandle, vm::ptr<u8> memAddr, u32 memSize)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpFreeMemory(esHandle=*0x%x, memAddr=*0x%x, memSize=0x%x)", esHandle, memAddr, memSize);
+	cellDmuxPamf.trace("_CellDmuxCoreOpFreeMemory(esHandle=*0x%x, memAddr=*0x%x, memSize=0x%x)", esHandle, memAddr, memSize);
 
-	return CELL_OK;
+	ensure(!!esHandle); // Not checked on LLE
+
+	const vm::ptr<DmuxPamfContext> dmux = esHandle->demuxer;
+
+	return dmux->send_request(ppu, [&]() -> error_code
+	{
+		esHandle->release(memAddr.addr(), memSize);
+		dmux->waiting_for_consumer = false;
+		return CELL_OK;
+	});
 }
 
 template <bool raw_es>
-error_code _CellDmuxCoreOpQueryEsAttr(vm::cptr<void> esFilterId, vm::cptr<void> esSpecificInfo, vm::ptr<CellDmuxPamfEsAttr> attr)
+error_code _CellDmuxCoreOpQueryEsAttr(vm::cptr<CellCodecEsFilterId> esFilterId, vm::cptr<void> esSpecificInfo, vm::ptr<CellDmuxPamfEsAttr> attr)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpQueryEsAttr<raw_es=%d>(esFilterId=*0x%x, esSpecificInfo=*0x%x, attr=*0x%x)", raw_es, esFilterId, esSpecificInfo, attr);
+	cellDmuxPamf.notice("_CellDmuxCoreOpQueryEsAttr<raw_es=%d>(esFilterId=*0x%x, esSpecificInfo=*0x%x, attr=*0x%x)", raw_es, esFilterId, esSpecificInfo, attr);
+
+	ensure(!!esFilterId && !!attr); // Not checked on LLE
+
+	const auto type = get_stream_type(*esFilterId);
+
+	if (!type)
+	{
+		return CELL_DMUX_ERROR_ARG;
+	}
+
+	const dmux_pamf_es_params params = get_es_params(*type, esSpecificInfo);
+
+	attr->auQueueMaxSize = params.au_queue_max_size;
+	attr->memSize = get_es_mem_size(params);
+	attr->specificInfoSize = params.specific_info_size;
 
 	return CELL_OK;
 }
 
 template <bool raw_es>
-error_code _CellDmuxCoreOpEnableEs(vm::ptr<void> handle, vm::cptr<void> esFilterId, vm::cptr<CellDmuxEsResource> esResource, vm::cptr<DmuxCb<DmuxEsNotifyAuFound>> notifyAuFound,
-	vm::cptr<DmuxCb<DmuxEsNotifyFlushDone>> notifyFlushDone, vm::cptr<void> esSpecificInfo, vm::pptr<void> esHandle)
+error_code _CellDmuxCoreOpEnableEs(ppu_thread& ppu, vm::ptr<DmuxPamfContext> handle, vm::cptr<CellCodecEsFilterId> esFilterId, vm::cptr<CellDmuxEsResource> esResource, vm::cptr<DmuxCb<DmuxEsNotifyAuFound>> notifyAuFound,
+	vm::cptr<DmuxCb<DmuxEsNotifyFlushDone>> notifyFlushDone, vm::cptr<void> esSpecificInfo, vm::pptr<DmuxPamfElementaryStream> esHandle)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpEnableEs<raw_es=%d>(handle=*0x%x, esFilterId=*0x%x, esResource=*0x%x, notifyAuFound=*0x%x, notifyFlushDone=*0x%x, esSpecificInfo=*0x%x, esHandle)",
+	cellDmuxPamf.notice("_CellDmuxCoreOpEnableEs<raw_es=%d>(handle=*0x%x, esFilterId=*0x%x, esResource=*0x%x, notifyAuFound=*0x%x, notifyFlushDone=*0x%x, esSpecificInfo=*0x%x, esHandle=**0x%x)",
 		raw_es, handle, esFilterId, esResource, notifyAuFound, notifyFlushDone, esSpecificInfo, esHandle);
 
-	return CELL_OK;
+	ensure(!!handle && !!esFilterId && !!esResource && !!notifyAuFound && !!notifyFlushDone && !!esHandle); // Not checked on LLE
+
+	const auto type = get_stream_type(*esFilterId);
+
+	if (!type)
+	{
+		return CELL_DMUX_ERROR_ARG;
+	}
+
+	const dmux_pamf_es_params params = get_es_params(*type, esSpecificInfo);
+
+	if (esResource->memSize < get_es_mem_size(params))
+	{
+		return CELL_DMUX_ERROR_ARG;
+	}
+
+	const auto es = vm::ptr<DmuxPamfElementaryStream>::make(utils::align(+esResource->memAddr, 0x80));
+	const auto au_buf = vm::ptr<u8>::make(es.addr() + utils::align(static_cast<u32>(sizeof(DmuxPamfElementaryStream)), 0x80));
+
+	// Raw elementary streams don't have PES headers, the filter only selects the access unit format
+	const u32 stream_id = raw_es ? 0 : +esFilterId->filterIdMajor;
+	const u32 private_stream_id = raw_es || esFilterId->filterIdMajor != 0xbd ? 0 : +esFilterId->filterIdMinor;
+
+	return handle->send_request(ppu, [&]() -> error_code
+	{
+		const auto slot = std::find_if(std::begin(handle->elementary_streams), std::end(handle->elementary_streams), [](const vm::bptr<DmuxPamfElementaryStream>& es) { return !es; });
+
+		if (slot == std::end(handle->elementary_streams) || (raw_es && slot != std::begin(handle->elementary_streams)) || (!raw_es && handle->find_es(stream_id, private_stream_id)))
+		{
+			return CELL_DMUX_ERROR_ARG;
+		}
+
+		write_to_ptr(es.get_ptr(), DmuxPamfElementaryStream(handle, stream_id, private_stream_id, *type, *notifyAuFound, *notifyFlushDone, au_buf, params.au_buf_size, params.au_max_size));
+
+		if (*type == DmuxPamfStreamType::lpcm && esSpecificInfo)
+		{
+			es->lpcm_info = *vm::static_ptr_cast<const CellDmuxPamfEsSpecificInfoLpcm>(esSpecificInfo);
+		}
+		else
+		{
+			es->lpcm_info = { CELL_DMUX_PAMF_FS_48K, 2, CELL_DMUX_PAMF_BITS_PER_SAMPLE_16 };
+		}
+
+		*slot = es;
+		*esHandle = es;
+		return CELL_OK;
+	});
 }
 
-error_code _CellDmuxCoreOpDisableEs(vm::ptr<void> esHandle)
+error_code _CellDmuxCoreOpDisableEs(ppu_thread& ppu, vm::ptr<DmuxPamfElementaryStream> esHandle)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpDisableEs(esHandle=*0x%x)", esHandle);
+	cellDmuxPamf.notice("_CellDmuxCoreOpDisableEs(esHandle=*0x%x)", esHandle);
 
-	return CELL_OK;
+	ensure(!!esHandle); // Not checked on LLE
+
+	const vm::ptr<DmuxPamfContext> dmux = esHandle->demuxer;
+
+	return dmux->send_request(ppu, [&]() -> error_code
+	{
+		const auto slot = std::find(std::begin(dmux->elementary_streams), std::end(dmux->elementary_streams), esHandle);
+
+		if (slot == std::end(dmux->elementary_streams))
+		{
+			return CELL_DMUX_ERROR_ARG;
+		}
+
+		*slot = vm::null;
+		return CELL_OK;
+	});
 }
 
-error_code _CellDmuxCoreOpFlushEs(vm::ptr<void> esHandle)
+error_code _CellDmuxCoreOpFlushEs(ppu_thread& ppu, vm::ptr<DmuxPamfElementaryStream> esHandle)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpFlushEs(esHandle=*0x%x)", esHandle);
+	cellDmuxPamf.notice("_CellDmuxCoreOpFlushEs(esHandle=*0x%x)", esHandle);
 
-	return CELL_OK;
+	ensure(!!esHandle); // Not checked on LLE
+
+	return esHandle->demuxer->send_request(ppu, [&]() -> error_code
+	{
+		esHandle->flush_requested = true;
+		return CELL_OK;
+	});
 }
 
-error_code _CellDmuxCoreOpResetEs(vm::ptr<void> esHandle)
+error_code _CellDmuxCoreOpResetEs(ppu_thread& ppu, vm::ptr<DmuxPamfElementaryStream> esHandle)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpResetEs(esHandle=*0x%x)", esHandle);
+	cellDmuxPamf.notice("_CellDmuxCoreOpResetEs(esHandle=*0x%x)", esHandle);
 
-	return CELL_OK;
+	ensure(!!esHandle); // Not checked on LLE
+
+	return esHandle->demuxer->send_request(ppu, [&]() -> error_code
+	{
+		esHandle->reset_requested = true;
+		return CELL_OK;
+	});
 }
 
-error_code _CellDmuxCoreOpResetStreamAndWaitDone(vm::ptr<void> handle)
+error_code _CellDmuxCoreOpResetStreamAndWaitDone(ppu_thread& ppu, vm::ptr<DmuxPamfContext> handle)
 {
-	cellDmuxPamf.todo("_CellDmuxCoreOpResetStreamAndWaitDone(handle=*0x%x)", handle);
+	cellDmuxPamf.notice("_CellDmuxCoreOpResetStreamAndWaitDone(handle=*0x%x)", handle);
+
+	ensure(!!handle); // Not checked on LLE
+
+	if (const error_code ret = _CellDmuxCoreOpResetStream(ppu, handle); ret != CELL_OK || ppu.state & cpu_flag::again)
+	{
+		return ret;
+	}
+
+	ensure(sys_mutex_lock(ppu, handle->mutex, 0) == CELL_OK);
+
+	if (ppu.state & cpu_flag::again)
+	{
+		return {};
+	}
+
+	while (handle->reset_stream_pending)
+	{
+		ensure(sys_cond_wait(ppu, handle->stream_reset, 0) == CELL_OK);
+
+		if (ppu.state & cpu_flag::again)
+		{
+			return {};
+		}
+	}
+
+	ensure(sys_mutex_unlock(ppu, handle->mutex) == CELL_OK);
 
 	return CELL_OK;
 }
@@ -166,4 +1295,6 @@ DECLARE(ppu_module_manager::cellDmuxPamf)("cellDmuxPamf", []
 	REG_HIDDEN_FUNC(_CellDmuxCoreOpFlushEs);
 	REG_HIDDEN_FUNC(_CellDmuxCoreOpResetEs);
 	REG_HIDDEN_FUNC(_CellDmuxCoreOpResetStreamAndWaitDone);
+
+	REG_HIDDEN_FUNC(dmuxPamfEntry);
 });
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "cellDmux.h"
+
 struct CellDmuxPamfAttr
 {
 	be_t<u32> maxEnabledEsNum;
@@ -13,3 +15,179 @@ struct CellDmuxPamfEsAttr
 	be_t<u32> memSize;
 	be_t<u32> specificInfoSize;
 };
+
+constexpr u32 DMUX_PAMF_VERSION = 0x280000;
+constexpr u32 DMUX_PAMF_MAX_ENABLED_ES_NUM = 0x40;
+constexpr u32 DMUX_PAMF_PACKET_SIZE = 0x800;
+
+enum
+{
+	DMUX_PAMF_PACK_START_CODE          = 0x000001ba,
+	DMUX_PAMF_SYSTEM_HEADER_START_CODE = 0x000001bb,
+	DMUX_PAMF_PROGRAM_END_CODE         = 0x000001b9,
+	DMUX_PAMF_PRIVATE_STREAM_1         = 0x000001bd,
+	DMUX_PAMF_PADDING_STREAM           = 0x000001be,
+	DMUX_PAMF_PRIVATE_STREAM_2         = 0x000001bf,
+};
+
+// HLE exclusive
+enum class DmuxPamfStreamType : u32
+{
+	avc,
+	m2v,
+	atracx,
+	lpcm,
+	ac3,
+	user_data,
+};
+
+struct DmuxPamfContext;
+
+struct DmuxPamfElementaryStream
+{
+	vm::bptr<DmuxPamfContext> demuxer;
+
+	be_t<u32> stream_id;
+	be_t<u32> private_stream_id;
+	be_t<DmuxPamfStreamType> type;
+
+	const DmuxCb<DmuxEsNotifyAuFound> notify_au_found;
+	const DmuxCb<DmuxEsNotifyFlushDone> notify_flush_done;
+
+	// Access units are assembled in a ring buffer following this structure, the consumer releases them in order with freeMemory()
+	vm::bptr<u8> au_buf;
+	be_t<u32> au_buf_size;
+	be_t<u32> au_max_size;
+	be_t<u32> free_pos;       // Start of the oldest access unit that has not been released
+	be_t<u32> wrap_pos;       // End of the data before the buffer wrapped around, umax if it didn't
+	be_t<u32> delivered_size; // Size of the delivered access units that have not been released
+	be_t<u32> au_start;       // Start of the access unit being assembled
+	be_t<u32> au_size;        // Size of the access unit being assembled
+	be_t<u32> scan_pos;       // Number of bytes of the access unit being assembled that were searched for start codes
+
+	be_t<u64> au_pts;
+	be_t<u64> au_dts;
+	be_t<u64> pes_pts; // Time stamps of the last PES packet, assigned to the first access unit starting in it
+	be_t<u64> pes_dts;
+	be_t<u32> pes_ts_pos; // Position of the PES packet relative to au_start
+	b8 pes_ts_pending;
+	be_t<u64> user_data;
+
+	b8 au_started;     // The first start code was found, video data before it is skipped
+	b8 au_has_picture; // M2V: a picture start code was found in the access unit being assembled
+	b8 au_is_rap;
+	b8 rap_pending;    // A private stream 2 packet, which marks an entry point, was found
+
+	// Requests from the core ops, handled by the demuxer thread
+	b8 flush_requested;
+	b8 reset_requested;
+
+	// An access unit is waiting to be accepted by the notify_au_found callback
+	b8 au_pending;
+	be_t<u32> pending_size;
+
+	DmuxAuInfo au_info;
+	u8 au_specific_info[8];
+
+	CellDmuxPamfEsSpecificInfoLpcm lpcm_info;
+
+	DmuxPamfElementaryStream(vm::ptr<DmuxPamfContext> demuxer, u32 stream_id, u32 private_stream_id, DmuxPamfStreamType type, const DmuxCb<DmuxEsNotifyAuFound>& notify_au_found,
+		const DmuxCb<DmuxEsNotifyFlushDone>& notify_flush_done, vm::ptr<u8> au_buf, u32 au_buf_size, u32 au_max_size)
+		: demuxer(demuxer)
+		, stream_id(stream_id)
+		, private_stream_id(private_stream_id)
+		, type(type)
+		, notify_au_found(notify_au_found)
+		, notify_flush_done(notify_flush_done)
+		, au_buf(au_buf)
+		, au_buf_size(au_buf_size)
+		, au_max_size(au_max_size)
+	{
+		reset();
+	}
+
+	void reset();
+	void discard_au();
+	bool reserve(u32 size);
+	void release(u32 addr, u32 size);
+	void push_payload(const u8* data, u32 size, bool has_ts, u64 pts, u64 dts, u64 user_data);
+	void start_au();
+	void skip(u32 size);
+	void find_au();
+	void set_pending(u32 size);
+	void commit_pending();
+};
+
+static_assert(std::is_standard_layout_v<DmuxPamfElementaryStream>);
+
+// HLE exclusive, for savestates
+enum class dmux_pamf_state : u8
+{
+	initial,
+	waiting_for_work,
+};
+
+struct DmuxPamfContext
+{
+	be_t<u64> thread_id; // sys_ppu_thread_t
+
+	be_t<u32> mutex;          // sys_mutex_t, protects everything below
+	be_t<u32> work_available; // sys_cond_t
+	be_t<u32> stream_reset;   // sys_cond_t, signaled when a stream reset has been handled
+
+	be_t<u32> run_thread = true;
+
+	const DmuxCb<DmuxNotifyDemuxDone> notify_demux_done;
+	const DmuxCb<DmuxNotifyProgEndCode> notify_prog_end_code;
+	const DmuxCb<DmuxNotifyFatalErr> notify_fatal_err;
+	const b8 prog_end_code_cb;
+
+	const be_t<u32> ppu_thread_priority;
+	const be_t<u32> ppu_thread_stack_size;
+
+	// Current stream, parsed in place from guest memory
+	vm::bcptr<u8> stream_addr;
+	be_t<u32> stream_size;
+	be_t<u32> stream_pos;
+	be_t<u64> stream_user_data;
+	b8 stream_active = false;
+	b8 raw_es = false;
+
+	b8 reset_stream_requested = false;
+	b8 reset_stream_pending = false; // Cleared once the callbacks of the stream reset were sent, for ResetStreamAndWaitDone
+	b8 demux_done_pending = false;
+	b8 prog_end_pending = false;
+	b8 fatal_error_pending = false;
+
+	// Nothing can be done until the consumer releases memory or accepts an access unit
+	b8 waiting_for_consumer = false;
+
+	vm::bptr<DmuxPamfElementaryStream> elementary_streams[DMUX_PAMF_MAX_ENABLED_ES_NUM]{};
+
+	// HLE exclusive
+	dmux_pamf_state savestate{};
+
+	DmuxPamfContext(const DmuxCb<DmuxNotifyDemuxDone>& notify_demux_done, const DmuxCb<DmuxNotifyProgEndCode>& notify_prog_end_code, const DmuxCb<DmuxNotifyFatalErr>& notify_fatal_err,
+		bool prog_end_code_cb, u32 ppu_thread_priority, u32 ppu_thread_stack_size)
+		: notify_demux_done(notify_demux_done)
+		, notify_prog_end_code(notify_prog_end_code)
+		, notify_fatal_err(notify_fatal_err)
+		, prog_end_code_cb(prog_end_code_cb)
+		, ppu_thread_priority(ppu_thread_priority)
+		, ppu_thread_stack_size(ppu_thread_stack_size)
+	{
+	}
+
+	void exec(ppu_thread& ppu);
+
+	template <typename F>
+	error_code send_request(ppu_thread& ppu, F&& func);
+
+	bool has_work() const;
+	bool has_pending_au() const;
+	bool demux_packet();
+	bool demux_raw_es();
+	vm::ptr<DmuxPamfElementaryStream> find_es(u32 stream_id, u32 private_stream_id) const;
+};
+
+static_assert(std::is_standard_layout_v<DmuxPamfContext>);
@@ -18,6 +18,9 @@
 #include "Input/ps_move_config.h"
 #include "Input/ps_move_tracker.h"
 
+#include "util/simd.hpp"
+#include "util/sysinfo.hpp"
+
 #ifdef HAVE_LIBEVDEV
 #include "Input/evdev_gun_handler.h"
 #endif
@@ -190,6 +193,116 @@ cfg_gems g_cfg_gem_real;
 cfg_fake_gems g_cfg_gem_fake;
 cfg_mouse_gems g_cfg_gem_mouse;
 
+// Converts the rows of camera frames in chunks, on the calling thread and on worker threads which are kept between frames.
+// The workers are only started by the first frame that is large enough to be split.
+class gem_convert_workers
+{
+	using convert_func = void (*)(const void* convert, u32 y_begin, u32 y_end);
+
+	std::mutex m_mutex;
+	convert_func m_func{};
+	const void* m_convert{};
+	u32 m_height = 0;
+	u32 m_rows_per_chunk = 0;
+
+	atomic_t<u32> m_next_chunk = 0;
+	atomic_t<u32> m_generation = 0;
+	atomic_t<u32> m_pending = 0;
+
+	const u32 m_max_workers = std::clamp<u32>(utils::get_thread_count() / 4, 1, 4) - 1;
+
+	std::unique_ptr<named_thread_group<std::function<void()>>> m_workers;
+
+	void convert_chunks()
+	{
+		for (u32 chunk = m_next_chunk++; chunk * m_rows_per_chunk < m_height; chunk = m_next_chunk++)
+		{
+			const u32 y_begin = chunk * m_rows_per_chunk;
+			m_func(m_convert, y_begin, std::min(y_begin + m_rows_per_chunk, m_height));
+		}
+	}
+
+	void start()
+	{
+		m_workers = std::make_unique<named_thread_group<std::function<void()>>>("Gem Convert ", m_max_workers, [this]()
+		{
+			for (u32 seen = 0; thread_ctrl::state() != thread_state::aborting;)
+			{
+				const u32 generation = m_generation.load();
+
+				if (generation == seen)
+				{
+					thread_ctrl::wait_on(m_generation, generation);
+					continue;
+				}
+
+				seen = generation;
+
+				convert_chunks();
+
+				if (m_pending.sub_fetch(1) == 0)
+				{
+					m_pending.notify_all();
+				}
+			}
+		});
+	}
+
+public:
+	gem_convert_workers() = default;
+	gem_convert_workers(const gem_convert_workers&) = delete;
+	gem_convert_workers& operator=(const gem_convert_workers&) = delete;
+
+	~gem_convert_workers()
+	{
+		m_workers.reset();
+	}
+
+	// Splits the rows of a frame into chunks (aligned to row_step) and converts them on several threads if the frame is large enough
+	template <typename F>
+	void convert_rows(u32 width, u32 height, u32 row_step, const F& convert)
+	{
+		// Splitting is only worth it for full sized frames
+		constexpr u32 min_pixels_per_worker = 320 * 240;
+
+		const u32 worker_count = std::min<u32>(m_max_workers + 1, (width * height) / min_pixels_per_worker);
+
+		if (worker_count <= 1)
+		{
+			convert(0, height);
+			return;
+		}
+
+		std::lock_guard lock(m_mutex);
+
+		if (!m_workers)
+		{
+			start();
+		}
+
+		m_func = [](const void* convert, u32 y_begin, u32 y_end)
+		{
+			(*static_cast<const F*>(convert))(y_begin, y_end);
+		};
+
+		m_convert = &convert;
+		m_height = height;
+		m_rows_per_chunk = utils::align(utils::aligned_div(height, worker_count), row_step);
+		m_next_chunk = 0;
+		m_pending = m_max_workers;
+
+		m_generation++;
+		m_generation.notify_all();
+
+		convert_chunks();
+
+		while (const u32 pending = m_pending.load())
+		{
+			m_pending.wait(pending);
+		}
+	}
+};
+
 struct gem_config_data
 {
 public:
@@ -261,6 +374,7 @@ public:
 	CellGemVideoConvertAttribute vc_attribute = {};
 	s32 video_data_out_size = -1;
 	std::vector<u8> video_data_in;
+	gem_convert_workers convert_workers;
 	u64 runtime_status_flags = 0; // The runtime status flags
 	bool enable_pitch_correction = false;
 	u32 inertial_counter = 0;
@@ -683,6 +797,39 @@ namespace gem
 
 	std::array<gem_position, CELL_GEM_MAX_NUM> positions {};
 
+	// RGB to YUV for 4 pixels at once. The inputs are u32 lanes with values from 0 to 255.
+	// The result of each channel ends up in the low byte of each lane.
+	struct YUV_vec
+	{
+		v128 y;
+		v128 u;
+		v128 v;
+
+		YUV_vec(const v128& r, const v128& g, const v128& b)
+		{
+			const v128 fr = gv_cvts32_tofs(r);
+			const v128 fg = gv_cvts32_tofs(g);
+			const v128 fb = gv_cvts32_tofs(b);
+
+			y = Y_f(fr, fg, fb);
+			u = gv_cvtfs_tos32(gv_addfs(gv_subfs(gv_mulfs(gv_bcstfs(-0.14713f), fr), gv_mulfs(gv_bcstfs(0.28886f), fg)), gv_mulfs(gv_bcstfs(0.436f), fb)));
+			v = gv_cvtfs_tos32(gv_subfs(gv_subfs(gv_mulfs(gv_bcstfs(0.615f), fr), gv_mulfs(gv_bcstfs(0.51499f), fg)), gv_mulfs(gv_bcstfs(0.10001f), fb)));
+		}
+
+		static inline v128 Y(const v128& r, const v128& g, const v128& b)
+		{
+			return Y_f(gv_cvts32_tofs(r), gv_cvts32_tofs(g), gv_cvts32_tofs(b));
+		}
+
+	private:
+		static inline v128 Y_f(const v128& fr, const v128& fg, const v128& fb)
+		{
+			return gv_cvtfs_tos32(gv_addfs(gv_addfs(gv_mulfs(gv_bcstfs(0.299f), fr), gv_mulfs(gv_bcstfs(0.587f), fg)), gv_mulfs(gv_bcstfs(0.114f), fb)));
+		}
+	};
+
+	// Single pixel version of YUV_vec for the remaining pixels of a row.
+	// It uses the same vector operations, plain float code may be compiled with fused multiply-adds which round differently.
 	struct YUV
 	{
 		u8 y = 0;
@@ -690,20 +837,78 @@ namespace gem
 		u8 v = 0;
 
 		YUV(u8 r, u8 g, u8 b)
-			: y(Y(r, g, b))
-			, u(U(r, g, b))
-			, v(V(r, g, b))
 		{
+			const YUV_vec yuv(gv_bcst32(r), gv_bcst32(g), gv_bcst32(b));
+			y = yuv.y._u8[0];
+			u = yuv.u._u8[0];
+			v = yuv.v._u8[0];
 		}
 
-		static inline u8 Y(u8 r, u8 g, u8 b) { return static_cast<u8>(0.299f * r + 0.587f * g + 0.114f * b); }
-		static inline u8 U(u8 r, u8 g, u8 b) { return static_cast<u8>(-0.14713f * r - 0.28886f * g + 0.436f * b); }
-		static inline u8 V(u8 r, u8 g, u8 b) { return static_cast<u8>(0.615f * r - 0.51499f * g - 0.10001f * b); }
+		static inline u8 Y(u8 r, u8 g, u8 b) { return YUV_vec::Y(gv_bcst32(r), gv_bcst32(g), gv_bcst32(b))._u8[0]; }
 	};
 
+	// Extracts byte N of each u32 lane
+	template <u32 N>
+	static inline v128 lane_byte(const v128& vec)
+	{
+		return gv_and32(gv_shr32(vec, N * 8), gv_bcst32(0xff));
+	}
+
+	// Truncates the u32 lanes of 4 vectors to 16 bytes
+	static inline v128 pack_low_bytes(const v128& a, const v128& b, const v128& c, const v128& d)
+	{
+		const v128 mask = gv_bcst32(0xff);
+		return gv_packus_s16(gv_packss_s32(gv_and32(a, mask), gv_and32(b, mask)), gv_packss_s32(gv_and32(c, mask), gv_and32(d, mask)));
+	}
+
+	// Keeps every other byte of a vector, the result is stored in the low 8 bytes
+	static inline v128 even_bytes(const v128& vec)
+	{
+		const v128 even = gv_and32(vec, gv_bcst16(0xff));
+		return gv_packus_s16(even, even);
+	}
+
+	// Loads 32 bytes of two Bayer rows (BGBG... and GRGR...) as 16 blocks of 2x2 pixels.
+	// Each u32 lane contains the bytes B, G0 (top), G1 (bottom) and R of one block.
+	static inline std::array<v128, 4> load_bayer_blocks(const u8* src0, const u8* src1)
+	{
+		const v128 top_lo = v128::loadu(src0);
+		const v128 top_hi = v128::loadu(src0 + 16);
+		const v128 bottom_lo = v128::loadu(src1);
+		const v128 bottom_hi = v128::loadu(src1 + 16);
+
+		return
+		{
+			gv_unpacklo16(top_lo, bottom_lo),
+			gv_unpackhi16(top_lo, bottom_lo),
+			gv_unpacklo16(top_hi, bottom_hi),
+			gv_unpackhi16(top_hi, bottom_hi),
+		};
+	}
+
+	// Number of source columns that are converted with one iteration of the vectorized Bayer loops
+	static constexpr u32 bayer_block_width = 32;
+
+	// Number of source pixels that are converted with one iteration of the vectorized RGBA loops
+	static constexpr u32 rgba_block_width = 16;
+
+	// Converts all rows on the calling thread unless workers are provided
+	template <typename F>
+	static void convert_rows(gem_convert_workers* workers, u32 width, u32 height, u32 row_step, const F& convert)
+	{
+		if (workers)
+		{
+			workers->convert_rows(width, height, row_step, convert);
+		}
+		else
+		{
+			convert(0, height);
+		}
+	}
+
 	bool convert_image_format(CellCameraFormat input_format, CellGemVideoConvertFormatEnum output_format,
 	                          const std::vector<u8>& video_data_in, u32 width, u32 height,
-	                          u8* video_data_out, u32 video_data_out_size, std::string_view caller)
+	                          u8* video_data_out, u32 video_data_out_size, std::string_view caller, gem_convert_workers* workers)
 	{
 		if (output_format != CELL_GEM_NO_VIDEO_OUTPUT && !video_data_out)
 		{
@@ -730,6 +935,8 @@ namespace gem
 			return false;
 		}
 
+		const v128 alpha = gv_bcst32(0xff000000);
+
 		switch (output_format)
 		{
 		case CELL_GEM_RGBA_640x480: // RGBA output; 640*480*4-byte output buffer required
@@ -741,37 +948,62 @@ namespace gem
 				const u32 in_pitch = width;
 				const u32 out_pitch = width * 4;
 
-				for (u32 y = 0; y < height - 1; y += 2)
+				convert_rows(workers, width, height, 2, [&](u32 y_begin, u32 y_end)
 				{
-					const u8* src0 = &video_data_in[y * in_pitch];
-					const u8* src1 = src0 + in_pitch;
+					for (u32 y = y_begin; y + 1 < y_end; y += 2)
+					{
+						const u8* src0 = &video_data_in[y * in_pitch];
+						const u8* src1 = src0 + in_pitch;
 
-					u8* dst0 = video_data_out + y * out_pitch;
-					u8* dst1 = dst0 + out_pitch;
+						u8* dst0 = video_data_out + y * out_pitch;
+						u8* dst1 = dst0 + out_pitch;
 
-					for (u32 x = 0; x < width - 1; x += 2, src0 += 2, src1 += 2, dst0 += 8, dst1 += 8)
-					{
-						const u8 b  = src0[0];
-						const u8 g0 = src0[1];
-						const u8 g1 = src1[0];
-						const u8 r  = src1[1];
+						u32 x = 0;
+
+						for (; x + bayer_block_width <= width; x += bayer_block_width, src0 += bayer_block_width, src1 += bayer_block_width)
+						{
+							for (const v128& block : load_bayer_blocks(src0, src1))
+							{
+								// R, G0, B, 255 and R, G1, B, 255
+								const v128 r_b = gv_or32(gv_or32(lane_byte<3>(block), gv_shl32(lane_byte<0>(block), 16)), alpha);
+								const v128 top = gv_or32(r_b, gv_and32(block, gv_bcst32(0xff00)));
+								const v128 bottom = gv_or32(r_b, gv_shl32(lane_byte<2>(block), 8));
+
+								// Each block covers 2 horizontal pixels
+								v128::storeu(gv_unpacklo32(top, top), dst0);
+								v128::storeu(gv_unpackhi32(top, top), dst0 + 16);
+								v128::storeu(gv_unpacklo32(bottom, bottom), dst1);
+								v128::storeu(gv_unpackhi32(bottom, bottom), dst1 + 16);
+
+								dst0 += 32;
+								dst1 += 32;
+							}
+						}
+
+						for (; x < width - 1; x += 2, src0 += 2, src1 += 2, dst0 += 8, dst1 += 8)
+						{
+							const u8 b  = src0[0];
+							const u8 g0 = src0[1];
+							const u8 g1 = src1[0];
+							const u8 r  = src1[1];
 
-						const u8 top[4] = { r, g0, b, 255 };
-						const u8 bottom[4] = { r, g1, b, 255 };
+							const u8 top[4] = { r, g0, b, 255 };
+							const u8 bottom[4] = { r, g1, b, 255 };
 
-						// Top-Left
-						std::memcpy(dst0, top, 4);
+							// Top-Left
+							std::memcpy(dst0, top, 4);
 
-						// Top-Right Pixel
-						std::memcpy(dst0 + 4, top, 4);
+							// Top-Right Pixel
+							std::memcpy(dst0 + 4, top, 4);
 
-						// Bottom-Left Pixel
-						std::memcpy(dst1, bottom, 4);
+							// Bottom-Left Pixel
+							std::memcpy(dst1, bottom, 4);
 
-						// Bottom-Right Pixel
-						std::memcpy(dst1 + 4, bottom, 4);
+							// Bottom-Right Pixel
+							std::memcpy(dst1 + 4, bottom, 4);
+						}
 					}
-				}
+				});
 				break;
 			}
 			case CELL_CAMERA_RGBA:
@@ -815,65 +1047,115 @@ namespace gem
 			{
 				const u32 in_pitch = width;
 
-				for (u32 y = 0; y < height - 1; y += 2)
+				convert_rows(workers, width, height, 2, [&](u32 y_begin, u32 y_end)
 				{
-					const u8* src0 = &video_data_in[y * in_pitch];
-					const u8* src1 = src0 + in_pitch;
+					for (u32 y = y_begin; y + 1 < y_end; y += 2)
+					{
+						const u8* src0 = &video_data_in[y * in_pitch];
+						const u8* src1 = src0 + in_pitch;
 
-					u8* dst_y0 = dst_y + y * yuv_pitch;
-					u8* dst_y1 = dst_y0 + yuv_pitch;
+						u8* dst_y0 = dst_y + y * yuv_pitch;
+						u8* dst_y1 = dst_y0 + yuv_pitch;
 
-					u8* dst_u0 = dst_u + y * yuv_pitch;
-					u8* dst_u1 = dst_u0 + yuv_pitch;
+						u8* dst_u0 = dst_u + y * yuv_pitch;
+						u8* dst_u1 = dst_u0 + yuv_pitch;
 
-					u8* dst_v0 = dst_v + y * yuv_pitch;
-					u8* dst_v1 = dst_v0 + yuv_pitch;
+						u8* dst_v0 = dst_v + y * yuv_pitch;
+						u8* dst_v1 = dst_v0 + yuv_pitch;
 
-					for (u32 x = 0; x < width - 1; x += 2, src0 += 2, src1 += 2, dst_y0 += 2, dst_y1 += 2, dst_u0 += 2, dst_u1 += 2, dst_v0 += 2, dst_v1 += 2)
-					{
-						const u8 b  = src0[0];
-						const u8 g0 = src0[1];
-						const u8 g1 = src1[0];
-						const u8 r  = src1[1];
+						u32 x = 0;
 
-						// Convert RGBA to YUV
-						const YUV yuv_top    = YUV(r, g0, b);
-						const YUV yuv_bottom = YUV(r, g1, b);
+						for (; x + bayer_block_width <= width; x += bayer_block_width, src0 += bayer_block_width, src1 += bayer_block_width,
+							dst_y0 += bayer_block_width, dst_y1 += bayer_block_width, dst_u0 += bayer_block_width, dst_u1 += bayer_block_width, dst_v0 += bayer_block_width, dst_v1 += bayer_block_width)
+						{
+							const auto blocks = load_bayer_blocks(src0, src1);
+							std::array<YUV_vec, 4> top{ YUV_vec(lane_byte<3>(blocks[0]), lane_byte<1>(blocks[0]), lane_byte<0>(blocks[0])), YUV_vec(lane_byte<3>(blocks[1]), lane_byte<1>(blocks[1]), lane_byte<0>(blocks[1])),
+							                            YUV_vec(lane_byte<3>(blocks[2]), lane_byte<1>(blocks[2]), lane_byte<0>(blocks[2])), YUV_vec(lane_byte<3>(blocks[3]), lane_byte<1>(blocks[3]), lane_byte<0>(blocks[3])) };
+							std::array<YUV_vec, 4> bottom{ YUV_vec(lane_byte<3>(blocks[0]), lane_byte<2>(blocks[0]), lane_byte<0>(blocks[0])), YUV_vec(lane_byte<3>(blocks[1]), lane_byte<2>(blocks[1]), lane_byte<0>(blocks[1])),
+							                               YUV_vec(lane_byte<3>(blocks[2]), lane_byte<2>(blocks[2]), lane_byte<0>(blocks[2])), YUV_vec(lane_byte<3>(blocks[3]), lane_byte<2>(blocks[3]), lane_byte<0>(blocks[3])) };
+
+							// Each block covers 2 horizontal pixels
+							const auto store_doubled = [](u8* dst, const v128& bytes)
+							{
+								v128::storeu(gv_unpacklo8(bytes, bytes), dst);
+								v128::storeu(gv_unpackhi8(bytes, bytes), dst + 16);
+							};
+
+							store_doubled(dst_y0, pack_low_bytes(top[0].y, top[1].y, top[2].y, top[3].y));
+							store_doubled(dst_y1, pack_low_bytes(bottom[0].y, bottom[1].y, bottom[2].y, bottom[3].y));
+							store_doubled(dst_u0, pack_low_bytes(top[0].u, top[1].u, top[2].u, top[3].u));
+							store_doubled(dst_u1, pack_low_bytes(bottom[0].u, bottom[1].u, bottom[2].u, bottom[3].u));
+							store_doubled(dst_v0, pack_low_bytes(top[0].v, top[1].v, top[2].v, top[3].v));
+							store_doubled(dst_v1, pack_low_bytes(bottom[0].v, bottom[1].v, bottom[2].v, bottom[3].v));
+						}
 
-						dst_y0[0] = dst_y0[1] = yuv_top.y;
-						dst_y1[0] = dst_y1[1] = yuv_bottom.y;
+						for (; x < width - 1; x += 2, src0 += 2, src1 += 2, dst_y0 += 2, dst_y1 += 2, dst_u0 += 2, dst_u1 += 2, dst_v0 += 2, dst_v1 += 2)
+						{
+							const u8 b  = src0[0];
+							const u8 g0 = src0[1];
+							const u8 g1 = src1[0];
+							const u8 r  = src1[1];
+
+							// Convert RGBA to YUV
+							const YUV yuv_top    = YUV(r, g0, b);
+							const YUV yuv_bottom = YUV(r, g1, b);
+
+							dst_y0[0] = dst_y0[1] = yuv_top.y;
+							dst_y1[0] = dst_y1[1] = yuv_bottom.y;
 
-						dst_u0[0] = dst_u0[1] = yuv_top.u;
-						dst_u1[0] = dst_u1[1] = yuv_bottom.u;
+							dst_u0[0] = dst_u0[1] = yuv_top.u;
+							dst_u1[0] = dst_u1[1] = yuv_bottom.u;
 
-						dst_v0[0] = dst_v0[1] = yuv_top.v;
-						dst_v1[0] = dst_v1[1] = yuv_bottom.v;
+							dst_v0[0] = dst_v0[1] = yuv_top.v;
+							dst_v1[0] = dst_v1[1] = yuv_bottom.v;
+						}
 					}
-				}
+				});
 				break;
 			}
 			case CELL_CAMERA_RGBA:
 			{
-				const u32 in_pitch = width / 4;
+				const u32 in_pitch = width * 4;
 
-				for (u32 y = 0; y < height; y++)
+				convert_rows(workers, width, height, 1, [&](u32 y_begin, u32 y_end)
 				{
-					const u8* src = &video_data_in[y * in_pitch];
-
-					for (u32 x = 0; x < width; x++, src += 4)
+					for (u32 y = y_begin; y < y_end; y++)
 					{
-						const u8 r = src[0];
-						const u8 g = src[1];
-						const u8 b = src[2];
+						const u8* src = &video_data_in[y * in_pitch];
+
+						u8* dst_y0 = dst_y + y * yuv_pitch;
+						u8* dst_u0 = dst_u + y * yuv_pitch;
+						u8* dst_v0 = dst_v + y * yuv_pitch;
 
-						// Convert RGBA to YUV
-						const YUV yuv = YUV(r, g, b);
+						u32 x = 0;
+
+						for (; x + rgba_block_width <= width; x += rgba_block_width, src += rgba_block_width * 4, dst_y0 += rgba_block_width, dst_u0 += rgba_block_width, dst_v0 += rgba_block_width)
+						{
+							std::array<YUV_vec, 4> yuv{ YUV_vec(lane_byte<0>(v128::loadu(src, 0)), lane_byte<1>(v128::loadu(src, 0)), lane_byte<2>(v128::loadu(src, 0))),
+							                            YUV_vec(lane_byte<0>(v128::loadu(src, 1)), lane_byte<1>(v128::loadu(src, 1)), lane_byte<2>(v128::loadu(src, 1))),
+							                            YUV_vec(lane_byte<0>(v128::loadu(src, 2)), lane_byte<1>(v128::loadu(src, 2)), lane_byte<2>(v128::loadu(src, 2))),
+							                            YUV_vec(lane_byte<0>(v128::loadu(src, 3)), lane_byte<1>(v128::loadu(src, 3)), lane_byte<2>(v128::loadu(src, 3))) };
+
+							v128::storeu(pack_low_bytes(yuv[0].y, yuv[1].y, yuv[2].y, yuv[3].y), dst_y0);
+							v128::storeu(pack_low_bytes(yuv[0].u, yuv[1].u, yuv[2].u, yuv[3].u), dst_u0);
+							v128::storeu(pack_low_bytes(yuv[0].v, yuv[1].v, yuv[2].v, yuv[3].v), dst_v0);
+						}
 
-						*dst_y++ = yuv.y;
-						*dst_u++ = yuv.u;
-						*dst_v++ = yuv.v;
+						for (; x < width; x++, src += 4)
+						{
+							const u8 r = src[0];
+							const u8 g = src[1];
+							const u8 b = src[2];
+
+							// Convert RGBA to YUV
+							const YUV yuv = YUV(r, g, b);
+
+							*dst_y0++ = yuv.y;
+							*dst_u0++ = yuv.u;
+							*dst_v0++ = yuv.v;
+						}
 					}
-				}
+				});
 				break;
 			}
 			default:
@@ -900,70 +1182,121 @@ namespace gem
 			{
 				const u32 in_pitch = width;
 
-				for (u32 y = 0; y < height - 1; y += 2)
+				convert_rows(workers, width, height, 2, [&](u32 y_begin, u32 y_end)
 				{
-					const u8* src0 = &video_data_in[y * in_pitch];
-					const u8* src1 = src0 + in_pitch;
+					for (u32 y = y_begin; y + 1 < y_end; y += 2)
+					{
+						const u8* src0 = &video_data_in[y * in_pitch];
+						const u8* src1 = src0 + in_pitch;
 
-					u8* dst_y0 = dst_y + y * y_pitch;
-					u8* dst_y1 = dst_y0 + y_pitch;
+						u8* dst_y0 = dst_y + y * y_pitch;
+						u8* dst_y1 = dst_y0 + y_pitch;
 
-					u8* dst_u0 = dst_u + y * uv_pitch;
-					u8* dst_u1 = dst_u0 + uv_pitch;
+						u8* dst_u0 = dst_u + y * uv_pitch;
+						u8* dst_u1 = dst_u0 + uv_pitch;
 
-					u8* dst_v0 = dst_v + y * uv_pitch;
-					u8* dst_v1 = dst_v0 + uv_pitch;
+						u8* dst_v0 = dst_v + y * uv_pitch;
+						u8* dst_v1 = dst_v0 + uv_pitch;
 
-					for (u32 x = 0; x < width - 1; x += 2, src0 += 2, src1 += 2, dst_y0 += 2, dst_y1 += 2)
-					{
-						const u8 b  = src0[0];
-						const u8 g0 = src0[1];
-						const u8 g1 = src1[0];
-						const u8 r  = src1[1];
+						u32 x = 0;
+
+						for (; x + bayer_block_width <= width; x += bayer_block_width, src0 += bayer_block_width, src1 += bayer_block_width,
+							dst_y0 += bayer_block_width, dst_y1 += bayer_block_width, dst_u0 += bayer_block_width / 2, dst_u1 += bayer_block_width / 2, dst_v0 += bayer_block_width / 2, dst_v1 += bayer_block_width / 2)
+						{
+							const auto blocks = load_bayer_blocks(src0, src1);
+							std::array<YUV_vec, 4> top{ YUV_vec(lane_byte<3>(blocks[0]), lane_byte<1>(blocks[0]), lane_byte<0>(blocks[0])), YUV_vec(lane_byte<3>(blocks[1]), lane_byte<1>(blocks[1]), lane_byte<0>(blocks[1])),
+							                            YUV_vec(lane_byte<3>(blocks[2]), lane_byte<1>(blocks[2]), lane_byte<0>(blocks[2])), YUV_vec(lane_byte<3>(blocks[3]), lane_byte<1>(blocks[3]), lane_byte<0>(blocks[3])) };
+							std::array<YUV_vec, 4> bottom{ YUV_vec(lane_byte<3>(blocks[0]), lane_byte<2>(blocks[0]), lane_byte<0>(blocks[0])), YUV_vec(lane_byte<3>(blocks[1]), lane_byte<2>(blocks[1]), lane_byte<0>(blocks[1])),
+							                               YUV_vec(lane_byte<3>(blocks[2]), lane_byte<2>(blocks[2]), lane_byte<0>(blocks[2])), YUV_vec(lane_byte<3>(blocks[3]), lane_byte<2>(blocks[3]), lane_byte<0>(blocks[3])) };
+
+							// Each block covers 2 horizontal pixels, but only 1 chroma sample
+							const v128 y_top = pack_low_bytes(top[0].y, top[1].y, top[2].y, top[3].y);
+							const v128 y_bottom = pack_low_bytes(bottom[0].y, bottom[1].y, bottom[2].y, bottom[3].y);
+
+							v128::storeu(gv_unpacklo8(y_top, y_top), dst_y0);
+							v128::storeu(gv_unpackhi8(y_top, y_top), dst_y0 + 16);
+							v128::storeu(gv_unpacklo8(y_bottom, y_bottom), dst_y1);
+							v128::storeu(gv_unpackhi8(y_bottom, y_bottom), dst_y1 + 16);
+
+							v128::storeu(pack_low_bytes(top[0].u, top[1].u, top[2].u, top[3].u), dst_u0);
+							v128::storeu(pack_low_bytes(bottom[0].u, bottom[1].u, bottom[2].u, bottom[3].u), dst_u1);
+							v128::storeu(pack_low_bytes(top[0].v, top[1].v, top[2].v, top[3].v), dst_v0);
+							v128::storeu(pack_low_bytes(bottom[0].v, bottom[1].v, bottom[2].v, bottom[3].v), dst_v1);
+						}
 
-						// Convert RGBA to YUV
-						const YUV yuv_top    = YUV(r, g0, b);
-						const YUV yuv_bottom = YUV(r, g1, b);
+						for (; x < width - 1; x += 2, src0 += 2, src1 += 2, dst_y0 += 2, dst_y1 += 2)
+						{
+							const u8 b  = src0[0];
+							const u8 g0 = src0[1];
+							const u8 g1 = src1[0];
+							const u8 r  = src1[1];
 
-						dst_y0[0] = dst_y0[1] = yuv_top.y;
-						dst_y1[0] = dst_y1[1] = yuv_bottom.y;
+							// Convert RGBA to YUV
+							const YUV yuv_top    = YUV(r, g0, b);
+							const YUV yuv_bottom = YUV(r, g1, b);
 
-						*dst_u0++ = yuv_top.u;
-						*dst_u1++ = yuv_bottom.u;
+							dst_y0[0] = dst_y0[1] = yuv_top.y;
+							dst_y1[0] = dst_y1[1] = yuv_bottom.y;
 
-						*dst_v0++ = yuv_top.v;
-						*dst_v1++ = yuv_bottom.v;
+							*dst_u0++ = yuv_top.u;
+							*dst_u1++ = yuv_bottom.u;
+
+							*dst_v0++ = yuv_top.v;
+							*dst_v1++ = yuv_bottom.v;
+						}
 					}
-				}
+				});
 				break;
 			}
 			case CELL_CAMERA_RGBA:
 			{
 				const u32 in_pitch = width * 4;
 
-				for (u32 y = 0; y < height; y++)
+				convert_rows(workers, width, height, 1, [&](u32 y_begin, u32 y_end)
 				{
-					const u8* src = &video_data_in[y * in_pitch];
-
-					for (u32 x = 0; x < width - 1; x += 2, src += 8, dst_y += 2)
+					for (u32 y = y_begin; y < y_end; y++)
 					{
-						const u8 r_0 = src[0];
-						const u8 g_0 = src[1];
-						const u8 b_0 = src[2];
-						const u8 r_1 = src[4];
-						const u8 g_1 = src[5];
-						const u8 b_1 = src[6];
-
-						// Convert RGBA to YUV
-						const YUV yuv_0 = YUV(r_0, g_0, b_0);
-						const u8 y_1 = YUV::Y(r_1, g_1, b_1);
-
-						dst_y[0] = yuv_0.y;
-						dst_y[1] = y_1;
-						*dst_u++ = yuv_0.u;
-						*dst_v++ = yuv_0.v;
+						const u8* src = &video_data_in[y * in_pitch];
+
+						u8* dst_y0 = dst_y + y * y_pitch;
+						u8* dst_u0 = dst_u + y * uv_pitch;
+						u8* dst_v0 = dst_v + y * uv_pitch;
+
+						u32 x = 0;
+
+						for (; x + rgba_block_width <= width; x += rgba_block_width, src += rgba_block_width * 4, dst_y0 += rgba_block_width, dst_u0 += rgba_block_width / 2, dst_v0 += rgba_block_width / 2)
+						{
+							std::array<YUV_vec, 4> yuv{ YUV_vec(lane_byte<0>(v128::loadu(src, 0)), lane_byte<1>(v128::loadu(src, 0)), lane_byte<2>(v128::loadu(src, 0))),
+							                            YUV_vec(lane_byte<0>(v128::loadu(src, 1)), lane_byte<1>(v128::loadu(src, 1)), lane_byte<2>(v128::loadu(src, 1))),
+							                            YUV_vec(lane_byte<0>(v128::loadu(src, 2)), lane_byte<1>(v128::loadu(src, 2)), lane_byte<2>(v128::loadu(src, 2))),
+							                            YUV_vec(lane_byte<0>(v128::loadu(src, 3)), lane_byte<1>(v128::loadu(src, 3)), lane_byte<2>(v128::loadu(src, 3))) };
+
+							// Chroma is only sampled from even pixels
+							v128::storeu(pack_low_bytes(yuv[0].y, yuv[1].y, yuv[2].y, yuv[3].y), dst_y0);
+							std::memcpy(dst_u0, &even_bytes(pack_low_bytes(yuv[0].u, yuv[1].u, yuv[2].u, yuv[3].u))._u64[0], 8);
+							std::memcpy(dst_v0, &even_bytes(pack_low_bytes(yuv[0].v, yuv[1].v, yuv[2].v, yuv[3].v))._u64[0], 8);
+						}
+
+						for (; x < width - 1; x += 2, src += 8, dst_y0 += 2)
+						{
+							const u8 r_0 = src[0];
+							const u8 g_0 = src[1];
+							const u8 b_0 = src[2];
+							const u8 r_1 = src[4];
+							const u8 g_1 = src[5];
+							const u8 b_1 = src[6];
+
+							// Convert RGBA to YUV
+							const YUV yuv_0 = YUV(r_0, g_0, b_0);
+							const u8 y_1 = YUV::Y(r_1, g_1, b_1);
+
+							dst_y0[0] = yuv_0.y;
+							dst_y0[1] = y_1;
+							*dst_u0++ = yuv_0.u;
+							*dst_v0++ = yuv_0.v;
+						}
 					}
-				}
+				});
 				break;
 			}
 			default:
@@ -990,90 +1323,153 @@ namespace gem
 			{
 				const u32 in_pitch = width;
 
-				for (u32 y = 0; y < height - 1; y += 2)
+				convert_rows(workers, width, height, 2, [&](u32 y_begin, u32 y_end)
 				{
-					const u8* src0 = &video_data_in[y * in_pitch];
-					const u8* src1 = src0 + in_pitch;
+					for (u32 y = y_begin; y + 1 < y_end; y += 2)
+					{
+						const u8* src0 = &video_data_in[y * in_pitch];
+						const u8* src1 = src0 + in_pitch;
 
-					u8* dst_y0 = dst_y + y * y_pitch;
-					u8* dst_y1 = dst_y0 + y_pitch;
+						u8* dst_y0 = dst_y + y * y_pitch;
+						u8* dst_y1 = dst_y0 + y_pitch;
 
-					u8* dst_u0 = dst_u + y * uv_pitch;
-					u8* dst_u1 = dst_u0 + uv_pitch;
+						u8* dst_u0 = dst_u + y * uv_pitch;
+						u8* dst_u1 = dst_u0 + uv_pitch;
 
-					u8* dst_v0 = dst_v + y * uv_pitch;
-					u8* dst_v1 = dst_v0 + uv_pitch;
+						u8* dst_v0 = dst_v + y * uv_pitch;
+						u8* dst_v1 = dst_v0 + uv_pitch;
 
-					for (u32 x = 0; x < width - 3; x += 4, src0 += 4, src1 += 4, dst_y0 += 4, dst_y1 += 4)
-					{
-						const u8 b_left   = src0[0];
-						const u8 g0_left  = src0[1];
-						const u8 b_right  = src0[2];
-						const u8 g0_right = src0[3];
+						u32 x = 0;
+
+						for (; x + bayer_block_width <= width; x += bayer_block_width, src0 += bayer_block_width, src1 += bayer_block_width,
+							dst_y0 += bayer_block_width, dst_y1 += bayer_block_width, dst_u0 += bayer_block_width / 4, dst_u1 += bayer_block_width / 4, dst_v0 += bayer_block_width / 4, dst_v1 += bayer_block_width / 4)
+						{
+							const auto blocks = load_bayer_blocks(src0, src1);
+							std::array<YUV_vec, 4> top{ YUV_vec(lane_byte<3>(blocks[0]), lane_byte<1>(blocks[0]), lane_byte<0>(blocks[0])), YUV_vec(lane_byte<3>(blocks[1]), lane_byte<1>(blocks[1]), lane_byte<0>(blocks[1])),
+							                            YUV_vec(lane_byte<3>(blocks[2]), lane_byte<1>(blocks[2]), lane_byte<0>(blocks[2])), YUV_vec(lane_byte<3>(blocks[3]), lane_byte<1>(blocks[3]), lane_byte<0>(blocks[3])) };
+							std::array<YUV_vec, 4> bottom{ YUV_vec(lane_byte<3>(blocks[0]), lane_byte<2>(blocks[0]), lane_byte<0>(blocks[0])), YUV_vec(lane_byte<3>(blocks[1]), lane_byte<2>(blocks[1]), lane_byte<0>(blocks[1])),
+							                               YUV_vec(lane_byte<3>(blocks[2]), lane_byte<2>(blocks[2]), lane_byte<0>(blocks[2])), YUV_vec(lane_byte<3>(blocks[3]), lane_byte<2>(blocks[3]), lane_byte<0>(blocks[3])) };
+
+							// Each block covers 2 horizontal pixels, chroma is only sampled from the left block of each 4x2 pixel group
+							const v128 y_top = pack_low_bytes(top[0].y, top[1].y, top[2].y, top[3].y);
+							const v128 y_bottom = pack_low_bytes(bottom[0].y, bottom[1].y, bottom[2].y, bottom[3].y);
+
+							v128::storeu(gv_unpacklo8(y_top, y_top), dst_y0);
+							v128::storeu(gv_unpackhi8(y_top, y_top), dst_y0 + 16);
+							v128::storeu(gv_unpacklo8(y_bottom, y_bottom), dst_y1);
+							v128::storeu(gv_unpackhi8(y_bottom, y_bottom), dst_y1 + 16);
+
+							std::memcpy(dst_u0, &even_bytes(pack_low_bytes(top[0].u, top[1].u, top[2].u, top[3].u))._u64[0], 8);
+							std::memcpy(dst_u1, &even_bytes(pack_low_bytes(bottom[0].u, bottom[1].u, bottom[2].u, bottom[3].u))._u64[0], 8);
+							std::memcpy(dst_v0, &even_bytes(pack_low_bytes(top[0].v, top[1].v, top[2].v, top[3].v))._u64[0], 8);
+							std::memcpy(dst_v1, &even_bytes(pack_low_bytes(bottom[0].v, bottom[1].v, bottom[2].v, bottom[3].v))._u64[0], 8);
+						}
+
+						for (; x < width - 3; x += 4, src0 += 4, src1 += 4, dst_y0 += 4, dst_y1 += 4)
+						{
+							const u8 b_left   = src0[0];
+							const u8 g0_left  = src0[1];
+							const u8 b_right  = src0[2];
+							const u8 g0_right = src0[3];
 
-						const u8 g1_left  = src1[0];
-						const u8 r_left   = src1[1];
-						const u8 g1_right = src1[2];
-						const u8 r_right  = src1[3];
+							const u8 g1_left  = src1[0];
+							const u8 r_left   = src1[1];
+							const u8 g1_right = src1[2];
+							const u8 r_right  = src1[3];
 
-						// Convert RGBA to YUV
-						const YUV yuv_top_left    = YUV(r_left, g0_left, b_left); // Re-used for top-right
-						const u8 y_top_right      = YUV::Y(r_right, g0_right, b_right);
-						const YUV yuv_bottom_left = YUV(r_left, g1_left, b_left); // Re-used for bottom-right
-						const u8 y_bottom_right   = YUV::Y(r_right, g1_right, b_right);
+							// Convert RGBA to YUV
+							const YUV yuv_top_left    = YUV(r_left, g0_left, b_left); // Re-used for top-right
+							const u8 y_top_right      = YUV::Y(r_right, g0_right, b_right);
+							const YUV yuv_bottom_left = YUV(r_left, g1_left, b_left); // Re-used for bottom-right
+							const u8 y_bottom_right   = YUV::Y(r_right, g1_right, b_right);
 
-						dst_y0[0] = dst_y0[1] = yuv_top_left.y;
-						dst_y0[2] = dst_y0[3] = y_top_right;
+							dst_y0[0] = dst_y0[1] = yuv_top_left.y;
+							dst_y0[2] = dst_y0[3] = y_top_right;
 
-						dst_y1[0] = dst_y1[1] = yuv_bottom_left.y;
-						dst_y1[2] = dst_y1[3] = y_bottom_right;
+							dst_y1[0] = dst_y1[1] = yuv_bottom_left.y;
+							dst_y1[2] = dst_y1[3] = y_bottom_right;
 
-						*dst_u0++ = yuv_top_left.u;
-						*dst_u1++ = yuv_bottom_left.u;
+							*dst_u0++ = yuv_top_left.u;
+							*dst_u1++ = yuv_bottom_left.u;
 
-						*dst_v0++ = yuv_top_left.v;
-						*dst_v1++ = yuv_bottom_left.v;
+							*dst_v0++ = yuv_top_left.v;
+							*dst_v1++ = yuv_bottom_left.v;
+						}
 					}
-				}
+				});
 				break;
 			}
 			case CELL_CAMERA_RGBA:
 			{
 				const u32 in_pitch = width * 4;
 
-				for (u32 y = 0; y < height; y++)
+				convert_rows(workers, width, height, 1, [&](u32 y_begin, u32 y_end)
 				{
-					const u8* src = &video_data_in[y * in_pitch];
-
-					for (u32 x = 0; x < width - 3; x += 4, src += 16, dst_y += 4)
+					for (u32 y = y_begin; y < y_end; y++)
 					{
-						const u8 r_0 = src[0];
-						const u8 g_0 = src[1];
-						const u8 b_0 = src[2];
-						const u8 r_1 = src[4];
-						const u8 g_1 = src[5];
-						const u8 b_1 = src[6];
-						const u8 r_2 = src[8];
-						const u8 g_2 = src[9];
-						const u8 b_2 = src[10];
-						const u8 r_3 = src[12];
-						const u8 g_3 = src[13];
-						const u8 b_3 = src[14];
-
-						// Convert RGBA to YUV
-						const YUV yuv_0 = YUV(r_0, g_0, b_0);
-						const u8 y_1 = YUV::Y(r_1, g_1, b_1);
-						const u8 y_2 = YUV::Y(r_2, g_2, b_2);
-						const u8 y_3 = YUV::Y(r_3, g_3, b_3);
-
-						dst_y[0] = yuv_0.y;
-						dst_y[1] = y_1;
-						dst_y[2] = y_2;
-						dst_y[3] = y_3;
-						*dst_u++ = yuv_0.u;
-						*dst_v++ = yuv_0.v;
+						const u8* src = &video_data_in[y * in_pitch];
+
+						u8* dst_y0 = dst_y + y * y_pitch;
+						u8* dst_u0 = dst_u + y * uv_pitch;
+						u8* dst_v0 = dst_v + y * uv_pitch;
+
+						u32 x = 0;
+
+						for (; x + rgba_block_width <= width; x += rgba_block_width, src += rgba_block_width * 4, dst_y0 += rgba_block_width, dst_u0 += rgba_block_width / 4, dst_v0 += rgba_block_width / 4)
+						{
+							std::array<v128, 4> r, g, b;
+
+							for (u32 i = 0; i < 4; i++)
+							{
+								const v128 pixels = v128::loadu(src, i);
+								r[i] = lane_byte<0>(pixels);
+								g[i] = lane_byte<1>(pixels);
+								b[i] = lane_byte<2>(pixels);
+							}
+
+							v128::storeu(pack_low_bytes(YUV_vec::Y(r[0], g[0], b[0]), YUV_vec::Y(r[1], g[1], b[1]), YUV_vec::Y(r[2], g[2], b[2]), YUV_vec::Y(r[3], g[3], b[3])), dst_y0);
+
+							// Chroma is only sampled from every fourth pixel, which is the first lane of each vector
+							const v128 first_r = gv_shufflefs<0, 2, 0, 2>(gv_shufflefs<0, 0, 0, 0>(r[0], r[1]), gv_shufflefs<0, 0, 0, 0>(r[2], r[3]));
+							const v128 first_g = gv_shufflefs<0, 2, 0, 2>(gv_shufflefs<0, 0, 0, 0>(g[0], g[1]), gv_shufflefs<0, 0, 0, 0>(g[2], g[3]));
+							const v128 first_b = gv_shufflefs<0, 2, 0, 2>(gv_shufflefs<0, 0, 0, 0>(b[0], b[1]), gv_shufflefs<0, 0, 0, 0>(b[2], b[3]));
+							const YUV_vec yuv(first_r, first_g, first_b);
+
+							const v128 uv = pack_low_bytes(yuv.u, yuv.v, v128{}, v128{});
+							std::memcpy(dst_u0, &uv._u32[0], 4);
+							std::memcpy(dst_v0, &uv._u32[1], 4);
+						}
+
+						for (; x < width - 3; x += 4, src += 16, dst_y0 += 4)
+						{
+							const u8 r_0 = src[0];
+							const u8 g_0 = src[1];
+							const u8 b_0 = src[2];
+							const u8 r_1 = src[4];
+							const u8 g_1 = src[5];
+							const u8 b_1 = src[6];
+							const u8 r_2 = src[8];
+							const u8 g_2 = src[9];
+							const u8 b_2 = src[10];
+							const u8 r_3 = src[12];
+							const u8 g_3 = src[13];
+							const u8 b_3 = src[14];
+
+							// Convert RGBA to YUV
+							const YUV yuv_0 = YUV(r_0, g_0, b_0);
+							const u8 y_1 = YUV::Y(r_1, g_1, b_1);
+							const u8 y_2 = YUV::Y(r_2, g_2, b_2);
+							const u8 y_3 = YUV::Y(r_3, g_3, b_3);
+
+							dst_y0[0] = yuv_0.y;
+							dst_y0[1] = y_1;
+							dst_y0[2] = y_2;
+							dst_y0[3] = y_3;
+							*dst_u0++ = yuv_0.u;
+							*dst_v0++ = yuv_0.v;
+						}
 					}
-				}
+				});
 				break;
 			}
 			default:
@@ -1094,31 +1490,41 @@ namespace gem
 				const u32 in_pitch = width;
 				const u32 out_pitch = width * 4 / 2;
 
-				for (u32 y = 0; y < height - 1; y += 2)
+				// Each 2x2 block becomes one pixel. Only the top row of each block is used.
+				convert_rows(workers, width, height, 2, [&](u32 y_begin, u32 y_end)
 				{
-					const u8* src0 = &video_data_in[y * in_pitch];
-					const u8* src1 = src0 + in_pitch;
+					for (u32 y = y_begin; y + 1 < y_end; y += 2)
+					{
+						const u8* src0 = &video_data_in[y * in_pitch];
+						const u8* src1 = src0 + in_pitch;
 
-					u8* dst0 = video_data_out + (y / 2) * out_pitch;
-					u8* dst1 = dst0 + out_pitch;
+						u8* dst = video_data_out + (y / 2) * out_pitch;
 
-					for (u32 x = 0; x < width - 1; x += 2, src0 += 2, src1 += 2, dst0 += 4, dst1 += 4)
-					{
-						const u8 b  = src0[0];
-						const u8 g0 = src0[1];
-						const u8 g1 = src1[0];
-						const u8 r  = src1[1];
+						u32 x = 0;
 
-						const u8 top[4] = { r, g0, b, 255 };
-						const u8 bottom[4] = { r, g1, b, 255 };
+						for (; x + bayer_block_width <= width; x += bayer_block_width, src0 += bayer_block_width, src1 += bayer_block_width)
+						{
+							for (const v128& block : load_bayer_blocks(src0, src1))
+							{
+								// R, G0, B, 255
+								const v128 top = gv_or32(gv_or32(gv_or32(lane_byte<3>(block), gv_shl32(lane_byte<0>(block), 16)), gv_and32(block, gv_bcst32(0xff00))), alpha);
+								v128::storeu(top, dst);
+								dst += 16;
+							}
+						}
+
+						for (; x < width - 1; x += 2, src0 += 2, src1 += 2, dst += 4)
+						{
+							const u8 b  = src0[0];
+							const u8 g0 = src0[1];
+							const u8 r  = src1[1];
 
-						// Top-Left
-						std::memcpy(dst0, top, 4);
+							const u8 top[4] = { r, g0, b, 255 };
 
-						// Bottom-Left Pixel
-						std::memcpy(dst1, bottom, 4);
+							std::memcpy(dst, top, 4);
+						}
 					}
-				}
+				});
 				break;
 			}
 			case CELL_CAMERA_RGBA:
@@ -1126,16 +1532,28 @@ namespace gem
 				const u32 in_pitch = width * 4;
 				const u32 out_pitch = width * 4 / 2;
 
-				for (u32 y = 0; y < height / 2; y++)
+				convert_rows(workers, width, height / 2, 1, [&](u32 y_begin, u32 y_end)
 				{
-					const u8* src = &video_data_in[y * 2 * in_pitch];
-					u8* dst = video_data_out + y * out_pitch;
-
-					for (u32 x = 0; x < width / 2; x++, src += 4 * 2, dst += 4)
+					for (u32 y = y_begin; y < y_end; y++)
 					{
-						std::memcpy(dst, src, 4);
+						const u8* src = &video_data_in[y * 2 * in_pitch];
+						u8* dst = video_data_out + y * out_pitch;
+
+						u32 x = 0;
+
+						// Keep every other pixel
+						for (; x + 8 <= width / 2; x += 8, src += 4 * 16, dst += 4 * 8)
+						{
+							v128::storeu(gv_shufflefs<0, 2, 0, 2>(v128::loadu(src, 0), v128::loadu(src, 1)), dst);
+							v128::storeu(gv_shufflefs<0, 2, 0, 2>(v128::loadu(src, 2), v128::loadu(src, 3)), dst + 16);
+						}
+
+						for (; x < width / 2; x++, src += 4 * 2, dst += 4)
+						{
+							std::memcpy(dst, src, 4);
+						}
 					}
-				}
+				});
 				break;
 			}
 			default:
@@ -1340,7 +1758,7 @@ void gem_config_data::operator()()
 
 		const auto& shared_data = g_fxo->get<gem_camera_shared>();
 
-		if (gem::convert_image_format(shared_data.format, vc.output_format, video_data_in, shared_data.width, shared_data.height, vc_attribute.video_data_out ? vc_attribute.video_data_out.get_ptr() : nullptr, video_data_out_size, "cellGem"))
+		if (gem::convert_image_format(shared_data.format, vc.output_format, video_data_in, shared_data.width, shared_data.height, vc_attribute.video_data_out ? vc_attribute.video_data_out.get_ptr() : nullptr, video_data_out_size, "cellGem", &convert_workers))
 		{
 			cellGem.trace("Converted video frame of format %s to %s", shared_data.format.load(), vc.output_format.get());
 
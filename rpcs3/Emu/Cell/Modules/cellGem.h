@@ -278,3 +278,15 @@ struct CellGemVideoConvertAttribute
 
 	ENABLE_BITWISE_SERIALIZATION;
 };
+
+enum CellCameraFormat : s32;
+
+class gem_convert_workers;
+
+namespace gem
+{
+	// Converts a camera frame for cellGemConvertVideoStart, the rows of large frames are split between the workers if provided
+	bool convert_image_format(CellCameraFormat input_format, CellGemVideoConvertFormatEnum output_format,
+	                          const std::vector<u8>& video_data_in, u32 width, u32 height,
+	                          u8* video_data_out, u32 video_data_out_size, std::string_view caller, gem_convert_workers* workers = nullptr);
+}
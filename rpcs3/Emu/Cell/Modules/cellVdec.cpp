@@ -21,6 +21,7 @@ extern "C"
 {
 #include "libavcodec/avcodec.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/pixdesc.h"
 #include "libswscale/swscale.h"
 }
 #ifdef _MSC_VER
@@ -37,7 +38,9 @@ extern "C"
 #include <cmath>
 #include "Utilities/lockless.h"
 #include <variant>
+#include <map>
 #include "util/asm.hpp"
+#include "util/sysinfo.hpp"
 
 std::mutex g_mutex_avcodec_open2;
 
@@ -141,16 +144,19 @@ struct vdec_cmd
 	CellVdecAuInfo au{};
 };
 
+struct vdec_frame_pool;
+
+// Returns the frame to its pool if it has one
+struct vdec_frame_dtor
+{
+	vdec_frame_pool* pool = nullptr;
+
+	void operator()(AVFrame* data) const;
+};
+
 struct vdec_frame
 {
-	struct frame_dtor
-	{
-		void operator()(AVFrame* data) const
-		{
-			av_frame_unref(data);
-			av_frame_free(&data);
-		}
-	};
+	using frame_dtor = vdec_frame_dtor;
 
 	u64 seq_id{};
 	u64 cmd_id{};
@@ -169,6 +175,210 @@ struct vdec_frame
 	}
 };
 
+// Recycles the frame structures, the picture buffers are already pooled by libavcodec
+struct vdec_frame_pool
+{
+	static constexpr usz max_size = 64;
+
+	std::mutex mutex;
+	std::vector<AVFrame*> frames;
+
+	vdec_frame_pool() = default;
+
+	vdec_frame_pool(const vdec_frame_pool&) = delete;
+
+	vdec_frame_pool& operator=(const vdec_frame_pool&) = delete;
+
+	~vdec_frame_pool()
+	{
+		for (AVFrame* frame : frames)
+		{
+			av_frame_free(&frame);
+		}
+	}
+
+	std::unique_ptr<AVFrame, vdec_frame::frame_dtor> get()
+	{
+		AVFrame* frame = nullptr;
+		{
+			std::lock_guard lock(mutex);
+
+			if (!frames.empty())
+			{
+				frame = frames.back();
+				frames.pop_back();
+			}
+		}
+
+		return { frame ? frame : av_frame_alloc(), vdec_frame::frame_dtor{this} };
+	}
+
+	void put(AVFrame* frame)
+	{
+		{
+			std::lock_guard lock(mutex);
+
+			if (frames.size() < max_size)
+			{
+				frames.push_back(frame);
+				return;
+			}
+		}
+
+		av_frame_free(&frame);
+	}
+};
+
+void vdec_frame_dtor::operator()(AVFrame* data) const
+{
+	av_frame_unref(data);
+
+	if (pool)
+	{
+		pool->put(data);
+	}
+	else
+	{
+		av_frame_free(&data);
+	}
+}
+
+// Converts pictures in horizontal bands, band 0 on the calling thread and the others on worker threads.
+// Every band has its own scaler context because they are not thread-safe.
+class vdec_scaler
+{
+	struct band
+	{
+		SwsContext* sws{};
+		const u8* in_data[4]{};
+		int in_line[4]{};
+		u8* out_data[4]{};
+		int out_line[4]{};
+		int height{};
+	};
+
+	std::mutex m_mutex;
+	std::vector<band> m_bands;
+	u32 m_band_count = 0;
+
+	atomic_t<u32> m_generation = 0;
+	atomic_t<u32> m_pending = 0;
+	atomic_t<u32> m_worker_index = 0;
+
+	std::unique_ptr<named_thread_group<std::function<void()>>> m_workers;
+
+	void convert_band(u32 index)
+	{
+		band& b = m_bands[index];
+		sws_scale(b.sws, b.in_data, b.in_line, 0, b.height, b.out_data, b.out_line);
+	}
+
+	static void offset_planes(auto& data, const int (&line)[4], AVPixelFormat format, int y)
+	{
+		const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+
+		for (int i = 0; i < 4; i++)
+		{
+			if (data[i])
+			{
+				data[i] += static_cast<std::ptrdiff_t>(i == 1 || i == 2 ? y >> desc->log2_chroma_h : y) * line[i];
+			}
+		}
+	}
+
+public:
+	vdec_scaler()
+	{
+		const u32 workers = std::clamp(utils::get_thread_count() / 4, 1u, 4u) - 1;
+
+		m_bands.resize(workers + 1);
+
+		if (workers)
+		{
+			m_workers = std::make_unique<named_thread_group<std::function<void()>>>("VDEC Scaler ", workers, [this]()
+			{
+				const u32 index = ++m_worker_index;
+
+				for (u32 seen = 0; thread_ctrl::state() != thread_state::aborting;)
+				{
+					const u32 generation = m_generation.load();
+
+					if (generation == seen)
+					{
+						thread_ctrl::wait_on(m_generation, generation);
+						continue;
+					}
+
+					seen = generation;
+
+					if (index < m_band_count)
+					{
+						convert_band(index);
+
+						if (m_pending.sub_fetch(1) == 0)
+						{
+							m_pending.notify_all();
+						}
+					}
+				}
+			});
+		}
+	}
+
+	~vdec_scaler()
+	{
+		m_workers.reset();
+
+		for (band& b : m_bands)
+		{
+			sws_freeContext(b.sws);
+		}
+	}
+
+	void convert(int w, int h, AVPixelFormat in_f, AVPixelFormat out_f, u8* const (&in_data)[4], const int (&in_line)[4], u8* const (&out_data)[4], const int (&out_line)[4])
+	{
+		std::lock_guard lock(m_mutex);
+
+		// Small pictures aren't worth splitting, band heights are even to keep the chroma rows together
+		const u32 height = static_cast<u32>(h);
+		const u32 max_bands = height >= 256 ? static_cast<u32>(m_bands.size()) : 1;
+		const u32 band_height = utils::align(utils::aligned_div(height, max_bands), 2);
+
+		m_band_count = utils::aligned_div(height, band_height);
+
+		for (u32 i = 0; i < m_band_count; i++)
+		{
+			band& b = m_bands[i];
+			const int y = static_cast<int>(i * band_height);
+
+			b.height = static_cast<int>(std::min(band_height, height - i * band_height));
+			b.sws = sws_getCachedContext(b.sws, w, b.height, in_f, w, b.height, out_f, SWS_POINT, nullptr, nullptr, nullptr);
+
+			std::copy_n(in_data, 4, b.in_data);
+			std::copy_n(in_line, 4, b.in_line);
+			std::copy_n(out_data, 4, b.out_data);
+			std::copy_n(out_line, 4, b.out_line);
+
+			offset_planes(b.in_data, b.in_line, in_f, y);
+			offset_planes(b.out_data, b.out_line, out_f, y);
+		}
+
+		if (m_band_count > 1)
+		{
+			m_pending = m_band_count - 1;
+			m_generation++;
+			m_generation.notify_all();
+		}
+
+		convert_band(0);
+
+		while (const u32 pending = m_pending.load())
+		{
+			m_pending.wait(pending);
+		}
+	}
+};
+
 struct vdec_context final
 {
 	static const u32 id_base = 0xf0000000;
@@ -187,7 +397,7 @@ struct vdec_context final
 	const AVCodec* codec{};
 	const AVCodecDescriptor* codec_desc{};
 	AVCodecContext* ctx{};
-	SwsContext* sws{};
+	vdec_scaler scaler;
 
 	shared_mutex mutex; // Used for 'out' queue (TODO)
 
@@ -203,9 +413,23 @@ struct vdec_context final
 	u64 next_dts{};
 	atomic_t<u32> ppu_tid{};
 
+	vdec_frame_pool frame_pool; // Must outlive the queued frames
 	std::deque<vdec_frame> out_queue;
 	const u32 out_max = 60;
 
+	// Pictures drained at the end of a sequence take the attributes of the last AU
+	u64 last_au_usrd{};
+	CellVdecPicAttr last_au_attr = CELL_VDEC_PICITEM_ATTR_NORMAL;
+
+	struct au_attributes
+	{
+		u64 userdata;
+		CellVdecPicAttr attr;
+	};
+
+	// Attributes of the AUs sent to the decoder by command id, pictures can be returned after later AUs were sent
+	std::map<u64, au_attributes> pending_au_attrs;
+
 	atomic_t<s32> au_count{0};
 
 	lf_queue<vdec_cmd> in_cmd;
@@ -261,6 +485,20 @@ struct vdec_context final
 			fmt::throw_exception("avcodec_alloc_context3() failed (type=0x%x)", type);
 		}
 
+		// Slice threading keeps one picture per AU. Frame threading delays the output by one picture per thread,
+		// which stalls games waiting for a picture after each AU, so it has to be enabled explicitly.
+		const u32 thread_count = g_cfg.video.video_decoder_threads ? static_cast<u32>(g_cfg.video.video_decoder_threads.get()) : std::clamp(utils::get_thread_count() / 2, 1u, 8u);
+
+		ctx->thread_count = static_cast<int>(thread_count);
+		ctx->thread_type = thread_count <= 1 ? 0 : g_cfg.video.video_decoder_frame_threading ? FF_THREAD_FRAME | FF_THREAD_SLICE : FF_THREAD_SLICE;
+
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+		// Pass the command id of each AU to its picture
+		ctx->flags |= AV_CODEC_FLAG_COPY_OPAQUE;
+#endif
+
+		cellVdec.notice("Using %d decoder threads (type=0x%x)", thread_count, type);
+
 		AVDictionary* opts = nullptr;
 
 		std::lock_guard lock(g_mutex_avcodec_open2);
@@ -289,7 +527,207 @@ struct vdec_context final
 	~vdec_context()
 	{
 		avcodec_free_context(&ctx);
-		sws_freeContext(sws);
+	}
+
+	// Receive all pictures available from the decoder, they are returned in presentation order
+	void receive_frames(const vdec_cmd& cmd, u64 au_usrd, CellVdecPicAttr attr, std::deque<vdec_frame>& decoded_frames)
+	{
+		while (!abort_decode && seq_id == cmd.seq_id)
+		{
+			// Keep receiving frames
+			vdec_frame frame;
+			frame.seq_id = cmd.seq_id;
+			frame.cmd_id = cmd.id;
+			frame.avf = frame_pool.get();
+
+			if (!frame.avf)
+			{
+				fmt::throw_exception("av_frame_alloc() failed (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd.seq_id, cmd.id);
+			}
+
+			if (int ret = avcodec_receive_frame(ctx, frame.avf.get()); ret < 0)
+			{
+				if (ret == AVERROR(EAGAIN) || ret == AVERROR(EOF))
+				{
+					break;
+				}
+
+				fmt::throw_exception("AU decoding error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd.seq_id, cmd.id, ret, utils::av_error_to_string(ret));
+			}
+
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(60, 31, 102)
+			const int ticks_per_frame = ctx->ticks_per_frame;
+#else
+			const int ticks_per_frame = (codec_desc->props & AV_CODEC_PROP_FIELDS) ? 2 : 1;
+#endif
+
+#if LIBAVUTIL_VERSION_INT < AV_VERSION_INT(58, 29, 100)
+			const bool is_interlaced = frame->interlaced_frame != 0;
+#else
+			const bool is_interlaced = !!(frame->flags & AV_FRAME_FLAG_INTERLACED);
+#endif
+
+			if (is_interlaced)
+			{
+				// NPEB01838, NPUB31260
+				cellVdec.todo("Interlaced frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd.seq_id, cmd.id);
+			}
+
+			if (frame->repeat_pict)
+			{
+				fmt::throw_exception("Repeated frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, repear_pict=0x%x)", handle, cmd.seq_id, cmd.id, frame->repeat_pict);
+			}
+
+			if (frame->pts != smin)
+			{
+				next_pts = frame->pts;
+			}
+
+			if (frame->pkt_dts != smin)
+			{
+				next_dts = frame->pkt_dts;
+			}
+
+			frame.pts = next_pts;
+			frame.dts = next_dts;
+			frame.userdata = au_usrd;
+			frame.attr = attr;
+
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+			if (const auto found = pending_au_attrs.find(reinterpret_cast<uptr>(frame->opaque)); found != pending_au_attrs.end())
+			{
+				frame.userdata = found->second.userdata;
+				frame.attr = found->second.attr;
+				pending_au_attrs.erase(found);
+			}
+#endif
+
+			if (frc_set)
+			{
+				u64 amend = 0;
+
+				switch (frc_set)
+				{
+				case CELL_VDEC_FRC_24000DIV1001: amend = 1001 * 90000 / 24000; break;
+				case CELL_VDEC_FRC_24: amend = 90000 / 24; break;
+				case CELL_VDEC_FRC_25: amend = 90000 / 25; break;
+				case CELL_VDEC_FRC_30000DIV1001: amend = 1001 * 90000 / 30000; break;
+				case CELL_VDEC_FRC_30: amend = 90000 / 30; break;
+				case CELL_VDEC_FRC_50: amend = 90000 / 50; break;
+				case CELL_VDEC_FRC_60000DIV1001: amend = 1001 * 90000 / 60000; break;
+				case CELL_VDEC_FRC_60: amend = 90000 / 60; break;
+				default:
+				{
+					fmt::throw_exception("Invalid frame rate code set (handle=0x%x, seq_id=%d, cmd_id=%d, frc=0x%x)", handle, cmd.seq_id, cmd.id, frc_set);
+				}
+				}
+
+				next_pts += amend;
+				next_dts += amend;
+				frame.frc = frc_set;
+			}
+			else if (ctx->time_base.num == 0)
+			{
+				if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
+				{
+					cellVdec.error("time_base.num is 0 (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd.seq_id, cmd.id, ctx->time_base.num, ctx->time_base.den, ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
+					log_time_base = ctx->time_base;
+				}
+
+				// Hack
+				const u64 amend = u64{90000} / 30;
+				frame.frc = CELL_VDEC_FRC_30;
+				next_pts += amend;
+				next_dts += amend;
+			}
+			else
+			{
+				u64 amend = u64{90000} * ctx->time_base.num * ticks_per_frame / ctx->time_base.den;
+				const auto freq = 1. * ctx->time_base.den / ctx->time_base.num / ticks_per_frame;
+
+				if (std::abs(freq - 23.976) < 0.002)
+					frame.frc = CELL_VDEC_FRC_24000DIV1001;
+				else if (std::abs(freq - 24.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_24;
+				else if (std::abs(freq - 25.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_25;
+				else if (std::abs(freq - 29.970) < 0.002)
+					frame.frc = CELL_VDEC_FRC_30000DIV1001;
+				else if (std::abs(freq - 30.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_30;
+				else if (std::abs(freq - 50.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_50;
+				else if (std::abs(freq - 59.940) < 0.002)
+					frame.frc = CELL_VDEC_FRC_60000DIV1001;
+				else if (std::abs(freq - 60.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_60;
+				else
+				{
+					if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
+					{
+						// 1/1000 usually means that the time stamps are written in 1ms units and that the frame rate may vary.
+						cellVdec.error("Unsupported time_base (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd.seq_id, cmd.id, ctx->time_base.num, ctx->time_base.den, ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
+						log_time_base = ctx->time_base;
+					}
+
+					// Hack
+					amend = u64{90000} / 30;
+					frame.frc = CELL_VDEC_FRC_30;
+				}
+
+				next_pts += amend;
+				next_dts += amend;
+			}
+
+			cellVdec.trace("Got picture (handle=0x%x, seq_id=%d, cmd_id=%d, pts=0x%llx[0x%llx], dts=0x%llx[0x%llx])", handle, cmd.seq_id, cmd.id, frame.pts, frame->pts, frame.dts, frame->pkt_dts);
+
+			decoded_frames.push_back(std::move(frame));
+		}
+	}
+
+	// Queue the pictures for the guest and send PICOUT for each one
+	void output_frames(ppu_thread& ppu, u32 vid, const vdec_cmd& cmd, std::deque<vdec_frame>& decoded_frames)
+	{
+		while (!decoded_frames.empty() && seq_id == cmd.seq_id)
+		{
+			// Wait until there is free space in the image queue.
+			// Do this after pushing the frame to the queue. That way the game can consume the frame and we can move on.
+			u32 elapsed = 0;
+			while (thread_ctrl::state() != thread_state::aborting && !abort_decode && seq_id == cmd.seq_id)
+			{
+				{
+					std::lock_guard lock{mutex};
+
+					if (out_queue.size() <= out_max)
+					{
+						break;
+					}
+				}
+
+				thread_ctrl::wait_for(10000);
+
+				if (elapsed++ >= 500) // 5 seconds
+				{
+					cellVdec.error("Video au decode has been waiting for a consumer for 5 seconds. (handle=0x%x, seq_id=%d, cmd_id=%d, queue_size=%d)", handle, cmd.seq_id, cmd.id, out_queue.size());
+					elapsed = 0;
+				}
+			}
+
+			if (thread_ctrl::state() == thread_state::aborting || abort_decode || seq_id != cmd.seq_id)
+			{
+				break;
+			}
+
+			{
+				std::lock_guard lock{mutex};
+				out_queue.push_back(std::move(decoded_frames.front()));
+				decoded_frames.pop_front();
+			}
+
+			cellVdec.trace("Sending CELL_VDEC_MSG_TYPE_PICOUT (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd.seq_id, cmd.id);
+			cb_func(ppu, vid, CELL_VDEC_MSG_TYPE_PICOUT, CELL_OK, cb_arg);
+			lv2_obj::sleep(ppu);
+		}
 	}
 
 	void exec(ppu_thread& ppu, u32 vid)
@@ -338,6 +776,7 @@ struct vdec_context final
 				}
 
 				avcodec_flush_buffers(ctx);
+				pending_au_attrs.clear();
 
 				out_queue.clear(); // Flush image queue
 				log_time_base = {};
@@ -354,6 +793,24 @@ struct vdec_context final
 			{
 				cellVdec.trace("End sequence... (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
 
+				if (!abort_decode && seq_id == cmd->seq_id)
+				{
+					// Drain the pictures held back by reordering and frame threading
+					std::deque<vdec_frame> decoded_frames;
+
+					if (int ret = avcodec_send_packet(ctx, nullptr); ret < 0 && ret != AVERROR(EOF))
+					{
+						fmt::throw_exception("Decoder drain error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
+					}
+
+					receive_frames(*cmd, last_au_usrd, last_au_attr, decoded_frames);
+					output_frames(ppu, vid, *cmd, decoded_frames);
+
+					// The decoder doesn't accept new packets after draining until it is flushed
+					avcodec_flush_buffers(ctx);
+					pending_au_attrs.clear();
+				}
+
 				{
 					std::lock_guard lock{mutex};
 					seq_state = sequence_state::dormant;
@@ -399,6 +856,20 @@ struct vdec_context final
 					au_mode == CELL_VDEC_DEC_MODE_NORMAL ? AVDISCARD_DEFAULT :
 					au_mode == CELL_VDEC_DEC_MODE_B_SKIP ? AVDISCARD_NONREF : AVDISCARD_NONINTRA;
 
+				last_au_usrd = au_usrd;
+				last_au_attr = attr;
+
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+				packet.opaque = reinterpret_cast<void*>(static_cast<uptr>(cmd->id));
+				pending_au_attrs[cmd->id] = {au_usrd, attr};
+
+				// Skipped AUs don't return a picture
+				while (pending_au_attrs.size() > 64)
+				{
+					pending_au_attrs.erase(pending_au_attrs.begin());
+				}
+#endif
+
 				std::deque<vdec_frame> decoded_frames;
 
 				if (!abort_decode && seq_id == cmd->seq_id)
@@ -410,148 +881,7 @@ struct vdec_context final
 						fmt::throw_exception("AU queuing error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
 					}
 
-					while (!abort_decode && seq_id == cmd->seq_id)
-					{
-						// Keep receiving frames
-						vdec_frame frame;
-						frame.seq_id = cmd->seq_id;
-						frame.cmd_id = cmd->id;
-						frame.avf.reset(av_frame_alloc());
-
-						if (!frame.avf)
-						{
-							fmt::throw_exception("av_frame_alloc() failed (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
-						}
-
-						if (int ret = avcodec_receive_frame(ctx, frame.avf.get()); ret < 0)
-						{
-							if (ret == AVERROR(EAGAIN) || ret == AVERROR(EOF))
-							{
-								break;
-							}
-
-							fmt::throw_exception("AU decoding error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
-						}
-
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(60, 31, 102)
-						const int ticks_per_frame = ctx->ticks_per_frame;
-#else
-						const int ticks_per_frame = (codec_desc->props & AV_CODEC_PROP_FIELDS) ? 2 : 1;
-#endif
-
-#if LIBAVUTIL_VERSION_INT < AV_VERSION_INT(58, 29, 100)
-						const bool is_interlaced = frame->interlaced_frame != 0;
-#else
-						const bool is_interlaced = !!(frame->flags & AV_FRAME_FLAG_INTERLACED);
-#endif
-
-						if (is_interlaced)
-						{
-							// NPEB01838, NPUB31260
-							cellVdec.todo("Interlaced frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
-						}
-
-						if (frame->repeat_pict)
-						{
-							fmt::throw_exception("Repeated frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, repear_pict=0x%x)", handle, cmd->seq_id, cmd->id, frame->repeat_pict);
-						}
-
-						if (frame->pts != smin)
-						{
-							next_pts = frame->pts;
-						}
-
-						if (frame->pkt_dts != smin)
-						{
-							next_dts = frame->pkt_dts;
-						}
-
-						frame.pts = next_pts;
-						frame.dts = next_dts;
-						frame.userdata = au_usrd;
-						frame.attr = attr;
-
-						if (frc_set)
-						{
-							u64 amend = 0;
-
-							switch (frc_set)
-							{
-							case CELL_VDEC_FRC_24000DIV1001: amend = 1001 * 90000 / 24000; break;
-							case CELL_VDEC_FRC_24: amend = 90000 / 24; break;
-							case CELL_VDEC_FRC_25: amend = 90000 / 25; break;
-							case CELL_VDEC_FRC_30000DIV1001: amend = 1001 * 90000 / 30000; break;
-							case CELL_VDEC_FRC_30: amend = 90000 / 30; break;
-							case CELL_VDEC_FRC_50: amend = 90000 / 50; break;
-							case CELL_VDEC_FRC_60000DIV1001: amend = 1001 * 90000 / 60000; break;
-							case CELL_VDEC_FRC_60: amend = 90000 / 60; break;
-							default:
-							{
-								fmt::throw_exception("Invalid frame rate code set (handle=0x%x, seq_id=%d, cmd_id=%d, frc=0x%x)", handle, cmd->seq_id, cmd->id, frc_set);
-							}
-							}
-
-							next_pts += amend;
-							next_dts += amend;
-							frame.frc = frc_set;
-						}
-						else if (ctx->time_base.num == 0)
-						{
-							if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
-							{
-								cellVdec.error("time_base.num is 0 (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd->seq_id, cmd->id, ctx->time_base.num, ctx->time_base.den, ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
-								log_time_base = ctx->time_base;
-							}
-
-							// Hack
-							const u64 amend = u64{90000} / 30;
-							frame.frc = CELL_VDEC_FRC_30;
-							next_pts += amend;
-							next_dts += amend;
-						}
-						else
-						{
-							u64 amend = u64{90000} * ctx->time_base.num * ticks_per_frame / ctx->time_base.den;
-							const auto freq = 1. * ctx->time_base.den / ctx->time_base.num / ticks_per_frame;
-
-							if (std::abs(freq - 23.976) < 0.002)
-								frame.frc = CELL_VDEC_FRC_24000DIV1001;
-							else if (std::abs(freq - 24.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_24;
-							else if (std::abs(freq - 25.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_25;
-							else if (std::abs(freq - 29.970) < 0.002)
-								frame.frc = CELL_VDEC_FRC_30000DIV1001;
-							else if (std::abs(freq - 30.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_30;
-							else if (std::abs(freq - 50.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_50;
-							else if (std::abs(freq - 59.940) < 0.002)
-								frame.frc = CELL_VDEC_FRC_60000DIV1001;
-							else if (std::abs(freq - 60.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_60;
-							else
-							{
-								if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
-								{
-									// 1/1000 usually means that the time stamps are written in 1ms units and that the frame rate may vary.
-									cellVdec.error("Unsupported time_base (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd->seq_id, cmd->id, ctx->time_base.num, ctx->time_base.den, ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
-									log_time_base = ctx->time_base;
-								}
-
-								// Hack
-								amend = u64{90000} / 30;
-								frame.frc = CELL_VDEC_FRC_30;
-							}
-
-							next_pts += amend;
-							next_dts += amend;
-						}
-
-						cellVdec.trace("Got picture (handle=0x%x, seq_id=%d, cmd_id=%d, pts=0x%llx[0x%llx], dts=0x%llx[0x%llx])", handle, cmd->seq_id, cmd->id, frame.pts, frame->pts, frame.dts, frame->pkt_dts);
-
-						decoded_frames.push_back(std::move(frame));
-					}
+					receive_frames(*cmd, au_usrd, attr, decoded_frames);
 				}
 
 				if (thread_ctrl::state() != thread_state::aborting)
@@ -563,46 +893,7 @@ struct vdec_context final
 					cb_func(ppu, vid, CELL_VDEC_MSG_TYPE_AUDONE, CELL_OK, cb_arg);
 					lv2_obj::sleep(ppu);
 
-					while (!decoded_frames.empty() && seq_id == cmd->seq_id)
-					{
-						// Wait until there is free space in the image queue.
-						// Do this after pushing the frame to the queue. That way the game can consume the frame and we can move on.
-						u32 elapsed = 0;
-						while (thread_ctrl::state() != thread_state::aborting && !abort_decode && seq_id == cmd->seq_id)
-						{
-							{
-								std::lock_guard lock{mutex};
-
-								if (out_queue.size() <= out_max)
-								{
-									break;
-								}
-							}
-
-							thread_ctrl::wait_for(10000);
-
-							if (elapsed++ >= 500) // 5 seconds
-							{
-								cellVdec.error("Video au decode has been waiting for a consumer for 5 seconds. (handle=0x%x, seq_id=%d, cmd_id=%d, queue_size=%d)", handle, cmd->seq_id, cmd->id, out_queue.size());
-								elapsed = 0;
-							}
-						}
-
-						if (thread_ctrl::state() == thread_state::aborting || abort_decode || seq_id != cmd->seq_id)
-						{
-							break;
-						}
-
-						{
-							std::lock_guard lock{mutex};
-							out_queue.push_back(std::move(decoded_frames.front()));
-							decoded_frames.pop_front();
-						}
-
-						cellVdec.trace("Sending CELL_VDEC_MSG_TYPE_PICOUT (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
-						cb_func(ppu, vid, CELL_VDEC_MSG_TYPE_PICOUT, CELL_OK, cb_arg);
-						lv2_obj::sleep(ppu);
-					}
+					output_frames(ppu, vid, *cmd, decoded_frames);
 				}
 
 				if (abort_decode || seq_id != cmd->seq_id)
@@ -1298,8 +1589,6 @@ error_code cellVdecGetPictureExt(ppu_thread& ppu, u32 handle, vm::cptr<CellVdecP
 
 		cellVdec.trace("cellVdecGetPictureExt: handle=0x%x, seq_id=%d, cmd_id=%d, w=%d, h=%d, frameFormat=%d, formatType=%d, in_f=%d, out_f=%d, alpha_plane=%d, alpha=%d, colorMatrixType=%d", handle, frame.seq_id, frame.cmd_id, w, h, frame->format, format->formatType, +in_f, +out_f, !!alpha_plane, format->alpha, format->colorMatrixType);
 
-		vdec->sws = sws_getCachedContext(vdec->sws, w, h, in_f, w, h, out_f, SWS_POINT, nullptr, nullptr, nullptr);
-
 		u8* in_data[4] = { frame->data[0], frame->data[1], frame->data[2], alpha_plane.get() };
 		int in_line[4] = { frame->linesize[0], frame->linesize[1], frame->linesize[2], w * 1 };
 		u8* out_data[4] = { outBuff.get_ptr() };
@@ -1321,7 +1610,7 @@ error_code cellVdecGetPictureExt(ppu_thread& ppu, u32 handle, vm::cptr<CellVdecP
 			}
 		}
 
-		sws_scale(vdec->sws, in_data, in_line, 0, h, out_data, out_line);
+		vdec->scaler.convert(w, h, in_f, out_f, in_data, in_line, out_data, out_line);
 	}
 
 	return CELL_OK;
@@ -10,6 +10,7 @@
 #include "Loader/ELF.h"
 #include "Emu/System.h"
 #include "Emu/system_config.h"
+#include "Emu/event_trace.hpp"
 #include "Emu/VFS.h"
 
 #include "Emu/Cell/PPUOpcodes.h"
@@ -2037,6 +2038,8 @@ void ppu_unload_prx(const lv2_prx& prx)
 
 bool ppu_load_exec(const ppu_exec_object& elf, bool virtual_load, const std::string& elf_path, utils::serial* ar)
 {
+	trace_scope trace0("ppu_load_exec", "boot");
+
 	if (elf != elf_error::ok)
 	{
 		return false;
@@ -2081,7 +2084,10 @@ bool ppu_load_exec(const ppu_exec_object& elf, bool virtual_load, const std::str
 	// Limit for analysis
 	u32 end = 0;
 
-	// Executable hash
+	// Executable hash, reused from the decrypted executable cache entry of the SELF if it was memoized there
+	const std::string self_cache_path = virtual_load ? std::string{} : g_ps3_process_info.self_info.cache_path;
+	const bool hash_memoized = !self_cache_path.empty() && load_self_cache_exec_hash(self_cache_path, _main.sha1);
+
 	sha1_context sha;
 	sha1_starts(&sha);
 
@@ -2128,8 +2134,11 @@ bool ppu_load_exec(const ppu_exec_object& elf, bool virtual_load, const std::str
 		_seg.filesz = ::narrow<u32>(prog.p_filesz);
 
 		// Hash big-endian values
-		sha1_update(&sha, reinterpret_cast<const uchar*>(&prog.p_type), sizeof(prog.p_type));
-		sha1_update(&sha, reinterpret_cast<const uchar*>(&prog.p_flags), sizeof(prog.p_flags));
+		if (!hash_memoized)
+		{
+			sha1_update(&sha, reinterpret_cast<const uchar*>(&prog.p_type), sizeof(prog.p_type));
+			sha1_update(&sha, reinterpret_cast<const uchar*>(&prog.p_flags), sizeof(prog.p_flags));
+		}
 
 		if (type == 0x1 /* LOAD */ && prog.p_memsz)
 		{
@@ -2199,9 +2208,12 @@ bool ppu_load_exec(const ppu_exec_object& elf, bool virtual_load, const std::str
 				vm::page_protect(addr0, size0, 0, vm::page_writable | vm::page_readable, vm::page_executable);
 			}
 
-			sha1_update(&sha, reinterpret_cast<const uchar*>(&prog.p_vaddr), sizeof(prog.p_vaddr));
-			sha1_update(&sha, reinterpret_cast<const uchar*>(&prog.p_memsz), sizeof(prog.p_memsz));
-			sha1_update(&sha, prog.bin.data(), prog.bin.size());
+			if (!hash_memoized)
+			{
+				sha1_update(&sha, reinterpret_cast<const uchar*>(&prog.p_vaddr), sizeof(prog.p_vaddr));
+				sha1_update(&sha, reinterpret_cast<const uchar*>(&prog.p_memsz), sizeof(prog.p_memsz));
+				sha1_update(&sha, prog.bin.data(), prog.bin.size());
+			}
 
 			// Initialize executable code if necessary
 			if (prog.p_flags & 0x1 && !virtual_load)
@@ -2237,7 +2249,15 @@ bool ppu_load_exec(const ppu_exec_object& elf, bool virtual_load, const std::str
 		}
 	}
 
-	sha1_finish(&sha, _main.sha1);
+	if (!hash_memoized)
+	{
+		sha1_finish(&sha, _main.sha1);
+
+		if (!self_cache_path.empty())
+		{
+			save_self_cache_exec_hash(self_cache_path, _main.sha1);
+		}
+	}
 
 	// Format patch name
 	std::string hash("PPU-0000000000000000000000000000000000000000");
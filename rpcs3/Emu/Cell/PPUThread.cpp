@@ -8,6 +8,9 @@
 #include "Loader/mself.hpp"
 #include "Emu/localized_string.h"
 #include "Emu/perf_meter.hpp"
+#include "Emu/event_trace.hpp"
+#include "Emu/benchmark.hpp"
+#include "Emu/reservation_stats.hpp"
 #include "Emu/Memory/vm_reservation.h"
 #include "Emu/Memory/vm_locking.h"
 #include "Emu/RSX/Core/RSXReservationLock.hpp"
@@ -3076,6 +3079,8 @@ static T ppu_load_acquire_reservation(ppu_thread& ppu, u32 addr)
 		ppu.use_full_rdata = false;
 	}
 
+	rsrv_stat(addr, ppu.cia, false, ppu.last_faddr && (addr & addr_mask) == (ppu.last_faddr & addr_mask) ? rsrv_event::retry : rsrv_event::acquire);
+
 	if (ppu_log.trace && (addr & addr_mask) == (ppu.last_faddr & addr_mask))
 	{
 		ppu_log.trace(u8"LARX after fail: addr=0x%x, faddr=0x%x, time=%u c", addr, ppu.last_faddr, (perf0.get() - ppu.last_ftsc));
@@ -3425,6 +3430,8 @@ static bool ppu_store_reservation(ppu_thread& ppu, u32 addr, u64 reg_value)
 				{
 				case umax:
 				{
+					rsrv_stat(addr, ppu.cia, false, rsrv_event::tx_abort);
+
 					auto& all_data = *vm::get_super_ptr<spu_rdata_t>(addr & -128);
 					auto& sdata = *vm::get_super_ptr<atomic_be_t<u64>>(addr & -8);
 
@@ -3674,12 +3681,16 @@ static bool ppu_store_reservation(ppu_thread& ppu, u32 addr, u64 reg_value)
 
 extern bool ppu_stwcx(ppu_thread& ppu, u32 addr, u32 reg_value)
 {
-	return ppu_store_reservation<u32>(ppu, addr, reg_value);
+	const bool result = ppu_store_reservation<u32>(ppu, addr, reg_value);
+	rsrv_stat(addr, ppu.cia, false, result ? rsrv_event::success : rsrv_event::failure);
+	return result;
 }
 
 extern bool ppu_stdcx(ppu_thread& ppu, u32 addr, u64 reg_value)
 {
-	return ppu_store_reservation<u64>(ppu, addr, reg_value);
+	const bool result = ppu_store_reservation<u64>(ppu, addr, reg_value);
+	rsrv_stat(addr, ppu.cia, false, result ? rsrv_event::success : rsrv_event::failure);
+	return result;
 }
 
 struct jit_core_allocator
@@ -3699,6 +3710,61 @@ struct jit_core_allocator
 };
 
 #ifdef LLVM_AVAILABLE
+// Coordination of PPU compilation between emulator instances sharing the cache directory ("Shared LLVM Compilation").
+// Lock files are used, they are released automatically by the OS if an instance crashes.
+namespace ppu_shared_compile
+{
+	// Try to lock a file without waiting
+	static fs::file try_lock(const std::string& path)
+	{
+		return fs::file(path, fs::write + fs::create + fs::lock);
+	}
+
+	// Wait for the exclusive lock of a module being compiled, returns an empty file if aborted
+	// The lock file is never removed, otherwise an instance could lock the unlinked file while another one creates a new one
+	static fs::file lock_module(const std::string& path, const std::function<bool()>& is_aborted)
+	{
+		while (!is_aborted())
+		{
+			if (fs::file lock = try_lock(path))
+			{
+				return lock;
+			}
+
+			thread_ctrl::wait_for(10'000);
+		}
+
+		return {};
+	}
+
+	// Wait for one of the host-wide compile slots, there is one per hardware thread for all instances together
+	static fs::file acquire_slot(const std::function<bool()>& is_aborted)
+	{
+		const std::string dir = rpcs3::utils::get_cache_dir() + "llvm_slots/";
+
+		if (!fs::create_path(dir))
+		{
+			ppu_log.error("LLVM: Failed to create '%s' (%s), compilation is not limited across instances", dir, fs::g_tls_error);
+			return {};
+		}
+
+		while (!is_aborted())
+		{
+			for (u32 i = 0; i < jit_core_allocator::limit(); i++)
+			{
+				if (fs::file slot = try_lock(fmt::format("%sslot%u.lock", dir, i)))
+				{
+					return slot;
+				}
+			}
+
+			thread_ctrl::wait_for(10'000);
+		}
+
+		return {};
+	}
+}
+
 namespace
 {
 	// Compiled PPU module info
@@ -3934,6 +4000,8 @@ extern void ppu_finalize(const ppu_module<lv2_obj>& info, bool force_mem_release
 
 extern void ppu_precompile(std::vector<std::string>& dir_queue, std::vector<ppu_module<lv2_obj>*>* loaded_modules)
 {
+	trace_scope trace0("ppu_precompile", "ppu", dir_queue.size());
+
 	if (g_cfg.core.ppu_decoder != ppu_decoder_type::llvm)
 	{
 		return;
@@ -4450,6 +4518,8 @@ extern void ppu_precompile(std::vector<std::string>& dir_queue, std::vector<ppu_
 
 extern void ppu_initialize()
 {
+	trace_scope trace0("ppu_initialize (all)", "ppu");
+
 	if (!g_fxo->is_init<main_ppu_module<lv2_obj>>())
 	{
 		return;
@@ -4590,6 +4660,8 @@ extern void ppu_initialize()
 
 bool ppu_initialize(const ppu_module<lv2_obj>& info, bool check_only, u64 file_size)
 {
+	trace_scope trace0("ppu_initialize", "ppu", file_size);
+
 	if (g_cfg.core.ppu_decoder != ppu_decoder_type::llvm)
 	{
 		if (check_only || vm::base(info.segs[0].addr) != info.segs[0].ptr)
@@ -5403,18 +5475,70 @@ bool ppu_initialize(const ppu_module<lv2_obj>& info, bool check_only, u64 file_s
 						rlock.lock();
 					}
 
+					const auto is_aborted = [this]()
+					{
+						return cpu ? cpu->state.all_of(cpu_flag::exit) : Emu.IsStopped();
+					};
+
+					// Another instance may be compiling the same module
+					const std::string lock_path = cache_path + obj_name + ".lock";
+					fs::file module_lock, host_slot;
+
+					if (g_cfg.core.llvm_shared_compilation)
+					{
+						// Don't hold a local core while another instance compiles this module
+						if (core_lock.owns_lock())
+						{
+							core_lock.unlock();
+						}
+
+						module_lock = ppu_shared_compile::lock_module(lock_path, is_aborted);
+
+						if (!module_lock)
+						{
+							continue;
+						}
+
+						if (jit_compiler::check(cache_path + obj_name))
+						{
+							ppu_log.success("LLVM: Module compiled by another instance: %s", obj_name);
+							module_lock.close();
+							continue;
+						}
+
+						core_lock.lock();
+						host_slot = ppu_shared_compile::acquire_slot(is_aborted);
+
+						if (is_aborted())
+						{
+							module_lock.close();
+							continue;
+						}
+					}
+
 					ppu_log.warning("LLVM: Compiling module %s%s", cache_path, obj_name);
 
 					{
+						compile_time_scope compile_time(benchmark_stats::compiler::ppu);
+
 						// Use another JIT instance
 						jit_compiler jit2({}, g_cfg.core.llvm_cpu, 0x1);
 						ppu_initialize2(jit2, part, cache_path, obj_name);
 					}
 
 					ppu_log.success("LLVM: Compiled module %s", obj_name);
+
+					if (module_lock)
+					{
+						host_slot.close();
+						module_lock.close();
+					}
 				}
 
-				core_lock.unlock();
+				if (core_lock.owns_lock())
+				{
+					core_lock.unlock();
+				}
 			}
 		};
 
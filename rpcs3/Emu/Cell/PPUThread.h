@@ -370,6 +370,7 @@ public:
 
 	ppu_thread* next_cpu{}; // LV2 sleep queues' node link
 	ppu_thread* next_ppu{}; // LV2 PPU running queue's node link
+	u32 timeout_index = umax; // Position in the LV2 scheduler timeout queue
 	bool ack_suspend = false;
 
 	be_t<u64>* get_stack_arg(s32 i, u64 align = alignof(u64));
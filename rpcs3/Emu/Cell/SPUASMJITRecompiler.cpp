@@ -2,6 +2,8 @@
 #include "SPUASMJITRecompiler.h"
 
 #include "Emu/system_config.h"
+#include "Emu/event_trace.hpp"
+#include "Emu/benchmark.hpp"
 #include "Emu/IdManager.h"
 #include "Emu/Cell/timers.hpp"
 
@@ -44,6 +46,9 @@ void spu_recompiler::init()
 
 spu_function_t spu_recompiler::compile(spu_program&& _func)
 {
+	trace_scope trace0("spu_compile", "spu", _func.data.size());
+	compile_time_scope compile_time(benchmark_stats::compiler::spu);
+
 	const u32 start0 = _func.entry_point;
 
 	const auto add_loc = m_spurt->add_empty(std::move(_func));
@@ -3,6 +3,7 @@
 
 #include "Emu/System.h"
 #include "Emu/system_config.h"
+#include "Emu/event_trace.hpp"
 #include "Emu/system_progress.hpp"
 #include "Emu/system_utils.hpp"
 #include "Emu/cache_utils.hpp"
@@ -719,6 +720,8 @@ void spu_cache::add(const spu_program& func)
 
 void spu_cache::initialize(bool build_existing_cache)
 {
+	trace_scope trace0("spu_cache::initialize", "spu");
+
 	spu_runtime::g_interpreter = spu_runtime::g_gateway;
 
 	if (g_cfg.core.spu_decoder == spu_decoder_type::_static || g_cfg.core.spu_decoder == spu_decoder_type::dynamic)
@@ -831,6 +834,31 @@ void spu_cache::initialize(bool build_existing_cache)
 		progress_dialog.emplace(get_localized_string(localized_string_id::PROGRESS_DIALOG_BUILDING_SPU_CACHE));
 	}
 
+	// Hashes of the cached functions, only needed when the debug bounds are set
+	std::vector<be_t<u64>> func_hashes;
+
+	if (worker_count && (g_cfg.core.spu_llvm_lower_bound != 0 || g_cfg.core.spu_llvm_upper_bound != umax))
+	{
+		std::vector<const uchar*> inputs(func_list.size());
+		std::vector<usz> sizes(func_list.size());
+		const auto outputs = std::make_unique<uchar[][20]>(func_list.size());
+
+		for (usz i = 0; i < func_list.size(); i++)
+		{
+			inputs[i] = reinterpret_cast<const uchar*>(func_list[i].data.data());
+			sizes[i] = func_list[i].data.size() * 4;
+		}
+
+		sha1_multi(inputs.data(), sizes.data(), outputs.get(), func_list.size());
+
+		func_hashes.resize(func_list.size());
+
+		for (usz i = 0; i < func_list.size(); i++)
+		{
+			std::memcpy(&func_hashes[i], outputs[i], sizeof(func_hashes[i]));
+		}
+	}
+
 	named_thread_group workers("SPU Worker ", worker_count, [&]() -> uint
 	{
 #ifdef __APPLE__
@@ -881,26 +909,19 @@ void spu_cache::initialize(bool build_existing_cache)
 			const u32 start = func.lower_bound;
 			const u32 size0 = ::size32(func.data);
 
-			be_t<u64> hash_start;
-			{
-				sha1_context ctx;
-				u8 output[20];
-
-				sha1_starts(&ctx);
-				sha1_update(&ctx, reinterpret_cast<const u8*>(func.data.data()), func.data.size() * 4);
-				sha1_finish(&ctx, output);
-				std::memcpy(&hash_start, output, sizeof(hash_start));
-			}
-
 			// Check hash against allowed bounds
-			const bool inverse_bounds = g_cfg.core.spu_llvm_lower_bound > g_cfg.core.spu_llvm_upper_bound;
-
-			if ((!inverse_bounds && (hash_start < g_cfg.core.spu_llvm_lower_bound || hash_start > g_cfg.core.spu_llvm_upper_bound)) ||
-				(inverse_bounds && (hash_start < g_cfg.core.spu_llvm_lower_bound && hash_start > g_cfg.core.spu_llvm_upper_bound)))
+			if (!func_hashes.empty())
 			{
-				spu_log.error("[Debug] Skipped function %s", fmt::base57(hash_start));
-				result++;
-				continue;
+				const be_t<u64> hash_start = func_hashes[func_i];
+				const bool inverse_bounds = g_cfg.core.spu_llvm_lower_bound > g_cfg.core.spu_llvm_upper_bound;
+
+				if ((!inverse_bounds && (hash_start < g_cfg.core.spu_llvm_lower_bound || hash_start > g_cfg.core.spu_llvm_upper_bound)) ||
+					(inverse_bounds && (hash_start < g_cfg.core.spu_llvm_lower_bound && hash_start > g_cfg.core.spu_llvm_upper_bound)))
+				{
+					spu_log.error("[Debug] Skipped function %s", fmt::base57(hash_start));
+					result++;
+					continue;
+				}
 			}
 
 			// Initialize LS with function data only
@@ -1182,21 +1203,26 @@ void spu_cache::initialize(bool build_existing_cache)
 				sorted[data] = &f;
 			}
 
+			std::vector<const uchar*> inputs;
+			std::vector<usz> sizes;
+
+			for (auto&& [bytes, f] : sorted)
+			{
+				inputs.push_back(bytes.data());
+				sizes.push_back(bytes.size());
+			}
+
+			const auto hashes = std::make_unique<uchar[][20]>(sorted.size());
+			sha1_multi(inputs.data(), sizes.data(), hashes.get(), sorted.size());
+
 			std::unordered_set<u32> depth_n;
 
 			u32 n_max = 0;
+			usz hash_i = 0;
 
 			for (auto&& [bytes, f] : sorted)
 			{
-				{
-					sha1_context ctx;
-					u8 output[20];
-
-					sha1_starts(&ctx);
-					sha1_update(&ctx, bytes.data(), bytes.size());
-					sha1_finish(&ctx, output);
-					fmt::append(dump, "\n\t[%s] ", fmt::base57(output));
-				}
+				fmt::append(dump, "\n\t[%s] ", fmt::base57(hashes[hash_i++]));
 
 				u32 depth_m = 0;
 
@@ -3,6 +3,8 @@
 
 #include "Emu/System.h"
 #include "Emu/system_config.h"
+#include "Emu/event_trace.hpp"
+#include "Emu/benchmark.hpp"
 #include "Emu/IdManager.h"
 #include "Emu/Cell/timers.hpp"
 #include "Emu/Memory/vm_reservation.h"
@@ -1510,6 +1512,9 @@ public:
 		const u32 start0 = _func.entry_point;
 		const usz func_size = _func.data.size();
 
+		trace_scope trace0("spu_compile", "spu", func_size);
+		compile_time_scope compile_time(benchmark_stats::compiler::spu);
+
 		const auto add_loc = m_spurt->add_empty(std::move(_func));
 
 		if (!add_loc)
@@ -10,6 +10,7 @@
 #include "Emu/IdManager.h"
 #include "Emu/System.h"
 #include "Emu/perf_meter.hpp"
+#include "Emu/reservation_stats.hpp"
 #include "Emu/Cell/PPUThread.h"
 #include "Emu/Cell/ErrorCodes.h"
 #include "Emu/Cell/lv2/sys_spu.h"
@@ -3828,6 +3829,8 @@ bool spu_thread::do_putllc(const spu_mfc_cmd& args)
 			{
 			case umax:
 			{
+				rsrv_stat(addr, pc, true, rsrv_event::tx_abort);
+
 				auto& data = *vm::get_super_ptr<spu_rdata_t>(addr);
 
 				const bool ok = cpu_thread::suspend_all<+3>(this, {data, data + 64, &res}, [&]()
@@ -3945,6 +3948,7 @@ bool spu_thread::do_putllc(const spu_mfc_cmd& args)
 			raddr = 0;
 		}
 
+		rsrv_stat(addr, pc, true, rsrv_event::success);
 		perf0.reset();
 		return true;
 	}
@@ -3972,6 +3976,7 @@ bool spu_thread::do_putllc(const spu_mfc_cmd& args)
 		}
 
 		raddr = 0;
+		rsrv_stat(addr, pc, true, rsrv_event::failure);
 		perf1.reset();
 		return false;
 	}
@@ -4543,6 +4548,8 @@ bool spu_thread::process_mfc_cmd()
 		const u32 addr = ch_mfc_cmd.eal & -128;
 		const auto& data = vm::_ref<spu_rdata_t>(addr);
 
+		rsrv_stat(addr, pc, true, addr == last_faddr ? rsrv_event::retry : rsrv_event::acquire);
+
 		if (addr == last_faddr)
 		{
 			// TODO: make this configurable and possible to disable
@@ -5481,6 +5488,8 @@ bool spu_thread::reservation_check(u32 addr, u32 hash, atomic_t<u64, 64>* range_
 
 usz spu_thread::register_cache_line_waiter(u32 addr)
 {
+	rsrv_stat(addr, pc, true, rsrv_event::wait);
+
 	const u64 value = u64{compute_rdata_hash32(rdata)} << 32 | addr;
 
 	for (usz i = 0; i < std::size(g_spu_waiters_by_value); i++)
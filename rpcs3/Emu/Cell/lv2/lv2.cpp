@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Emu/System.h"
 #include "Emu/system_config.h"
+#include "Emu/event_trace.hpp"
 #include "Emu/Memory/vm_ptr.h"
 #include "Emu/Memory/vm_reservation.h"
 #include "Emu/Memory/vm_locking.h"
@@ -9,6 +10,7 @@
 #include "Emu/Cell/PPUThread.h"
 #include "Emu/Cell/SPUThread.h"
 #include "Emu/Cell/ErrorCodes.h"
+#include "Emu/Cell/timeout_queue.hpp"
 #include "sys_sync.h"
 #include "sys_lwmutex.h"
 #include "sys_lwcond.h"
@@ -1255,6 +1257,7 @@ extern void ppu_execute_syscall(ppu_thread& ppu, u64 code)
 #ifdef __APPLE__
 			pthread_jit_write_protect_np(false);
 #endif
+			trace_scope trace0(g_ppu_syscall_table[code].second.data(), "lv2", code);
 			func(ppu, {}, vm::_ptr<u32>(ppu.cia), nullptr);
 			ppu_log.trace("Syscall '%s' (%llu) finished, r3=0x%llx", ppu_syscall_code(code), code, ppu.gpr[3]);
 
@@ -1293,13 +1296,32 @@ DECLARE(lv2_obj::g_mutex);
 DECLARE(lv2_obj::g_ppu){};
 DECLARE(lv2_obj::g_pending){};
 DECLARE(lv2_obj::g_priority_order_tag){};
+DECLARE(lv2_obj::g_timer_wakeup){};
 
 thread_local DECLARE(lv2_obj::g_to_notify){};
 thread_local DECLARE(lv2_obj::g_postpone_notify_barrier){};
 thread_local DECLARE(lv2_obj::g_to_awake);
 
-// Scheduler queue for timeouts (wait until -> thread)
-static std::deque<std::pair<u64, class cpu_thread*>> g_waiting;
+// Scheduler queue for timeouts (wait until -> thread), one entry per PPU thread with headroom for threads outside of IDM
+static timeout_queue<ppu_thread, ppu_thread::id_count * 2, &ppu_thread::timeout_index> g_waiting;
+
+static void add_waiting_timeout(ppu_thread* thread, u64 wait_until)
+{
+	if (g_waiting.push(thread, wait_until))
+	{
+		// The timer thread delivers the timeout if nothing else did by then
+		lv2_obj::g_timer_wakeup.next_timeout = wait_until;
+		lv2_obj::g_timer_wakeup.notify_before(wait_until);
+	}
+}
+
+static void remove_waiting_timeout(ppu_thread* thread)
+{
+	if (g_waiting.remove(thread))
+	{
+		lv2_obj::g_timer_wakeup.next_timeout = g_waiting.next_time();
+	}
+}
 
 // Threads which must call lv2_obj::sleep before the scheduler starts
 static std::deque<class cpu_thread*> g_to_sleep;
@@ -1568,14 +1590,7 @@ bool lv2_obj::sleep_unlocked(cpu_thread& thread, u64 timeout, u64 current_time)
 		const u64 wait_until = start_time + std::min<u64>(timeout, ~start_time);
 
 		// Register timeout if necessary
-		for (auto it = g_waiting.cbegin(), end = g_waiting.cend();; it++)
-		{
-			if (it == end || it->first > wait_until)
-			{
-				g_waiting.emplace(it, wait_until, &thread);
-				break;
-			}
-		}
+		add_waiting_timeout(static_cast<ppu_thread*>(&thread), wait_until);
 	}
 
 	return return_val;
@@ -1727,14 +1742,7 @@ bool lv2_obj::awake_unlocked(cpu_thread* cpu, s32 prio)
 		}
 
 		// Unregister timeout if necessary
-		for (auto it = g_waiting.cbegin(), end = g_waiting.cend(); it != end; it++)
-		{
-			if (it->second == cpu)
-			{
-				g_waiting.erase(it);
-				break;
-			}
-		}
+		remove_waiting_timeout(static_cast<ppu_thread*>(cpu));
 
 		ppu_log.trace("awake(): %s", cpu->id);
 		return true;
@@ -1832,6 +1840,7 @@ void lv2_obj::cleanup()
 	g_scheduler_ready = false;
 	g_to_sleep.clear();
 	g_waiting.clear();
+	g_timer_wakeup.next_timeout = u64{umax};
 	g_pending = 0;
 	s_yield_frequency = 0;
 }
@@ -1875,20 +1884,15 @@ void lv2_obj::schedule_all(u64 current_time)
 	}
 
 	// Check registered timeouts
-	while (!g_waiting.empty())
+	if (!g_waiting.empty())
 	{
-		const auto pair = &g_waiting.front();
-
 		if (!current_time)
 		{
 			current_time = get_guest_system_time();
 		}
 
-		if (pair->first <= current_time)
+		while (const auto target = g_waiting.pop(current_time))
 		{
-			const auto target = pair->second;
-			g_waiting.pop_front();
-
 			if (target != cpu_thread::get_current())
 			{
 				// Change cpu_thread::state for the lightweight notification to work
@@ -1906,11 +1910,8 @@ void lv2_obj::schedule_all(u64 current_time)
 				}
 			}
 		}
-		else
-		{
-			// The list is sorted so assume no more timeouts
-			break;
-		}
+
+		g_timer_wakeup.next_timeout = g_waiting.next_time();
 	}
 
 	if (it < std::end(g_to_notify))
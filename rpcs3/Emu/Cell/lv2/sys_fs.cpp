@@ -3,6 +3,7 @@
 #include "sys_fs.h"
 #include "sys_memory.h"
 #include "util/asm.hpp"
+#include "Emu/Memory/vm_locking.h"
 
 #include "Emu/Cell/PPUThread.h"
 #include "Crypto/unedat.h"
@@ -18,6 +19,11 @@
 #include <span>
 #include <shared_mutex>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/uio.h>
+#endif
+
 LOG_CHANNEL(sys_fs);
 
 lv2_fs_mount_point g_mp_sys_dev_usb{"/dev_usb", "CELL_FS_FAT", "CELL_FS_IOS:USB_MASS_STORAGE", 512, 0x100, 4096, lv2_mp_flag::no_uid_gid};
@@ -380,19 +386,124 @@ lv2_fs_object::lv2_fs_object(utils::serial& ar, bool)
 {
 }
 
-u64 lv2_file::op_read(const fs::file& file, vm::ptr<void> buf, u64 size, u64 opt_pos)
+// Reusable intermediate buffer (avoid allocation on every call)
+static std::span<uchar> get_staging_buffer()
+{
+	thread_local std::vector<uchar> s_buf(65536);
+	return s_buf;
+}
+
+// Resolve host page protection (e.g. set by RSX texture cache) before guest memory is accessed through the super pointer
+static void touch_guest_pages(u32 addr, u32 size, bool is_write)
+{
+	for (u64 page = addr & -4096, end = u64{addr} + size; page < end; page += 4096)
+	{
+		if (is_write)
+		{
+			utils::trigger_write_page_fault(vm::base(static_cast<u32>(page)));
+		}
+		else
+		{
+			static_cast<void>(*static_cast<const volatile u8*>(vm::base(static_cast<u32>(page))));
+		}
+	}
+}
+
+// Transfer data directly between guest memory and the file, returns the amount of bytes processed
+// Stops early if the range is not accessible, remaining data must be transferred through the intermediate buffer
+template <bool IsRead, typename F>
+static u64 direct_guest_io(u32 addr, u64 size, F&& func)
 {
-	if (u64 region = buf.addr() >> 28, region_end = (buf.addr() & 0xfff'ffff) + (size & 0xfff'ffff); region == region_end && ((region >> 28) == 0 || region >= 0xC))
+	constexpr u8 page_flags = IsRead ? vm::page_readable + vm::page_writable : +vm::page_readable;
+
+	if (!size || size > 0x1000'0000 || !vm::check_addr(addr, page_flags, static_cast<u32>(size)))
 	{
-		// Optimize reads from safe memory
-		return (opt_pos == umax ? file.read(buf.get_ptr(), size) : file.read_at(opt_pos, buf.get_ptr(), size));
+		return 0;
 	}
 
-	// Copy data from intermediate buffer (avoid passing vm pointer to a native API)
-	std::vector<uchar> local_buf(std::min<u64>(size, 65536));
+	const auto range_lock = vm::try_alloc_range_lock();
+
+	if (!range_lock)
+	{
+		return 0;
+	}
 
 	u64 result = 0;
 
+	while (result < size)
+	{
+		const u32 block_addr = addr + static_cast<u32>(result);
+
+		// Range lock can't cover two different 64K pages safely
+		const u32 block = static_cast<u32>(std::min<u64>(size - result, 0x10000 - (block_addr % 0x10000)));
+
+		touch_guest_pages(block_addr, block, IsRead);
+
+		vm::range_lock(range_lock, block_addr, block);
+
+		if (!vm::check_addr(block_addr, page_flags, block))
+		{
+			// Memory has been unmapped meanwhile
+			range_lock->release(0);
+			break;
+		}
+
+		const u64 done = func(result, vm::get_super_ptr(block_addr), block);
+
+		range_lock->release(0);
+
+		if constexpr (IsRead)
+		{
+			// Invalidate data cached from this memory during the transfer
+			touch_guest_pages(block_addr, static_cast<u32>(done), true);
+		}
+
+		result += done;
+
+		if (done < block)
+		{
+			break;
+		}
+	}
+
+	vm::free_range_lock(range_lock);
+	return result;
+}
+
+u64 lv2_file::op_read(const fs::file& file, vm::ptr<void> buf, u64 size, u64 opt_pos)
+{
+	u64 result = 0;
+
+#if defined(__linux__) && defined(RWF_NOWAIT)
+	// Read into guest memory without copying (never pass regular vm pointer to a native API)
+	// Only data already in the page cache is read this way: waiting for the disk while holding the range lock
+	// would block reservation stores and page protection changes (e.g. by the RSX texture cache) on these pages
+	if (const int fd = file.get_handle(); fd != -1)
+	{
+		result = direct_guest_io<true>(buf.addr(), size, [&](u64 offset, void* ptr, u32 block) -> u64
+		{
+			iovec iov{ptr, block};
+			const ssize_t nread = ::preadv2(fd, &iov, 1, opt_pos == umax ? -1 : static_cast<off_t>(opt_pos + offset), RWF_NOWAIT);
+			return nread > 0 ? nread : 0;
+		});
+	}
+#endif
+
+	if (result < size)
+	{
+		const u32 addr = buf.addr() + static_cast<u32>(result);
+		const u64 rest = size - result;
+
+		if (u64 region = addr >> 28, region_end = region + (((addr & 0xfff'ffff) + rest - 1) >> 28); region == region_end && (region == 0 || region >= 0xC))
+		{
+			// Optimize reads from safe memory (also used for files without a native handle and where the above is unavailable)
+			return result + (opt_pos == umax ? file.read(vm::base(addr), rest) : file.read_at(opt_pos + result, vm::base(addr), rest));
+		}
+	}
+
+	// Copy data from intermediate buffer (also reads the rest of a partially cached range or detects EOF)
+	const std::span<uchar> local_buf = get_staging_buffer();
+
 	while (result < size)
 	{
 		const u64 block = std::min<u64>(size - result, local_buf.size());
@@ -412,11 +523,29 @@ u64 lv2_file::op_read(const fs::file& file, vm::ptr<void> buf, u64 size, u64 opt
 
 u64 lv2_file::op_write(const fs::file& file, vm::cptr<void> buf, u64 size)
 {
-	// Copy data to intermediate buffer (avoid passing vm pointer to a native API)
-	std::vector<uchar> local_buf(std::min<u64>(size, 65536));
-
+	bool is_short = false;
 	u64 result = 0;
 
+	// Write from guest memory without copying, only for host files (virtual files like EDATA may do a lot of work per call)
+	// The range lock is held during the system call, it's accepted since buffered writes normally return once the data is in the page cache
+	if (file.get_handle() != fs::file{}.get_handle())
+	{
+		result = direct_guest_io<false>(buf.addr(), size, [&](u64, const void* ptr, u32 block)
+		{
+			const u64 nwrite = file.write(ptr, block);
+			is_short = nwrite < block;
+			return nwrite;
+		});
+	}
+
+	if (is_short)
+	{
+		return result;
+	}
+
+	// Copy data to intermediate buffer
+	const std::span<uchar> local_buf = get_staging_buffer();
+
 	while (result < size)
 	{
 		const u64 block = std::min<u64>(size - result, local_buf.size());
@@ -433,6 +562,47 @@ u64 lv2_file::op_write(const fs::file& file, vm::cptr<void> buf, u64 size)
 	return result;
 }
 
+void lv2_file::hint_read_ahead(u64 opt_pos, u64 size) const
+{
+#ifdef __linux__
+	const u64 pos = opt_pos == umax ? file.pos() : opt_pos;
+
+	// Track sequential access pattern
+	if (read_next_pos.exchange(pos + size) != pos || !size)
+	{
+		read_sequential_count.release(0);
+		read_ahead_pos.release(0);
+		return;
+	}
+
+	if (read_sequential_count++ < 2)
+	{
+		return;
+	}
+
+	const int fd = file.get_handle();
+
+	if (fd < 0)
+	{
+		return;
+	}
+
+	// Request the next window before the current one is exhausted
+	const u64 window = std::clamp<u64>(size * 8, 0x40000, 0x800000);
+
+	if (pos + size + window / 2 <= read_ahead_pos)
+	{
+		return;
+	}
+
+	read_ahead_pos.release(pos + size + window);
+	::posix_fadvise(fd, pos + size, window, POSIX_FADV_WILLNEED);
+#else
+	static_cast<void>(opt_pos);
+	static_cast<void>(size);
+#endif
+}
+
 lv2_file::lv2_file(utils::serial& ar)
 	: lv2_fs_object(ar, false)
 	, mode(ar)
@@ -289,6 +289,11 @@ struct lv2_file final : lv2_fs_object
 	// Stream lock
 	atomic_t<u32> lock{0};
 
+	// Sequential read detection
+	mutable atomic_t<u64> read_next_pos{umax};
+	mutable atomic_t<u64> read_ahead_pos{0};
+	mutable atomic_t<u32> read_sequential_count{0};
+
 	// Some variables for convenience of data restoration
 	struct save_restore_t
 	{
@@ -339,15 +344,19 @@ struct lv2_file final : lv2_fs_object
 	static open_raw_result_t open_raw(const std::string& path, s32 flags, s32 mode, lv2_file_type type = lv2_file_type::regular, const lv2_fs_mount_info& mp = g_mi_sys_not_found);
 	static open_result_t open(std::string_view vpath, s32 flags, s32 mode, const void* arg = {}, u64 size = 0);
 
-	// File reading with intermediate buffer
+	// File reading (directly into guest memory if possible)
 	static u64 op_read(const fs::file& file, vm::ptr<void> buf, u64 size, u64 opt_pos = umax);
 
 	u64 op_read(vm::ptr<void> buf, u64 size, u64 opt_pos = umax) const
 	{
+		hint_read_ahead(opt_pos, size);
 		return op_read(file, buf, size, opt_pos);
 	}
 
-	// File writing with intermediate buffer
+	// Advise the OS to prefetch file data if sequential reading is detected
+	void hint_read_ahead(u64 opt_pos, u64 size) const;
+
+	// File writing (directly from guest memory if possible)
 	static u64 op_write(const fs::file& file, vm::cptr<void> buf, u64 size);
 
 	u64 op_write(vm::cptr<void> buf, u64 size) const
@@ -495,6 +495,26 @@ public:
 	// Proirity tags
 	static atomic_t<u64> g_priority_order_tag;
 
+	// Wakeup source of the timer thread, shared by sys_timer and the scheduler timeouts
+	struct timer_wakeup_t
+	{
+		atomic_t<u32> signal{0}; // Incremented to wake the timer thread up
+		atomic_t<u64> deadline{umax}; // Guest time of the next planned wakeup (umax while awake)
+		atomic_t<u64> next_timeout{umax}; // Earliest scheduler timeout (written under g_mutex)
+
+		// Wake the timer thread up if it is going to sleep past the specified guest time
+		void notify_before(u64 time)
+		{
+			if (time < deadline)
+			{
+				signal++;
+				signal.notify_one();
+			}
+		}
+	};
+
+	static timer_wakeup_t g_timer_wakeup;
+
 private:
 	// Pending list of threads to run
 	static thread_local std::vector<class cpu_thread*> g_to_awake;
@@ -5,6 +5,7 @@
 #include "Emu/Cell/ErrorCodes.h"
 #include "Emu/Cell/PPUThread.h"
 #include "Emu/Cell/timers.hpp"
+#include "Emu/Cell/timeout_queue.hpp"
 
 #include "util/asm.hpp"
 #include "Emu/System.h"
@@ -22,9 +23,17 @@ struct lv2_timer_thread
 	shared_mutex mutex;
 	std::deque<shared_ptr<lv2_timer>> timers;
 
+	// Running timers ordered by expiration time, at most one entry per timer.
+	// Entries of stopped or re-armed timers are left in place and dropped or moved when they come up.
+	timeout_queue<lv2_timer, lv2_obj::id_count, &lv2_timer::queue_index> queue;
+
 	lv2_timer_thread();
 	void operator()();
 
+	// Queue a started timer, returns true if it is the next to expire
+	bool schedule(const shared_ptr<lv2_timer>& timer);
+	void unschedule_unlocked(lv2_timer& timer);
+
 	//SAVESTATE_INIT_POS(46); // FREE SAVESTATE_INIT_POS number
 
 	static constexpr auto thread_name = "Timer Thread"sv;
@@ -107,15 +116,41 @@ lv2_timer_thread::lv2_timer_thread()
 {
 	Emu.PostponeInitCode([this]()
 	{
-		idm::select<lv2_obj, lv2_timer>([&](u32 id, lv2_timer&)
+		idm::select<lv2_obj, lv2_timer>([&](u32 id, lv2_timer& timer)
 		{
 			timers.emplace_back(idm::get_unlocked<lv2_obj, lv2_timer>(id));
+
+			if (timer.state == SYS_TIMER_STATE_RUN)
+			{
+				queue.push(&timer, timer.expire);
+			}
 		});
 	});
 }
 
+bool lv2_timer_thread::schedule(const shared_ptr<lv2_timer>& timer)
+{
+	std::lock_guard lock(mutex);
+
+	if (!lv2_obj::check(timer))
+	{
+		// Destroyed in the mean time
+		return false;
+	}
+
+	return queue.push(timer.get(), timer->expire);
+}
+
+void lv2_timer_thread::unschedule_unlocked(lv2_timer& timer)
+{
+	queue.remove(&timer);
+}
+
 void lv2_timer_thread::operator()()
 {
+	auto& wakeup = lv2_obj::g_timer_wakeup;
+
+	u32 signal = wakeup.signal;
 	u64 sleep_time = 0;
 
 	while (true)
@@ -126,13 +161,16 @@ void lv2_timer_thread::operator()()
 			sleep_time = std::min(sleep_time, u64{umax} / 100) * 100 / g_cfg.core.clocks_scale;
 		}
 
-		thread_ctrl::wait_for(sleep_time);
+		thread_ctrl::wait_on(wakeup.signal, signal, sleep_time);
 
 		if (thread_ctrl::state() == thread_state::aborting)
 		{
 			break;
 		}
 
+		// Every new timeout wakes the thread up until the next sleep is planned
+		wakeup.deadline = u64{umax};
+		signal = wakeup.signal;
 		sleep_time = umax;
 
 		if (Emu.IsPausedOrReady())
@@ -143,28 +181,42 @@ void lv2_timer_thread::operator()()
 
 		const u64 _now = get_guest_system_time();
 
-		reader_lock lock(mutex);
+		if (wakeup.next_timeout <= _now)
+		{
+			// Deliver the scheduler timeouts which were not handled by their thread or another scheduler call yet
+			lv2_obj::awake_all();
+		}
 
-		for (const auto& timer : timers)
+		u64 next = wakeup.next_timeout;
 		{
-			while (lv2_obj::check(timer))
+			std::lock_guard lock(mutex);
+
+			// Only visit the timers which are due
+			while (const auto timer = queue.pop(_now))
 			{
-				if (thread_ctrl::state() == thread_state::aborting)
+				u64 advised_sleep_time = 0;
+
+				while (!advised_sleep_time && thread_ctrl::state() != thread_state::aborting)
 				{
-					break;
+					// Returns umax if stopped, or the time left if it was re-armed since it was queued
+					advised_sleep_time = timer->check(_now);
 				}
 
-				if (const u64 advised_sleep_time = timer->check(_now))
+				if (advised_sleep_time != umax && advised_sleep_time)
 				{
-					if (sleep_time > advised_sleep_time)
-					{
-						sleep_time = advised_sleep_time;
-					}
-
-					break;
+					queue.push(timer, utils::add_saturate<u64>(_now, advised_sleep_time));
 				}
 			}
+
+			next = std::min(next, queue.next_time());
+		}
+
+		if (next != umax)
+		{
+			sleep_time = utils::sub_saturate<u64>(next, _now);
 		}
+
+		wakeup.deadline = next;
 	}
 }
 
@@ -225,6 +277,8 @@ error_code sys_timer_destroy(ppu_thread& ppu, u32 timer_id)
 	auto& thread = g_fxo->get<named_thread<lv2_timer_thread>>();
 	std::lock_guard lock(thread.mutex);
 
+	thread.unschedule_unlocked(*timer.ptr);
+
 	if (auto it = std::find(thread.timers.begin(), thread.timers.end(), timer.ptr); it != thread.timers.end())
 	{
 		thread.timers.erase(it);
@@ -274,6 +328,8 @@ error_code _sys_timer_start(ppu_thread& ppu, u32 timer_id, u64 base_time, u64 pe
 		return CELL_EINVAL;
 	}
 
+	shared_ptr<lv2_timer> started;
+
 	const auto timer = idm::check<lv2_obj, lv2_timer>(timer_id, [&](lv2_timer& timer) -> CellError
 	{
 		std::lock_guard lock(timer.mutex);
@@ -316,6 +372,8 @@ error_code _sys_timer_start(ppu_thread& ppu, u32 timer_id, u64 base_time, u64 pe
 		timer.expire = expire;
 		timer.period = period;
 		timer.state  = SYS_TIMER_STATE_RUN;
+
+		started = idm::get_unlocked<lv2_obj, lv2_timer>(timer_id);
 		return {};
 	});
 
@@ -334,7 +392,13 @@ error_code _sys_timer_start(ppu_thread& ppu, u32 timer_id, u64 base_time, u64 pe
 		return timer.ret;
 	}
 
-	g_fxo->get<named_thread<lv2_timer_thread>>()([]{});
+	auto& thread = g_fxo->get<named_thread<lv2_timer_thread>>();
+
+	if (thread.schedule(started))
+	{
+		// Wake the thread up to shorten its sleep
+		lv2_obj::g_timer_wakeup.notify_before(started->expire);
+	}
 
 	return CELL_OK;
 }
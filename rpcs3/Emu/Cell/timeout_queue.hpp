@@ -0,0 +1,173 @@
+#pragma once
+
+#include "util/types.hpp"
+
+#include <array>
+
+// Binary min-heap of timeouts with a fixed capacity, FIFO for equal times.
+// Queued objects store their own position in Index (umax when not queued), so that push, remove and pop are O(log n) and never allocate.
+template <typename T, usz Capacity, u32 T::*Index>
+class timeout_queue
+{
+	struct entry
+	{
+		u64 time;
+		u64 order;
+		T* ptr;
+
+		bool operator<(const entry& rhs) const
+		{
+			return time != rhs.time ? time < rhs.time : order < rhs.order;
+		}
+	};
+
+	std::array<entry, Capacity> m_heap{};
+	u32 m_size = 0;
+	u64 m_order = 0;
+
+public:
+	bool empty() const
+	{
+		return m_size == 0;
+	}
+
+	u32 size() const
+	{
+		return m_size;
+	}
+
+	// Time of the earliest timeout, umax if empty
+	u64 next_time() const
+	{
+		return m_size ? m_heap[0].time : u64{umax};
+	}
+
+	T* front() const
+	{
+		return m_size ? m_heap[0].ptr : nullptr;
+	}
+
+	// Queue an object, or move it if it is already queued. Returns true if it is the new earliest timeout.
+	bool push(T* ptr, u64 time)
+	{
+		if (ptr->*Index != umax)
+		{
+			remove_at(ptr->*Index);
+		}
+
+		ensure(m_size < Capacity);
+
+		const u32 pos = m_size++;
+		place(pos, entry{time, m_order++, ptr});
+		return sift_up(pos) == 0;
+	}
+
+	// Returns false if the object was not queued
+	bool remove(T* ptr)
+	{
+		if (ptr->*Index == umax)
+		{
+			return false;
+		}
+
+		remove_at(ptr->*Index);
+		return true;
+	}
+
+	// Remove the earliest timeout if it is due at the specified time
+	T* pop(u64 now)
+	{
+		if (!m_size || m_heap[0].time > now)
+		{
+			return nullptr;
+		}
+
+		T* ptr = m_heap[0].ptr;
+		remove_at(0);
+		return ptr;
+	}
+
+	void clear()
+	{
+		for (u32 i = 0; i < m_size; i++)
+		{
+			m_heap[i].ptr->*Index = umax;
+		}
+
+		m_size = 0;
+	}
+
+private:
+	void place(u32 pos, const entry& e)
+	{
+		m_heap[pos] = e;
+		e.ptr->*Index = pos;
+	}
+
+	u32 sift_up(u32 pos)
+	{
+		const entry e = m_heap[pos];
+
+		while (pos)
+		{
+			const u32 parent = (pos - 1) / 2;
+
+			if (!(e < m_heap[parent]))
+			{
+				break;
+			}
+
+			place(pos, m_heap[parent]);
+			pos = parent;
+		}
+
+		place(pos, e);
+		return pos;
+	}
+
+	void sift_down(u32 pos)
+	{
+		const entry e = m_heap[pos];
+
+		while (true)
+		{
+			u32 child = pos * 2 + 1;
+
+			if (child >= m_size)
+			{
+				break;
+			}
+
+			if (child + 1 < m_size && m_heap[child + 1] < m_heap[child])
+			{
+				child++;
+			}
+
+			if (!(m_heap[child] < e))
+			{
+				break;
+			}
+
+			place(pos, m_heap[child]);
+			pos = child;
+		}
+
+		place(pos, e);
+	}
+
+	void remove_at(u32 pos)
+	{
+		m_heap[pos].ptr->*Index = umax;
+
+		if (pos != --m_size)
+		{
+			// Move the last entry into the hole, it may have to go either way
+			place(pos, m_heap[m_size]);
+
+			if (sift_up(pos) == pos)
+			{
+				sift_down(pos);
+			}
+		}
+	}
+};
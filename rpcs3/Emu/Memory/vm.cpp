@@ -145,7 +145,7 @@ namespace vm
 		}
 	}
 
-	atomic_t<u64, 64>* alloc_range_lock()
+	atomic_t<u64, 64>* try_alloc_range_lock()
 	{
 		const auto [bits, ok] = get_range_lock_bits(false).fetch_op([](u64& bits)
 		{
@@ -161,12 +161,24 @@ namespace vm
 
 		if (!ok) [[unlikely]]
 		{
-			fmt::throw_exception("Out of range lock bits");
+			return nullptr;
 		}
 
 		return &g_range_lock_set[std::countr_one(bits)];
 	}
 
+	atomic_t<u64, 64>* alloc_range_lock()
+	{
+		const auto range_lock = try_alloc_range_lock();
+
+		if (!range_lock) [[unlikely]]
+		{
+			fmt::throw_exception("Out of range lock bits");
+		}
+
+		return range_lock;
+	}
+
 	template <typename F>
 	static u64 for_all_range_locks(u64 input, F func);
 
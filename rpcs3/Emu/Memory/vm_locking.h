@@ -38,6 +38,9 @@ namespace vm
 	// Register range lock for further use
 	atomic_t<u64, 64>* alloc_range_lock();
 
+	// Same as above but returns nullptr if none is available
+	atomic_t<u64, 64>* try_alloc_range_lock();
+
 	void range_lock_internal(atomic_t<u64, 64>* range_lock, u32 begin, u32 size);
 
 	// Lock memory range ignoring memory protection (Size!=0 also implies aligned begin)
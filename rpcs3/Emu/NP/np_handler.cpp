@@ -1086,6 +1086,9 @@ namespace np
 		while (thread_ctrl::state() != thread_state::aborting && !Emu.IsStopped())
 		{
 			bool sleep = true;
+			std::shared_ptr<rpcn::rpcn_client> client;
+			u32 old_signal = 0;
+
 			if (rpcn)
 			{
 				std::lock_guard lock(mutex_rpcn);
@@ -1094,6 +1097,10 @@ namespace np
 					continue;
 				}
 
+				// Read before fetching anything so that updates queued meanwhile wake up the thread
+				client = rpcn;
+				old_signal = client->get_np_signal();
+
 				auto replies = rpcn->get_replies();
 				for (auto& reply : replies)
 				{
@@ -1265,10 +1272,18 @@ namespace np
 				}
 			}
 
-			// TODO: replace with an appropriate semaphore
 			if (sleep)
 			{
-				thread_ctrl::wait_for(200'000);
+				if (client)
+				{
+					// Woken up by the RPCN client as soon as something is queued, the timeout is a safety net
+					thread_ctrl::wait_on(client->get_np_signal(), old_signal, 200'000);
+				}
+				else
+				{
+					thread_ctrl::wait_for(200'000);
+				}
+
 				continue;
 			}
 		}
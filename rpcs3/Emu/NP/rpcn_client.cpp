@@ -256,9 +256,6 @@ namespace rpcn
 		rpcn_log.notice("online: %s, pr_com_id: %s, pr_title: %s, pr_status: %s, pr_comment: %s, pr_data: %s", online ? "true" : "false", pr_com_id.data, pr_title, pr_status, pr_comment, fmt::buf_to_hexstring(pr_data.data(), pr_data.size()));
 	}
 
-	constexpr u32 RPCN_PROTOCOL_VERSION = 26;
-	constexpr usz RPCN_HEADER_SIZE = 15;
-
 	const char* error_to_explanation(rpcn::ErrorType error)
 	{
 		switch (error)
@@ -334,6 +331,7 @@ namespace rpcn
 		terminate_connection();
 		std::lock_guard lock(inst_mutex);
 		terminate = true;
+		cancel_reply_cbs();
 		sem_rpcn.release();
 		sem_reader.release();
 		sem_writer.release();
@@ -656,7 +654,7 @@ namespace rpcn
 				break;
 			}
 
-			// Those commands are handled synchronously and won't be forwarded to NP Handler
+			// Those commands are sent with a completion and won't be forwarded to NP Handler
 			if (command == CommandType::Login || command == CommandType::GetServerList || command == CommandType::Create ||
 				command == CommandType::AddFriend || command == CommandType::RemoveFriend ||
 				command == CommandType::AddBlock || command == CommandType::RemoveBlock ||
@@ -664,15 +662,35 @@ namespace rpcn
 				command == CommandType::SendResetToken || command == CommandType::ResetPassword ||
 				command == CommandType::GetNetworkTime || command == CommandType::SetPresence || command == CommandType::Terminate)
 			{
-				std::lock_guard lock(mutex_replies_sync);
-				replies_sync.insert(std::make_pair(packet_id, std::make_pair(command, std::move(data))));
+				reply_cb_func cb;
+				{
+					std::lock_guard lock(mutex_reply_cbs);
+					if (auto found = reply_cbs.find(packet_id); found != reply_cbs.end())
+					{
+						cb = std::move(found->second);
+						reply_cbs.erase(found);
+					}
+				}
+
+				if (cb)
+				{
+					cb(data);
+				}
+				else
+				{
+					rpcn_log.error("Received a reply to %s(packet_id %d) without a pending request", command, packet_id);
+				}
 			}
 			else
 			{
 				if (packet_id < 0x100000000)
 				{
-					std::lock_guard lock(mutex_replies);
-					replies.insert(std::make_pair(static_cast<u32>(packet_id), std::make_pair(command, std::move(data))));
+					{
+						std::lock_guard lock(mutex_replies);
+						replies.insert(std::make_pair(static_cast<u32>(packet_id), std::make_pair(command, std::move(data))));
+					}
+
+					notify_np();
 				}
 				else
 				{
@@ -709,6 +727,8 @@ namespace rpcn
 				break;
 			}
 			}
+
+			notify_np();
 			break;
 		}
 		case PacketType::ServerInfo:
@@ -734,6 +754,23 @@ namespace rpcn
 		sem_writer.release();
 	}
 
+	std::vector<u8> rpcn_client::get_packet_buffer(usz size)
+	{
+		std::vector<u8> packet;
+		{
+			std::lock_guard lock(mutex_packets_to_send);
+
+			if (!packet_pool.empty())
+			{
+				packet = std::move(packet_pool.back());
+				packet_pool.pop_back();
+			}
+		}
+
+		packet.resize(size);
+		return packet;
+	}
+
 	bool rpcn_client::handle_output()
 	{
 		std::vector<std::vector<u8>> packets;
@@ -751,6 +788,23 @@ namespace rpcn
 			}
 		}
 
+		// Give the buffers back to the pool so that the next requests don't have to allocate
+		std::lock_guard lock(mutex_packets_to_send);
+
+		for (auto& packet : packets)
+		{
+			if (packet_pool.size() >= RPCN_PACKET_POOL_SIZE)
+			{
+				break;
+			}
+
+			if (packet.capacity() <= RPCN_PACKET_POOL_MAX_CAPACITY)
+			{
+				packet.clear();
+				packet_pool.push_back(std::move(packet));
+			}
+		}
+
 		return true;
 	}
 
@@ -909,19 +963,54 @@ namespace rpcn
 	{
 		// TODO: add a check for status?
 
-		std::vector<u8> sent_packet = forge_request(command, packet_id, data);
+		std::vector<u8> sent_packet = forge_request(command, packet_id, data.size());
+		std::memcpy(sent_packet.data() + RPCN_HEADER_SIZE, data.data(), data.size());
 		add_packet(std::move(sent_packet));
 		return true;
 	}
 
+	// The completion is registered before the request is queued so that it can't miss the reply
+	bool rpcn_client::forge_send_async(rpcn::CommandType command, u64 packet_id, const std::vector<u8>& data, reply_cb_func cb)
+	{
+		register_reply_cb(packet_id, std::move(cb));
+		return forge_send(command, packet_id, data);
+	}
+
 	bool rpcn_client::forge_send_reply(rpcn::CommandType command, u64 packet_id, const std::vector<u8>& data, std::vector<u8>& reply_data)
 	{
-		if (!forge_send(command, packet_id, data))
+		struct pending_reply
+		{
+			atomic_t<u32> done = 0;
+			std::vector<u8> data;
+		};
+
+		// Shared with the completion as this thread may give up before it is called
+		const auto reply = std::make_shared<pending_reply>();
+
+		forge_send_async(command, packet_id, data, [reply](std::vector<u8>& received)
+		{
+			reply->data = std::move(received);
+			reply->done.release(1);
+			reply->done.notify_one();
+		});
+
+		while (!reply->done && connected && !terminate)
+		{
+			// The completion is also called when the connection is lost, the timeout is only a safety net
+			reply->done.wait(0, atomic_wait_timeout{100'000'000});
+		}
+
+		if (!reply->done)
+		{
+			std::lock_guard lock(mutex_reply_cbs);
+			reply_cbs.erase(packet_id);
 			return false;
+		}
 
-		if (!get_reply(packet_id, reply_data))
+		if (reply->data.empty())
 			return false;
 
+		reply_data = std::move(reply->data);
 		return true;
 	}
 
@@ -941,14 +1030,14 @@ namespace rpcn
 			write_wssl = nullptr;
 		}
 
+		// wolfSSL_Init() is reference counted, only release the reference taken by connect()
 		if (wssl_ctx)
 		{
 			wolfSSL_CTX_free(wssl_ctx);
 			wssl_ctx = nullptr;
+			wolfSSL_Cleanup();
 		}
 
-		wolfSSL_Cleanup();
-
 		if (sockfd)
 		{
 #ifdef _WIN32
@@ -964,6 +1053,7 @@ namespace rpcn
 		connected = false;
 		authentified = false;
 		server_info_received = false;
+		cancel_reply_cbs();
 	}
 
 	bool rpcn_client::connect(const std::string& host)
@@ -1016,6 +1106,7 @@ namespace rpcn
 
 			if ((wssl_ctx = wolfSSL_CTX_new(wolfTLSv1_2_client_method())) == nullptr)
 			{
+				wolfSSL_Cleanup();
 				rpcn_log.error("connect: Failed to create wolfssl context");
 				state = rpcn_state::failure_wolfssl;
 				return false;
@@ -1545,34 +1636,6 @@ namespace rpcn
 		return ret_new_messages;
 	}
 
-	bool rpcn_client::get_reply(const u64 expected_id, std::vector<u8>& data)
-	{
-		auto check_for_reply = [this, expected_id, &data]() -> bool
-		{
-			std::lock_guard lock(mutex_replies_sync);
-			if (auto r = replies_sync.find(expected_id); r != replies_sync.end())
-			{
-				data = std::move(r->second.second);
-				replies_sync.erase(r);
-				return true;
-			}
-			return false;
-		};
-
-		while (connected && !terminate)
-		{
-			if (check_for_reply())
-				return true;
-
-			std::this_thread::sleep_for(5ms);
-		}
-
-		if (check_for_reply())
-			return true;
-
-		return false;
-	}
-
 	bool rpcn_client::get_server_list(u32 req_id, const SceNpCommunicationId& communication_id, std::vector<u16>& server_list)
 	{
 		std::vector<u8> data(COMMUNICATION_ID_SIZE), reply_data;
@@ -1635,6 +1698,28 @@ namespace rpcn
 		return network_time;
 	}
 
+	bool rpcn_client::get_network_time_async(u32 req_id, network_time_cb_func cb)
+	{
+		if (!connected)
+			return false;
+
+		std::vector<u8> data;
+		return forge_send_async(CommandType::GetNetworkTime, req_id, data, [cb = std::move(cb)](std::vector<u8>& reply_data)
+		{
+			if (reply_data.empty())
+			{
+				cb(0);
+				return;
+			}
+
+			vec_stream reply(reply_data);
+			const auto error = static_cast<ErrorType>(reply.get<u8>());
+			const u64 network_time = reply.get<u64>();
+
+			cb(error == rpcn::ErrorType::NoError && !reply.is_error() ? network_time : 0);
+		});
+	}
+
 	bool rpcn_client::get_world_list(u32 req_id, const SceNpCommunicationId& communication_id, u16 server_id)
 	{
 		std::vector<u8> data(COMMUNICATION_ID_SIZE + sizeof(u16));
@@ -2153,7 +2238,11 @@ namespace rpcn
 		reinterpret_cast<le_t<u32>&>(data[0]) = static_cast<u32>(bufsize);
 		memcpy(data.data() + sizeof(u32), buf, bufsize);
 
-		return forge_send(CommandType::SendMessage, rpcn_request_counter.fetch_add(1), data);
+		return forge_send_async(CommandType::SendMessage, rpcn_request_counter.fetch_add(1), data, [](std::vector<u8>& reply_data)
+		{
+			if (!reply_data.empty())
+				print_error(CommandType::SendMessage, static_cast<ErrorType>(reply_data[0]));
+		});
 	}
 
 	bool rpcn_client::get_board_infos(u32 req_id, const SceNpCommunicationId& communication_id, SceNpScoreBoardId board_id)
@@ -2459,7 +2548,15 @@ namespace rpcn
 		auto req_finished = CreateSetPresenceRequest(builder, builder.CreateString(pr_title), builder.CreateString(pr_status), builder.CreateString(pr_comment), builder.CreateVector(pr_data));
 		builder.Finish(req_finished);
 
-		return forge_request_with_com_id(builder, pr_com_id, CommandType::SetPresence, rpcn_request_counter.fetch_add(1));
+		const u64 packet_id = rpcn_request_counter.fetch_add(1);
+
+		register_reply_cb(packet_id, [](std::vector<u8>& reply_data)
+		{
+			if (!reply_data.empty())
+				print_error(CommandType::SetPresence, static_cast<ErrorType>(reply_data[0]));
+		});
+
+		return forge_request_with_com_id(builder, pr_com_id, CommandType::SetPresence, packet_id);
 	}
 
 	bool rpcn_client::createjoin_room_gui(u32 req_id, const SceNpCommunicationId& communication_id, const SceNpMatchingAttr* attr_list)
@@ -2709,56 +2806,101 @@ namespace rpcn
 	}
 
 	void rpcn_client::write_communication_id(const SceNpCommunicationId& com_id, std::vector<u8>& data)
+	{
+		write_communication_id(com_id, data.data());
+	}
+
+	void rpcn_client::write_communication_id(const SceNpCommunicationId& com_id, u8* data)
 	{
 		ensure(com_id.data[9] == 0 && com_id.num <= 99, "rpcn_client::write_communication_id: Invalid SceNpCommunicationId");
 		const std::string com_id_str = np::communication_id_to_string(com_id);
 		ensure(com_id_str.size() == 12, "rpcn_client::write_communication_id: Error formatting SceNpCommunicationId");
-		memcpy(data.data(), com_id_str.data(), COMMUNICATION_ID_SIZE);
+		memcpy(data, com_id_str.data(), COMMUNICATION_ID_SIZE);
 	}
 
+	// The flatbuffer is written straight into the packet instead of going through an intermediate buffer
 	bool rpcn_client::forge_request_with_com_id(const flatbuffers::FlatBufferBuilder& builder, const SceNpCommunicationId& com_id, CommandType command, u64 packet_id)
 	{
 		const u8* buf = builder.GetBufferPointer();
 		const usz bufsize = builder.GetSize();
-		std::vector<u8> data(COMMUNICATION_ID_SIZE + sizeof(u32) + bufsize);
+		std::vector<u8> packet = forge_request(command, packet_id, COMMUNICATION_ID_SIZE + sizeof(u32) + bufsize);
+		u8* data = packet.data() + RPCN_HEADER_SIZE;
 
 		rpcn_client::write_communication_id(com_id, data);
 
-		reinterpret_cast<le_t<u32>&>(data[COMMUNICATION_ID_SIZE]) = static_cast<u32>(bufsize);
-		memcpy(data.data() + COMMUNICATION_ID_SIZE + sizeof(u32), buf, bufsize);
+		write_to_ptr<le_t<u32>>(data + COMMUNICATION_ID_SIZE, static_cast<u32>(bufsize));
+		memcpy(data + COMMUNICATION_ID_SIZE + sizeof(u32), buf, bufsize);
 
-		return forge_send(command, packet_id, data);
+		add_packet(std::move(packet));
+		return true;
 	}
 
 	bool rpcn_client::forge_request_with_data(const flatbuffers::FlatBufferBuilder& builder, CommandType command, u64 packet_id)
 	{
 		const u8* buf = builder.GetBufferPointer();
 		const usz bufsize = builder.GetSize();
-		std::vector<u8> data(sizeof(u32) + bufsize);
+		std::vector<u8> packet = forge_request(command, packet_id, sizeof(u32) + bufsize);
+		u8* data = packet.data() + RPCN_HEADER_SIZE;
 
-		reinterpret_cast<le_t<u32>&>(data[0]) = static_cast<u32>(bufsize);
-		memcpy(data.data() + sizeof(u32), buf, bufsize);
+		write_to_ptr<le_t<u32>>(data, static_cast<u32>(bufsize));
+		memcpy(data + sizeof(u32), buf, bufsize);
 
-		return forge_send(command, packet_id, data);
+		add_packet(std::move(packet));
+		return true;
 	}
 
-	std::vector<u8> rpcn_client::forge_request(rpcn::CommandType command, u64 packet_id, const std::vector<u8>& data) const
+	std::vector<u8> rpcn_client::forge_request(rpcn::CommandType command, u64 packet_id, usz data_size)
 	{
-		const usz packet_size = data.size() + RPCN_HEADER_SIZE;
+		const usz packet_size = data_size + RPCN_HEADER_SIZE;
 
-		std::vector<u8> packet(packet_size);
+		std::vector<u8> packet = get_packet_buffer(packet_size);
 		packet[0] = static_cast<u8>(PacketType::Request);
 		reinterpret_cast<le_t<u16>&>(packet[1]) = static_cast<u16>(command);
 		reinterpret_cast<le_t<u32>&>(packet[3]) = ::narrow<u32>(packet_size);
 		reinterpret_cast<le_t<u64>&>(packet[7]) = packet_id;
 
-		memcpy(packet.data() + RPCN_HEADER_SIZE, data.data(), data.size());
 		return packet;
 	}
 
+	void rpcn_client::register_reply_cb(u64 packet_id, reply_cb_func cb)
+	{
+		std::lock_guard lock(mutex_reply_cbs);
+		reply_cbs.insert_or_assign(packet_id, std::move(cb));
+	}
+
+	// Replies can't arrive anymore once the connection is lost, pending completions are called with an empty reply
+	void rpcn_client::cancel_reply_cbs()
+	{
+		std::unordered_map<u64, reply_cb_func> cancelled;
+		{
+			std::lock_guard lock(mutex_reply_cbs);
+			cancelled = std::move(reply_cbs);
+			reply_cbs.clear();
+		}
+
+		std::vector<u8> no_reply;
+
+		for (auto& [packet_id, cb] : cancelled)
+		{
+			cb(no_reply);
+		}
+	}
+
+	void rpcn_client::notify_np()
+	{
+		np_signal++;
+		np_signal.notify_all();
+	}
+
+	atomic_t<u32>& rpcn_client::get_np_signal()
+	{
+		return np_signal;
+	}
+
 	bool rpcn_client::error_and_disconnect(const std::string& error_msg)
 	{
 		connected = false;
+		cancel_reply_cbs();
 		rpcn_log.error("%s", error_msg);
 		return false;
 	}
@@ -2766,6 +2908,7 @@ namespace rpcn
 	bool rpcn_client::error_and_disconnect_notice(const std::string& error_msg)
 	{
 		connected = false;
+		cancel_reply_cbs();
 		rpcn_log.notice("%s", error_msg);
 		return false;
 	}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <functional>
 #include <chrono>
 #include <thread>
 #include <semaphore>
@@ -98,8 +99,7 @@ public:
 			return {};
 		}
 
-		std::vector<u8> ret;
-		std::copy(vec.begin() + i, vec.begin() + i + size, std::back_inserter(ret));
+		std::vector<u8> ret(vec.begin() + i, vec.begin() + i + size);
 		i += size;
 		return ret;
 	}
@@ -131,6 +131,33 @@ public:
 	template <typename T>
 	const T* get_flatbuffer()
 	{
+		const u32 size = get<u32>();
+
+		if (error || i + size > vec.size())
+		{
+			error = true;
+			return nullptr;
+		}
+
+		// The reply outlives the stream, so a suitably aligned flatbuffer can be verified and read in place
+		if (size && (reinterpret_cast<uptr>(&vec[i]) % alignof(u64)) == 0)
+		{
+			const u8* data = &vec[i];
+			i += size;
+
+			const T* ret = flatbuffers::GetRoot<T>(data);
+			flatbuffers::Verifier verifier(data, size);
+
+			if (!ret->Verify(verifier))
+			{
+				error = true;
+				return nullptr;
+			}
+
+			return ret;
+		}
+
+		i -= sizeof(u32);
 		auto rawdata_vec = get_rawdata();
 
 		if (error)
@@ -185,6 +212,8 @@ namespace rpcn
 {
 	using friend_cb_func  = void (*)(void* param, NotificationType ntype, const std::string& username, bool status);
 	using message_cb_func = void (*)(void* param, const shared_ptr<std::pair<std::string, message_data>> new_msg, u64 msg_id);
+	using reply_cb_func = std::function<void(std::vector<u8>& reply_data)>; // reply_data is empty if the connection was lost
+	using network_time_cb_func = std::function<void(u64 network_time)>;
 
 	struct friend_online_data
 	{
@@ -241,6 +270,7 @@ namespace rpcn
 		atomic_t<rpcn_state> state = rpcn_state::failure_no_failure;
 
 		std::vector<std::vector<u8>> packets_to_send;
+		std::vector<std::vector<u8>> packet_pool; // Sent packets kept for reuse, also protected by mutex_packets_to_send
 		std::mutex mutex_packets_to_send;
 
 		// Friends related
@@ -331,6 +361,8 @@ namespace rpcn
 		// Synchronous requests
 		bool get_server_list(u32 req_id, const SceNpCommunicationId& communication_id, std::vector<u16>& server_list);
 		u64 get_network_time(u32 req_id);
+		// Same as get_network_time but doesn't wait for the reply, cb is called from the reader thread with 0 on failure
+		bool get_network_time_async(u32 req_id, network_time_cb_func cb);
 		// Asynchronous requests
 		bool get_world_list(u32 req_id, const SceNpCommunicationId& communication_id, u16 server_id);
 		bool createjoin_room(u32 req_id, const SceNpCommunicationId& communication_id, const SceNpMatching2CreateJoinRoomRequest* req);
@@ -389,15 +421,23 @@ namespace rpcn
 		u32 get_addr_local() const;
 		void update_local_addr(u32 addr);
 
+		// Incremented when replies, notifications, presence updates or messages are queued for NP Handler
+		atomic_t<u32>& get_np_signal();
+
 	private:
-		bool get_reply(u64 expected_id, std::vector<u8>& data);
+		void register_reply_cb(u64 packet_id, reply_cb_func cb);
+		void cancel_reply_cbs();
+		void notify_np();
 
 		static void write_communication_id(const SceNpCommunicationId& com_id, std::vector<u8>& data);
+		static void write_communication_id(const SceNpCommunicationId& com_id, u8* data);
 
-		std::vector<u8> forge_request(rpcn::CommandType command, u64 packet_id, const std::vector<u8>& data) const;
+		std::vector<u8> get_packet_buffer(usz size);
+		std::vector<u8> forge_request(rpcn::CommandType command, u64 packet_id, usz data_size);
 		bool forge_send(rpcn::CommandType command, u64 packet_id, const std::vector<u8>& data);
 		bool forge_request_with_com_id(const flatbuffers::FlatBufferBuilder& builder, const SceNpCommunicationId& com_id, CommandType command, u64 packet_id);
 		bool forge_request_with_data(const flatbuffers::FlatBufferBuilder& builder, CommandType command, u64 packet_id);
+		bool forge_send_async(rpcn::CommandType command, u64 packet_id, const std::vector<u8>& data, reply_cb_func cb);
 		bool forge_send_reply(rpcn::CommandType command, u64 packet_id, const std::vector<u8>& data, std::vector<u8>& reply_data);
 
 		bool error_and_disconnect(const std::string& error_mgs);
@@ -424,10 +464,11 @@ namespace rpcn
 
 		atomic_t<u64> rpcn_request_counter = 0x100000001; // Counter used for commands whose result is not forwarded to NP handler(login, create, sendmessage, etc)
 
-		shared_mutex mutex_notifs, mutex_replies, mutex_replies_sync, mutex_presence_updates;
+		shared_mutex mutex_notifs, mutex_replies, mutex_reply_cbs, mutex_presence_updates;
 		std::vector<std::pair<rpcn::NotificationType, std::vector<u8>>> notifications;       // notif type / data
 		std::unordered_map<u32, std::pair<rpcn::CommandType, std::vector<u8>>> replies;      // req id / (command / data)
-		std::unordered_map<u64, std::pair<rpcn::CommandType, std::vector<u8>>> replies_sync; // same but for sync replies(see handle_input())
+		std::unordered_map<u64, reply_cb_func> reply_cbs;                                    // packet id / completion of the replies not forwarded to NP Handler(see handle_input())
+		atomic_t<u32> np_signal = 0;                                                         // see get_np_signal()
 		std::unordered_map<std::string, friend_online_data> presence_updates;                // npid / presence data
 
 		// Messages
@@ -463,6 +504,9 @@ namespace rpcn
 
 		static constexpr int RPCN_TIMEOUT_INTERVAL = 50; // 50ms
 		static constexpr int RPCN_TIMEOUT = 10'000;      // 10s
+
+		static constexpr usz RPCN_PACKET_POOL_SIZE = 16;
+		static constexpr usz RPCN_PACKET_POOL_MAX_CAPACITY = 0x10000; // Larger buffers are released after being sent
 	};
 
 } // namespace rpcn
@@ -4,6 +4,9 @@
 
 namespace rpcn
 {
+	constexpr u32 RPCN_PROTOCOL_VERSION = 26;
+	constexpr usz RPCN_HEADER_SIZE = 15; // Packet type(u8), command(le16), packet size including the header(le32), packet id(le64)
+
 	enum class CommandType : u16
 	{
 		Login,
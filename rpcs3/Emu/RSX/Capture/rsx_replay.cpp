@@ -189,6 +189,9 @@ namespace rsx
 			auto render = get_current_renderer();
 			auto last_flip = render->int_flip_index;
 
+			// Registers were replaced without going through the FIFO
+			render->m_graphics_state |= rsx::pipeline_state::vertex_layout_dirty;
+
 			usz stopIdx = 0;
 			for (const auto& replay_cmd : frame->replay_commands)
 			{
@@ -19,6 +19,49 @@ namespace rsx
 		const rsx_state& state = *REGS(m_ctx);
 		const u32 input_mask = state.vertex_attrib_input_mask() & vp_metadata.referenced_inputs_mask;
 
+		auto& graphics_state = RSX(m_ctx)->m_graphics_state;
+		auto& stats = RSX(m_ctx)->get_stats();
+		stats.vertex_layout_request_count++;
+
+		// Immediate draws read from the push buffers which change with every draw
+		if (state.current_draw_clause.is_immediate_draw && state.current_draw_clause.command != rsx::draw_command::indexed)
+		{
+			m_vertex_layout_key = {};
+		}
+		else
+		{
+			vertex_layout_key_t key{ &result, input_mask, 0, state.current_draw_clause.command };
+
+			for (auto [ref_mask, index] = std::tuple{ input_mask, u8(0) }; ref_mask; ++index, ref_mask >>= 1)
+			{
+				if ((ref_mask & 1u) && state.register_vertex_info[index].size > 0)
+				{
+					key.register_mask |= (1u << index);
+				}
+			}
+
+			if (!graphics_state.test(rsx::pipeline_state::vertex_layout_dirty) && key == m_vertex_layout_key)
+			{
+				// Layout is unchanged, only the vertex base may have moved
+				for (auto& info : result.interleaved_blocks)
+				{
+					info->vertex_range.second = 0;
+
+					if (key.command != rsx::draw_command::inlined_array)
+					{
+						info->real_offset_address = rsx::get_address(rsx::get_vertex_offset_from_base(state.vertex_data_base_offset(), info->base_offset), info->memory_location);
+					}
+				}
+
+				return;
+			}
+
+			m_vertex_layout_key = key;
+		}
+
+		graphics_state.clear(rsx::pipeline_state::vertex_layout_dirty);
+		stats.vertex_layout_miss_count++;
+
 		result.clear();
 		result.attribute_mask = static_cast<u16>(input_mask);
 
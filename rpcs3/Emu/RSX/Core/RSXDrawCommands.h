@@ -20,7 +20,19 @@ namespace rsx
 	{
 		using vertex_program_metadata_t = program_hash_util::vertex_program_utils::vertex_program_metadata;
 
+		// Inputs of the last analyzed vertex layout not covered by pipeline_state::vertex_layout_dirty
+		struct vertex_layout_key_t
+		{
+			const vertex_input_layout* layout = nullptr;
+			u32 input_mask = 0;
+			u16 register_mask = 0;
+			rsx::draw_command command = rsx::draw_command::none;
+
+			bool operator==(const vertex_layout_key_t&) const = default;
+		};
+
 		context* m_ctx = nullptr;
+		vertex_layout_key_t m_vertex_layout_key{};
 
 	protected:
 		friend class thread;
@@ -37,6 +49,7 @@ namespace rsx
 		}
 
 		// Analyze vertex inputs and group all interleaved blocks
+		// The previous result is reused if the vertex array registers, input mask and draw type did not change
 		void analyse_inputs_interleaved(vertex_input_layout& layout, const vertex_program_metadata_t& vp_metadata);
 
 		// Retrieve raw bytes for the index array (untyped)
@@ -40,6 +40,8 @@ namespace rsx
 
 		xform_instancing_state_dirty  = (1 << 25), // Transform instancing state has changed
 
+		vertex_layout_dirty           = (1 << 26), // Vertex array format or offset registers changed
+
 		fragment_program_dirty = fragment_program_ucode_dirty | fragment_program_state_dirty,
 		vertex_program_dirty = vertex_program_ucode_dirty | vertex_program_state_dirty,
 		invalidate_pipeline_bits = fragment_program_dirty | vertex_program_dirty | xform_instancing_state_dirty,
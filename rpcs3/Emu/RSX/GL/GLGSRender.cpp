@@ -131,6 +131,7 @@ void GLGSRender::on_init_thread()
 	// Bind primary context to main RSX thread
 	m_frame->set_current(m_context);
 	gl::set_primary_context_thread();
+	gl::initialize_program_binary_cache();
 
 	zcull_ctrl.reset(static_cast<::rsx::reports::ZCULL_control*>(this));
 	m_occlusion_type = g_cfg.video.precise_zpass_count ? GL_SAMPLES_PASSED : GL_ANY_SAMPLES_PASSED;
@@ -1,6 +1,10 @@
 #include "stdafx.h"
 #include "GLPipelineCompiler.h"
 #include "Utilities/Thread.h"
+#include "Utilities/File.h"
+#include "Crypto/sha1.h"
+#include "Emu/cache_utils.hpp"
+#include "Emu/system_config.h"
 #include "util/sysinfo.hpp"
 
 namespace gl
@@ -10,6 +14,78 @@ namespace gl
 	int g_num_pipe_compilers = 0;
 	atomic_t<int> g_compiler_index{};
 
+	// Program binary cache, written once on init before any program is compiled
+	std::string g_program_binary_path;
+	std::string g_driver_id;
+
+	// Bump when the layout of the cache entries or the program setup in GLProgramBuffer changes
+	constexpr u32 program_binary_version = 1;
+
+	struct program_binary_header
+	{
+		u32 magic;
+		u32 version;
+		u32 format;
+		u32 size;
+	};
+
+	constexpr u32 program_binary_magic = "GLPB"_u32;
+
+	static bool load_program_binary(glsl::program* program, const std::string& key, const pipe_compiler::build_callback_t& post_link_func)
+	{
+		const std::string path = g_program_binary_path + key + ".bin";
+		const fs::file f(path);
+
+		if (!f)
+		{
+			return false;
+		}
+
+		program_binary_header header{};
+		std::vector<u8> binary;
+
+		if (!f.read(header) || header.magic != program_binary_magic || header.version != program_binary_version ||
+			f.size() != sizeof(header) + header.size)
+		{
+			rsx_log.warning("Discarding invalid program binary '%s'", path);
+			fs::remove_file(path);
+			return false;
+		}
+
+		binary.resize(header.size);
+
+		if (f.read(binary.data(), binary.size()) != binary.size() || !program->link_binary(header.format, binary, post_link_func))
+		{
+			// Let the next successful link replace the entry
+			rsx_log.notice("Program binary '%s' was rejected by the driver, relinking", path);
+			return false;
+		}
+
+		return true;
+	}
+
+	static void save_program_binary(const glsl::program* program, const std::string& key)
+	{
+		GLenum format = GL_NONE;
+		std::vector<u8> binary;
+
+		if (!program->get_binary(format, binary))
+		{
+			return;
+		}
+
+		const program_binary_header header{ program_binary_magic, program_binary_version, format, ::size32(binary) };
+		const std::string path = g_program_binary_path + key + ".bin";
+
+		fs::pending_file temp(path);
+
+		if (!temp.file || temp.file.write(&header, sizeof(header)) < sizeof(header) ||
+			temp.file.write(binary.data(), binary.size()) < binary.size() || !temp.commit())
+		{
+			rsx_log.warning("Failed to write program binary '%s' (error=%s)", path, fs::g_tls_error);
+		}
+	}
+
 	pipe_compiler::pipe_compiler()
 	{
 	}
@@ -47,7 +123,8 @@ namespace gl
 
 				auto result = int_compile_graphics_pipe(
 					job.post_create_func,
-					job.post_link_func);
+					job.post_link_func,
+					job.binary_key);
 
 				job.completion_callback(result);
 			}
@@ -60,30 +137,51 @@ namespace gl
 		op_flags flags,
 		build_callback_t post_create_func,
 		build_callback_t post_link_func,
-		storage_callback_t completion_callback_func)
+		storage_callback_t completion_callback_func,
+		const std::string& binary_key)
 	{
 		if (flags == COMPILE_INLINE)
 		{
-			return int_compile_graphics_pipe(post_create_func, post_link_func);
+			return int_compile_graphics_pipe(post_create_func, post_link_func, binary_key);
 		}
 
-		m_work_queue.push(post_create_func, post_link_func, completion_callback_func);
+		m_work_queue.push(post_create_func, post_link_func, completion_callback_func, binary_key);
 		return {};
 	}
 
 	std::unique_ptr<glsl::program> pipe_compiler::int_compile_graphics_pipe(
 		build_callback_t post_create_func,
-		build_callback_t post_link_func)
+		build_callback_t post_link_func,
+		const std::string& binary_key)
 	{
 		auto result = std::make_unique<glsl::program>();
 		result->create();
 
+		if (!binary_key.empty())
+		{
+			// On a hit post_create_func is never run, so the shader objects are left uncompiled
+			if (load_program_binary(result.get(), binary_key, post_link_func))
+			{
+				return result;
+			}
+
+			// Start over with a clean object, a failed glProgramBinary leaves it unlinked
+			result->recreate();
+			result->set_binary_retrievable();
+		}
+
 		if (post_create_func)
 		{
 			post_create_func(result.get());
 		}
 
 		result->link(post_link_func);
+
+		if (!binary_key.empty())
+		{
+			save_program_binary(result.get(), binary_key);
+		}
+
 		return result;
 	}
 
@@ -140,4 +238,81 @@ namespace gl
 
 		return g_pipe_compilers.get()->begin() + (thread_index % g_num_pipe_compilers);
 	}
+
+	void initialize_program_binary_cache()
+	{
+		g_program_binary_path.clear();
+		g_driver_id.clear();
+
+		if (g_cfg.video.disable_on_disk_shader_cache)
+		{
+			return;
+		}
+
+		GLint num_formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+
+		if (num_formats <= 0)
+		{
+			rsx_log.notice("The OpenGL driver does not support program binaries");
+			return;
+		}
+
+		const std::string cache_path = rpcs3::cache::get_ppu_cache();
+
+		if (cache_path.empty())
+		{
+			return;
+		}
+
+		const std::string dir = cache_path + "shaders_cache/pipelines/opengl/binaries/";
+
+		if (!fs::create_path(dir))
+		{
+			rsx_log.error("Failed to create program binary cache directory '%s' (error=%s)", dir, fs::g_tls_error);
+			return;
+		}
+
+		// Binaries are only valid for the exact driver build which produced them
+		g_driver_id = fmt::format("%s\n%s\n%s",
+			reinterpret_cast<const char*>(glGetString(GL_VENDOR)),
+			reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+			reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+
+		g_program_binary_path = dir;
+	}
+
+	std::string get_program_binary_key(const glsl::shader& vp, const glsl::shader& fp)
+	{
+		if (g_program_binary_path.empty())
+		{
+			return {};
+		}
+
+		sha1_context ctx;
+		u8 digest[20];
+
+		sha1_starts(&ctx);
+		sha1_update(&ctx, reinterpret_cast<const u8*>(&program_binary_version), sizeof(program_binary_version));
+		sha1_update(&ctx, reinterpret_cast<const u8*>(g_driver_id.data()), g_driver_id.size());
+
+		for (const glsl::shader* shader : { &vp, &fp })
+		{
+			// Length prefix keeps the two sources from aliasing each other
+			const u64 length = shader->get_source().size();
+			sha1_update(&ctx, reinterpret_cast<const u8*>(&length), sizeof(length));
+			sha1_update(&ctx, reinterpret_cast<const u8*>(shader->get_source().data()), length);
+		}
+
+		sha1_finish(&ctx, digest);
+
+		std::string key;
+
+		for (const u8 byte : digest)
+		{
+			fmt::append(key, "%02x", byte);
+		}
+
+		return key;
+	}
 }
@@ -31,7 +31,8 @@ namespace gl
 			op_flags flags,
 			build_callback_t post_create_func = {},
 			build_callback_t post_link_func = {},
-			storage_callback_t completion_callback = {});
+			storage_callback_t completion_callback = {},
+			const std::string& binary_key = {});
 
 		void operator()();
 
@@ -42,9 +43,10 @@ namespace gl
 			build_callback_t post_create_func;
 			build_callback_t post_link_func;
 			storage_callback_t completion_callback;
+			std::string binary_key;
 
-			pipe_compiler_job(build_callback_t post_create, build_callback_t post_link, storage_callback_t completion)
-				: post_create_func(post_create), post_link_func(post_link), completion_callback(completion)
+			pipe_compiler_job(build_callback_t post_create, build_callback_t post_link, storage_callback_t completion, const std::string& key)
+				: post_create_func(post_create), post_link_func(post_link), completion_callback(completion), binary_key(key)
 			{}
 		};
 
@@ -57,7 +59,7 @@ namespace gl
 		std::function<void(draw_context_t context)> m_context_destroy_func;
 
 		std::unique_ptr<glsl::program> int_compile_graphics_pipe(
-			build_callback_t post_create_func, build_callback_t post_link_func);
+			build_callback_t post_create_func, build_callback_t post_link_func, const std::string& binary_key);
 	};
 
 	void initialize_pipe_compiler(
@@ -68,4 +70,10 @@ namespace gl
 
 	void destroy_pipe_compiler();
 	pipe_compiler* get_pipe_compiler();
+
+	// On-disk cache of linked program binaries. Must be called with a context bound to query the driver.
+	void initialize_program_binary_cache();
+
+	// Returns an empty key if the program binary cache is disabled
+	std::string get_program_binary_key(const glsl::shader& vp, const glsl::shader& fp);
 }
@@ -280,7 +280,7 @@ void GLGSRender::flip(const rsx::display_flip_info_t& info)
 	{
 		if (g_user_asked_for_screenshot || (g_recording_mode != recording_mode::stopped && m_frame->can_consume_frame()))
 		{
-			std::vector<u8> sshot_frame(buffer_height * buffer_width * 4);
+			std::vector<u8> sshot_frame = m_frame->get_frame_buffer(buffer_height * buffer_width * 4);
 			glGetError();
 
 			gl::pixel_pack_settings pack_settings{};
@@ -400,6 +400,10 @@ void GLGSRender::flip(const rsx::display_flip_info_t& info)
 		const auto vertex_cache_hit_ratio = info.stats.vertex_cache_request_count
 			? (vertex_cache_hit_count * 100) / info.stats.vertex_cache_request_count
 			: 0;
+		const auto vertex_layout_hit_count = (info.stats.vertex_layout_request_count - info.stats.vertex_layout_miss_count);
+		const auto vertex_layout_hit_ratio = info.stats.vertex_layout_request_count
+			? (vertex_layout_hit_count * 100) / info.stats.vertex_layout_request_count
+			: 0;
 
 		rsx::overlays::set_debug_overlay_text(fmt::format(
 			"Internal Resolution:     %s\n"
@@ -413,13 +417,15 @@ void GLGSRender::flip(const rsx::display_flip_info_t& info)
 			"Texture memory: %12dM\n"
 			"Flush requests: %12d  = %2d (%3d%%) hard faults, %2d unavoidable, %2d misprediction(s), %2d speculation(s)\n"
 			"Texture uploads: %11u (%u from CPU - %02u%%, %u copies avoided)\n"
-			"Vertex cache hits: %9u/%u (%u%%)",
+			"Vertex cache hits: %9u/%u (%u%%)\n"
+			"Vertex layout hits: %8u/%u (%u%%)",
 			info.stats.framebuffer_stats.to_string(!backend_config.supports_hw_msaa),
 			get_load(), info.stats.draw_calls, info.stats.setup_time, info.stats.vertex_upload_time,
 			info.stats.textures_upload_time, info.stats.draw_exec_time, num_dirty_textures, texture_memory_size,
 			num_flushes, num_misses, cache_miss_ratio, num_unavoidable, num_mispredict, num_speculate,
 			num_texture_upload, num_texture_upload_miss, texture_upload_miss_ratio, texture_copies_ellided,
-			vertex_cache_hit_count, info.stats.vertex_cache_request_count, vertex_cache_hit_ratio)
+			vertex_cache_hit_count, info.stats.vertex_cache_request_count, vertex_cache_hit_ratio,
+			vertex_layout_hit_count, info.stats.vertex_layout_request_count, vertex_layout_hit_ratio)
 		);
 	}
 
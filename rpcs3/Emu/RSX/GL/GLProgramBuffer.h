@@ -41,6 +41,8 @@ struct GLTraits
 		auto compiler = gl::get_pipe_compiler();
 		auto flags = (compile_async) ? gl::pipe_compiler::COMPILE_DEFERRED : gl::pipe_compiler::COMPILE_INLINE;
 
+		// Shader objects only hold their source until here, they are compiled when the program is linked from source.
+		// A program binary cache hit in the pipe compiler skips this callback and never compiles them.
 		auto post_create_func = [vp = &vertexProgramData.shader, fp = &fragmentProgramData.shader]
 		(gl::glsl::program* program)
 		{
@@ -103,7 +105,9 @@ struct GLTraits
 			program->uniforms[1] = GL_STREAM_BUFFER_START + 1;
 		};
 
-		auto pipeline = compiler->compile(flags, post_create_func, post_link_func, callback);
+		const std::string binary_key = gl::get_program_binary_key(vertexProgramData.shader, fragmentProgramData.shader);
+
+		auto pipeline = compiler->compile(flags, post_create_func, post_link_func, callback, binary_key);
 		return callback(pipeline);
 	}
 };
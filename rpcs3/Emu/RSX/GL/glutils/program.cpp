@@ -291,6 +291,51 @@ namespace gl
 			}
 		}
 
+		bool program::link_binary(GLenum format, const std::vector<u8>& binary, std::function<void(program*)> init_func)
+		{
+			glProgramBinary(m_id, format, binary.data(), ::size32(binary));
+
+			GLint status = GL_FALSE;
+			glGetProgramiv(m_id, GL_LINK_STATUS, &status);
+
+			if (status == GL_FALSE)
+			{
+				// Stale binary (e.g. after a driver update), the caller has to link from source
+				return false;
+			}
+
+			if (init_func)
+			{
+				init_func(this);
+			}
+
+			m_fence.create();
+			flush_command_queue(m_fence);
+			return true;
+		}
+
+		bool program::get_binary(GLenum& format, std::vector<u8>& binary) const
+		{
+			GLint status = GL_FALSE;
+			glGetProgramiv(m_id, GL_LINK_STATUS, &status);
+
+			GLint length = 0;
+			glGetProgramiv(m_id, GL_PROGRAM_BINARY_LENGTH, &length);
+
+			if (status == GL_FALSE || length <= 0)
+			{
+				return false;
+			}
+
+			binary.resize(length);
+
+			GLsizei written = 0;
+			glGetProgramBinary(m_id, length, &written, &format, binary.data());
+
+			binary.resize(written);
+			return written > 0;
+		}
+
 		void program::validate()
 		{
 			glValidateProgram(m_id);
@@ -159,6 +159,18 @@ namespace gl
 
 			void link(std::function<void(program*)> init_func = {});
 
+			// Link from a binary previously returned by get_binary. Returns false if the driver rejects it.
+			bool link_binary(GLenum format, const std::vector<u8>& binary, std::function<void(program*)> init_func = {});
+
+			// Retrieve the driver binary of a linked program. Requires set_binary_retrievable before linking.
+			bool get_binary(GLenum& format, std::vector<u8>& binary) const;
+
+			program& set_binary_retrievable()
+			{
+				glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+				return *this;
+			}
+
 			void validate();
 
 			void sync()
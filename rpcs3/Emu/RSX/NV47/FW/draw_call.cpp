@@ -184,6 +184,7 @@ namespace rsx
 			{
 				// Change vertex array offset
 				REGS(ctx)->decode(NV4097_SET_VERTEX_DATA_ARRAY_OFFSET + barrier.index, barrier.arg0);
+				RSX(ctx)->m_graphics_state |= rsx::pipeline_state::vertex_layout_dirty;
 				result |= vertex_arrays_changed;
 				break;
 			}
@@ -81,5 +81,10 @@ namespace rsx
 				RSX(ctx)->m_graphics_state |= rsx::pipeline_state::vertex_program_state_dirty;
 			}
 		}
+
+		void set_vertex_layout_dirty_bit(rsx::context* ctx)
+		{
+			RSX(ctx)->m_graphics_state |= rsx::pipeline_state::vertex_layout_dirty;
+		}
 	}
 }
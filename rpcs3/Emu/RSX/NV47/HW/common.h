@@ -20,6 +20,8 @@ namespace rsx
 		void set_fragment_texture_dirty_bit(rsx::context* ctx, u32 index);
 
 		void set_vertex_texture_dirty_bit(rsx::context* ctx, u32 index);
+
+		void set_vertex_layout_dirty_bit(rsx::context* ctx);
 	}
 }
  
@@ -10,6 +10,12 @@ NullGSRender::NullGSRender(utils::serial* ar) noexcept : GSRender(ar)
 {
 }
 
+void NullGSRender::flip(const rsx::display_flip_info_t& info)
+{
+	GSRender::flip(info);
+	rsx::thread::flip(info);
+}
+
 void NullGSRender::end()
 {
 	execute_nop_draw();
@@ -9,6 +9,8 @@ public:
 	NullGSRender(utils::serial* ar) noexcept;
 	NullGSRender() noexcept : NullGSRender(nullptr) {}
 
+	void flip(const rsx::display_flip_info_t& info) override;
+
 private:
 	void end() override;
 };
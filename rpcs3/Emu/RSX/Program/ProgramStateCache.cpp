@@ -338,7 +338,7 @@ vertex_program_utils::vertex_program_metadata vertex_program_utils::analyse_vert
 
 usz vertex_program_storage_hash::operator()(const RSXVertexProgram &program) const
 {
-	const usz ucode_hash = vertex_program_utils::get_vertex_program_ucode_hash(program);
+	const usz ucode_hash = program.ucode_hash ? program.ucode_hash : vertex_program_utils::get_vertex_program_ucode_hash(program);
 	const u32 state_params[] =
 	{
 		program.ctrl,
@@ -352,6 +352,8 @@ usz vertex_program_storage_hash::operator()(const RSXVertexProgram &program) con
 
 bool vertex_program_compare::operator()(const RSXVertexProgram &binary1, const RSXVertexProgram &binary2) const
 {
+	if (binary1.ucode_hash && binary2.ucode_hash && binary1.ucode_hash != binary2.ucode_hash)
+		return false;
 	if (binary1.output_mask != binary2.output_mask)
 		return false;
 	if (binary1.ctrl != binary2.ctrl)
@@ -533,7 +535,7 @@ usz fragment_program_utils::get_fragment_program_ucode_hash(const RSXFragmentPro
 
 usz fragment_program_storage_hash::operator()(const RSXFragmentProgram& program) const
 {
-	const usz ucode_hash = fragment_program_utils::get_fragment_program_ucode_hash(program);
+	const usz ucode_hash = program.ucode_hash ? program.ucode_hash : fragment_program_utils::get_fragment_program_ucode_hash(program);
 	const u32 state_params[] =
 	{
 		program.ctrl,
@@ -551,7 +553,8 @@ usz fragment_program_storage_hash::operator()(const RSXFragmentProgram& program)
 
 bool fragment_program_compare::operator()(const RSXFragmentProgram& binary1, const RSXFragmentProgram& binary2) const
 {
-	if (binary1.ucode_length != binary2.ucode_length ||
+	if ((binary1.ucode_hash && binary2.ucode_hash && binary1.ucode_hash != binary2.ucode_hash) ||
+		binary1.ucode_length != binary2.ucode_length ||
 		binary1.ctrl != binary2.ctrl ||
 		binary1.texture_state != binary2.texture_state ||
 		binary1.texcoord_control_mask != binary2.texcoord_control_mask ||
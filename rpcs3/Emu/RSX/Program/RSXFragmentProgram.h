@@ -300,6 +300,7 @@ struct RSXFragmentProgram
 	u32 ucode_length = 0;
 	u32 total_length = 0;
 	u32 ctrl = 0;
+	usz ucode_hash = 0; // Memoized ucode hash (0 if not computed yet)
 	u32 texcoord_control_mask = 0;
 	u32 mrt_buffers_count = 0;
 
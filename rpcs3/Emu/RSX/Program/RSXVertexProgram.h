@@ -227,6 +227,7 @@ struct RSXVertexProgram
 	u32 output_mask = 0;
 	u32 base_address = 0;
 	u32 entry = 0;
+	usz ucode_hash = 0; // Memoized ucode hash (0 if not computed yet)
 	std::bitset<rsx::max_vertex_program_instructions> instruction_mask;
 	std::set<u32> jump_table;
 
@@ -21,10 +21,53 @@
 
 #include "SPIRVCommon.h"
 #include "Emu/RSX/Program/GLSLTypes.h"
+#include "Crypto/sha1.h"
+#include "Utilities/File.h"
 
 namespace spirv
 {
 	static TBuiltInResource g_default_config;
+	static std::string g_binary_cache_path;
+
+	// Bump when the glslang version or the compiler options change
+	constexpr u32 binary_cache_version = 1;
+
+	static std::string get_binary_cache_name(const std::string& shader, ::glsl::program_domain domain, ::glsl::glsl_rules rules)
+	{
+		const u8 options[] = { static_cast<u8>(domain), static_cast<u8>(rules), static_cast<u8>(binary_cache_version) };
+
+		sha1_context ctx;
+		u8 digest[20];
+
+		sha1_starts(&ctx);
+		sha1_update(&ctx, options, sizeof(options));
+		sha1_update(&ctx, reinterpret_cast<const u8*>(shader.data()), shader.size());
+		sha1_finish(&ctx, digest);
+
+		std::string name = g_binary_cache_path;
+
+		for (const u8 byte : digest)
+		{
+			fmt::append(name, "%02x", byte);
+		}
+
+		return name + ".spv";
+	}
+
+	static bool load_cached_spv(std::vector<u32>& spv, const std::string& path)
+	{
+		const fs::file f(path);
+
+		if (!f || f.size() < sizeof(u32) || f.size() % sizeof(u32))
+		{
+			return false;
+		}
+
+		spv = f.to_vector<u32>();
+
+		// Reject truncated or foreign files
+		return !spv.empty() && spv[0] == 0x07230203u;
+	}
 
 	void init_default_resources(TBuiltInResource& rsc)
 	{
@@ -125,6 +168,20 @@ namespace spirv
 
 	bool compile_glsl_to_spv(std::vector<u32>& spv, std::string& shader, ::glsl::program_domain domain, ::glsl::glsl_rules rules)
 	{
+		std::string cache_name;
+
+		if (!g_binary_cache_path.empty())
+		{
+			cache_name = get_binary_cache_name(shader, domain, rules);
+
+			if (load_cached_spv(spv, cache_name))
+			{
+				return true;
+			}
+
+			spv.clear();
+		}
+
 		EShLanguage lang = (domain == ::glsl::glsl_fragment_program)
 			? EShLangFragment
 			: (domain == ::glsl::glsl_vertex_program)
@@ -184,17 +241,36 @@ namespace spirv
 			rsx_log.error("%s", shader_object.getInfoDebugLog());
 		}
 
+		if (success && !cache_name.empty())
+		{
+			fs::pending_file temp(cache_name);
+
+			if (!temp.file || temp.file.write(spv.data(), spv.size() * sizeof(u32)) < spv.size() * sizeof(u32) || !temp.commit())
+			{
+				rsx_log.warning("Failed to write SPIR-V cache entry '%s' (error=%s)", cache_name, fs::g_tls_error);
+			}
+		}
+
 		return success;
 	}
 
-	void initialize_compiler_context()
+	void initialize_compiler_context(const std::string& cache_path)
 	{
 		glslang::InitializeProcess();
 		init_default_resources(g_default_config);
+
+		g_binary_cache_path = cache_path;
+
+		if (!g_binary_cache_path.empty() && !fs::create_path(g_binary_cache_path))
+		{
+			rsx_log.error("Failed to create SPIR-V cache directory '%s' (error=%s)", g_binary_cache_path, fs::g_tls_error);
+			g_binary_cache_path.clear();
+		}
 	}
 
 	void finalize_compiler_context()
 	{
 		glslang::FinalizeProcess();
+		g_binary_cache_path.clear();
 	}
 }
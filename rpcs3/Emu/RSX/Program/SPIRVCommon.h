@@ -10,6 +10,7 @@ namespace spirv
 {
 	bool compile_glsl_to_spv(std::vector<u32>& spv, std::string& shader, ::glsl::program_domain domain, ::glsl::glsl_rules rules);
 
-	void initialize_compiler_context();
+	// Compiled binaries are stored in cache_path keyed by the GLSL source. An empty path disables the disk cache.
+	void initialize_compiler_context(const std::string& cache_path = {});
 	void finalize_compiler_context();
 }
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 
 #include "Emu/System.h"
+#include "Emu/event_trace.hpp"
 #include "RSXFIFO.h"
 #include "RSXThread.h"
 #include "Capture/rsx_capture.h"
@@ -750,7 +751,13 @@ namespace rsx
 			}
 
 			// Update performance counters with time spent in idle mode
-			performance_counters.idle_time += (get_system_time() - performance_counters.FIFO_idle_timestamp);
+			const u64 idle_time = get_system_time() - performance_counters.FIFO_idle_timestamp;
+			performance_counters.idle_time += idle_time;
+
+			if (g_cfg.core.event_trace) [[unlikely]]
+			{
+				event_trace::push_elapsed("FIFO idle", "rsx", idle_time, static_cast<u64>(state));
+			}
 		}
 
 		do
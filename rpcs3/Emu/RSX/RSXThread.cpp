@@ -15,6 +15,8 @@
 #include "RSXDisAsm.h"
 
 #include "Emu/System.h"
+#include "Emu/event_trace.hpp"
+#include "Emu/benchmark.hpp"
 #include "Emu/Cell/PPUThread.h"
 #include "Emu/Cell/timers.hpp"
 #include "Emu/Cell/lv2/sys_event.h"
@@ -1912,7 +1914,25 @@ namespace rsx
 		const auto prev_textures_reference_mask = current_fp_metadata.referenced_textures_mask;
 
 		auto data_ptr = vm::base(rsx::get_address(program_offset, program_location));
-		current_fp_metadata = program_hash_util::fragment_program_utils::analyse_fragment_program(data_ptr);
+
+		// Games rebind the same program many times, skip analysis and hashing if the ucode did not change since the last use
+		const u64 cache_key = (u64{program_location} << 32) | program_offset;
+		auto found = m_fragment_program_cache.find(cache_key);
+
+		if (found != m_fragment_program_cache.end() && std::memcmp(data_ptr, found->second.ucode.data(), found->second.ucode.size()) != 0)
+		{
+			m_fragment_program_cache.erase(found);
+			found = m_fragment_program_cache.end();
+		}
+
+		if (found != m_fragment_program_cache.end())
+		{
+			current_fp_metadata = found->second.metadata;
+		}
+		else
+		{
+			current_fp_metadata = program_hash_util::fragment_program_utils::analyse_fragment_program(data_ptr);
+		}
 
 		current_fragment_program.data = (static_cast<u8*>(data_ptr) + current_fp_metadata.program_start_offset);
 		current_fragment_program.offset = program_offset + current_fp_metadata.program_start_offset;
@@ -1921,6 +1941,29 @@ namespace rsx
 		current_fragment_program.texture_state.import(current_fp_texture_state, current_fp_metadata.referenced_textures_mask);
 		current_fragment_program.valid = true;
 
+		if (found != m_fragment_program_cache.end())
+		{
+			current_fragment_program.ucode_hash = found->second.ucode_hash;
+		}
+		else
+		{
+			current_fragment_program.ucode_hash = program_hash_util::fragment_program_utils::get_fragment_program_ucode_hash(current_fragment_program);
+
+			if (m_fragment_program_cache.size() >= 1024)
+			{
+				// Programs generated at runtime may use many different addresses
+				m_fragment_program_cache.clear();
+			}
+
+			const u8* ucode = static_cast<const u8*>(data_ptr);
+			m_fragment_program_cache.emplace(cache_key, fragment_program_cache_entry
+			{
+				current_fp_metadata,
+				current_fragment_program.ucode_hash,
+				std::vector<u8>(ucode, ucode + current_fragment_program.total_length)
+			});
+		}
+
 		if (!m_graphics_state.test(rsx::pipeline_state::fragment_program_state_dirty))
 		{
 			// Verify current texture state is valid
@@ -1968,6 +2011,8 @@ namespace rsx
 			current_vertex_program                      // [out] Program object
 		);
 
+		current_vertex_program.ucode_hash = program_hash_util::vertex_program_utils::get_vertex_program_ucode_hash(current_vertex_program);
+
 		current_vertex_program.texture_state.import(current_vp_texture_state, current_vp_metadata.referenced_textures_mask);
 
 		if (!m_graphics_state.test(rsx::pipeline_state::vertex_program_state_dirty))
@@ -2357,6 +2402,8 @@ namespace rsx
 
 	void thread::flip(const display_flip_info_t& info)
 	{
+		trace_scope trace0("flip", "rsx", info.buffer);
+
 		m_eng_interrupt_mask.clear(rsx::display_interrupt);
 
 		if (async_flip_requested & flip_request::any)
@@ -2375,6 +2422,7 @@ namespace rsx
 		if (info.emu_flip)
 		{
 			performance_counters.sampled_frames++;
+			benchmark_stats::on_flip();
 
 			if (m_pause_after_x_flips && m_pause_after_x_flips-- == 1)
 			{
@@ -260,6 +260,16 @@ namespace rsx
 		vertex_program_texture_state current_vp_texture_state = {};
 		fragment_program_texture_state current_fp_texture_state = {};
 
+		struct fragment_program_cache_entry
+		{
+			program_hash_util::fragment_program_utils::fragment_program_metadata metadata;
+			usz ucode_hash;
+			std::vector<u8> ucode; // Copy of the program block, a mismatch means the program was written to
+		};
+
+		// Analysed fragment programs, keyed by shader program address and location
+		std::unordered_map<u64, fragment_program_cache_entry> m_fragment_program_cache;
+
 		// Runs shader prefetch and resolves pipeline status flags
 		void analyse_current_rsx_pipeline();
 
@@ -903,6 +903,12 @@ void VKGSRender::emit_geometry(u32 sub_index)
 		reload_state = true;
 	});
 
+	// Pick up the optimized pipeline as soon as it is ready, it can be bound inside the current render pass
+	if (m_program->update_pipeline() && !reload_state)
+	{
+		vkCmdBindPipeline(*m_current_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_program->pipeline);
+	}
+
 	if (reload_state)
 	{
 		vkCmdBindPipeline(*m_current_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_program->pipeline);
@@ -571,7 +571,17 @@ VKGSRender::VKGSRender(utils::serial* ar) noexcept : GSRender(ar)
 	null_buffer = std::make_unique<vk::buffer>(*m_device, 32, memory_map.device_local, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT, 0, VMM_ALLOCATION_POOL_UNDEFINED);
 	null_buffer_view = std::make_unique<vk::buffer_view>(*m_device, null_buffer->value, VK_FORMAT_R8_UINT, 0, 32);
 
-	spirv::initialize_compiler_context();
+	std::string spirv_cache_path;
+
+	if (!g_cfg.video.disable_on_disk_shader_cache)
+	{
+		if (std::string cache_path = rpcs3::cache::get_ppu_cache(); !cache_path.empty())
+		{
+			spirv_cache_path = std::move(cache_path) + "shaders_cache/spirv/";
+		}
+	}
+
+	spirv::initialize_compiler_context(spirv_cache_path);
 	vk::initialize_pipe_compiler(g_cfg.video.shader_compiler_threads_count);
 
 	m_prog_buffer = std::make_unique<vk::program_cache>
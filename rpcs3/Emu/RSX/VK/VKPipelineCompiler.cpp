@@ -2,6 +2,10 @@
 #include "VKPipelineCompiler.h"
 #include "VKRenderPass.h"
 #include "vkutils/device.h"
+#include "Emu/cache_utils.hpp"
+#include "Emu/Cell/timers.hpp"
+#include "Emu/system_config.h"
+#include "Utilities/File.h"
 #include "Utilities/Thread.h"
 
 #include "util/sysinfo.hpp"
@@ -13,6 +17,362 @@ namespace vk
 	int g_num_pipe_compilers = 0;
 	atomic_t<int> g_compiler_index{};
 
+	// Driver pipeline cache shared by all workers, persisted per title and device
+	VkPipelineCache g_pipeline_cache = VK_NULL_HANDLE;
+	std::string g_pipeline_cache_path;
+	shared_mutex g_pipeline_cache_mutex;
+	atomic_t<u32> g_pipelines_since_save{};
+	usz g_pipeline_cache_saved_size = 0;
+
+	// Number of pipeline creations between incremental saves
+	constexpr u32 pipeline_cache_save_interval = 256;
+
+	// Graphics pipeline libraries, keyed by the state of the stage they were compiled for
+	struct pipeline_library_entry
+	{
+		std::shared_ptr<pipeline_library> library;
+		atomic_t<u64> last_use{};
+	};
+
+	bool g_use_pipeline_libraries = false;
+	std::unordered_map<std::string, pipeline_library_entry> g_pipeline_libraries;
+	shared_mutex g_pipeline_library_mutex;
+	atomic_t<u64> g_pipeline_library_clock{};
+
+	// Beyond this number of libraries, the least recently used quarter is evicted
+	constexpr usz max_pipeline_libraries = 8192;
+
+	pipe_compiler_stats g_pipe_compiler_stats;
+
+	// Fixed function state of a graphics pipeline, with pointers rebased to this object
+	struct graphics_pipe_state
+	{
+		VkPipelineShaderStageCreateInfo shader_stages[2] = {};
+		std::vector<VkDynamicState> dynamic_state_descriptors;
+		VkPipelineDynamicStateCreateInfo dynamic_state_info = {};
+		VkPipelineVertexInputStateCreateInfo vi = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+		VkPipelineViewportStateCreateInfo vp = {};
+		VkPipelineDepthStencilStateCreateInfo ds;
+		VkPipelineMultisampleStateCreateInfo ms;
+		VkPipelineColorBlendStateCreateInfo cs;
+		VkRenderPass render_pass;
+
+		graphics_pipe_state(const vk::render_device& dev, const vk::pipeline_props& create_info, VkShaderModule modules[2]);
+		graphics_pipe_state(const graphics_pipe_state&) = delete;
+		graphics_pipe_state& operator=(const graphics_pipe_state&) = delete;
+	};
+
+	graphics_pipe_state::graphics_pipe_state(const vk::render_device& dev, const vk::pipeline_props& create_info, VkShaderModule modules[2])
+	{
+		shader_stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shader_stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+		shader_stages[0].module = modules[0];
+		shader_stages[0].pName = "main";
+
+		shader_stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shader_stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		shader_stages[1].module = modules[1];
+		shader_stages[1].pName = "main";
+
+		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_VIEWPORT);
+		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_SCISSOR);
+		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_LINE_WIDTH);
+		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_BLEND_CONSTANTS);
+		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK);
+		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK);
+		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_STENCIL_REFERENCE);
+		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_DEPTH_BIAS);
+
+		ds = create_info.state.ds;
+		if (dev.get_depth_bounds_support()) [[likely]]
+		{
+			dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_DEPTH_BOUNDS);
+		}
+		else if (ds.depthBoundsTestEnable)
+		{
+			rsx_log.warning("Depth bounds test is enabled in the pipeline object but not supported by the current driver.");
+			ds.depthBoundsTestEnable = VK_FALSE;
+		}
+
+		dynamic_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamic_state_info.pDynamicStates = dynamic_state_descriptors.data();
+		dynamic_state_info.dynamicStateCount = ::size32(dynamic_state_descriptors);
+
+		vp.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		vp.viewportCount = 1;
+		vp.scissorCount = 1;
+
+		ms = create_info.state.ms;
+		ensure(ms.rasterizationSamples == VkSampleCountFlagBits((create_info.renderpass_key >> 16) & 0xF)); // "Multisample state mismatch!"
+
+		if (ms.rasterizationSamples != VK_SAMPLE_COUNT_1_BIT)
+		{
+			// Update the sample mask pointer
+			ms.pSampleMask = &create_info.state.temp_storage.msaa_sample_mask;
+		}
+
+		if (g_cfg.video.antialiasing_level == msaa_level::none && ms.sampleShadingEnable) [[unlikely]]
+		{
+			// Do not compile with MSAA enabled if multisampling is disabled
+			rsx_log.warning("MSAA is disabled globally but a shader with multi-sampling enabled was submitted for compilation.");
+			ms.sampleShadingEnable = VK_FALSE;
+		}
+
+		// Rebase pointers from pipeline structure in case it is moved/copied
+		cs = create_info.state.cs;
+		cs.pAttachments = create_info.state.att_state;
+
+		render_pass = vk::get_renderpass(dev, create_info.renderpass_key);
+	}
+
+	template <typename... T>
+	static void append_library_key(std::string& key, const T&... data)
+	{
+		(key.append(reinterpret_cast<const char*>(&data), sizeof(T)), ...);
+	}
+
+	// One key per library type, in the order of pipe_compiler::pipeline_libraries_t.
+	// Only the fields used by each stage are added (no sType, pNext or padding), state which is dynamic is left out.
+	static std::array<std::string, 4> get_pipeline_library_keys(const vk::pipeline_props& create_info, u64 module_hashes[2])
+	{
+		const auto& state = create_info.state;
+		std::array<std::string, 4> keys = { "I", "P", "F", "O" };
+
+		// Multisample state is shared by the fragment shader and output libraries
+		std::string ms_key;
+		append_library_key(ms_key, state.ms.rasterizationSamples);
+
+		if (state.ms.rasterizationSamples != VK_SAMPLE_COUNT_1_BIT)
+		{
+			append_library_key(ms_key, state.ms.sampleShadingEnable, state.ms.minSampleShading, state.ms.alphaToCoverageEnable, state.ms.alphaToOneEnable);
+			append_library_key(ms_key, state.temp_storage.msaa_sample_mask);
+		}
+
+		// Vertex input interface. Attributes are fetched by the shaders, only the input assembly state matters.
+		append_library_key(keys[0], state.ia.topology, state.ia.primitiveRestartEnable);
+
+		// Pre-rasterization shaders (depth bias values and line width are dynamic)
+		append_library_key(keys[1], module_hashes[0]);
+		append_library_key(keys[1], state.rs.depthClampEnable, state.rs.rasterizerDiscardEnable, state.rs.polygonMode, state.rs.cullMode, state.rs.frontFace, state.rs.depthBiasEnable);
+		append_library_key(keys[1], create_info.renderpass_key);
+
+		// Fragment shader (depth bounds and stencil masks and references are dynamic)
+		append_library_key(keys[2], module_hashes[1]);
+		append_library_key(keys[2], state.ds.depthTestEnable, state.ds.depthWriteEnable, state.ds.depthCompareOp, state.ds.depthBoundsTestEnable, state.ds.stencilTestEnable);
+
+		for (const VkStencilOpState& op : { state.ds.front, state.ds.back })
+		{
+			append_library_key(keys[2], op.failOp, op.passOp, op.depthFailOp, op.compareOp);
+		}
+
+		append_library_key(keys[2], create_info.renderpass_key);
+		keys[2] += ms_key;
+
+		// Fragment output interface (blend constants are dynamic)
+		append_library_key(keys[3], state.cs.attachmentCount, state.cs.logicOpEnable, state.cs.logicOp);
+
+		for (u32 i = 0; i < state.cs.attachmentCount; i++)
+		{
+			const VkPipelineColorBlendAttachmentState& att = state.att_state[i];
+			append_library_key(keys[3], att.blendEnable, att.srcColorBlendFactor, att.dstColorBlendFactor, att.colorBlendOp, att.srcAlphaBlendFactor, att.dstAlphaBlendFactor, att.alphaBlendOp, att.colorWriteMask);
+		}
+
+		append_library_key(keys[3], create_info.renderpass_key);
+		keys[3] += ms_key;
+
+		return keys;
+	}
+
+	static std::shared_ptr<pipeline_library> find_pipeline_library(const std::string& key)
+	{
+		reader_lock lock(g_pipeline_library_mutex);
+
+		const auto found = g_pipeline_libraries.find(key);
+		if (found == g_pipeline_libraries.end())
+		{
+			return {};
+		}
+
+		found->second.last_use = g_pipeline_library_clock++;
+		return found->second.library;
+	}
+
+	// Must be called with g_pipeline_library_mutex locked exclusively
+	static void evict_pipeline_libraries()
+	{
+		if (g_pipeline_libraries.size() <= max_pipeline_libraries)
+		{
+			return;
+		}
+
+		std::vector<u64> uses;
+		uses.reserve(g_pipeline_libraries.size());
+
+		for (const auto& [key, entry] : g_pipeline_libraries)
+		{
+			uses.push_back(entry.last_use);
+		}
+
+		const auto threshold = uses.begin() + uses.size() / 4;
+		std::nth_element(uses.begin(), threshold, uses.end());
+
+		// Libraries still used by a pending link are destroyed once it is done
+		const usz evicted = std::erase_if(g_pipeline_libraries, [last_use = *threshold](const auto& item)
+		{
+			return item.second.last_use <= last_use;
+		});
+
+		rsx_log.notice("Evicted %u graphics pipeline libraries", evicted);
+	}
+
+	static void destroy_pipeline_libraries()
+	{
+		std::lock_guard lock(g_pipeline_library_mutex);
+		g_pipeline_libraries.clear();
+	}
+
+	pipeline_library::~pipeline_library()
+	{
+		vkDestroyPipeline(device, handle, nullptr);
+	}
+
+	static bool is_valid_pipeline_cache_header(const std::vector<u8>& data, const VkPhysicalDeviceProperties& props)
+	{
+		// Header layout is defined by the spec for VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		struct header_t
+		{
+			u32 header_size;
+			u32 header_version;
+			u32 vendor_id;
+			u32 device_id;
+			u8 cache_uuid[VK_UUID_SIZE];
+		};
+
+		header_t header{};
+
+		if (data.size() < sizeof(header_t))
+		{
+			return false;
+		}
+
+		std::memcpy(&header, data.data(), sizeof(header_t));
+
+		return header.header_size >= sizeof(header_t) &&
+			header.header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+			header.vendor_id == props.vendorID &&
+			header.device_id == props.deviceID &&
+			std::memcmp(header.cache_uuid, props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+
+	static void create_pipeline_cache(const vk::render_device& dev)
+	{
+		const VkPhysicalDeviceProperties& props = dev.gpu().get_properties();
+		std::vector<u8> initial_data;
+
+		g_pipeline_cache_path.clear();
+		g_pipeline_cache_saved_size = 0;
+
+		if (!g_cfg.video.disable_on_disk_shader_cache)
+		{
+			if (const std::string cache_path = rpcs3::cache::get_ppu_cache(); !cache_path.empty())
+			{
+				const std::string dir = cache_path + "shaders_cache/pipelines/vulkan/driver/";
+				g_pipeline_cache_path = dir + fmt::format("%04x_%04x.bin", props.vendorID, props.deviceID);
+
+				if (fs::file f{g_pipeline_cache_path})
+				{
+					initial_data = f.to_vector<u8>();
+
+					if (!is_valid_pipeline_cache_header(initial_data, props))
+					{
+						// The driver or device changed, start over
+						rsx_log.notice("Discarding outdated pipeline cache '%s'", g_pipeline_cache_path);
+						initial_data.clear();
+					}
+				}
+				else
+				{
+					fs::create_path(dir);
+				}
+			}
+		}
+
+		VkPipelineCacheCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		info.initialDataSize = initial_data.size();
+		info.pInitialData = initial_data.empty() ? nullptr : initial_data.data();
+
+		if (vkCreatePipelineCache(dev, &info, nullptr, &g_pipeline_cache) != VK_SUCCESS && !initial_data.empty())
+		{
+			rsx_log.warning("Failed to create pipeline cache from '%s', starting with an empty cache", g_pipeline_cache_path);
+			info.initialDataSize = 0;
+			info.pInitialData = nullptr;
+			CHECK_RESULT(vkCreatePipelineCache(dev, &info, nullptr, &g_pipeline_cache));
+		}
+
+		g_pipeline_cache_saved_size = initial_data.size();
+		g_pipelines_since_save = 0;
+
+		if (!initial_data.empty())
+		{
+			rsx_log.notice("Loaded pipeline cache '%s' (%u bytes)", g_pipeline_cache_path, initial_data.size());
+		}
+	}
+
+	static void save_pipeline_cache(const vk::render_device& dev, bool wait)
+	{
+		if (g_pipeline_cache == VK_NULL_HANDLE || g_pipeline_cache_path.empty())
+		{
+			return;
+		}
+
+		std::unique_lock lock(g_pipeline_cache_mutex, std::defer_lock);
+
+		if (wait)
+		{
+			lock.lock();
+		}
+		else if (!lock.try_lock())
+		{
+			// Another worker is already saving
+			return;
+		}
+
+		usz size = 0;
+
+		if (vkGetPipelineCacheData(dev, g_pipeline_cache, &size, nullptr) != VK_SUCCESS || size == g_pipeline_cache_saved_size)
+		{
+			return;
+		}
+
+		std::vector<u8> data(size);
+
+		if (vkGetPipelineCacheData(dev, g_pipeline_cache, &size, data.data()) != VK_SUCCESS)
+		{
+			return;
+		}
+
+		data.resize(size);
+
+		fs::pending_file temp(g_pipeline_cache_path);
+
+		if (temp.file && temp.file.write(data.data(), data.size()) >= data.size() && temp.commit())
+		{
+			g_pipeline_cache_saved_size = size;
+			return;
+		}
+
+		rsx_log.error("Failed to save pipeline cache '%s' (error=%s)", g_pipeline_cache_path, fs::g_tls_error);
+	}
+
+	static void on_pipeline_created(const vk::render_device& dev)
+	{
+		if (++g_pipelines_since_save % pipeline_cache_save_interval == 0)
+		{
+			save_pipeline_cache(dev, false);
+		}
+	}
+
 	pipe_compiler::pipe_compiler()
 	{
 		// TODO: Initialize workqueue
@@ -34,15 +394,35 @@ namespace vk
 		{
 			for (auto&& job : m_work_queue.pop_all())
 			{
-				if (job.is_graphics_job)
+				switch (job.type)
+				{
+				case pipe_compiler_job::graphics_job:
 				{
-					auto compiled = int_compile_graphics_pipe(job.graphics_data, job.graphics_modules, job.pipe_layout, job.inputs, {});
+					auto compiled = int_compile_graphics_pipe(job.graphics_data, job.graphics_modules, job.graphics_module_hashes, job.pipe_layout, job.inputs, {});
 					job.callback_func(compiled);
+					break;
 				}
-				else
+				case pipe_compiler_job::compute_job:
 				{
 					auto compiled = int_compile_compute_pipe(job.compute_data, job.pipe_layout);
 					job.callback_func(compiled);
+					break;
+				}
+				case pipe_compiler_job::optimize_link_job:
+				{
+					if (job.link_target.use_count() == 1)
+					{
+						// The program was destroyed before we got to it
+						break;
+					}
+
+					const u64 start = get_system_time();
+					job.link_target->pipeline = link_pipeline_libraries(job.libraries, job.pipe_layout, true);
+
+					g_pipe_compiler_stats.optimized_link_count++;
+					g_pipe_compiler_stats.optimized_link_time_us += get_system_time() - start;
+					break;
+				}
 				}
 			}
 
@@ -53,7 +433,8 @@ namespace vk
 	std::unique_ptr<glsl::program> pipe_compiler::int_compile_compute_pipe(const VkComputePipelineCreateInfo& create_info, VkPipelineLayout pipe_layout)
 	{
 		VkPipeline pipeline;
-		vkCreateComputePipelines(*g_render_device, nullptr, 1, &create_info, nullptr, &pipeline);
+		vkCreateComputePipelines(*g_render_device, g_pipeline_cache, 1, &create_info, nullptr, &pipeline);
+		on_pipeline_created(*m_device);
 		return std::make_unique<vk::glsl::program>(*m_device, pipeline, pipe_layout);
 	}
 
@@ -61,108 +442,202 @@ namespace vk
 			const std::vector<glsl::program_input>& vs_inputs, const std::vector<glsl::program_input>& fs_inputs)
 	{
 		VkPipeline pipeline;
-		CHECK_RESULT(vkCreateGraphicsPipelines(*m_device, VK_NULL_HANDLE, 1, &create_info, nullptr, &pipeline));
+		CHECK_RESULT(vkCreateGraphicsPipelines(*m_device, g_pipeline_cache, 1, &create_info, nullptr, &pipeline));
+		on_pipeline_created(*m_device);
 		auto result = std::make_unique<vk::glsl::program>(*m_device, pipeline, pipe_layout, vs_inputs, fs_inputs);
 		result->link();
 		return result;
 	}
 
-	std::unique_ptr<glsl::program> pipe_compiler::int_compile_graphics_pipe(const vk::pipeline_props &create_info, VkShaderModule modules[2], VkPipelineLayout pipe_layout,
+	std::unique_ptr<glsl::program> pipe_compiler::int_compile_graphics_pipe(const vk::pipeline_props &create_info, VkShaderModule modules[2], u64 module_hashes[2], VkPipelineLayout pipe_layout,
 			const std::vector<glsl::program_input>& vs_inputs, const std::vector<glsl::program_input>& fs_inputs)
 	{
-		VkPipelineShaderStageCreateInfo shader_stages[2] = {};
-		shader_stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		shader_stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-		shader_stages[0].module = modules[0];
-		shader_stages[0].pName = "main";
-
-		shader_stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		shader_stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		shader_stages[1].module = modules[1];
-		shader_stages[1].pName = "main";
+		const u64 start = get_system_time();
+		std::unique_ptr<glsl::program> result;
 
-		std::vector<VkDynamicState> dynamic_state_descriptors;
-		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_VIEWPORT);
-		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_SCISSOR);
-		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_LINE_WIDTH);
-		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_BLEND_CONSTANTS);
-		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK);
-		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK);
-		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_STENCIL_REFERENCE);
-		dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_DEPTH_BIAS);
-
-		auto pdss = &create_info.state.ds;
-		VkPipelineDepthStencilStateCreateInfo ds2;
-		if (g_render_device->get_depth_bounds_support()) [[likely]]
+		if (g_use_pipeline_libraries)
 		{
-			dynamic_state_descriptors.push_back(VK_DYNAMIC_STATE_DEPTH_BOUNDS);
+			// Compile the missing stages once, later combinations reusing them can be fast linked
+			pipeline_libraries_t libraries;
+			create_pipeline_libraries(create_info, modules, module_hashes, pipe_layout, libraries);
+
+			result = std::make_unique<vk::glsl::program>(*m_device, link_pipeline_libraries(libraries, pipe_layout, true), pipe_layout, vs_inputs, fs_inputs);
+			result->link();
 		}
-		else if (pdss->depthBoundsTestEnable)
+		else
 		{
-			rsx_log.warning("Depth bounds test is enabled in the pipeline object but not supported by the current driver.");
-
-			ds2 = *pdss;
-			pdss = &ds2;
-			ds2.depthBoundsTestEnable = VK_FALSE;
+			const graphics_pipe_state state(*m_device, create_info, modules);
+
+			VkGraphicsPipelineCreateInfo info = {};
+			info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			info.pVertexInputState = &state.vi;
+			info.pInputAssemblyState = &create_info.state.ia;
+			info.pRasterizationState = &create_info.state.rs;
+			info.pColorBlendState = &state.cs;
+			info.pMultisampleState = &state.ms;
+			info.pViewportState = &state.vp;
+			info.pDepthStencilState = &state.ds;
+			info.stageCount = 2;
+			info.pStages = state.shader_stages;
+			info.pDynamicState = &state.dynamic_state_info;
+			info.layout = pipe_layout;
+			info.basePipelineIndex = -1;
+			info.basePipelineHandle = VK_NULL_HANDLE;
+			info.renderPass = state.render_pass;
+
+			result = int_compile_graphics_pipe(info, pipe_layout, vs_inputs, fs_inputs);
 		}
 
-		VkPipelineDynamicStateCreateInfo dynamic_state_info = {};
-		dynamic_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		dynamic_state_info.pDynamicStates = dynamic_state_descriptors.data();
-		dynamic_state_info.dynamicStateCount = ::size32(dynamic_state_descriptors);
+		g_pipe_compiler_stats.full_compile_count++;
+		g_pipe_compiler_stats.full_compile_time_us += get_system_time() - start;
+		return result;
+	}
 
-		VkPipelineVertexInputStateCreateInfo vi = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+	bool pipe_compiler::find_pipeline_libraries(const vk::pipeline_props& create_info, u64 module_hashes[2], pipeline_libraries_t& libraries) const
+	{
+		const auto keys = get_pipeline_library_keys(create_info, module_hashes);
 
-		VkPipelineViewportStateCreateInfo vp = {};
-		vp.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		vp.viewportCount = 1;
-		vp.scissorCount = 1;
+		for (usz i = 0; i < keys.size(); ++i)
+		{
+			if (libraries[i] = find_pipeline_library(keys[i]); !libraries[i])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
 
-		auto pmss = &create_info.state.ms;
-		VkPipelineMultisampleStateCreateInfo ms2;
-		ensure(pmss->rasterizationSamples == VkSampleCountFlagBits((create_info.renderpass_key >> 16) & 0xF)); // "Multisample state mismatch!"
+	void pipe_compiler::create_pipeline_libraries(const vk::pipeline_props& create_info, VkShaderModule modules[2], u64 module_hashes[2], VkPipelineLayout pipe_layout, pipeline_libraries_t& libraries)
+	{
+		constexpr VkGraphicsPipelineLibraryFlagsEXT library_types[] =
+		{
+			VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+			VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+			VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+			VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT
+		};
+
+		const auto keys = get_pipeline_library_keys(create_info, module_hashes);
+		const graphics_pipe_state state(*m_device, create_info, modules);
 
-		if (pmss->rasterizationSamples != VK_SAMPLE_COUNT_1_BIT || pmss->sampleShadingEnable) [[unlikely]]
+		for (usz i = 0; i < keys.size(); ++i)
 		{
-			ms2 = *pmss;
-			pmss = &ms2;
+			if (libraries[i] = find_pipeline_library(keys[i]); libraries[i])
+			{
+				continue;
+			}
 
-			if (ms2.rasterizationSamples != VK_SAMPLE_COUNT_1_BIT)
+			VkGraphicsPipelineLibraryCreateInfoEXT library_info = {};
+			library_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+			library_info.flags = library_types[i];
+
+			VkGraphicsPipelineCreateInfo info = {};
+			info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			info.pNext = &library_info;
+			info.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+			info.pDynamicState = &state.dynamic_state_info;
+			info.basePipelineIndex = -1;
+			info.basePipelineHandle = VK_NULL_HANDLE;
+
+			switch (library_types[i])
 			{
-				// Update the sample mask pointer
-				ms2.pSampleMask = &create_info.state.temp_storage.msaa_sample_mask;
+			case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+				info.pVertexInputState = &state.vi;
+				info.pInputAssemblyState = &create_info.state.ia;
+				break;
+			case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+				info.stageCount = 1;
+				info.pStages = &state.shader_stages[0];
+				info.pViewportState = &state.vp;
+				info.pRasterizationState = &create_info.state.rs;
+				info.layout = pipe_layout;
+				info.renderPass = state.render_pass;
+				break;
+			case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+				info.stageCount = 1;
+				info.pStages = &state.shader_stages[1];
+				info.pDepthStencilState = &state.ds;
+				info.pMultisampleState = &state.ms;
+				info.layout = pipe_layout;
+				info.renderPass = state.render_pass;
+				break;
+			default:
+				info.pColorBlendState = &state.cs;
+				info.pMultisampleState = &state.ms;
+				info.renderPass = state.render_pass;
+				break;
 			}
 
-			if (g_cfg.video.antialiasing_level == msaa_level::none && ms2.sampleShadingEnable)
+			VkPipeline library;
+			CHECK_RESULT(vkCreateGraphicsPipelines(*m_device, g_pipeline_cache, 1, &info, nullptr, &library));
+			on_pipeline_created(*m_device);
+
+			libraries[i] = std::make_shared<pipeline_library>(*m_device, library);
+
+			std::lock_guard lock(g_pipeline_library_mutex);
+
+			if (const auto [found, inserted] = g_pipeline_libraries.try_emplace(keys[i]); !inserted)
+			{
+				// Another thread created the same library in the mean time, ours is destroyed with the shared pointer
+				libraries[i] = found->second.library;
+				found->second.last_use = g_pipeline_library_clock++;
+			}
+			else
 			{
-				// Do not compile with MSAA enabled if multisampling is disabled
-				rsx_log.warning("MSAA is disabled globally but a shader with multi-sampling enabled was submitted for compilation.");
-				ms2.sampleShadingEnable = VK_FALSE;
+				found->second.library = libraries[i];
+				found->second.last_use = g_pipeline_library_clock++;
+				evict_pipeline_libraries();
 			}
 		}
+	}
 
-		// Rebase pointers from pipeline structure in case it is moved/copied
-		VkPipelineColorBlendStateCreateInfo cs = create_info.state.cs;
-		cs.pAttachments = create_info.state.att_state;
+	VkPipeline pipe_compiler::link_pipeline_libraries(const pipeline_libraries_t& libraries, VkPipelineLayout pipe_layout, bool optimize)
+	{
+		std::array<VkPipeline, std::tuple_size_v<pipeline_libraries_t>> handles;
+		std::transform(libraries.begin(), libraries.end(), handles.begin(), [](const auto& library) { return library->handle; });
+
+		VkPipelineLibraryCreateInfoKHR library_info = {};
+		library_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+		library_info.libraryCount = ::size32(handles);
+		library_info.pLibraries = handles.data();
 
 		VkGraphicsPipelineCreateInfo info = {};
 		info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		info.pVertexInputState = &vi;
-		info.pInputAssemblyState = &create_info.state.ia;
-		info.pRasterizationState = &create_info.state.rs;
-		info.pColorBlendState = &cs;
-		info.pMultisampleState = pmss;
-		info.pViewportState = &vp;
-		info.pDepthStencilState = pdss;
-		info.stageCount = 2;
-		info.pStages = shader_stages;
-		info.pDynamicState = &dynamic_state_info;
+		info.pNext = &library_info;
+		info.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
 		info.layout = pipe_layout;
 		info.basePipelineIndex = -1;
 		info.basePipelineHandle = VK_NULL_HANDLE;
-		info.renderPass = vk::get_renderpass(*m_device, create_info.renderpass_key);
 
-		return int_compile_graphics_pipe(info, pipe_layout, vs_inputs, fs_inputs);
+		// Fast linked pipelines are short-lived, keep them out of the driver cache
+		VkPipeline pipeline;
+		CHECK_RESULT(vkCreateGraphicsPipelines(*m_device, optimize ? g_pipeline_cache : VK_NULL_HANDLE, 1, &info, nullptr, &pipeline));
+
+		if (optimize)
+		{
+			on_pipeline_created(*m_device);
+		}
+
+		return pipeline;
+	}
+
+	std::unique_ptr<glsl::program> pipe_compiler::int_fast_link_graphics_pipe(const pipeline_libraries_t& libraries, VkPipelineLayout pipe_layout,
+			const std::vector<glsl::program_input>& vs_inputs, const std::vector<glsl::program_input>& fs_inputs)
+	{
+		const u64 start = get_system_time();
+
+		auto result = std::make_unique<vk::glsl::program>(*m_device, link_pipeline_libraries(libraries, pipe_layout, false), pipe_layout, vs_inputs, fs_inputs);
+		result->link();
+
+		// Swap in the optimized pipeline once a worker is done with it
+		auto optimized = std::make_shared<glsl::deferred_pipeline>(*m_device);
+		result->set_deferred_pipeline(optimized);
+		get_pipe_compiler()->m_work_queue.push(libraries, pipe_layout, std::move(optimized));
+
+		g_pipe_compiler_stats.fast_link_count++;
+		g_pipe_compiler_stats.fast_link_time_us += get_system_time() - start;
+		return result;
 	}
 
 	std::unique_ptr<glsl::program> pipe_compiler::compile(
@@ -193,16 +668,26 @@ namespace vk
 	std::unique_ptr<glsl::program> pipe_compiler::compile(
 		const vk::pipeline_props& create_info,
 		VkShaderModule module_handles[2],
+		u64 module_hashes[2],
 		VkPipelineLayout pipe_layout,
 		op_flags flags, callback_t callback,
 		const std::vector<glsl::program_input>& vs_inputs, const std::vector<glsl::program_input>& fs_inputs)
 	{
+		if (g_use_pipeline_libraries)
+		{
+			// If every stage was seen before, linking is cheap enough to skip the asynchronous path and the interpreter fallback
+			if (pipeline_libraries_t libraries; find_pipeline_libraries(create_info, module_hashes, libraries))
+			{
+				return int_fast_link_graphics_pipe(libraries, pipe_layout, vs_inputs, fs_inputs);
+			}
+		}
+
 		if (flags == COMPILE_INLINE)
 		{
-			return int_compile_graphics_pipe(create_info, module_handles, pipe_layout, vs_inputs, fs_inputs);
+			return int_compile_graphics_pipe(create_info, module_handles, module_hashes, pipe_layout, vs_inputs, fs_inputs);
 		}
 
-		m_work_queue.push(create_info, pipe_layout, module_handles, vs_inputs, fs_inputs, callback);
+		m_work_queue.push(create_info, pipe_layout, module_handles, module_hashes, vs_inputs, fs_inputs, callback);
 		return {};
 	}
 
@@ -233,6 +718,16 @@ namespace vk
 		ensure(num_worker_threads >= 1);
 		ensure(g_render_device); // "Cannot initialize pipe compiler before creating a logical device"
 
+		create_pipeline_cache(*g_render_device);
+
+		g_use_pipeline_libraries = g_render_device->get_graphics_pipeline_library_support();
+		g_pipe_compiler_stats.reset();
+
+		if (g_use_pipeline_libraries)
+		{
+			rsx_log.notice("Using graphics pipeline libraries");
+		}
+
 		// Create the thread pool
 		g_pipe_compilers = std::make_unique<named_thread_group<pipe_compiler>>("RSX.W", num_worker_threads);
 		g_num_pipe_compilers = num_worker_threads;
@@ -247,6 +742,21 @@ namespace vk
 	void destroy_pipe_compiler()
 	{
 		g_pipe_compilers.reset();
+
+		const auto& stats = g_pipe_compiler_stats;
+		rsx_log.notice("Pipeline compiler statistics: %u fast links (avg %uus), %u full compiles (avg %uus), %u optimized links (avg %uus)",
+			stats.fast_link_count.load(), stats.average_fast_link_time(),
+			stats.full_compile_count.load(), stats.average_full_compile_time(),
+			stats.optimized_link_count.load(), stats.optimized_link_time_us.load() / std::max<u64>(stats.optimized_link_count.load(), 1));
+
+		destroy_pipeline_libraries();
+
+		if (g_pipeline_cache != VK_NULL_HANDLE)
+		{
+			save_pipeline_cache(*g_render_device, true);
+			vkDestroyPipelineCache(*g_render_device, g_pipeline_cache, nullptr);
+			g_pipeline_cache = VK_NULL_HANDLE;
+		}
 	}
 
 	pipe_compiler* get_pipe_compiler()
@@ -256,4 +766,9 @@ namespace vk
 
 		return g_pipe_compilers.get()->begin() + (thread_index % g_num_pipe_compilers);
 	}
+
+	const pipe_compiler_stats& get_pipe_compiler_stats()
+	{
+		return g_pipe_compiler_stats;
+	}
 }
@@ -50,6 +50,22 @@ namespace vk
 		}
 	};
 
+	// Graphics pipeline library, destroyed when it was evicted from the library map and no pending link uses it anymore
+	struct pipeline_library
+	{
+		VkDevice device;
+		VkPipeline handle;
+
+		pipeline_library(VkDevice dev, VkPipeline pipeline)
+			: device(dev), handle(pipeline)
+		{}
+
+		pipeline_library(const pipeline_library&) = delete;
+		pipeline_library& operator=(const pipeline_library&) = delete;
+
+		~pipeline_library();
+	};
+
 	class pipe_compiler
 	{
 	public:
@@ -82,6 +98,7 @@ namespace vk
 		std::unique_ptr<glsl::program> compile(
 			const vk::pipeline_props &create_info,
 			VkShaderModule module_handles[2],
+			u64 module_hashes[2],
 			VkPipelineLayout pipe_layout,
 			op_flags flags, callback_t callback = {},
 			const std::vector<glsl::program_input>& vs_inputs = {},
@@ -105,21 +122,35 @@ namespace vk
 			}
 		};
 
+		using pipeline_libraries_t = std::array<std::shared_ptr<pipeline_library>, 4>;
+
 		struct pipe_compiler_job
 		{
-			bool is_graphics_job;
+			enum job_type
+			{
+				graphics_job,
+				compute_job,
+				optimize_link_job
+			};
+
+			job_type type;
 			callback_t callback_func;
 
 			vk::pipeline_props graphics_data;
 			compute_pipeline_props compute_data;
 			VkPipelineLayout pipe_layout;
 			VkShaderModule graphics_modules[2];
+			u64 graphics_module_hashes[2];
 			std::vector<glsl::program_input> inputs;
 
+			pipeline_libraries_t libraries;
+			std::shared_ptr<glsl::deferred_pipeline> link_target;
+
 			pipe_compiler_job(
 				const vk::pipeline_props& props,
 				VkPipelineLayout layout,
 				VkShaderModule modules[2],
+				u64 module_hashes[2],
 				const std::vector<glsl::program_input>& vs_in,
 				const std::vector<glsl::program_input>& fs_in,
 				callback_t func)
@@ -129,7 +160,9 @@ namespace vk
 				pipe_layout = layout;
 				graphics_modules[0] = modules[0];
 				graphics_modules[1] = modules[1];
-				is_graphics_job = true;
+				graphics_module_hashes[0] = module_hashes[0];
+				graphics_module_hashes[1] = module_hashes[1];
+				type = graphics_job;
 
 				inputs.reserve(vs_in.size() + fs_in.size());
 				inputs.insert(inputs.end(), vs_in.begin(), vs_in.end());
@@ -144,7 +177,18 @@ namespace vk
 				callback_func = func;
 				compute_data = props;
 				pipe_layout = layout;
-				is_graphics_job = false;
+				type = compute_job;
+			}
+
+			pipe_compiler_job(
+				const pipeline_libraries_t& libs,
+				VkPipelineLayout layout,
+				std::shared_ptr<glsl::deferred_pipeline> target)
+			{
+				libraries = libs;
+				pipe_layout = layout;
+				link_target = std::move(target);
+				type = optimize_link_job;
 			}
 		};
 
@@ -154,13 +198,49 @@ namespace vk
 		std::unique_ptr<glsl::program> int_compile_compute_pipe(const VkComputePipelineCreateInfo& create_info, VkPipelineLayout pipe_layout);
 		std::unique_ptr<glsl::program> int_compile_graphics_pipe(const VkGraphicsPipelineCreateInfo& create_info, VkPipelineLayout pipe_layout,
 			const std::vector<glsl::program_input>& vs_inputs, const std::vector<glsl::program_input>& fs_inputs);
-		std::unique_ptr<glsl::program> int_compile_graphics_pipe(const vk::pipeline_props &create_info, VkShaderModule modules[2], VkPipelineLayout pipe_layout,
+		std::unique_ptr<glsl::program> int_compile_graphics_pipe(const vk::pipeline_props &create_info, VkShaderModule modules[2], u64 module_hashes[2], VkPipelineLayout pipe_layout,
+			const std::vector<glsl::program_input>& vs_inputs, const std::vector<glsl::program_input>& fs_inputs);
+
+		// VK_EXT_graphics_pipeline_library path
+		bool find_pipeline_libraries(const vk::pipeline_props& create_info, u64 module_hashes[2], pipeline_libraries_t& libraries) const;
+		void create_pipeline_libraries(const vk::pipeline_props& create_info, VkShaderModule modules[2], u64 module_hashes[2], VkPipelineLayout pipe_layout, pipeline_libraries_t& libraries);
+		VkPipeline link_pipeline_libraries(const pipeline_libraries_t& libraries, VkPipelineLayout pipe_layout, bool optimize);
+		std::unique_ptr<glsl::program> int_fast_link_graphics_pipe(const pipeline_libraries_t& libraries, VkPipelineLayout pipe_layout,
 			const std::vector<glsl::program_input>& vs_inputs, const std::vector<glsl::program_input>& fs_inputs);
 	};
 
+	struct pipe_compiler_stats
+	{
+		// Fast links of existing pipeline libraries, done on the calling thread
+		atomic_t<u64> fast_link_count{};
+		atomic_t<u64> fast_link_time_us{};
+
+		// Pipelines compiled from shader modules, either monolithic or by creating the missing libraries
+		atomic_t<u64> full_compile_count{};
+		atomic_t<u64> full_compile_time_us{};
+
+		// Background link-time optimization of fast linked pipelines
+		atomic_t<u64> optimized_link_count{};
+		atomic_t<u64> optimized_link_time_us{};
+
+		u64 average_fast_link_time() const { return fast_link_time_us.load() / std::max<u64>(fast_link_count.load(), 1); }
+		u64 average_full_compile_time() const { return full_compile_time_us.load() / std::max<u64>(full_compile_count.load(), 1); }
+
+		void reset()
+		{
+			fast_link_count = 0;
+			fast_link_time_us = 0;
+			full_compile_count = 0;
+			full_compile_time_us = 0;
+			optimized_link_count = 0;
+			optimized_link_time_us = 0;
+		}
+	};
+
 	void initialize_pipe_compiler(int num_worker_threads = -1);
 	void destroy_pipe_compiler();
 	pipe_compiler* get_pipe_compiler();
+	const pipe_compiler_stats& get_pipe_compiler_stats();
 }
 
 namespace rpcs3
@@ -748,7 +748,7 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 
 			flush_command_queue(true);
 			auto src = sshot_vkbuf.map(0, sshot_size);
-			std::vector<u8> sshot_frame(sshot_size);
+			std::vector<u8> sshot_frame = m_frame->get_frame_buffer(sshot_size);
 			memcpy(sshot_frame.data(), src, sshot_size);
 			sshot_vkbuf.unmap();
 
@@ -828,6 +828,11 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 			const auto vertex_cache_hit_ratio = info.stats.vertex_cache_request_count
 				? (vertex_cache_hit_count * 100) / info.stats.vertex_cache_request_count
 				: 0;
+			const auto vertex_layout_hit_count = (info.stats.vertex_layout_request_count - info.stats.vertex_layout_miss_count);
+			const auto vertex_layout_hit_ratio = info.stats.vertex_layout_request_count
+				? (vertex_layout_hit_count * 100) / info.stats.vertex_layout_request_count
+				: 0;
+			const auto& pipe_stats = vk::get_pipe_compiler_stats();
 
 			rsx::overlays::set_debug_overlay_text(fmt::format(
 				"Internal Resolution:      %s\n"
@@ -844,14 +849,19 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 				"Temporary texture memory: %3dM\n"
 				"Flush requests: %13d  = %2d (%3d%%) hard faults, %2d unavoidable, %2d misprediction(s), %2d speculation(s)\n"
 				"Texture uploads: %12u (%u from CPU - %02u%%, %u copies avoided)\n"
-				"Vertex cache hits: %10u/%u (%u%%)",
+				"Vertex cache hits: %10u/%u (%u%%)\n"
+				"Vertex layout hits: %9u/%u (%u%%)\n"
+				"Pipeline fast links: %8u (%uus avg), full compiles: %u (%uus avg)",
 				info.stats.framebuffer_stats.to_string(!backend_config.supports_hw_msaa),
 				get_load(), info.stats.draw_calls, info.stats.submit_count, info.stats.setup_time, info.stats.vertex_upload_time,
 				info.stats.textures_upload_time, info.stats.draw_exec_time, info.stats.flip_time,
 				num_dirty_textures, texture_memory_size, tmp_texture_memory_size,
 				num_flushes, num_misses, cache_miss_ratio, num_unavoidable, num_mispredict, num_speculate,
 				num_texture_upload, num_texture_upload_miss, texture_upload_miss_ratio, texture_copies_ellided,
-				vertex_cache_hit_count, info.stats.vertex_cache_request_count, vertex_cache_hit_ratio)
+				vertex_cache_hit_count, info.stats.vertex_cache_request_count, vertex_cache_hit_ratio,
+				vertex_layout_hit_count, info.stats.vertex_layout_request_count, vertex_layout_hit_ratio,
+				pipe_stats.fast_link_count.load(), pipe_stats.average_fast_link_time(),
+				pipe_stats.full_compile_count.load(), pipe_stats.average_full_compile_time())
 			);
 		}
 
@@ -51,10 +51,11 @@ namespace vk
 		{
 			const auto compiler_flags = compile_async ? vk::pipe_compiler::COMPILE_DEFERRED : vk::pipe_compiler::COMPILE_INLINE;
 			VkShaderModule modules[2] = { vertexProgramData.handle, fragmentProgramData.handle };
+			u64 module_hashes[2] = { vertexProgramData.shader.get_compiled_hash(), fragmentProgramData.shader.get_compiled_hash() };
 
 			auto compiler = vk::get_pipe_compiler();
 			auto result = compiler->compile(
-				pipelineProperties, modules, common_pipeline_layout,
+				pipelineProperties, modules, module_hashes, common_pipeline_layout,
 				compiler_flags, callback,
 				vertexProgramData.uniforms,
 				fragmentProgramData.uniforms);
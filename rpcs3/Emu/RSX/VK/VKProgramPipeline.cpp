@@ -1,10 +1,13 @@
 #include "stdafx.h"
 #include "VKProgramPipeline.h"
+#include "VKResourceManager.h"
 #include "vkutils/descriptors.h"
 #include "vkutils/device.h"
 
 #include "../Program/SPIRVCommon.h"
 
+#include "util/fnv_hash.hpp"
+
 namespace vk
 {
 	namespace glsl
@@ -30,6 +33,13 @@ namespace vk
 				fmt::throw_exception("Failed to compile %s shader", shader_type);
 			}
 
+			m_compiled_hash = rpcs3::fnv_seed;
+
+			for (const u32 word : m_compiled)
+			{
+				m_compiled_hash = rpcs3::hash64(m_compiled_hash, word);
+			}
+
 			VkShaderModuleCreateInfo vs_info;
 			vs_info.codeSize = m_compiled.size() * sizeof(u32);
 			vs_info.pNext    = nullptr;
@@ -46,6 +56,7 @@ namespace vk
 		{
 			m_source.clear();
 			m_compiled.clear();
+			m_compiled_hash = 0;
 
 			if (m_handle)
 			{
@@ -69,6 +80,11 @@ namespace vk
 			return m_handle;
 		}
 
+		u64 shader::get_compiled_hash() const
+		{
+			return m_compiled_hash;
+		}
+
 		void program::create_impl()
 		{
 			linked = false;
@@ -94,11 +110,46 @@ namespace vk
 			create_impl();
 		}
 
+		deferred_pipeline::~deferred_pipeline()
+		{
+			if (const VkPipeline handle = pipeline.load())
+			{
+				vkDestroyPipeline(device, handle, nullptr);
+			}
+		}
+
 		program::~program()
 		{
 			vkDestroyPipeline(m_device, pipeline, nullptr);
 		}
 
+		void program::set_deferred_pipeline(std::shared_ptr<deferred_pipeline> deferred)
+		{
+			m_deferred_pipeline = std::move(deferred);
+		}
+
+		bool program::update_pipeline()
+		{
+			if (!m_deferred_pipeline) [[likely]]
+			{
+				return false;
+			}
+
+			const VkPipeline replacement = m_deferred_pipeline->pipeline.exchange(VK_NULL_HANDLE);
+			if (!replacement)
+			{
+				return false;
+			}
+
+			// The old pipeline may still be referenced by submitted command buffers
+			auto retired = std::make_unique<deferred_pipeline>(m_device);
+			retired->pipeline = std::exchange(pipeline, replacement);
+			vk::get_resource_manager()->dispose(retired);
+
+			m_deferred_pipeline.reset();
+			return true;
+		}
+
 		program& program::load_uniforms(const std::vector<program_input>& inputs)
 		{
 			ensure(!linked); // "Cannot change uniforms in already linked program!"
@@ -5,6 +5,7 @@
 
 #include "vkutils/descriptors.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -55,6 +56,7 @@ namespace vk
 			VkShaderModule m_handle = VK_NULL_HANDLE;
 			std::string m_source;
 			std::vector<u32> m_compiled;
+			u64 m_compiled_hash = 0;
 
 		public:
 			shader() = default;
@@ -70,12 +72,30 @@ namespace vk
 			const std::vector<u32> get_compiled() const;
 
 			VkShaderModule get_handle() const;
+
+			// Identifies the contents of the module, unlike the handle which can be reused once the module is destroyed
+			u64 get_compiled_hash() const;
+		};
+
+		// Pipeline which replaces the one of an existing program once it is ready, e.g. an optimized link of pipeline libraries.
+		// Owns the handle until it is picked up, so the producer can outlive the program.
+		struct deferred_pipeline
+		{
+			VkDevice device;
+			atomic_t<VkPipeline> pipeline{ VK_NULL_HANDLE };
+
+			deferred_pipeline(VkDevice dev)
+				: device(dev)
+			{}
+
+			~deferred_pipeline();
 		};
 
 		class program
 		{
 			std::array<std::vector<program_input>, input_type_max_enum> uniforms;
 			VkDevice m_device;
+			std::shared_ptr<deferred_pipeline> m_deferred_pipeline;
 
 			std::array<u32, 16> fs_texture_bindings;
 			std::array<u32, 16> fs_texture_mirror_bindings;
@@ -99,6 +119,11 @@ namespace vk
 			program& load_uniforms(const std::vector<program_input>& inputs);
 			program& link();
 
+			void set_deferred_pipeline(std::shared_ptr<deferred_pipeline> deferred);
+
+			// Swap in the deferred pipeline if it has been produced, returns true if the pipeline changed. Must be called from the thread recording with this program.
+			bool update_pipeline();
+
 			bool has_uniform(program_input_type type, const std::string &uniform_name);
 			void bind_uniform(const VkDescriptorImageInfo &image_descriptor, const std::string &uniform_name, VkDescriptorType type, vk::descriptor_set &set);
 			void bind_uniform(const VkDescriptorImageInfo &image_descriptor, int texture_unit, ::glsl::program_domain domain, vk::descriptor_set &set, bool is_stencil_mirror = false);
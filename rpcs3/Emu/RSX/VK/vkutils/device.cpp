@@ -36,6 +36,7 @@ namespace vk
 			VkPhysicalDeviceCustomBorderColorFeaturesEXT custom_border_color_info{};
 			VkPhysicalDeviceBorderColorSwizzleFeaturesEXT border_color_swizzle_info{};
 			VkPhysicalDeviceFaultFeaturesEXT device_fault_info{};
+			VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipeline_library_info{};
 
 			if (device_extensions.is_supported(VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME))
 			{
@@ -86,6 +87,14 @@ namespace vk
 				features2.pNext         = &device_fault_info;
 			}
 
+			if (device_extensions.is_supported(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+				device_extensions.is_supported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+			{
+				pipeline_library_info.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+				pipeline_library_info.pNext = features2.pNext;
+				features2.pNext             = &pipeline_library_info;
+			}
+
 			auto _vkGetPhysicalDeviceFeatures2KHR = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(parent, "vkGetPhysicalDeviceFeatures2KHR"));
 			ensure(_vkGetPhysicalDeviceFeatures2KHR); // "vkGetInstanceProcAddress failed to find entry point!"
 			_vkGetPhysicalDeviceFeatures2KHR(dev, &features2);
@@ -101,6 +110,7 @@ namespace vk
 			optional_features_support.barycentric_coords  = !!shader_barycentric_info.fragmentShaderBarycentric;
 			optional_features_support.framebuffer_loops   = !!fbo_loops_info.attachmentFeedbackLoopLayout;
 			optional_features_support.extended_device_fault = !!device_fault_info.deviceFault;
+			optional_features_support.graphics_pipeline_library = !!pipeline_library_info.graphicsPipelineLibrary;
 
 			features = features2.features;
 
@@ -164,6 +174,7 @@ namespace vk
 			properties2.pNext = nullptr;
 
 			VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptor_indexing_props{};
+			VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT pipeline_library_props{};
 
 			if (descriptor_indexing_support)
 			{
@@ -179,6 +190,13 @@ namespace vk
 				properties2.pNext = &driver_properties;
 			}
 
+			if (optional_features_support.graphics_pipeline_library)
+			{
+				pipeline_library_props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+				pipeline_library_props.pNext = properties2.pNext;
+				properties2.pNext = &pipeline_library_props;
+			}
+
 			auto _vkGetPhysicalDeviceProperties2KHR = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(vkGetInstanceProcAddr(parent, "vkGetPhysicalDeviceProperties2KHR"));
 			ensure(_vkGetPhysicalDeviceProperties2KHR);
 
@@ -198,6 +216,13 @@ namespace vk
 					descriptor_max_draw_calls = 8192;
 				}
 			}
+
+			if (optional_features_support.graphics_pipeline_library && !pipeline_library_props.graphicsPipelineLibraryFastLinking)
+			{
+				// Without fast linking the libraries only add overhead on top of a monolithic compile
+				rsx_log.notice("Graphics pipeline libraries are supported but fast linking is not. Pipeline libraries are disabled.");
+				optional_features_support.graphics_pipeline_library = false;
+			}
 		}
 	}
 
@@ -417,6 +442,11 @@ namespace vk
 		return props.limits;
 	}
 
+	const VkPhysicalDeviceProperties& physical_device::get_properties() const
+	{
+		return props;
+	}
+
 	physical_device::operator VkPhysicalDevice() const
 	{
 		return dev;
@@ -545,6 +575,12 @@ namespace vk
 			requested_extensions.push_back(VK_EXT_DEVICE_FAULT_EXTENSION_NAME);
 		}
 
+		if (pgpu->optional_features_support.graphics_pipeline_library)
+		{
+			requested_extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+			requested_extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+		}
+
 		enabled_features.robustBufferAccess = VK_TRUE;
 		enabled_features.fullDrawIndexUint32 = VK_TRUE;
 		enabled_features.independentBlend = VK_TRUE;
@@ -751,6 +787,15 @@ namespace vk
 			device.pNext = &device_fault_info;
 		}
 
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipeline_library_info{};
+		if (pgpu->optional_features_support.graphics_pipeline_library)
+		{
+			pipeline_library_info.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+			pipeline_library_info.pNext = const_cast<void*>(device.pNext);
+			pipeline_library_info.graphicsPipelineLibrary = VK_TRUE;
+			device.pNext = &pipeline_library_info;
+		}
+
 		VkPhysicalDeviceConditionalRenderingFeaturesEXT conditional_rendering_info{};
 		if (pgpu->optional_features_support.conditional_rendering)
 		{
@@ -93,6 +93,7 @@ namespace vk
 			bool unrestricted_depth_range = false;
 			bool extended_device_fault = false;
 			bool texture_compression_bc = false;
+			bool graphics_pipeline_library = false;
 		} optional_features_support;
 
 		friend class render_device;
@@ -119,6 +120,7 @@ namespace vk
 		const VkQueueFamilyProperties& get_queue_properties(u32 queue);
 		const VkPhysicalDeviceMemoryProperties& get_memory_properties() const;
 		const VkPhysicalDeviceLimits& get_limits() const;
+		const VkPhysicalDeviceProperties& get_properties() const;
 
 		operator VkPhysicalDevice() const;
 		operator VkInstance() const;
@@ -192,6 +194,7 @@ namespace vk
 		bool get_synchronization2_support() const { return pgpu->optional_features_support.synchronization_2; }
 		bool get_extended_device_fault_support() const { return pgpu->optional_features_support.extended_device_fault; }
 		bool get_texture_compression_bc_support() const { return pgpu->optional_features_support.texture_compression_bc; }
+		bool get_graphics_pipeline_library_support() const { return pgpu->optional_features_support.graphics_pipeline_library; }
 
 		u64 get_descriptor_update_after_bind_support() const { return pgpu->descriptor_indexing_support.update_after_bind_mask; }
 		u32 get_descriptor_max_draw_calls() const { return pgpu->descriptor_max_draw_calls; }
@@ -710,6 +710,14 @@ namespace rsx
 			state_signals[NV4097_SET_TWO_SIDE_LIGHT_EN] = rsx::fragment_program_state_dirty;
 			state_signals[NV4097_SET_POINT_SPRITE_CONTROL] = rsx::fragment_program_state_dirty;
 			state_signals[NV4097_SET_USER_CLIP_PLANE_CONTROL] = rsx::vertex_state_dirty;
+			state_signals[NV4097_SET_VERTEX_ATTRIB_INPUT_MASK] = rsx::vertex_layout_dirty;
+			state_signals[NV4097_SET_FREQUENCY_DIVIDER_OPERATION] = rsx::vertex_layout_dirty;
+
+			for (u32 index = 0; index < rsx::limits::vertex_count; ++index)
+			{
+				state_signals[NV4097_SET_VERTEX_DATA_ARRAY_FORMAT + index] = rsx::vertex_layout_dirty;
+			}
+
 			state_signals[NV4097_SET_TRANSFORM_BRANCH_BITS] = rsx::vertex_state_dirty;
 			state_signals[NV4097_SET_CLIP_MIN] = rsx::invalidate_zclip_bits;
 			state_signals[NV4097_SET_CLIP_MAX] = rsx::invalidate_zclip_bits;
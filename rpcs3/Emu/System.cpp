@@ -6,6 +6,9 @@
 #include "Emu/system_progress.hpp"
 #include "Emu/system_utils.hpp"
 #include "Emu/perf_meter.hpp"
+#include "Emu/event_trace.hpp"
+#include "Emu/benchmark.hpp"
+#include "Emu/reservation_stats.hpp"
 #include "Emu/perf_monitor.hpp"
 #include "Emu/vfs_config.h"
 #include "Emu/IPC_config.h"
@@ -36,6 +39,7 @@
 #include "Loader/TAR.h"
 #include "Loader/ELF.h"
 #include "Loader/disc.h"
+#include "Loader/ISO.h"
 
 #include "rpcs3_version.h"
 
@@ -253,6 +257,20 @@ void init_fxo_for_exec(utils::serial* ar, bool full = false)
 	}
 }
 
+// Game paths registered in games.yml may point to a disc image, mount it in that case
+static std::string resolve_game_path(std::string path)
+{
+	if (disc_image::get_image_type(path) != disc_image::image_type::invalid)
+	{
+		if (std::string root = disc_image::mount(path); !root.empty())
+		{
+			return root + "/";
+		}
+	}
+
+	return path;
+}
+
 // Some settings are not allowed in certain PPU decoders
 static void fixup_settings(const psf::registry* _psf)
 {
@@ -303,6 +321,12 @@ static void fixup_settings(const psf::registry* _psf)
 			g_cfg.video.resolution.set(new_resolution);
 		}
 	}
+
+	if (benchmark_stats::is_enabled() && g_cfg.video.renderer != video_renderer::null)
+	{
+		sys_log.warning("Benchmark mode: forcing the %s video renderer instead of %s.", video_renderer::null, g_cfg.video.renderer.get());
+		g_cfg.video.renderer.set(video_renderer::null);
+	}
 }
 
 extern void dump_executable(std::span<const u8> data, const ppu_module<lv2_obj>* _module, std::string_view title_id)
@@ -965,6 +989,17 @@ game_boot_result Emulator::GetElfPathFromDir(std::string& elf_path, const std::s
 	return game_boot_result::invalid_file_or_folder;
 }
 
+std::string Emulator::GetBootSourcePath() const
+{
+	// The mount point of a disc image changes on every run
+	if (std::string image_path = disc_image::get_source_path(m_path); !image_path.empty())
+	{
+		return image_path;
+	}
+
+	return m_path;
+}
+
 game_boot_result Emulator::BootGame(const std::string& path, const std::string& title_id, bool direct, cfg_mode config_mode, const std::string& config_path)
 {
 	if (m_restrict_emu_state_change)
@@ -1011,7 +1046,7 @@ game_boot_result Emulator::BootGame(const std::string& path, const std::string&
 
 	if (m_path_original.empty() || config_mode != cfg_mode::continuous)
 	{
-		m_path_original = m_path;
+		m_path_original = GetBootSourcePath();
 	}
 
 	m_path_old = m_path;
@@ -1019,8 +1054,23 @@ game_boot_result Emulator::BootGame(const std::string& path, const std::string&
 	m_config_mode = config_mode;
 	m_config_path = config_path;
 
+	// Disc images are mounted as a virtual device and booted like a disc directory
+	std::string image_root;
+
+	if (disc_image::get_image_type(path) != disc_image::image_type::invalid)
+	{
+		image_root = disc_image::mount(path);
+
+		if (image_root.empty())
+		{
+			return restore_on_no_boot(game_boot_result::invalid_file_or_folder);
+		}
+	}
+
+	const std::string& boot_path = image_root.empty() ? path : image_root;
+
 	// Handle files and special paths inside Load unmodified
-	if (direct || !fs::is_dir(path))
+	if (image_root.empty() && (direct || !fs::is_dir(path)))
 	{
 		m_path = path;
 
@@ -1030,7 +1080,7 @@ game_boot_result Emulator::BootGame(const std::string& path, const std::string&
 	game_boot_result result = game_boot_result::nothing_to_boot;
 
 	std::string elf;
-	if (const game_boot_result res = GetElfPathFromDir(elf, path); res == game_boot_result::no_errors)
+	if (const game_boot_result res = GetElfPathFromDir(elf, boot_path); res == game_boot_result::no_errors)
 	{
 		ensure(!elf.empty());
 		m_path = elf;
@@ -1057,6 +1107,8 @@ void Emulator::SetContinuousMode(bool continuous_mode)
 
 game_boot_result Emulator::Load(const std::string& title_id, bool is_disc_patch, usz recursion_count)
 {
+	trace_scope trace0("Emulator::Load", "boot", recursion_count);
+
 	if (recursion_count == 0 && m_restrict_emu_state_change)
 	{
 		return game_boot_result::currently_restricted;
@@ -1244,7 +1296,7 @@ game_boot_result Emulator::Load(const std::string& title_id, bool is_disc_patch,
 					}
 					else
 					{
-						disc = std::move(game_path);
+						disc = resolve_game_path(std::move(game_path));
 					}
 				}
 				else if (!g_cfg.savestate.state_inspection_mode)
@@ -1433,7 +1485,7 @@ game_boot_result Emulator::Load(const std::string& title_id, bool is_disc_patch,
 					// Try to load game directory from list if available
 					if (std::string game_path = m_games_config.get_path(m_title_id); !game_path.empty())
 					{
-						disc = std::move(game_path);
+						disc = resolve_game_path(std::move(game_path));
 						m_path = disc + argv[0].substr(game0_path.size() + dirname.size());
 					}
 				}
@@ -1676,6 +1728,13 @@ game_boot_result Emulator::Load(const std::string& title_id, bool is_disc_patch,
 			g_cfg.core.llvm_precompilation.set(true);
 			g_cfg.core.spu_cache.set(true);
 
+			// Limit PPU and SPU compile threads (batch cache creation under a memory budget)
+			if (m_precompile_thread_limit && (!g_cfg.core.llvm_threads || g_cfg.core.llvm_threads > m_precompile_thread_limit))
+			{
+				sys_log.notice("Limiting compile threads to %u", m_precompile_thread_limit);
+				g_cfg.core.llvm_threads.set(m_precompile_thread_limit);
+			}
+
 			// Disable incompatible settings
 			fixup_settings(&_psf);
 
@@ -1871,7 +1930,7 @@ game_boot_result Emulator::Load(const std::string& title_id, bool is_disc_patch,
 				}
 				else
 				{
-					bdvd_dir = std::move(game_path);
+					bdvd_dir = resolve_game_path(std::move(game_path));
 				}
 			}
 			else
@@ -1912,10 +1971,13 @@ game_boot_result Emulator::Load(const std::string& title_id, bool is_disc_patch,
 					sys_log.error("Unexpected PARAM.SFO found in disc directory '%s' (found '%s')", m_title_id, bdvd_title_id);
 				}
 
-				// Store /dev_bdvd/ location
-				if (games_config::result res = m_games_config.add_game(m_title_id, bdvd_dir); res == games_config::result::success)
+				// Store /dev_bdvd/ location (or the disc image it comes from)
+				const std::string image_path = disc_image::get_source_path(bdvd_dir);
+				const std::string& bdvd_location = image_path.empty() ? bdvd_dir : image_path;
+
+				if (games_config::result res = m_games_config.add_game(m_title_id, bdvd_location); res == games_config::result::success)
 				{
-					sys_log.notice("Registered BDVD game directory for title '%s': %s", m_title_id, bdvd_dir);
+					sys_log.notice("Registered BDVD game directory for title '%s': %s", m_title_id, bdvd_location);
 				}
 				else if (res == games_config::result::failure)
 				{
@@ -2243,6 +2305,7 @@ game_boot_result Emulator::Load(const std::string& title_id, bool is_disc_patch,
 		else
 		{
 			g_ps3_process_info.self_info.valid = false;
+			g_ps3_process_info.self_info.cache_path.clear();
 		}
 
 		if (!elf_file)
@@ -2853,6 +2916,8 @@ void Emulator::Resume()
 	}
 
 	perf_stat_base::report();
+	event_trace::dump();
+	reservation_stats::report();
 
 	auto on_select = [](u32, cpu_thread& cpu)
 	{
@@ -3747,6 +3812,8 @@ void Emulator::Kill(bool allow_autoexit, bool savestate, savestate_stage* save_s
 			jit_runtime::finalize();
 
 			perf_stat_base::report();
+			event_trace::dump();
+			reservation_stats::report();
 
 			static u64 aw_refs = 0;
 			static u64 aw_colm = 0;
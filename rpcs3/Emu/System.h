@@ -6,6 +6,7 @@
 #include "Utilities/bit_set.h"
 #include "config_mode.h"
 #include "games_config.h"
+#include "game_list_index.h"
 #include <functional>
 #include <memory>
 #include <string>
@@ -130,6 +131,7 @@ class Emulator final
 	atomic_t<u64> m_restrict_emu_state_change{0};
 
 	games_config m_games_config;
+	game_list_index m_game_list_index;
 
 	video_renderer m_default_renderer;
 	std::string m_default_graphics_adapter;
@@ -156,6 +158,9 @@ class Emulator final
 	// 2. It signifies that we don't want to exit on Kill(), for example if we want to transition to another application.
 	bool m_force_boot = false;
 
+	// Maximum number of compile threads for cache creation boots (0: use the config)
+	u32 m_precompile_thread_limit = 0;
+
 	bool m_continuous_mode = false;
 	bool m_has_gui = true;
 
@@ -269,6 +274,9 @@ public:
 		return m_path_original;
 	}
 
+	// Boot path which stays valid after a restart (the image file if booted from a disc image)
+	std::string GetBootSourcePath() const;
+
 	const std::string& GetTitleID() const
 	{
 		return m_title_id;
@@ -321,6 +329,11 @@ public:
 		return m_games_config;
 	}
 
+	game_list_index& GetGameListIndex()
+	{
+		return m_game_list_index;
+	}
+
 	// Get deserialization manager
 	utils::serial* DeserialManager() const;
 
@@ -398,6 +411,7 @@ public:
 
 	void SetForceBoot(bool force_boot);
 	void SetContinuousMode(bool continuous_mode);
+	void SetPrecompileThreadLimit(u32 thread_limit) { m_precompile_thread_limit = thread_limit; }
 
 	game_boot_result Load(const std::string& title_id = "", bool is_disc_patch = false, usz recursion_count = 0);
 	void Run(bool start_playtime);
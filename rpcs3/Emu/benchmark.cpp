@@ -0,0 +1,86 @@
+#include "stdafx.h"
+#include "benchmark.hpp"
+
+#include "util/atomic.hpp"
+#include "Utilities/mutex.h"
+
+#include <chrono>
+#include <mutex>
+
+namespace
+{
+	atomic_t<bool> s_enabled = false;
+
+	shared_mutex s_flip_mutex;
+
+	std::vector<u64> s_flip_times;
+
+	struct compile_counter
+	{
+		atomic_t<u64> count{0};
+		atomic_t<u64> us{0};
+	};
+
+	compile_counter s_compile[static_cast<usz>(benchmark_stats::compiler::count)];
+}
+
+void benchmark_stats::enable() noexcept
+{
+	s_enabled = true;
+}
+
+bool benchmark_stats::is_enabled() noexcept
+{
+	return s_enabled.observe();
+}
+
+u64 benchmark_stats::now() noexcept
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void benchmark_stats::on_flip() noexcept
+{
+	if (!is_enabled()) [[likely]]
+	{
+		return;
+	}
+
+	const u64 stamp = now();
+
+	std::lock_guard lock(s_flip_mutex);
+
+	s_flip_times.push_back(stamp);
+}
+
+u64 benchmark_stats::get_flip_count() noexcept
+{
+	reader_lock lock(s_flip_mutex);
+
+	return s_flip_times.size();
+}
+
+std::vector<u64> benchmark_stats::get_flip_times(u64 first)
+{
+	reader_lock lock(s_flip_mutex);
+
+	if (first >= s_flip_times.size())
+	{
+		return {};
+	}
+
+	return {s_flip_times.begin() + first, s_flip_times.end()};
+}
+
+void benchmark_stats::add_compile_time(compiler type, u64 us) noexcept
+{
+	auto& counter = ::at32(s_compile, static_cast<usz>(type));
+	counter.count++;
+	counter.us += us;
+}
+
+std::pair<u64, u64> benchmark_stats::get_compile_time(compiler type) noexcept
+{
+	const auto& counter = ::at32(s_compile, static_cast<usz>(type));
+	return {counter.count.load(), counter.us.load()};
+}
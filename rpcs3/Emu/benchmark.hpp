@@ -0,0 +1,69 @@
+#pragma once
+
+#include "util/types.hpp"
+
+#include <utility>
+#include <vector>
+
+// Measurements of the headless benchmark mode: host timestamps of emulated flips and JIT compile times.
+// Nothing is recorded unless benchmark mode was enabled before booting.
+class benchmark_stats
+{
+public:
+	enum class compiler : u32
+	{
+		ppu,
+		spu,
+
+		count
+	};
+
+	// Start recording, must be called before booting. Also forces the Null renderer.
+	static void enable() noexcept;
+
+	static bool is_enabled() noexcept;
+
+	// Get the current timestamp in microseconds
+	static u64 now() noexcept;
+
+	// Record an emulated flip
+	static void on_flip() noexcept;
+
+	// Get the number of emulated flips since booting
+	static u64 get_flip_count() noexcept;
+
+	// Get the timestamps of all flips starting with the flip at index first
+	static std::vector<u64> get_flip_times(u64 first);
+
+	// Record a compilation which took the given number of microseconds
+	static void add_compile_time(compiler type, u64 us) noexcept;
+
+	// Get the number of compilations and their total time in microseconds
+	static std::pair<u64, u64> get_compile_time(compiler type) noexcept;
+};
+
+// Object that records its lifetime as compile time
+class compile_time_scope
+{
+	benchmark_stats::compiler m_type;
+	u64 m_start;
+
+public:
+	compile_time_scope(benchmark_stats::compiler type) noexcept
+		: m_type(type)
+		, m_start(benchmark_stats::is_enabled() ? benchmark_stats::now() : 0)
+	{
+	}
+
+	compile_time_scope(const compile_time_scope&) = delete;
+
+	compile_time_scope& operator=(const compile_time_scope&) = delete;
+
+	~compile_time_scope()
+	{
+		if (m_start)
+		{
+			benchmark_stats::add_compile_time(m_type, benchmark_stats::now() - m_start);
+		}
+	}
+};
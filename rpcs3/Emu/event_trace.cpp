@@ -0,0 +1,248 @@
+#include "stdafx.h"
+#include "event_trace.hpp"
+
+#include "util/sysinfo.hpp"
+#include "util/tsc.hpp"
+#include "Utilities/date_time.h"
+#include "Utilities/File.h"
+#include "Utilities/Thread.h"
+#include "Utilities/mutex.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+LOG_CHANNEL(trace_log, "TRACE");
+
+namespace
+{
+	constexpr usz trace_ring_size = 1 << 14;
+
+	struct trace_event
+	{
+		const char* name;
+		const char* category;
+		u64 start;
+		u64 end;
+		u64 arg;
+	};
+
+	// Event slot guarded by a sequence lock, so that dump() can copy events while the owner thread overwrites them.
+	// seq is pos * 2 + 1 while event number pos is being written and pos * 2 + 2 once it is complete.
+	struct trace_slot
+	{
+		atomic_t<u64> seq = 0;
+		trace_event event;
+	};
+
+	struct trace_ring
+	{
+		std::unique_ptr<trace_slot[]> slots = std::make_unique<trace_slot[]>(trace_ring_size);
+
+		// Total number of events pushed, only written by the owner thread
+		atomic_t<u64> head = 0;
+
+		atomic_t<bool> exited = false;
+
+		std::string thread_name;
+
+		u64 tid = 0;
+	};
+
+	shared_mutex s_trace_mutex;
+
+	// Rings of exited threads are kept until the next dump
+	std::vector<std::shared_ptr<trace_ring>> s_trace_rings;
+
+	atomic_t<u64> s_trace_tid = 0;
+
+	thread_local struct trace_ring_holder
+	{
+		std::shared_ptr<trace_ring> ring;
+
+		~trace_ring_holder()
+		{
+			if (ring)
+			{
+				ring->exited = true;
+			}
+		}
+	} s_tls_trace;
+
+	// Ticks per second of the trace clock: TSC if usable, nanoseconds otherwise
+	u64 get_trace_freq() noexcept
+	{
+		static const u64 s_freq = utils::get_tsc_freq() ? utils::get_tsc_freq() : 1'000'000'000;
+		return s_freq;
+	}
+
+	void escape_json(std::string& out, std::string_view str)
+	{
+		for (const char c : str)
+		{
+			if (c == '"' || c == '\\')
+			{
+				out += '\\';
+				out += c;
+			}
+			else if (static_cast<u8>(c) < 0x20)
+			{
+				fmt::append(out, "\\u%04x", static_cast<u8>(c));
+			}
+			else
+			{
+				out += c;
+			}
+		}
+	}
+}
+
+u64 event_trace::now() noexcept
+{
+	if (utils::get_tsc_freq()) [[likely]]
+	{
+		return utils::get_tsc();
+	}
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void event_trace::push(const char* name, const char* category, u64 start_time, u64 arg) noexcept
+{
+	const u64 end_time = now();
+
+	auto& ring = s_tls_trace.ring;
+
+	if (!ring) [[unlikely]]
+	{
+		ring = std::make_shared<trace_ring>();
+		ring->tid = ++s_trace_tid;
+		ring->thread_name = thread_ctrl::get_name();
+
+		std::lock_guard lock(s_trace_mutex);
+		s_trace_rings.emplace_back(ring);
+	}
+
+	const u64 pos = ring->head.observe();
+	trace_slot& slot = ring->slots[pos % trace_ring_size];
+
+	slot.seq.release(pos * 2 + 1);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.event = trace_event{name, category, start_time, end_time, arg};
+	slot.seq.release(pos * 2 + 2);
+
+	ring->head.release(pos + 1);
+}
+
+void event_trace::push_elapsed(const char* name, const char* category, u64 elapsed_us, u64 arg) noexcept
+{
+	const u64 elapsed = static_cast<u64>(elapsed_us * (get_trace_freq() / 1'000'000.));
+	push(name, category, now() - elapsed, arg);
+}
+
+bool event_trace::dump(const std::string& path) noexcept
+{
+	std::vector<std::shared_ptr<trace_ring>> rings;
+	{
+		reader_lock lock(s_trace_mutex);
+		rings = s_trace_rings;
+	}
+
+	if (rings.empty())
+	{
+		return true;
+	}
+
+	// Copy the events first, the slots which are overwritten while copying are skipped
+	std::vector<std::vector<trace_event>> events(rings.size());
+
+	u64 base = umax;
+
+	for (usz r = 0; r < rings.size(); r++)
+	{
+		const auto& ring = rings[r];
+		const u64 head = ring->head.load();
+		const u64 begin = head > trace_ring_size ? head - trace_ring_size : 0;
+
+		events[r].reserve(head - begin);
+
+		for (u64 i = begin; i < head; i++)
+		{
+			const trace_slot& slot = ring->slots[i % trace_ring_size];
+
+			if (slot.seq.load() != i * 2 + 2)
+			{
+				continue;
+			}
+
+			const trace_event ev = slot.event;
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (slot.seq.observe() != i * 2 + 2)
+			{
+				continue;
+			}
+
+			events[r].push_back(ev);
+			base = std::min(base, ev.start);
+		}
+	}
+
+	const f64 us_per_tick = 1'000'000. / get_trace_freq();
+
+	std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out.reserve(1 << 20);
+
+	usz count = 0;
+
+	for (usz r = 0; r < rings.size(); r++)
+	{
+		const auto& ring = rings[r];
+
+		fmt::append(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", ring->tid);
+		escape_json(out, ring->thread_name);
+		out += "\"}},\n";
+
+		for (const trace_event& ev : events[r])
+		{
+			fmt::append(out, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"arg\":%u}},\n"
+				, ev.name, ev.category, ring->tid, (ev.start - base) * us_per_tick, (ev.end - ev.start) * us_per_tick, ev.arg);
+
+			count++;
+		}
+	}
+
+	// Remove the trailing comma
+	out.resize(out.size() - 2);
+	out += "\n]}\n";
+
+	fs::pending_file file(path);
+
+	if (!file.file || file.file.write(out.data(), out.size()) < out.size() || !file.commit())
+	{
+		trace_log.error("Failed to write event trace to '%s' (%s)", path, fs::g_tls_error);
+		return false;
+	}
+
+	trace_log.notice("Saved %u events of %u threads to '%s'", count, rings.size(), path);
+
+	// Forget threads which are gone
+	std::lock_guard lock(s_trace_mutex);
+
+	std::erase_if(s_trace_rings, [](const std::shared_ptr<trace_ring>& ring)
+	{
+		return ring->exited.load();
+	});
+
+	return true;
+}
+
+void event_trace::dump() noexcept
+{
+	if (!g_cfg.core.event_trace)
+	{
+		return;
+	}
+
+	dump(fmt::format("%sRPCS3_trace_%s.json", fs::get_log_dir(), date_time::current_time_narrow<'_'>()));
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "util/types.hpp"
+#include "system_config.h"
+
+#include <string>
+
+// Timeline of scoped events, exported in the Chrome trace event format (open in ui.perfetto.dev or chrome://tracing).
+// Every thread records into its own ring buffer without locking, the oldest events are overwritten when it is full.
+class event_trace
+{
+public:
+	// Get the current timestamp in trace clock ticks
+	static u64 now() noexcept;
+
+	// Record an event which started at start_time and ends now. Name and category must be string literals.
+	static void push(const char* name, const char* category, u64 start_time, u64 arg) noexcept;
+
+	// Record an event which lasted elapsed_us microseconds and ends now
+	static void push_elapsed(const char* name, const char* category, u64 elapsed_us, u64 arg) noexcept;
+
+	// Write all recorded events to a JSON file
+	static bool dump(const std::string& path) noexcept;
+
+	// Write all recorded events to a new file in the log directory if tracing is enabled
+	static void dump() noexcept;
+};
+
+// Object that records an event spanning its lifetime
+class trace_scope
+{
+	const char* m_name;
+	const char* m_category;
+	u64 m_arg;
+	u64 m_start;
+
+public:
+	FORCE_INLINE trace_scope(const char* name, const char* category, u64 arg = 0) noexcept
+		: m_name(name)
+		, m_category(category)
+		, m_arg(arg)
+		, m_start(g_cfg.core.event_trace ? event_trace::now() : 0)
+	{
+	}
+
+	trace_scope(const trace_scope&) = delete;
+
+	trace_scope& operator=(const trace_scope&) = delete;
+
+	// Set the value shown as the event argument
+	void set_arg(u64 arg) noexcept
+	{
+		m_arg = arg;
+	}
+
+	FORCE_INLINE ~trace_scope()
+	{
+		if (m_start) [[unlikely]]
+		{
+			event_trace::push(m_name, m_category, m_start, m_arg);
+		}
+	}
+};
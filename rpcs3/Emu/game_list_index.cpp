@@ -0,0 +1,395 @@
+#include "stdafx.h"
+#include "game_list_index.h"
+#include "util/logs.hpp"
+#include "util/fnv_hash.hpp"
+#include "Utilities/File.h"
+
+LOG_CHANNEL(sys_log, "SYS");
+
+namespace
+{
+	constexpr u64 index_magic = "RPCSGLI\0"_u64;
+	constexpr u32 index_version = 1;
+
+	struct index_writer
+	{
+		std::vector<u8> data;
+
+		template <typename T> requires std::is_trivially_copyable_v<T>
+		void put(const T& value)
+		{
+			const u8* ptr = reinterpret_cast<const u8*>(&value);
+			data.insert(data.end(), ptr, ptr + sizeof(T));
+		}
+
+		void put(std::string_view str)
+		{
+			put<u32>(::size32(str));
+			data.insert(data.end(), str.begin(), str.end());
+		}
+
+		void put(const std::vector<u8>& vec)
+		{
+			put<u32>(::size32(vec));
+			data.insert(data.end(), vec.begin(), vec.end());
+		}
+	};
+
+	struct index_reader
+	{
+		const std::vector<u8>& data;
+		usz pos = 0;
+
+		template <typename T> requires std::is_trivially_copyable_v<T>
+		bool get(T& value)
+		{
+			if (data.size() - pos < sizeof(T))
+			{
+				return false;
+			}
+
+			std::memcpy(&value, data.data() + pos, sizeof(T));
+			pos += sizeof(T);
+			return true;
+		}
+
+		template <typename T> requires (std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<u8>>)
+		bool get(T& value)
+		{
+			u32 size = 0;
+
+			if (!get(size) || data.size() - pos < size)
+			{
+				return false;
+			}
+
+			value.assign(data.begin() + pos, data.begin() + pos + size);
+			pos += size;
+			return true;
+		}
+	};
+}
+
+psf::registry game_list_index::get_sfo(const std::string& sfo_dir)
+{
+	const std::string sfo_path = sfo_dir + "/PARAM.SFO";
+
+	fs::stat_t info{};
+
+	if (!fs::get_stat(sfo_path, info) || info.is_directory)
+	{
+		return {};
+	}
+
+	{
+		std::lock_guard lock(m_mutex);
+
+		if (!m_loaded)
+		{
+			load_nl();
+		}
+
+		if (auto it = m_sfo.find(sfo_dir); it != m_sfo.end() && it->second.sfo_mtime == info.mtime && it->second.sfo_size == info.size)
+		{
+			if (psf::registry psf = psf::load_object(fs::make_stream<std::vector<u8>>(std::vector<u8>(it->second.sfo)), sfo_path); !psf.empty())
+			{
+				it->second.used = true;
+				return psf;
+			}
+		}
+	}
+
+	fs::file sfo_file(sfo_path);
+
+	if (!sfo_file)
+	{
+		return {};
+	}
+
+	std::vector<u8> data = sfo_file.to_vector<u8>();
+	psf::registry psf = psf::load_object(fs::make_stream<std::vector<u8>>(std::vector<u8>(data)), sfo_path);
+
+	if (psf.empty())
+	{
+		return psf;
+	}
+
+	std::lock_guard lock(m_mutex);
+
+	sfo_entry& entry = m_sfo[sfo_dir];
+	entry.sfo_mtime = info.mtime;
+	entry.sfo_size = info.size;
+	entry.size_on_disk = umax;
+	entry.sfo = std::move(data);
+	entry.used = true;
+	m_dirty = true;
+
+	return psf;
+}
+
+u64 game_list_index::get_size_on_disk(const std::string& game_path, const std::string& sfo_dir)
+{
+	fs::stat_t dir_info{};
+	fs::stat_t sfo_info{};
+
+	if (!fs::get_stat(game_path, dir_info) || !fs::get_stat(sfo_dir + "/PARAM.SFO", sfo_info))
+	{
+		return umax;
+	}
+
+	std::lock_guard lock(m_mutex);
+
+	if (!m_loaded)
+	{
+		load_nl();
+	}
+
+	// Only the top level directory and PARAM.SFO are checked, game updates always rewrite the latter
+	if (auto it = m_sfo.find(sfo_dir); it != m_sfo.end() && it->second.sfo_mtime == sfo_info.mtime && it->second.sfo_size == sfo_info.size && it->second.dir_mtime == dir_info.mtime)
+	{
+		it->second.used = true;
+		return it->second.size_on_disk;
+	}
+
+	return umax;
+}
+
+void game_list_index::set_size_on_disk(const std::string& game_path, const std::string& sfo_dir, u64 size)
+{
+	fs::stat_t dir_info{};
+	fs::stat_t sfo_info{};
+
+	if (size == umax || !fs::get_stat(game_path, dir_info) || !fs::get_stat(sfo_dir + "/PARAM.SFO", sfo_info))
+	{
+		return;
+	}
+
+	std::lock_guard lock(m_mutex);
+
+	// The entry is created by get_sfo, do not index sizes of unknown games
+	if (auto it = m_sfo.find(sfo_dir); it != m_sfo.end() && it->second.sfo_mtime == sfo_info.mtime && it->second.sfo_size == sfo_info.size)
+	{
+		it->second.dir_mtime = dir_info.mtime;
+		it->second.size_on_disk = size;
+		it->second.used = true;
+		m_dirty = true;
+	}
+}
+
+std::string game_list_index::get_icon(const std::string& icon_path)
+{
+	fs::stat_t info{};
+
+	if (icon_path.empty() || !fs::get_stat(icon_path, info) || info.is_directory)
+	{
+		return icon_path;
+	}
+
+	const std::string cache_path = get_icon_cache_path(icon_path);
+
+	{
+		std::lock_guard lock(m_mutex);
+
+		if (!m_loaded)
+		{
+			load_nl();
+		}
+
+		if (auto it = m_icons.find(icon_path); it != m_icons.end() && it->second.mtime == info.mtime && it->second.size == info.size)
+		{
+			it->second.used = true;
+			return cache_path;
+		}
+	}
+
+	if (!fs::copy_file(icon_path, cache_path, true))
+	{
+		sys_log.warning("Failed to cache icon '%s' to '%s' (error=%s)", icon_path, cache_path, fs::g_tls_error);
+		return icon_path;
+	}
+
+	std::lock_guard lock(m_mutex);
+
+	icon_entry& entry = m_icons[icon_path];
+	entry.mtime = info.mtime;
+	entry.size = info.size;
+	entry.used = true;
+	m_dirty = true;
+
+	return cache_path;
+}
+
+bool game_list_index::save(bool prune)
+{
+	std::lock_guard lock(m_mutex);
+	return save_nl(prune);
+}
+
+bool game_list_index::save_nl(bool prune)
+{
+	if (!m_loaded)
+	{
+		// Nothing was accessed
+		return true;
+	}
+
+	if (prune)
+	{
+		for (auto it = m_sfo.begin(); it != m_sfo.end();)
+		{
+			if (!it->second.used)
+			{
+				it = m_sfo.erase(it);
+				m_dirty = true;
+				continue;
+			}
+
+			++it;
+		}
+
+		// Icons are loaded lazily by the UI, only drop the ones whose source is gone
+		for (auto it = m_icons.begin(); it != m_icons.end();)
+		{
+			if (!it->second.used && !fs::is_file(it->first))
+			{
+				fs::remove_file(get_icon_cache_path(it->first));
+				it = m_icons.erase(it);
+				m_dirty = true;
+				continue;
+			}
+
+			++it;
+		}
+
+		// Start tracking usage again for the next refresh
+		for (auto& [sfo_dir, entry] : m_sfo)
+		{
+			entry.used = false;
+		}
+	}
+
+	if (!m_dirty)
+	{
+		return true;
+	}
+
+	index_writer out;
+	out.put(index_magic);
+	out.put(index_version);
+
+	out.put<u32>(::size32(m_sfo));
+
+	for (const auto& [sfo_dir, entry] : m_sfo)
+	{
+		out.put(sfo_dir);
+		out.put(entry.sfo_mtime);
+		out.put(entry.sfo_size);
+		out.put(entry.dir_mtime);
+		out.put(entry.size_on_disk);
+		out.put(entry.sfo);
+	}
+
+	out.put<u32>(::size32(m_icons));
+
+	for (const auto& [icon_path, entry] : m_icons)
+	{
+		out.put(icon_path);
+		out.put(entry.mtime);
+		out.put(entry.size);
+	}
+
+	fs::pending_file temp(fs::get_cache_dir() + "game_list_index.dat");
+
+	if (temp.file && temp.file.write(out.data.data(), out.data.size()) >= out.data.size() && temp.commit())
+	{
+		m_dirty = false;
+		return true;
+	}
+
+	sys_log.error("Failed to save game list index: %s", fs::g_tls_error);
+	return false;
+}
+
+void game_list_index::load_nl()
+{
+	m_loaded = true;
+	m_sfo.clear();
+	m_icons.clear();
+
+	fs::create_path(get_icon_cache_dir());
+
+	const fs::file f(fs::get_cache_dir() + "game_list_index.dat");
+
+	if (!f)
+	{
+		return;
+	}
+
+	const std::vector<u8> data = f.to_vector<u8>();
+	index_reader in{data};
+
+	u64 magic = 0;
+	u32 version = 0;
+
+	if (!in.get(magic) || magic != index_magic || !in.get(version) || version != index_version)
+	{
+		sys_log.notice("Game list index is outdated or invalid, rebuilding");
+		return;
+	}
+
+	u32 count = 0;
+	bool ok = in.get(count);
+
+	for (u32 i = 0; ok && i < count; i++)
+	{
+		std::string sfo_dir;
+		sfo_entry entry{};
+		ok = in.get(sfo_dir) && in.get(entry.sfo_mtime) && in.get(entry.sfo_size) && in.get(entry.dir_mtime) && in.get(entry.size_on_disk) && in.get(entry.sfo);
+
+		if (ok)
+		{
+			m_sfo.emplace(std::move(sfo_dir), std::move(entry));
+		}
+	}
+
+	ok = ok && in.get(count);
+
+	for (u32 i = 0; ok && i < count; i++)
+	{
+		std::string icon_path;
+		icon_entry entry{};
+		ok = in.get(icon_path) && in.get(entry.mtime) && in.get(entry.size);
+
+		if (ok)
+		{
+			m_icons.emplace(std::move(icon_path), entry);
+		}
+	}
+
+	if (!ok)
+	{
+		sys_log.error("Game list index is corrupted, rebuilding");
+		m_sfo.clear();
+		m_icons.clear();
+		return;
+	}
+
+	sys_log.notice("Loaded game list index (%d entries, %d icons)", m_sfo.size(), m_icons.size());
+}
+
+std::string game_list_index::get_icon_cache_dir()
+{
+	return fs::get_cache_dir() + "game_list_icons/";
+}
+
+std::string game_list_index::get_icon_cache_path(const std::string& icon_path)
+{
+	usz hash = rpcs3::fnv_seed;
+
+	for (const char c : icon_path)
+	{
+		hash = rpcs3::hash64(hash, static_cast<u8>(c));
+	}
+
+	return fmt::format("%s%016x.png", get_icon_cache_dir(), hash);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Utilities/mutex.h"
+#include "Loader/PSF.h"
+#include <unordered_map>
+
+// Persistent on-disk cache of game list metadata (parsed PARAM.SFO, size on disk and icon copies).
+// Entries are validated against the file status of their sources, so a refresh only has to stat files
+// and re-parse what changed since the last run.
+class game_list_index
+{
+public:
+	game_list_index() = default;
+
+	game_list_index(const game_list_index&) = delete;
+	game_list_index& operator=(const game_list_index&) = delete;
+
+	// Get the parsed PARAM.SFO in sfo_dir, only loading it if it changed since it was indexed
+	psf::registry get_sfo(const std::string& sfo_dir);
+
+	// Get the size on disk of a game directory, or umax if it is unknown or outdated
+	u64 get_size_on_disk(const std::string& game_path, const std::string& sfo_dir);
+	void set_size_on_disk(const std::string& game_path, const std::string& sfo_dir, u64 size);
+
+	// Get the path to a local copy of an icon, refreshing the copy if the source changed.
+	// Returns the source path if the copy could not be made.
+	std::string get_icon(const std::string& icon_path);
+
+	// Save the index to disk if it changed. If prune is set, game entries which were not accessed since the last load are dropped.
+	// Not done on destruction, the owner has to save it while the file system and logs are still usable.
+	bool save(bool prune = false);
+
+private:
+	struct sfo_entry
+	{
+		s64 sfo_mtime = 0;
+		u64 sfo_size = 0;
+		s64 dir_mtime = 0;
+		u64 size_on_disk = umax;
+		std::vector<u8> sfo;
+		bool used = false;
+	};
+
+	struct icon_entry
+	{
+		s64 mtime = 0;
+		u64 size = 0;
+		bool used = false;
+	};
+
+	void load_nl();
+	bool save_nl(bool prune);
+
+	static std::string get_icon_cache_dir();
+	static std::string get_icon_cache_path(const std::string& icon_path);
+
+	std::unordered_map<std::string, sfo_entry> m_sfo;
+	std::unordered_map<std::string, icon_entry> m_icons;
+	shared_mutex m_mutex;
+
+	bool m_loaded = false;
+	bool m_dirty = false;
+};
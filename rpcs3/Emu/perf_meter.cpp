@@ -155,3 +155,27 @@ void perf_stat_base::report() noexcept
 
 	perf_log.notice("Performance report end.");
 }
+
+std::map<std::string, std::array<u64, 66>> perf_stat_base::get_stats() noexcept
+{
+	std::lock_guard lock(s_perf_mutex);
+
+	for (auto& [name, ns] : s_perf_sources)
+	{
+		s_perf_acc[name].push(ns);
+	}
+
+	std::map<std::string, std::array<u64, 66>> result;
+
+	for (auto& [name, data] : s_perf_acc)
+	{
+		auto& out = result[name];
+
+		for (u32 i = 0; i < 66; i++)
+		{
+			out[i] = data.m_log[i].load();
+		}
+	}
+
+	return result;
+}
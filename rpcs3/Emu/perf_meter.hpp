@@ -6,6 +6,8 @@
 #include "system_config.h"
 #include <array>
 #include <cmath>
+#include <map>
+#include <string>
 
 LOG_CHANNEL(perf_log, "PERF");
 
@@ -50,6 +52,9 @@ public:
 
 	// Collect all data, report it, and clean
 	static void report() noexcept;
+
+	// Collect all data without cleaning: event count, histogram of event lengths in powers of two nanoseconds, and total time
+	static std::map<std::string, std::array<u64, 66>> get_stats() noexcept;
 };
 
 // Object that prints event length stats at the end
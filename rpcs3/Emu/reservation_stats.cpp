@@ -0,0 +1,365 @@
+#include "stdafx.h"
+#include "reservation_stats.hpp"
+
+#include "util/sysinfo.hpp"
+#include "util/tsc.hpp"
+#include "Utilities/date_time.h"
+#include "Utilities/File.h"
+
+#include <algorithm>
+#include <chrono>
+
+LOG_CHANNEL(perf_log, "PERF");
+
+namespace
+{
+	constexpr usz rsrv_event_count = static_cast<usz>(rsrv_event::count);
+
+	constexpr std::string_view rsrv_event_names[rsrv_event_count]
+	{
+		"acquire",
+		"retry",
+		"success",
+		"failure",
+		"tx_abort",
+		"wait",
+	};
+
+	// Number of probed slots before an event is counted as dropped
+	constexpr u32 rsrv_max_probe = 32;
+
+	struct alignas(64) rsrv_entry
+	{
+		// Non-zero when in use, see make_line_key and make_pc_key
+		atomic_t<u32> key;
+
+		atomic_t<u64> count[rsrv_event_count];
+	};
+
+	void clear_counts(atomic_t<u64> (&count)[rsrv_event_count]) noexcept
+	{
+		for (auto& value : count)
+		{
+			value.release(0);
+		}
+	}
+
+	template <u32 Bits>
+	struct rsrv_table
+	{
+		rsrv_entry entries[1u << Bits]{};
+
+		rsrv_entry* find(u32 key) noexcept
+		{
+			u32 index = (key * 0x9e3779b1u) >> (32 - Bits);
+
+			for (u32 i = 0; i < rsrv_max_probe; i++, index = (index + 1) % (1u << Bits))
+			{
+				rsrv_entry& entry = entries[index];
+				const u32 old = entry.key.load();
+
+				if (old == key)
+				{
+					return &entry;
+				}
+
+				if (!old && entry.key.compare_and_swap_test(0, key))
+				{
+					return &entry;
+				}
+
+				if (entry.key.load() == key)
+				{
+					// Lost the race against another thread inserting the same key
+					return &entry;
+				}
+			}
+
+			return nullptr;
+		}
+
+		void clear() noexcept
+		{
+			for (rsrv_entry& entry : entries)
+			{
+				entry.key.release(0);
+				clear_counts(entry.count);
+			}
+		}
+	};
+
+	struct rsrv_second
+	{
+		// Second since the start of the recording plus one
+		atomic_t<u64> time;
+
+		atomic_t<u64> count[rsrv_event_count];
+	};
+
+	// 8192 cache lines and 4096 PCs
+	rsrv_table<13> s_lines;
+	rsrv_table<12> s_pcs;
+
+	// About 17 minutes of history, older seconds are overwritten
+	std::array<rsrv_second, 1024> s_timeline{};
+
+	atomic_t<u64> s_dropped = 0;
+
+	// Start of the recording in TSC ticks or nanoseconds
+	atomic_t<u64> s_start = 0;
+
+	u64 get_time() noexcept
+	{
+		if (utils::get_tsc_freq()) [[likely]]
+		{
+			return utils::get_tsc();
+		}
+
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	u64 get_time_freq() noexcept
+	{
+		return utils::get_tsc_freq() ? utils::get_tsc_freq() : 1'000'000'000;
+	}
+
+	// Cache line number, plus one to keep the key non-zero
+	u32 make_line_key(u32 addr) noexcept
+	{
+		return (addr / 128) + 1;
+	}
+
+	// Instructions are 4-byte aligned, the low bits tell PPU and SPU apart
+	u32 make_pc_key(u32 pc, bool is_spu) noexcept
+	{
+		return (pc & -4) | (is_spu ? 2 : 1);
+	}
+
+	u64 get_total(const atomic_t<u64> (&count)[rsrv_event_count]) noexcept
+	{
+		u64 result = 0;
+
+		for (const auto& value : count)
+		{
+			result += value.load();
+		}
+
+		return result;
+	}
+
+	// Cache lines and PCs are ranked by failed stores, transaction aborts and waits
+	u64 get_contention(const atomic_t<u64> (&count)[rsrv_event_count]) noexcept
+	{
+		return count[static_cast<usz>(rsrv_event::failure)].load() + count[static_cast<usz>(rsrv_event::tx_abort)].load() + count[static_cast<usz>(rsrv_event::wait)].load();
+	}
+
+	template <u32 Bits>
+	std::vector<const rsrv_entry*> get_ranked(const rsrv_table<Bits>& table)
+	{
+		std::vector<const rsrv_entry*> result;
+
+		for (const rsrv_entry& entry : table.entries)
+		{
+			if (entry.key.load() && get_total(entry.count))
+			{
+				result.push_back(&entry);
+			}
+		}
+
+		std::stable_sort(result.begin(), result.end(), [](const rsrv_entry* a, const rsrv_entry* b)
+		{
+			const u64 ca = get_contention(a->count);
+			const u64 cb = get_contention(b->count);
+			return ca != cb ? ca > cb : get_total(a->count) > get_total(b->count);
+		});
+
+		return result;
+	}
+
+	std::string format_key(const rsrv_entry& entry, bool is_line)
+	{
+		const u32 key = entry.key.load();
+
+		if (is_line)
+		{
+			return fmt::format("line,0x%08x", (key - 1) * 128);
+		}
+
+		return fmt::format("%s,0x%08x", key & 2 ? "spu_pc" : "ppu_pc", key & -4);
+	}
+
+	void append_counts(std::string& out, const atomic_t<u64> (&count)[rsrv_event_count])
+	{
+		for (const auto& value : count)
+		{
+			fmt::append(out, ",%u", value.load());
+		}
+
+		out += '\n';
+	}
+
+	bool write_file(const std::string& path, const std::string& data)
+	{
+		fs::pending_file file(path);
+
+		if (!file.file || file.file.write(data.data(), data.size()) < data.size() || !file.commit())
+		{
+			perf_log.error("Failed to write reservation statistics to '%s' (%s)", path, fs::g_tls_error);
+			return false;
+		}
+
+		return true;
+	}
+}
+
+void reservation_stats::push(u32 addr, u32 pc, bool is_spu, rsrv_event event) noexcept
+{
+	const usz index = static_cast<usz>(event);
+
+	if (rsrv_entry* line = s_lines.find(make_line_key(addr)))
+	{
+		line->count[index]++;
+	}
+	else
+	{
+		s_dropped++;
+	}
+
+	if (rsrv_entry* entry = s_pcs.find(make_pc_key(pc, is_spu)))
+	{
+		entry->count[index]++;
+	}
+	else
+	{
+		s_dropped++;
+	}
+
+	const u64 now = get_time();
+	u64 start = s_start.load();
+
+	if (!start) [[unlikely]]
+	{
+		s_start.compare_and_swap(0, now);
+		start = s_start.load();
+	}
+
+	const u64 second = (now > start ? now - start : 0) / get_time_freq() + 1;
+	rsrv_second& slot = s_timeline[second % s_timeline.size()];
+
+	if (slot.time.load() != second) [[unlikely]]
+	{
+		// Reuse the slot of an older second, events pushed concurrently may be lost
+		if (slot.time.exchange(second) != second)
+		{
+			clear_counts(slot.count);
+		}
+	}
+
+	slot.count[index]++;
+}
+
+bool reservation_stats::dump(const std::string& path_prefix) noexcept
+{
+	std::string header = "kind,address";
+
+	for (std::string_view name : rsrv_event_names)
+	{
+		fmt::append(header, ",%s", name);
+	}
+
+	header += '\n';
+
+	std::string ranked = header;
+
+	for (const rsrv_entry* entry : get_ranked(s_lines))
+	{
+		ranked += format_key(*entry, true);
+		append_counts(ranked, entry->count);
+	}
+
+	for (const rsrv_entry* entry : get_ranked(s_pcs))
+	{
+		ranked += format_key(*entry, false);
+		append_counts(ranked, entry->count);
+	}
+
+	std::string timeline = "second";
+
+	for (std::string_view name : rsrv_event_names)
+	{
+		fmt::append(timeline, ",%s", name);
+	}
+
+	timeline += '\n';
+
+	std::vector<const rsrv_second*> seconds;
+
+	for (const rsrv_second& slot : s_timeline)
+	{
+		if (slot.time.load())
+		{
+			seconds.push_back(&slot);
+		}
+	}
+
+	std::sort(seconds.begin(), seconds.end(), [](const rsrv_second* a, const rsrv_second* b)
+	{
+		return a->time.load() < b->time.load();
+	});
+
+	for (const rsrv_second* slot : seconds)
+	{
+		fmt::append(timeline, "%u", slot->time.load() - 1);
+		append_counts(timeline, slot->count);
+	}
+
+	return write_file(path_prefix + ".csv", ranked) && write_file(path_prefix + "_timeline.csv", timeline);
+}
+
+void reservation_stats::report() noexcept
+{
+	if (!s_start.load())
+	{
+		// Nothing was recorded
+		return;
+	}
+
+	const auto lines = get_ranked(s_lines);
+
+	perf_log.notice("Reservation statistics: %u cache lines, %u dropped events", lines.size(), s_dropped.load());
+
+	for (usz i = 0; i < lines.size() && i < 16; i++)
+	{
+		std::string counts;
+
+		for (usz j = 0; j < rsrv_event_count; j++)
+		{
+			fmt::append(counts, "%s%s=%u", j ? ", " : "", rsrv_event_names[j], lines[i]->count[j].load());
+		}
+
+		perf_log.notice("Reservation 0x%08x: %s", (lines[i]->key.load() - 1) * 128, counts);
+	}
+
+	if (g_cfg.core.reservation_stats)
+	{
+		const std::string path = fmt::format("%sRPCS3_reservations_%s", fs::get_log_dir(), date_time::current_time_narrow<'_'>());
+
+		if (dump(path))
+		{
+			perf_log.notice("Saved reservation statistics to '%s.csv'", path);
+		}
+	}
+
+	// Start a new recording, events pushed concurrently may be lost
+	s_lines.clear();
+	s_pcs.clear();
+
+	for (rsrv_second& slot : s_timeline)
+	{
+		slot.time.release(0);
+		clear_counts(slot.count);
+	}
+
+	s_dropped.release(0);
+	s_start.release(0);
+}
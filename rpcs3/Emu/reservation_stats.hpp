@@ -0,0 +1,41 @@
+#pragma once
+
+#include "util/types.hpp"
+#include "system_config.h"
+
+#include <string>
+
+enum class rsrv_event : u8
+{
+	acquire,  // LWARX/LDARX/GETLLAR of a new reservation
+	retry,    // Acquisition of the same cache line after a failed store
+	success,  // Successful STWCX/STDCX/PUTLLC
+	failure,  // Failed STWCX/STDCX/PUTLLC
+	tx_abort, // Transaction gave up, fell back to suspend_all
+	wait,     // SPU registered as a cache line waiter
+
+	count
+};
+
+// Counts reservation events per 128-byte cache line, per guest PC and per second.
+// The report is written on pause and on stop, counters are lock-free but approximate under heavy contention.
+class reservation_stats
+{
+public:
+	// Record an event, pc is the PPU instruction address or the SPU LS address
+	static void push(u32 addr, u32 pc, bool is_spu, rsrv_event event) noexcept;
+
+	// Write ranked cache lines and PCs and the timeline as CSV files with the given prefix
+	static bool dump(const std::string& path_prefix) noexcept;
+
+	// Log a summary, write the CSV files to the log directory if statistics are enabled, and clear the counters
+	static void report() noexcept;
+};
+
+FORCE_INLINE void rsrv_stat(u32 addr, u32 pc, bool is_spu, rsrv_event event) noexcept
+{
+	if (g_cfg.core.reservation_stats) [[unlikely]]
+	{
+		reservation_stats::push(addr, pc, is_spu, event);
+	}
+}
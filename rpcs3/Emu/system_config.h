@@ -26,8 +26,10 @@ struct cfg_root : cfg::node
 		cfg::_bool llvm_logs{ this, "Save LLVM logs" };
 		cfg::string llvm_cpu{ this, "Use LLVM CPU" };
 		cfg::_int<0, 1024> llvm_threads{ this, "Max LLVM Compile Threads", 0 };
+		cfg::_bool llvm_shared_compilation{ this, "Shared LLVM Compilation", false }; // Coordinate PPU compilation with other instances sharing the cache directory (SPU programs are still compiled by every instance)
 		cfg::_bool ppu_llvm_greedy_mode{ this, "PPU LLVM Greedy Mode", false, false };
 		cfg::_bool llvm_precompilation{ this, "LLVM Precompilation", true };
+		cfg::_bool cache_decrypted_executables{ this, "Cache Decrypted Executables", false }; // Keep decrypted SELF/SPRX images in cache/self_cache/ to skip decryption on the next boot (unbounded)
 		cfg::_enum<thread_scheduler_mode> thread_scheduler{this, "Thread Scheduler Mode", thread_scheduler_mode::os};
 		cfg::_bool set_daz_and_ftz{ this, "Set DAZ and FTZ", false };
 		cfg::_enum<spu_decoder_type> spu_decoder{ this, "SPU Decoder", spu_decoder_type::llvm };
@@ -99,6 +101,8 @@ struct cfg_root : cfg::node
 
 		cfg::uint64 perf_report_threshold{this, "Performance Report Threshold", 500, true}; // In µs, 0.5ms = default, 0 = everything
 		cfg::_bool perf_report{this, "Enable Performance Report", false, true}; // Show certain perf-related logs
+		cfg::_bool event_trace{this, "Enable Event Trace", false, true}; // Record a timeline of events, saved to the log directory on resume and on stop
+		cfg::_bool reservation_stats{this, "Enable Reservation Statistics", false, true}; // Count reservation events per cache line and per PC, saved to the log directory on resume and on stop
 		cfg::_bool external_debugger{this, "Assume External Debugger"};
 	} core{ this };
 
@@ -170,6 +174,8 @@ struct cfg_root : cfg::node
 		cfg::_float<-32, 32> texture_lod_bias{ this, "Texture LOD Bias Addend", 0, true };
 		cfg::_int<1, 1024> min_scalable_dimension{ this, "Minimum Scalable Dimension", 16 };
 		cfg::_int<0, 16> shader_compiler_threads_count{ this, "Shader Compiler Threads", 0 };
+		cfg::_int<0, 16> video_decoder_threads{ this, "Video Decoder Threads", 0 }; // 0 means automatic, 1 disables threaded decoding
+		cfg::_bool video_decoder_frame_threading{ this, "Video Decoder Frame Threading", false }; // Faster, but pictures are returned a few AUs later
 		cfg::_int<0, 30000000> driver_recovery_timeout{ this, "Driver Recovery Timeout", 1000000, true };
 		cfg::uint<0, 16667> driver_wakeup_delay{ this, "Driver Wake-Up Delay", 1, true };
 		cfg::_int<1, 3000> vblank_rate{ this, "Vblank Rate", 60, true }; // Changing this from 60 may affect game speed in unexpected ways
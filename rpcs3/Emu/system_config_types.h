@@ -299,7 +299,8 @@ enum class thread_scheduler_mode
 {
 	os,
 	old,
-	alt
+	alt,
+	topology
 };
 
 enum class perf_graph_detail_level
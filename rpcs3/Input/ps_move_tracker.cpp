@@ -3,6 +3,8 @@
 #include "Emu/Cell/Modules/cellGem.h"
 #include "ps_move_tracker.h"
 
+#include "util/simd.hpp"
+
 #include <cmath>
 
 #ifdef HAVE_OPENCV
@@ -231,7 +233,6 @@ void ps_move_tracker<DiagnosticsEnabled>::convert_image(s32 output_format)
 	const u32 size = height * width;
 
 	m_image_rgba.resize(size * 4);
-	m_image_hsv.resize(size * 3);
 
 	for (u32 index = 0; index < CELL_GEM_MAX_NUM; index++)
 	{
@@ -245,6 +246,7 @@ void ps_move_tracker<DiagnosticsEnabled>::convert_image(s32 output_format)
 
 	if constexpr (DiagnosticsEnabled)
 	{
+		m_image_hsv.resize(size * 3);
 		m_image_gray.resize(size);
 		m_image_rgba_contours.resize(size * 4);
 
@@ -252,6 +254,17 @@ void ps_move_tracker<DiagnosticsEnabled>::convert_image(s32 output_format)
 	}
 }
 
+template <bool DiagnosticsEnabled>
+bool ps_move_tracker<DiagnosticsEnabled>::ps_move_config::matches(u16 hue, u8 saturation, u8 value) const
+{
+	const bool wrapped_hue = min_hue > max_hue; // e.g. min=355, max=5 (red)
+
+	// Simply drop dark and colorless pixels as well as pixels that don't match our hue
+	return !((wrapped_hue ? (hue < min_hue && hue > max_hue) : (hue < min_hue || hue > max_hue)) ||
+		saturation < saturation_threshold_u8 || saturation > 200 ||
+		value < 150);
+}
+
 template <bool DiagnosticsEnabled>
 void ps_move_tracker<DiagnosticsEnabled>::process_hues()
 {
@@ -263,32 +276,171 @@ void ps_move_tracker<DiagnosticsEnabled>::process_hues()
 		std::fill(m_hues.begin(), m_hues.end(), 0);
 	}
 
-	u8* gray = nullptr;
+	// Gather the thresholds of all active devices, so that we can classify each pixel in a single pass
+	std::array<u32, CELL_GEM_MAX_NUM> active_devices{};
+	u32 active_count = 0;
+
+	for (u32 index = 0; index < CELL_GEM_MAX_NUM; index++)
+	{
+		if (m_config[index].active)
+		{
+			active_devices[active_count++] = index;
+		}
+	}
+
+	struct hsv_thresholds
+	{
+		v128 min_hue;
+		v128 max_hue;
+		bool wrapped_hue;
+		v128 saturation_min;
+	};
+
+	std::array<hsv_thresholds, CELL_GEM_MAX_NUM> thresholds{};
+
+	for (u32 i = 0; i < active_count; i++)
+	{
+		const ps_move_config& config = m_config[active_devices[i]];
+
+		// Comparisons are done with signed "greater than", so we adjust the bounds by one
+		thresholds[i].min_hue = gv_bcst32(config.min_hue - 1);
+		thresholds[i].max_hue = gv_bcst32(config.max_hue + 1);
+		thresholds[i].wrapped_hue = config.min_hue > config.max_hue;
+		thresholds[i].saturation_min = gv_bcst32(config.saturation_threshold_u8 - 1);
+	}
+
+	const v128 mask_u8 = gv_bcst32(0xff);
+	const v128 scale = gv_bcstfs(255.0f);
+	const v128 sixty = gv_bcstfs(60.0f);
+	const v128 zero = v128{};
+	const v128 hue_g_offset = gv_bcst32(120);
+	const v128 hue_b_offset = gv_bcst32(240);
+	const v128 hue_wrap = gv_bcst32(360);
+	const v128 hue_lsb = gv_bcst32(1);
+	const v128 saturation_max = gv_bcst32(201);
+	const v128 value_min = gv_bcst32(149);
+
+	// Converts 4 RGBA pixels to HSV. Bit-exact with rgb_to_hsv and the scalar quantization below.
+	// The hue keeps its full resolution, saturation and value are scaled to 0-255.
+	const auto rgba_to_hsv = [&](const u8* rgba, v128& hue, v128& saturation, v128& value)
+	{
+		const v128 pixels = v128::loadu(rgba);
+		const v128 r = gv_divfs(gv_cvts32_tofs(gv_and32(pixels, mask_u8)), scale);
+		const v128 g = gv_divfs(gv_cvts32_tofs(gv_and32(gv_shr32(pixels, 8), mask_u8)), scale);
+		const v128 b = gv_divfs(gv_cvts32_tofs(gv_and32(gv_shr32(pixels, 16), mask_u8)), scale);
+
+		const v128 cmax = gv_maxfs(gv_maxfs(r, g), b);
+		const v128 cmin = gv_minfs(gv_minfs(r, g), b);
+		const v128 delta = gv_subfs(cmax, cmin);
+
+		// Lanes with delta == 0 produce garbage here, but they are masked out below
+		const v128 hue_r = gv_cvtfs_tos32(gv_divfs(gv_mulfs(sixty, gv_subfs(g, b)), delta));
+		const v128 hue_g = gv_add32(gv_cvtfs_tos32(gv_divfs(gv_mulfs(sixty, gv_subfs(b, r)), delta)), hue_g_offset);
+		const v128 hue_b = gv_add32(gv_cvtfs_tos32(gv_divfs(gv_mulfs(sixty, gv_subfs(r, g)), delta)), hue_b_offset);
+		const v128 hue_r_wrapped = gv_select32(gv_gts32(zero, hue_r), gv_add32(hue_r, hue_wrap), hue_r);
+
+		hue = gv_select32(gv_eqfs(cmax, r), hue_r_wrapped, gv_select32(gv_eqfs(cmax, g), hue_g, hue_b));
+		hue = gv_andn32(gv_eqfs(delta, zero), hue);
+
+		const v128 sat = gv_andn32(gv_eqfs(cmax, zero), gv_divfs(delta, cmax));
+		saturation = gv_cvtfs_tos32(gv_mulfs(sat, scale));
+		value = gv_cvtfs_tos32(gv_mulfs(cmax, scale));
+	};
+
+	// Returns a mask of all lanes that match the thresholds of the given device
+	const auto classify = [&](const hsv_thresholds& t, v128 hue, const v128& sat_val_ok)
+	{
+		// Quantize like the HSV image does: hue is stored as hue / 2
+		hue = gv_andn32(hue_lsb, hue);
+
+		const v128 above_min = gv_gts32(hue, t.min_hue);
+		const v128 below_max = gv_gts32(t.max_hue, hue);
+		const v128 hue_ok = t.wrapped_hue ? gv_or32(above_min, below_max) : gv_and32(above_min, below_max);
+		return gv_and32(hue_ok, sat_val_ok);
+	};
+
+	constexpr u32 pixels_per_block = 16;
 
 	for (u32 y = 0; y < height; y++)
 	{
 		const u8* rgba = &m_image_rgba[y * width * 4];
-		u8* hsv = &m_image_hsv[y * width * 3];
+		u32 x = 0;
 
-		if constexpr (DiagnosticsEnabled)
+		for (; x + pixels_per_block <= width; x += pixels_per_block, rgba += pixels_per_block * 4)
 		{
-			gray = &m_image_gray[y * width];
+			std::array<v128, 4> hue, saturation, value, sat_val_ok;
+
+			for (u32 i = 0; i < 4; i++)
+			{
+				rgba_to_hsv(rgba + i * 16, hue[i], saturation[i], value[i]);
+
+				sat_val_ok[i] = gv_and32(gv_gts32(saturation_max, saturation[i]), gv_gts32(value[i], value_min));
+			}
+
+			for (u32 i = 0; i < active_count; i++)
+			{
+				const hsv_thresholds& t = thresholds[i];
+				std::array<v128, 4> match;
+
+				for (u32 j = 0; j < 4; j++)
+				{
+					match[j] = gv_and32(classify(t, hue[j], sat_val_ok[j]), gv_gts32(saturation[j], t.saturation_min));
+				}
+
+				// Pack the lane masks (0 or -1) into 16 bytes (0 or 255)
+				const v128 packed = gv_packss_s16(gv_packss_s32(match[0], match[1]), gv_packss_s32(match[2], match[3]));
+				v128::storeu(packed, &m_image_binary[active_devices[i]][y * width + x]);
+			}
+
+			if constexpr (DiagnosticsEnabled)
+			{
+				u8* hsv = &m_image_hsv[(y * width + x) * 3];
+				u8* gray = &m_image_gray[y * width + x];
+				const u8* src = rgba;
+
+				for (u32 i = 0; i < pixels_per_block; i++, hsv += 3, src += 4)
+				{
+					const u32 hue_value = hue[i / 4]._u32[i % 4];
+
+					hsv[0] = static_cast<u8>(hue_value / 2);
+					++m_hues[hue_value];
+					hsv[1] = static_cast<u8>(saturation[i / 4]._u32[i % 4]);
+					hsv[2] = static_cast<u8>(value[i / 4]._u32[i % 4]);
+
+					const f32 r = src[0] / 255.0f;
+					const f32 g = src[1] / 255.0f;
+					const f32 b = src[2] / 255.0f;
+					*gray++ = static_cast<u8>(std::clamp((0.299f * r + 0.587f * g + 0.114f * b) * 255.0f, 0.0f, 255.0f));
+				}
+			}
 		}
 
-		for (u32 x = 0; x < width; x++, rgba += 4, hsv += 3)
+		// Scalar tail
+		for (; x < width; x++, rgba += 4)
 		{
 			const f32 r = rgba[0] / 255.0f;
 			const f32 g = rgba[1] / 255.0f;
 			const f32 b = rgba[2] / 255.0f;
 			const auto [hue, saturation, value] = rgb_to_hsv(r, g, b);
 
-			hsv[0] = static_cast<u8>(hue / 2);
-			hsv[1] = static_cast<u8>(saturation * 255.0f);
-			hsv[2] = static_cast<u8>(value * 255.0f);
+			const u8 hsv_hue = static_cast<u8>(hue / 2);
+			const u8 hsv_saturation = static_cast<u8>(saturation * 255.0f);
+			const u8 hsv_value = static_cast<u8>(value * 255.0f);
+
+			for (u32 i = 0; i < active_count; i++)
+			{
+				const u32 index = active_devices[i];
+				m_image_binary[index][y * width + x] = m_config[index].matches(hsv_hue * 2, hsv_saturation, hsv_value) ? 255 : 0;
+			}
 
 			if constexpr (DiagnosticsEnabled)
 			{
-				*gray++ = static_cast<u8>(std::clamp((0.299f * r + 0.587f * g + 0.114f * b) * 255.0f, 0.0f, 255.0f));
+				u8* hsv = &m_image_hsv[(y * width + x) * 3];
+				hsv[0] = hsv_hue;
+				hsv[1] = hsv_saturation;
+				hsv[2] = hsv_value;
+
+				m_image_gray[y * width + x] = static_cast<u8>(std::clamp((0.299f * r + 0.587f * g + 0.114f * b) * 255.0f, 0.0f, 255.0f));
 				++m_hues[hue];
 			}
 		}
@@ -344,46 +496,17 @@ void ps_move_tracker<DiagnosticsEnabled>::draw_sphere_size_range(f32 result_radi
 template <bool DiagnosticsEnabled>
 void ps_move_tracker<DiagnosticsEnabled>::process_contours(ps_move_info& info, u32 index)
 {
-	const ps_move_config& config = ::at32(m_config, index);
-	const std::vector<u8>& image_hsv = m_image_hsv;
 	std::vector<u8>& image_binary = ::at32(m_image_binary, index);
 
 	const u32 width = m_width;
 	const u32 height = m_height;
-	const bool wrapped_hue = config.min_hue > config.max_hue; // e.g. min=355, max=5 (red)
 
 	info.x_max = width;
 	info.y_max = height;
 
-	// Map memory
+	// Map memory. The image was already filtered by process_hues.
 	cv::Mat binary(cv::Size(width, height), CV_8UC1, image_binary.data(), 0);
 
-	// Filter image
-	for (u32 y = 0; y < height; y++)
-	{
-		const u8* src = &image_hsv[y * width * 3];
-		u8* dst = &image_binary[y * width];
-
-		for (u32 x = 0; x < width; x++, src += 3)
-		{
-			const u16 hue = src[0] * 2;
-			const u8 saturation = src[1];
-			const u8 value = src[2];
-
-			// Simply drop dark and colorless pixels as well as pixels that don't match our hue
-			if ((wrapped_hue ? (hue < config.min_hue && hue > config.max_hue) : (hue < config.min_hue || hue > config.max_hue)) ||
-				saturation < config.saturation_threshold_u8 || saturation > 200 ||
-				value < 150 || value > 255)
-			{
-				dst[x] = 0;
-			}
-			else
-			{
-				dst[x] = 255;
-			}
-		}
-	}
-
 	// Remove all small outer contours
 	if (m_filter_small_contours)
 	{
@@ -71,6 +71,7 @@ private:
 		f32 saturation_threshold = 0.0f;
 
 		void calculate_values();
+		bool matches(u16 hue, u8 saturation, u8 value) const;
 	};
 
 	void set_valid(ps_move_info& info, u32 index, bool valid);
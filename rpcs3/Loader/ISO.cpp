@@ -0,0 +1,1031 @@
+#include "stdafx.h"
+#include "ISO.h"
+
+#include "Utilities/File.h"
+#include "Utilities/StrUtil.h"
+#include "Utilities/Thread.h"
+#include "util/asm.hpp"
+#include "util/sysinfo.hpp"
+
+#include <zstd.h>
+
+#include <chrono>
+#include <deque>
+#include <list>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+
+LOG_CHANNEL(iso_log, "ISO");
+
+namespace disc_image
+{
+	constexpr u32 c_sector_size = 2048;
+
+	// Memory used by the decompressed block cache of an image
+	constexpr usz c_block_cache_size = 64 << 20;
+	static_assert(c_block_cache_size / compressed_max_block_size >= 16);
+
+	// Uncompressed view of a compressed image, thread-safe for read_at
+	class compressed_image final : public fs::file_base
+	{
+		struct block
+		{
+			std::vector<u8> data;
+			atomic_t<u32> state{0}; // 0: pending, 1: ready, 2: failed
+		};
+
+		const fs::file m_file;
+		const u64 m_size;
+		const u32 m_block_size;
+		const std::vector<u64> m_index;
+
+		u64 m_pos = 0;
+
+		// Decompressed block cache
+		std::mutex m_mutex;
+		std::list<u64> m_lru; // Most recently used first
+		std::unordered_map<u64, std::pair<std::shared_ptr<block>, std::list<u64>::iterator>> m_cache;
+		usz m_cache_max = 0; // Blocks fitting in c_block_cache_size
+
+		// Read-ahead
+		atomic_t<u64> m_last_block{umax};
+		std::deque<u64> m_prefetch;
+		atomic_t<u32> m_prefetch_signal{0};
+		u32 m_prefetch_depth = 0;
+
+		std::unique_ptr<named_thread_group<std::function<void()>>> m_workers;
+
+		bool decompress(u64 index, std::vector<u8>& out) const
+		{
+			const u64 offset = m_index[index];
+			const u64 size = m_index[index + 1] - offset;
+
+			out.resize(std::min<u64>(m_block_size, m_size - index * m_block_size));
+
+			if (size == out.size())
+			{
+				// Stored uncompressed
+				return m_file.read_at(offset, out.data(), size) == size;
+			}
+
+			thread_local std::vector<u8> s_src;
+			thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> s_ctx{ZSTD_createDCtx(), ZSTD_freeDCtx};
+
+			s_src.resize(size);
+
+			if (!s_ctx || m_file.read_at(offset, s_src.data(), size) != size)
+			{
+				return false;
+			}
+
+			const usz result = ZSTD_decompressDCtx(s_ctx.get(), out.data(), out.size(), s_src.data(), s_src.size());
+
+			if (ZSTD_isError(result) || result != out.size())
+			{
+				iso_log.error("Failed to decompress block %u (%s)", index, ZSTD_isError(result) ? ZSTD_getErrorName(result) : "size mismatch");
+				return false;
+			}
+
+			return true;
+		}
+
+		std::shared_ptr<block> get_block(u64 index)
+		{
+			std::shared_ptr<block> result;
+			bool is_owner = false;
+
+			{
+				std::lock_guard lock(m_mutex);
+
+				if (auto found = m_cache.find(index); found != m_cache.end())
+				{
+					result = found->second.first;
+					m_lru.splice(m_lru.begin(), m_lru, found->second.second);
+				}
+				else
+				{
+					result = std::make_shared<block>();
+					m_lru.push_front(index);
+					m_cache.emplace(index, std::make_pair(result, m_lru.begin()));
+					is_owner = true;
+
+					while (m_cache.size() > m_cache_max)
+					{
+						// Blocks still in use are kept alive by their users
+						m_cache.erase(m_lru.back());
+						m_lru.pop_back();
+					}
+				}
+			}
+
+			if (is_owner)
+			{
+				result->state.release(decompress(index, result->data) ? 1 : 2);
+				result->state.notify_all();
+			}
+			else
+			{
+				while (!result->state)
+				{
+					result->state.wait(0);
+				}
+			}
+
+			if (result->state != 1)
+			{
+				std::lock_guard lock(m_mutex);
+
+				// Allow retrying
+				if (auto found = m_cache.find(index); found != m_cache.end() && found->second.first == result)
+				{
+					m_lru.erase(found->second.second);
+					m_cache.erase(found);
+				}
+
+				return nullptr;
+			}
+
+			return result;
+		}
+
+		void read_ahead(u64 index)
+		{
+			// Only sequential access is worth prefetching
+			if (!m_workers || m_last_block.exchange(index) + 1 != index)
+			{
+				return;
+			}
+
+			{
+				std::lock_guard lock(m_mutex);
+
+				for (u64 i = index + 1; i <= index + m_prefetch_depth && i + 1 < m_index.size(); i++)
+				{
+					if (!m_cache.contains(i) && std::find(m_prefetch.begin(), m_prefetch.end(), i) == m_prefetch.end())
+					{
+						m_prefetch.push_back(i);
+					}
+				}
+
+				// Drop outdated requests
+				while (m_prefetch.size() > m_prefetch_depth * 2)
+				{
+					m_prefetch.pop_front();
+				}
+			}
+
+			m_prefetch_signal++;
+			m_prefetch_signal.notify_all();
+		}
+
+	public:
+		compressed_image(fs::file&& file, const compressed_header& header, std::vector<u64>&& index)
+			: m_file(std::move(file))
+			, m_size(header.image_size)
+			, m_block_size(header.block_size)
+			, m_index(std::move(index))
+		{
+			m_cache_max = c_block_cache_size / m_block_size;
+
+			if (const u32 workers = std::min<u32>(utils::get_thread_count() / 4, 2))
+			{
+				m_prefetch_depth = workers * 4;
+
+				m_workers = std::make_unique<named_thread_group<std::function<void()>>>("Disc Image Reader ", workers, [this]()
+				{
+					for (u32 seen = 0; thread_ctrl::state() != thread_state::aborting;)
+					{
+						u64 index = umax;
+
+						{
+							std::lock_guard lock(m_mutex);
+
+							if (!m_prefetch.empty())
+							{
+								index = m_prefetch.front();
+								m_prefetch.pop_front();
+							}
+						}
+
+						if (index != umax)
+						{
+							get_block(index);
+							continue;
+						}
+
+						const u32 signal = m_prefetch_signal.load();
+
+						if (signal == seen)
+						{
+							thread_ctrl::wait_on(m_prefetch_signal, signal);
+						}
+
+						seen = signal;
+					}
+				});
+			}
+		}
+
+		~compressed_image() override
+		{
+			m_workers.reset();
+		}
+
+		fs::stat_t get_stat() override
+		{
+			fs::stat_t stat = m_file.get_stat();
+			stat.size = m_size;
+			stat.is_writable = false;
+			return stat;
+		}
+
+		bool trunc(u64) override
+		{
+			fs::g_tls_error = fs::error::readonly;
+			return false;
+		}
+
+		u64 read(void* buffer, u64 size) override
+		{
+			const u64 result = compressed_image::read_at(m_pos, buffer, size);
+			m_pos += result;
+			return result;
+		}
+
+		u64 read_at(u64 offset, void* buffer, u64 size) override
+		{
+			if (offset >= m_size)
+			{
+				return 0;
+			}
+
+			size = std::min<u64>(size, m_size - offset);
+
+			u64 result = 0;
+
+			while (result < size)
+			{
+				const u64 pos = offset + result;
+				const u64 index = pos / m_block_size;
+				const u64 block_offset = pos % m_block_size;
+
+				read_ahead(index);
+
+				const auto data = get_block(index);
+
+				if (!data)
+				{
+					break;
+				}
+
+				const u64 copy = std::min<u64>(size - result, data->data.size() - block_offset);
+				std::memcpy(static_cast<u8*>(buffer) + result, data->data.data() + block_offset, copy);
+				result += copy;
+			}
+
+			return result;
+		}
+
+		u64 write(const void*, u64) override
+		{
+			fs::g_tls_error = fs::error::readonly;
+			return 0;
+		}
+
+		u64 seek(s64 offset, fs::seek_mode whence) override
+		{
+			const s64 new_pos =
+				whence == fs::seek_set ? offset :
+				whence == fs::seek_cur ? offset + m_pos :
+				whence == fs::seek_end ? offset + m_size : -1;
+
+			if (new_pos < 0)
+			{
+				fs::g_tls_error = fs::error::inval;
+				return -1;
+			}
+
+			m_pos = new_pos;
+			return m_pos;
+		}
+
+		u64 size() override
+		{
+			return m_size;
+		}
+	};
+
+	// Open an image for reading its uncompressed contents
+	static fs::file open_image(const std::string& path)
+	{
+		fs::file file(path, fs::read + fs::isfile);
+
+		if (!file)
+		{
+			return {};
+		}
+
+		compressed_header header{};
+
+		if (!file.read(header) || header.magic != compressed_magic)
+		{
+			return file;
+		}
+
+		if (header.version != compressed_version || header.block_size < c_sector_size || header.block_size > compressed_max_block_size)
+		{
+			iso_log.error("Unsupported compressed image '%s' (version=%u, block_size=0x%x)", path, header.version, header.block_size);
+			return {};
+		}
+
+		const u64 count = utils::aligned_div<u64>(header.image_size, header.block_size);
+		const u64 file_size = file.size();
+
+		if (count >= file_size / sizeof(u64))
+		{
+			iso_log.error("Invalid compressed image '%s' (block count=%u)", path, count);
+			return {};
+		}
+
+		std::vector<le_t<u64>> raw_index(count + 1);
+
+		if (!file.read(raw_index))
+		{
+			return {};
+		}
+
+		std::vector<u64> index(raw_index.begin(), raw_index.end());
+
+		for (u64 i = 0; i < count; i++)
+		{
+			const u64 size = std::min<u64>(header.block_size, header.image_size - i * header.block_size);
+
+			if (index[i] > index[i + 1] || index[i + 1] > file_size || index[i + 1] - index[i] > std::max<u64>(size, ZSTD_compressBound(size)))
+			{
+				iso_log.error("Invalid compressed image '%s' (block %u)", path, i);
+				return {};
+			}
+		}
+
+		fs::file result;
+		result.reset(std::make_unique<compressed_image>(std::move(file), header, std::move(index)));
+		return result;
+	}
+
+	struct iso_extent
+	{
+		u64 offset;
+		u64 size;
+	};
+
+	struct iso_node
+	{
+		fs::dir_entry info;
+		std::vector<iso_extent> extents;
+		std::vector<u32> children;
+	};
+
+	// ISO9660 file system (with Joliet names if available)
+	class iso_archive
+	{
+		fs::file m_image;
+		std::vector<iso_node> m_nodes;
+		std::unordered_map<std::string, u32> m_paths; // Path without leading slash -> node
+
+		struct record
+		{
+			u32 lba;
+			u32 size;
+			u8 flags;
+			s64 time;
+			std::string name;
+		};
+
+		static bool parse_record(std::span<const u8> data, bool joliet, record& out)
+		{
+			if (data.size() < 33 || data[0] < 33 + data[32] || data[0] > data.size())
+			{
+				return false;
+			}
+
+			out.lba = read_from_ptr<le_t<u32>>(data.data(), 2);
+			out.size = read_from_ptr<le_t<u32>>(data.data(), 10);
+			out.flags = data[25];
+
+			// Recording date (years since 1900, GMT offset in 15 minute units)
+			using namespace std::chrono;
+			const sys_days date = year_month_day{year{data[18] + 1900}, month{data[19]}, day{data[20]}};
+			out.time = s64{date.time_since_epoch().count()} * 86400 + data[21] * 3600 + data[22] * 60 + data[23] - static_cast<s8>(data[24]) * 900;
+
+			const auto name = data.subspan(33, data[32]);
+
+			if (name.size() == 1 && name[0] <= 1)
+			{
+				// "." or ".."
+				out.name.clear();
+				return true;
+			}
+
+			if (joliet)
+			{
+				std::u16string name16(name.size() / 2, u'\0');
+
+				for (usz i = 0; i < name16.size(); i++)
+				{
+					name16[i] = static_cast<char16_t>(name[i * 2] << 8 | name[i * 2 + 1]);
+				}
+
+				out.name = utf16_to_utf8(name16);
+			}
+			else
+			{
+				out.name.assign(name.begin(), name.end());
+			}
+
+			// Remove version suffix and the empty extension
+			if (const usz pos = out.name.find_last_of(';'); pos != umax)
+			{
+				out.name.resize(pos);
+			}
+
+			if (out.name.ends_with('.'))
+			{
+				out.name.pop_back();
+			}
+
+			return !out.name.empty() && out.name.find('/') == umax;
+		}
+
+	public:
+		bool load(fs::file&& image)
+		{
+			m_image = std::move(image);
+
+			std::array<u8, c_sector_size> sector{};
+			std::optional<record> primary, joliet;
+
+			for (u64 lba = 16; lba < 64; lba++)
+			{
+				if (m_image.read_at(lba * c_sector_size, sector.data(), sector.size()) != sector.size() || std::memcmp(sector.data() + 1, "CD001", 5) != 0)
+				{
+					break;
+				}
+
+				if (sector[0] == 255)
+				{
+					// Terminator
+					break;
+				}
+
+				if (sector[0] == 1 && !primary && read_from_ptr<le_t<u16>>(sector.data(), 128) == c_sector_size)
+				{
+					primary.emplace();
+
+					if (!parse_record(std::span(sector).subspan(156, 34), false, *primary))
+					{
+						primary.reset();
+					}
+				}
+				else if (sector[0] == 2 && !joliet && sector[88] == '%' && sector[89] == '/' && (sector[90] == '@' || sector[90] == 'C' || sector[90] == 'E'))
+				{
+					joliet.emplace();
+
+					if (!parse_record(std::span(sector).subspan(156, 34), true, *joliet))
+					{
+						joliet.reset();
+					}
+				}
+			}
+
+			if (!primary && !joliet)
+			{
+				return false;
+			}
+
+			const bool is_joliet = joliet.has_value();
+			const record& root = is_joliet ? *joliet : *primary;
+
+			iso_node& root_node = m_nodes.emplace_back();
+			root_node.info.is_directory = true;
+			root_node.info.atime = root_node.info.mtime = root_node.info.ctime = root.time;
+			m_paths.emplace("", 0);
+
+			struct pending_dir
+			{
+				u32 node;
+				u32 lba;
+				u32 size;
+				u32 depth;
+				std::string path;
+			};
+
+			std::vector<pending_dir> queue{{0, root.lba, root.size, 0, {}}};
+			std::unordered_set<u32> visited{root.lba};
+			std::vector<u8> data;
+
+			while (!queue.empty())
+			{
+				const pending_dir dir = std::move(queue.back());
+				queue.pop_back();
+
+				if (dir.size > 0x400'0000)
+				{
+					iso_log.error("Directory '/%s' is too large (0x%x)", dir.path, dir.size);
+					return false;
+				}
+
+				data.resize(dir.size);
+
+				if (m_image.read_at(u64{dir.lba} * c_sector_size, data.data(), data.size()) != data.size())
+				{
+					iso_log.error("Failed to read directory '/%s'", dir.path);
+					return false;
+				}
+
+				u32 multi_extent = umax;
+
+				for (usz pos = 0; pos < data.size();)
+				{
+					if (!data[pos])
+					{
+						// Records don't cross sector boundaries
+						pos = utils::align<usz>(pos + 1, c_sector_size);
+						continue;
+					}
+
+					record rec{};
+
+					if (!parse_record(std::span(data).subspan(pos), is_joliet, rec))
+					{
+						iso_log.error("Invalid directory record in '/%s' at 0x%x", dir.path, pos);
+						return false;
+					}
+
+					pos += data[pos];
+
+					if (rec.name.empty())
+					{
+						continue;
+					}
+
+					const iso_extent extent{u64{rec.lba} * c_sector_size, rec.size};
+
+					if (multi_extent != umax && m_nodes[multi_extent].info.name == rec.name)
+					{
+						// Continuation of a file larger than 4GB
+						m_nodes[multi_extent].extents.push_back(extent);
+						m_nodes[multi_extent].info.size += rec.size;
+						multi_extent = rec.flags & 0x80 ? multi_extent : umax;
+						continue;
+					}
+
+					const u32 index = ::size32(m_nodes);
+					const bool is_dir = !!(rec.flags & 0x2);
+
+					iso_node& node = m_nodes.emplace_back();
+					node.info.name = std::move(rec.name);
+					node.info.is_directory = is_dir;
+					node.info.size = is_dir ? 0 : rec.size;
+					node.info.atime = node.info.mtime = node.info.ctime = rec.time;
+
+					if (!is_dir)
+					{
+						node.extents.push_back(extent);
+					}
+
+					m_nodes[dir.node].children.push_back(index);
+					multi_extent = rec.flags & 0x80 ? index : umax;
+
+					std::string path = dir.path.empty() ? node.info.name : dir.path + "/" + node.info.name;
+
+					if (is_dir && dir.depth < 64 && visited.emplace(rec.lba).second)
+					{
+						queue.push_back({index, rec.lba, rec.size, dir.depth + 1, path});
+					}
+
+					m_paths.emplace(std::move(path), index);
+				}
+			}
+
+			iso_log.notice("Loaded %s file system (%u entries)", is_joliet ? "Joliet" : "ISO9660", m_nodes.size());
+			return true;
+		}
+
+		const iso_node* find(const std::string& path) const
+		{
+			if (auto found = m_paths.find(path); found != m_paths.end())
+			{
+				return &m_nodes[found->second];
+			}
+
+			return nullptr;
+		}
+
+		const iso_node& get(u32 index) const
+		{
+			return m_nodes[index];
+		}
+
+		const fs::file& image() const
+		{
+			return m_image;
+		}
+	};
+
+	// File inside of the image
+	class iso_file final : public fs::file_base
+	{
+		const std::shared_ptr<iso_archive> m_archive;
+		const iso_node& m_node;
+		u64 m_pos = 0;
+
+	public:
+		iso_file(std::shared_ptr<iso_archive> archive, const iso_node& node)
+			: m_archive(std::move(archive))
+			, m_node(node)
+		{
+		}
+
+		fs::stat_t get_stat() override
+		{
+			return m_node.info;
+		}
+
+		bool trunc(u64) override
+		{
+			fs::g_tls_error = fs::error::readonly;
+			return false;
+		}
+
+		u64 read(void* buffer, u64 size) override
+		{
+			const u64 result = iso_file::read_at(m_pos, buffer, size);
+			m_pos += result;
+			return result;
+		}
+
+		u64 read_at(u64 offset, void* buffer, u64 size) override
+		{
+			u64 result = 0;
+
+			for (const iso_extent& extent : m_node.extents)
+			{
+				if (offset >= extent.size)
+				{
+					offset -= extent.size;
+					continue;
+				}
+
+				const u64 block = std::min<u64>(size - result, extent.size - offset);
+				const u64 nread = m_archive->image().read_at(extent.offset + offset, static_cast<u8*>(buffer) + result, block);
+
+				result += nread;
+				offset = 0;
+
+				if (nread < block || result == size)
+				{
+					break;
+				}
+			}
+
+			return result;
+		}
+
+		u64 write(const void*, u64) override
+		{
+			fs::g_tls_error = fs::error::readonly;
+			return 0;
+		}
+
+		u64 seek(s64 offset, fs::seek_mode whence) override
+		{
+			const s64 new_pos =
+				whence == fs::seek_set ? offset :
+				whence == fs::seek_cur ? offset + m_pos :
+				whence == fs::seek_end ? offset + m_node.info.size : -1;
+
+			if (new_pos < 0)
+			{
+				fs::g_tls_error = fs::error::inval;
+				return -1;
+			}
+
+			m_pos = new_pos;
+			return m_pos;
+		}
+
+		u64 size() override
+		{
+			return m_node.info.size;
+		}
+	};
+
+	class iso_dir final : public fs::dir_base
+	{
+		std::vector<fs::dir_entry> m_entries;
+		usz m_pos = 0;
+
+	public:
+		iso_dir(const iso_archive& archive, const iso_node& node)
+		{
+			m_entries.reserve(node.children.size() + 2);
+
+			fs::dir_entry& self = m_entries.emplace_back(node.info);
+			self.name = ".";
+			fs::dir_entry& parent = m_entries.emplace_back(node.info);
+			parent.name = "..";
+
+			for (u32 child : node.children)
+			{
+				m_entries.emplace_back(archive.get(child).info);
+			}
+		}
+
+		bool read(fs::dir_entry& out) override
+		{
+			if (m_pos >= m_entries.size())
+			{
+				return false;
+			}
+
+			out = m_entries[m_pos++];
+			return true;
+		}
+
+		void rewind() override
+		{
+			m_pos = 0;
+		}
+	};
+
+	class iso_device final : public fs::device_base
+	{
+		const std::shared_ptr<iso_archive> m_archive;
+		const std::string m_source;
+		const std::string m_root;
+
+		const iso_node* lookup(const std::string& path) const
+		{
+			std::vector<std::string> parts;
+
+			if (path.starts_with(m_root))
+			{
+				for (std::string& part : fmt::split(std::string_view(path).substr(m_root.size()), {"/", "\\"}))
+				{
+					if (part == "..")
+					{
+						if (!parts.empty())
+						{
+							parts.pop_back();
+						}
+					}
+					else if (part != ".")
+					{
+						parts.push_back(std::move(part));
+					}
+				}
+
+				if (const iso_node* node = m_archive->find(fmt::merge(parts, "/")))
+				{
+					return node;
+				}
+			}
+
+			fs::g_tls_error = fs::error::noent;
+			return nullptr;
+		}
+
+	public:
+		iso_device(std::shared_ptr<iso_archive> archive, std::string source, std::string_view name)
+			: m_archive(std::move(archive))
+			, m_source(std::move(source))
+			, m_root(fs_prefix + std::string(name))
+		{
+		}
+
+		const std::string& source() const
+		{
+			return m_source;
+		}
+
+		const std::string& root() const
+		{
+			return m_root;
+		}
+
+		bool stat(const std::string& path, fs::stat_t& info) override
+		{
+			if (const iso_node* node = lookup(path))
+			{
+				info = node->info;
+				return true;
+			}
+
+			return false;
+		}
+
+		bool statfs(const std::string& path, fs::device_stat& info) override
+		{
+			if (!lookup(path))
+			{
+				return false;
+			}
+
+			info.block_size = c_sector_size;
+			info.total_size = m_archive->image().size();
+			info.total_free = 0;
+			info.avail_free = 0;
+			return true;
+		}
+
+		std::unique_ptr<fs::file_base> open(const std::string& path, bs_t<fs::open_mode> mode) override
+		{
+			if (mode & (fs::write + fs::append + fs::create + fs::trunc))
+			{
+				fs::g_tls_error = fs::error::readonly;
+				return nullptr;
+			}
+
+			const iso_node* node = lookup(path);
+
+			if (!node)
+			{
+				return nullptr;
+			}
+
+			if (node->info.is_directory)
+			{
+				fs::g_tls_error = fs::error::isdir;
+				return nullptr;
+			}
+
+			return std::make_unique<iso_file>(m_archive, *node);
+		}
+
+		std::unique_ptr<fs::dir_base> open_dir(const std::string& path) override
+		{
+			const iso_node* node = lookup(path);
+
+			if (!node)
+			{
+				return nullptr;
+			}
+
+			if (!node->info.is_directory)
+			{
+				fs::g_tls_error = fs::error::inval;
+				return nullptr;
+			}
+
+			return std::make_unique<iso_dir>(*m_archive, *node);
+		}
+	};
+
+	static std::mutex s_mount_mutex;
+	static shared_ptr<iso_device> s_mounted;
+
+	image_type get_image_type(const std::string& path)
+	{
+		fs::file file(path, fs::read + fs::isfile);
+
+		if (!file)
+		{
+			return image_type::invalid;
+		}
+
+		if (compressed_header header{}; file.read(header) && header.magic == compressed_magic)
+		{
+			return image_type::compressed;
+		}
+
+		// Primary volume descriptor identifier
+		char id[5]{};
+
+		if (file.read_at(16 * c_sector_size + 1, id, sizeof(id)) == sizeof(id) && std::memcmp(id, "CD001", 5) == 0)
+		{
+			return image_type::iso;
+		}
+
+		return image_type::invalid;
+	}
+
+	std::string mount(const std::string& path)
+	{
+		std::lock_guard lock(s_mount_mutex);
+
+		if (s_mounted && s_mounted->source() == path)
+		{
+			return s_mounted->root();
+		}
+
+		auto archive = std::make_shared<iso_archive>();
+
+		if (fs::file image = open_image(path); !image || !archive->load(std::move(image)))
+		{
+			iso_log.error("Failed to mount disc image '%s'", path);
+			return {};
+		}
+
+		// Replace the previous image, opened files keep it alive
+		constexpr std::string_view name = "disc_image";
+
+		fs::set_virtual_device(std::string(name), null_ptr);
+
+		auto device = stx::make_shared<iso_device>(std::move(archive), path, name);
+
+		if (!fs::set_virtual_device(std::string(name), device))
+		{
+			iso_log.error("Failed to register disc image device (%s)", fs::g_tls_error);
+			s_mounted.reset();
+			return {};
+		}
+
+		s_mounted = std::move(device);
+
+		iso_log.success("Mounted disc image '%s' at '%s'", path, s_mounted->root());
+		return s_mounted->root();
+	}
+
+	std::string get_source_path(const std::string& path)
+	{
+		std::lock_guard lock(s_mount_mutex);
+
+		if (s_mounted && path.starts_with(s_mounted->root()))
+		{
+			return s_mounted->source();
+		}
+
+		return {};
+	}
+
+	bool compress(const fs::file& src, fs::file& dst, u32 block_size, s32 level)
+	{
+		if (block_size < c_sector_size || block_size > compressed_max_block_size)
+		{
+			iso_log.error("Unsupported block size for a compressed image (0x%x)", block_size);
+			return false;
+		}
+
+		const u64 image_size = src.size();
+		const u64 count = utils::aligned_div<u64>(image_size, block_size);
+
+		compressed_header header{};
+		header.magic = compressed_magic;
+		header.version = compressed_version;
+		header.block_size = block_size;
+		header.image_size = image_size;
+
+		std::vector<le_t<u64>> index(count + 1);
+
+		const u64 index_size = index.size() * sizeof(u64);
+
+		// Write placeholder index
+		if (dst.write(&header, sizeof(header)) != sizeof(header) || dst.write(index.data(), index_size) != index_size)
+		{
+			return false;
+		}
+
+		std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> ctx{ZSTD_createCCtx(), ZSTD_freeCCtx};
+
+		if (!ctx || ZSTD_isError(ZSTD_CCtx_setParameter(ctx.get(), ZSTD_c_compressionLevel, level)))
+		{
+			return false;
+		}
+
+		std::vector<u8> in(block_size);
+		std::vector<u8> out(ZSTD_compressBound(block_size));
+
+		u64 offset = sizeof(header) + index_size;
+
+		for (u64 i = 0; i < count; i++)
+		{
+			const u64 size = std::min<u64>(block_size, image_size - i * block_size);
+
+			if (src.read_at(i * block_size, in.data(), size) != size)
+			{
+				return false;
+			}
+
+			const usz csize = ZSTD_compress2(ctx.get(), out.data(), out.size(), in.data(), size);
+
+			// Store uncompressed if it doesn't shrink
+			const bool is_raw = ZSTD_isError(csize) || csize >= size;
+			const u64 written = is_raw ? size : csize;
+
+			if (dst.write(is_raw ? in.data() : out.data(), written) != written)
+			{
+				return false;
+			}
+
+			index[i] = offset;
+			offset += written;
+		}
+
+		index[count] = offset;
+
+		dst.seek(sizeof(header));
+		return dst.write(index.data(), index_size) == index_size;
+	}
+}
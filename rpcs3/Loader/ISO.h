@@ -0,0 +1,47 @@
+#pragma once
+
+#include "util/types.hpp"
+#include "util/endian.hpp"
+
+#include <string>
+
+namespace fs
+{
+	class file;
+}
+
+namespace disc_image
+{
+	enum class image_type
+	{
+		invalid,
+		iso,        // Plain ISO9660 image
+		compressed, // ISO9660 image compressed in independent zstd blocks
+	};
+
+	// Compressed image header, followed by (block count + 1) offsets of the blocks in the file (le_t<u64>) and the blocks
+	// A block which is as large as its uncompressed size is stored uncompressed
+	struct compressed_header
+	{
+		le_t<u64> magic;
+		le_t<u32> version;
+		le_t<u32> block_size;
+		le_t<u64> image_size; // Uncompressed size
+		le_t<u64> reserved;
+	};
+
+	constexpr u64 compressed_magic = "RPCS3RZI"_u64;
+	constexpr u32 compressed_version = 1;
+	constexpr u32 compressed_max_block_size = 4 << 20;
+
+	image_type get_image_type(const std::string& path);
+
+	// Mount the image as a read-only virtual device, returns its root directory or an empty string on failure
+	std::string mount(const std::string& path);
+
+	// Get the image path if the path points inside of a mounted image (empty string otherwise)
+	std::string get_source_path(const std::string& path);
+
+	// Write an image in the compressed format
+	bool compress(const fs::file& src, fs::file& dst, u32 block_size = 0x40000, s32 level = 9);
+}
@@ -8,8 +8,27 @@
 #include "Emu/Cell/Modules/sceNpTrophy.h"
 #include "Emu/Io/Null/null_camera_handler.h"
 #include "Emu/Io/Null/null_music_handler.h"
+#include "Emu/IdManager.h"
+#include "Emu/Cell/PPUThread.h"
+#include "Emu/Cell/SPUThread.h"
+#include "Emu/RSX/RSXThread.h"
+#include "Emu/perf_meter.hpp"
+#include "Emu/benchmark.hpp"
+#include "rpcs3_version.h"
+#include "util/cpu_stats.hpp"
+#include "util/sysinfo.hpp"
 
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
 #include <clocale>
+#include <cmath>
+
+LOG_CHANNEL(sys_log, "SYS");
 
 [[noreturn]] void report_fatal_error(std::string_view text, bool is_html = false, bool include_help_text = true);
 
@@ -189,3 +208,377 @@ void headless_application::CallFromMainThread(const std::function<void()>& func,
 		wake_up->notify_one();
 	}
 }
+
+struct headless_application::benchmark_state
+{
+	benchmark_settings settings;
+	QTimer* timer = nullptr;
+	utils::cpu_stats cpu_stats;
+
+	bool was_running = false;
+	bool measuring = false;
+	u64 first_flip = 0;     // Index of the flip which starts the measurement
+	u64 start_time = 0;     // Microseconds
+	u64 start_cpu_time = 0; // Process CPU time in nanoseconds
+	u64 samples = 0;
+	f64 cpu_usage_sum = 0.;
+	u64 ppu_cycles = 0;
+	u64 spu_cycles = 0;
+	u64 rsx_cycles = 0;
+
+	// Accumulate the CPU time of the emulated threads since the previous call
+	void sample_threads()
+	{
+		idm::select<named_thread<ppu_thread>>([this](u32, named_thread<ppu_thread>& ppu)
+		{
+			ppu_cycles += thread_ctrl::get_cycles(ppu);
+		});
+
+		idm::select<named_thread<spu_thread>>([this](u32, named_thread<spu_thread>& spu)
+		{
+			spu_cycles += thread_ctrl::get_cycles(spu);
+		});
+
+		if (auto rsx = rsx::get_current_renderer())
+		{
+			rsx_cycles += rsx->get_cycles();
+		}
+	}
+};
+
+// Thread CPU time is counted in TSC cycles on Windows and in nanoseconds elsewhere
+static f64 thread_time_to_seconds(u64 value)
+{
+#ifdef _WIN32
+	if (const u64 freq = utils::get_tsc_freq())
+	{
+		return value / static_cast<f64>(freq);
+	}
+#endif
+
+	return value / 1'000'000'000.;
+}
+
+void headless_application::StartBenchmark(const benchmark_settings& settings)
+{
+	m_benchmark = std::make_shared<benchmark_state>();
+	m_benchmark->settings = settings;
+
+	if (!settings.max_flips && !settings.max_seconds)
+	{
+		m_benchmark->settings.max_seconds = 60;
+	}
+
+	sys_log.notice("Benchmark: output='%s', warmup=%u flips, limit=%u flips, %u seconds", settings.output_path, settings.warmup_flips, m_benchmark->settings.max_flips, m_benchmark->settings.max_seconds);
+
+	benchmark_stats::enable();
+
+	m_benchmark->timer = new QTimer(this);
+	connect(m_benchmark->timer, &QTimer::timeout, this, &headless_application::UpdateBenchmark);
+	m_benchmark->timer->start(100);
+}
+
+void headless_application::UpdateBenchmark()
+{
+	benchmark_state& bench = *m_benchmark;
+
+	if (Emu.IsStopped())
+	{
+		if (bench.was_running)
+		{
+			sys_log.error("Benchmark: emulation stopped before the benchmark completed");
+			FinishBenchmark(false);
+		}
+
+		return;
+	}
+
+	if (!Emu.IsRunning())
+	{
+		return;
+	}
+
+	bench.was_running = true;
+
+	const u64 flip_count = benchmark_stats::get_flip_count();
+
+	if (!bench.measuring)
+	{
+		// The last flip seen is the start of the first measured frame
+		if (flip_count <= bench.settings.warmup_flips)
+		{
+			return;
+		}
+
+		bench.measuring = true;
+		bench.first_flip = flip_count - 1;
+		bench.start_time = benchmark_stats::now();
+		bench.start_cpu_time = utils::cpu_stats::get_process_cpu_time();
+
+		// Reset the counters
+		bench.sample_threads();
+		bench.ppu_cycles = 0;
+		bench.spu_cycles = 0;
+		bench.rsx_cycles = 0;
+		bench.cpu_stats.get_usage();
+
+		sys_log.success("Benchmark: measurement started after %u flips", flip_count);
+		return;
+	}
+
+	bench.sample_threads();
+
+	// Sample the total CPU usage every second
+	if (++bench.samples % 10 == 0)
+	{
+		bench.cpu_usage_sum += bench.cpu_stats.get_usage();
+	}
+
+	const u64 measured_flips = flip_count - 1 - bench.first_flip;
+	const u64 elapsed = benchmark_stats::now() - bench.start_time;
+
+	if ((bench.settings.max_flips && measured_flips >= bench.settings.max_flips) ||
+		(bench.settings.max_seconds && elapsed >= bench.settings.max_seconds * 1'000'000))
+	{
+		FinishBenchmark(true);
+	}
+}
+
+void headless_application::FinishBenchmark(bool completed)
+{
+	benchmark_state& bench = *m_benchmark;
+	bench.timer->stop();
+
+	const f64 duration = bench.measuring ? (benchmark_stats::now() - bench.start_time) / 1'000'000. : 0.;
+
+	// Frame times in milliseconds
+	std::vector<f64> frame_times;
+
+	if (bench.measuring)
+	{
+		const std::vector<u64> flips = benchmark_stats::get_flip_times(bench.first_flip);
+
+		for (usz i = 1; i < flips.size(); i++)
+		{
+			frame_times.push_back((flips[i] - flips[i - 1]) / 1000.);
+		}
+	}
+
+	QJsonObject root;
+	root["completed"] = completed;
+	root["build"] = QString::fromStdString(rpcs3::get_verbose_version());
+	root["system"] = QString::fromStdString(utils::get_system_info());
+	root["title_id"] = QString::fromStdString(Emu.GetTitleID());
+	root["title"] = QString::fromStdString(Emu.GetTitle());
+
+	QJsonObject settings;
+	settings["warmup_flips"] = static_cast<qint64>(bench.settings.warmup_flips);
+	settings["max_flips"] = static_cast<qint64>(bench.settings.max_flips);
+	settings["max_seconds"] = static_cast<qint64>(bench.settings.max_seconds);
+	settings["ppu_decoder"] = QString::fromStdString(g_cfg.core.ppu_decoder.to_string());
+	settings["spu_decoder"] = QString::fromStdString(g_cfg.core.spu_decoder.to_string());
+	settings["thread_scheduler"] = QString::fromStdString(g_cfg.core.thread_scheduler.to_string());
+	root["settings"] = settings;
+
+	root["duration_s"] = duration;
+	root["frames"] = static_cast<qint64>(frame_times.size());
+	root["fps"] = duration > 0. ? frame_times.size() / duration : 0.;
+
+	QJsonObject frame_time;
+
+	if (!frame_times.empty())
+	{
+		std::vector<f64> sorted = frame_times;
+		std::sort(sorted.begin(), sorted.end());
+
+		// Nearest-rank percentile
+		const auto percentile = [&](f64 p)
+		{
+			const usz rank = static_cast<usz>(std::ceil(p / 100. * sorted.size()));
+			return sorted[std::clamp<usz>(rank, 1, sorted.size()) - 1];
+		};
+
+		f64 sum = 0.;
+
+		for (f64 value : sorted)
+		{
+			sum += value;
+		}
+
+		frame_time["min"] = sorted.front();
+		frame_time["avg"] = sum / sorted.size();
+		frame_time["p50"] = percentile(50.);
+		frame_time["p90"] = percentile(90.);
+		frame_time["p95"] = percentile(95.);
+		frame_time["p99"] = percentile(99.);
+		frame_time["p99_9"] = percentile(99.9);
+		frame_time["max"] = sorted.back();
+	}
+
+	root["frame_time_ms"] = frame_time;
+
+	QJsonObject cpu_time;
+	cpu_time["ppu"] = thread_time_to_seconds(bench.ppu_cycles);
+	cpu_time["spu"] = thread_time_to_seconds(bench.spu_cycles);
+	cpu_time["rsx"] = thread_time_to_seconds(bench.rsx_cycles);
+	cpu_time["process"] = bench.measuring ? (utils::cpu_stats::get_process_cpu_time() - bench.start_cpu_time) / 1'000'000'000. : 0.;
+	root["cpu_time_s"] = cpu_time;
+	root["cpu_usage_percent"] = bench.samples >= 10 ? bench.cpu_usage_sum / (bench.samples / 10) : 0.;
+
+	QJsonObject compile;
+
+	for (const auto& [name, type] : {std::pair{"ppu", benchmark_stats::compiler::ppu}, std::pair{"spu", benchmark_stats::compiler::spu}})
+	{
+		const auto [count, us] = benchmark_stats::get_compile_time(type);
+
+		QJsonObject entry;
+		entry["count"] = static_cast<qint64>(count);
+		entry["time_s"] = us / 1'000'000.;
+		compile[name] = entry;
+	}
+
+	root["compile"] = compile;
+	root["peak_memory_bytes"] = static_cast<qint64>(utils::cpu_stats::get_peak_memory_usage());
+
+	// Histogram entry i counts the events shorter than 2^i nanoseconds
+	QJsonObject perf_stats;
+
+	for (const auto& [name, data] : perf_stat_base::get_stats())
+	{
+		if (!data[0])
+		{
+			continue;
+		}
+
+		QJsonArray histogram;
+
+		for (u32 i = 1; i < 65; i++)
+		{
+			histogram.append(static_cast<qint64>(data[i]));
+		}
+
+		QJsonObject entry;
+		entry["count"] = static_cast<qint64>(data[0]);
+		entry["total_s"] = data[65] / 1'000'000'000.;
+		entry["histogram_log2_ns"] = histogram;
+		perf_stats[QString::fromStdString(name)] = entry;
+	}
+
+	root["perf_stats"] = perf_stats;
+
+	const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+	fs::pending_file file(bench.settings.output_path);
+
+	if (!file.file || file.file.write(json.constData(), json.size()) < static_cast<usz>(json.size()) || !file.commit())
+	{
+		sys_log.error("Benchmark: failed to write '%s' (%s)", bench.settings.output_path, fs::g_tls_error);
+		completed = false;
+	}
+	else
+	{
+		sys_log.success("Benchmark: %u frames in %.3fs (%.2f fps), report written to '%s'", frame_times.size(), duration, duration > 0. ? frame_times.size() / duration : 0., bench.settings.output_path);
+	}
+
+	Emu.GracefulShutdown(false);
+	Emu.CleanUp();
+
+	// A non-zero exit code reports an incomplete benchmark
+	QCoreApplication::exit(completed ? 0 : 1);
+}
+
+struct headless_application::cache_build_state
+{
+	cache_build_settings settings;
+	QTimer* timer = nullptr;
+
+	usz next = 0;
+	u32 failed = 0;
+	bool building = false;
+	u32 thread_limit = 0;
+	std::chrono::steady_clock::time_point start_time;
+	u64 base_memory = 0;
+	u64 peak_memory = 0;
+
+	// Memory needed by one compile thread, refined with the usage measured for each title
+	u64 thread_memory = 512ull << 20;
+};
+
+void headless_application::StartCacheBuild(const cache_build_settings& settings)
+{
+	m_cache_build = std::make_shared<cache_build_state>();
+	m_cache_build->settings = settings;
+
+	sys_log.notice("Cache build: %u titles, memory budget %u MiB", settings.paths.size(), settings.memory_budget >> 20);
+
+	m_cache_build->timer = new QTimer(this);
+	connect(m_cache_build->timer, &QTimer::timeout, this, &headless_application::UpdateCacheBuild);
+	m_cache_build->timer->start(250);
+}
+
+void headless_application::UpdateCacheBuild()
+{
+	cache_build_state& build = *m_cache_build;
+
+	if (build.building)
+	{
+		if (!Emu.IsStopped(true))
+		{
+			build.peak_memory = std::max(build.peak_memory, utils::cpu_stats::get_memory_usage());
+			return;
+		}
+
+		build.building = false;
+
+		const u32 threads = build.thread_limit ? build.thread_limit : utils::get_thread_count();
+
+		if (build.peak_memory > build.base_memory)
+		{
+			build.thread_memory = std::max(build.thread_memory, (build.peak_memory - build.base_memory) / std::max<u32>(threads, 1));
+		}
+
+		sys_log.success("Cache build: finished '%s' in %.1fs (%u threads, peak memory %u MiB)", ::at32(build.settings.paths, build.next)
+			, std::chrono::duration<f64>(std::chrono::steady_clock::now() - build.start_time).count(), threads, build.peak_memory >> 20);
+
+		build.next++;
+	}
+
+	if (build.next >= build.settings.paths.size())
+	{
+		build.timer->stop();
+
+		sys_log.success("Cache build: done, %u of %u titles failed", build.failed, build.settings.paths.size());
+
+		Emu.CleanUp();
+		QCoreApplication::exit(build.failed ? 1 : 0);
+		return;
+	}
+
+	const std::string& path = ::at32(build.settings.paths, build.next);
+
+	build.base_memory = utils::cpu_stats::get_memory_usage();
+	build.peak_memory = build.base_memory;
+	build.thread_limit = 0;
+
+	if (build.settings.memory_budget)
+	{
+		const u64 available = build.settings.memory_budget > build.base_memory ? build.settings.memory_budget - build.base_memory : 0;
+		build.thread_limit = static_cast<u32>(std::clamp<u64>(available / build.thread_memory, 1, utils::get_thread_count()));
+	}
+
+	sys_log.notice("Cache build: building '%s' (%u/%u)", path, build.next + 1, build.settings.paths.size());
+
+	Emu.SetPrecompileThreadLimit(build.thread_limit);
+	Emu.SetForceBoot(true);
+
+	if (const game_boot_result error = Emu.BootGame(path, "", true); error != game_boot_result::no_errors)
+	{
+		sys_log.error("Cache build: could not build caches for '%s', error: %s", path, error);
+		build.failed++;
+		build.next++;
+		return;
+	}
+
+	build.start_time = std::chrono::steady_clock::now();
+	build.building = true;
+}
@@ -6,6 +6,9 @@
 #include "util/atomic.hpp"
 
 #include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
 /** Headless RPCS3 Application Class
  * The main point of this class is to do application initialization and initialize callbacks.
@@ -20,10 +23,41 @@ public:
 	/** Call this method before calling app.exec */
 	bool Init() override;
 
+	struct benchmark_settings
+	{
+		std::string output_path; // JSON report
+		u64 warmup_flips = 0;    // Flips to skip before measuring
+		u64 max_flips = 0;       // Stop after this many measured flips (0: no limit)
+		u64 max_seconds = 0;     // Stop after this many measured seconds (0: no limit)
+	};
+
+	/** Measure the booted title, write the report and quit. Call this method before booting */
+	void StartBenchmark(const benchmark_settings& settings);
+
+	struct cache_build_settings
+	{
+		std::vector<std::string> paths; // Game directories
+		u64 memory_budget = 0;          // Bytes (0: no limit)
+	};
+
+	/** Build the PPU and SPU caches of the given games one after another and quit */
+	void StartCacheBuild(const cache_build_settings& settings);
+
 private:
 	void InitializeCallbacks();
 	void InitializeConnects() const;
 
+	void UpdateBenchmark();
+	void FinishBenchmark(bool completed);
+
+	struct benchmark_state;
+	std::shared_ptr<benchmark_state> m_benchmark;
+
+	void UpdateCacheBuild();
+
+	struct cache_build_state;
+	std::shared_ptr<cache_build_state> m_cache_build;
+
 	QThread* get_thread() override
 	{
 		return thread();
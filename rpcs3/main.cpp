@@ -30,6 +30,7 @@
 #include "Utilities/date_time.h"
 #include "util/console.h"
 #include "Crypto/decrypt_binaries.h"
+#include "Loader/ISO.h"
 #ifdef _WIN32
 #include "module_verifier.hpp"
 #include "util/dyn_lib.hpp"
@@ -368,6 +369,9 @@ private:
 constexpr auto arg_headless     = "headless";
 constexpr auto arg_decrypt      = "decrypt";
 constexpr auto arg_commit_db    = "get-commit-db";
+constexpr auto arg_benchmark    = "benchmark";
+constexpr auto arg_build_caches = "build-caches";
+constexpr auto arg_compress_iso = "compress-disc-image";
 
 // Arguments that can be used with a gui application
 constexpr auto arg_no_gui       = "no-gui";
@@ -392,6 +396,10 @@ constexpr auto arg_timer        = "high-res-timer";
 constexpr auto arg_verbose_curl = "verbose-curl";
 constexpr auto arg_any_location = "allow-any-location";
 constexpr auto arg_codecs       = "codecs";
+constexpr auto arg_bench_warmup = "benchmark-warmup";  // only useful with benchmark
+constexpr auto arg_bench_flips  = "benchmark-flips";   // only useful with benchmark
+constexpr auto arg_bench_secs   = "benchmark-seconds"; // only useful with benchmark
+constexpr auto arg_cache_memory = "build-caches-memory"; // only useful with build-caches
 
 #ifdef _WIN32
 constexpr auto arg_stdout       = "stdout";
@@ -411,7 +419,10 @@ QCoreApplication* create_application(int& argc, char* argv[])
 {
 	if (find_arg(arg_headless, argc, argv) != -1 ||
 		find_arg(arg_decrypt, argc, argv) != -1 ||
-		find_arg(arg_commit_db, argc, argv) != -1)
+		find_arg(arg_commit_db, argc, argv) != -1 ||
+		find_arg(arg_benchmark, argc, argv) != -1 ||
+		find_arg(arg_build_caches, argc, argv) != -1 ||
+		find_arg(arg_compress_iso, argc, argv) != -1)
 	{
 		return new headless_application(argc, argv);
 	}
@@ -785,6 +796,16 @@ int main(int argc, char** argv)
 	parser.addOption(QCommandLineOption(arg_any_location, "Allow RPCS3 to be run from any location. Dangerous"));
 	const QCommandLineOption codec_option(arg_codecs, "List ffmpeg codecs");
 	parser.addOption(codec_option);
+	const QCommandLineOption benchmark_option(arg_benchmark, "Run a headless benchmark with the Null renderer and write the results as JSON to this path.", "path", "");
+	parser.addOption(benchmark_option);
+	parser.addOption(QCommandLineOption(arg_bench_warmup, "Number of flips to skip before the benchmark starts measuring.", "count", "0"));
+	parser.addOption(QCommandLineOption(arg_bench_flips, "Stop the benchmark after this many measured flips.", "count", "0"));
+	parser.addOption(QCommandLineOption(arg_bench_secs, "Stop the benchmark after this many seconds. Defaults to 60 if no flip count is set.", "seconds", "0"));
+	const QCommandLineOption build_caches_option(arg_build_caches, "Build the PPU and SPU caches of a game directory, or of each directory listed in a text file, then exit. Can be repeated.", "path(s)", "");
+	parser.addOption(build_caches_option);
+	parser.addOption(QCommandLineOption(arg_cache_memory, "Memory budget in MiB for building caches. Limits the number of compile threads.", "MiB", "0"));
+	const QCommandLineOption compress_iso_option(arg_compress_iso, "Convert a disc image to the compressed disc image format (.rzi) next to it, then exit.", "path", "");
+	parser.addOption(compress_iso_option);
 
 #ifdef _WIN32
 	parser.addOption(QCommandLineOption(arg_stdout, "Attach the console window and listen to standard output stream. (STDOUT)"));
@@ -1141,6 +1162,22 @@ int main(int argc, char** argv)
 			Emu.Quit(true);
 			return 0;
 		}
+
+		if (parser.isSet(benchmark_option))
+		{
+			headless_application::benchmark_settings settings{};
+			settings.output_path = parser.value(benchmark_option).toStdString();
+			settings.warmup_flips = parser.value(arg_bench_warmup).toULongLong();
+			settings.max_flips = parser.value(arg_bench_flips).toULongLong();
+			settings.max_seconds = parser.value(arg_bench_secs).toULongLong();
+
+			if (settings.output_path.empty())
+			{
+				report_fatal_error(fmt::format("The option '%s' requires an output path.", arg_benchmark));
+			}
+
+			headless_app->StartBenchmark(settings);
+		}
 	}
 	else
 	{
@@ -1296,6 +1333,89 @@ int main(int argc, char** argv)
 		return 0;
 	}
 
+	if (parser.isSet(arg_compress_iso))
+	{
+		utils::attach_console(utils::console_stream::std_out, true);
+
+		const std::string src_path = parser.value(compress_iso_option).toStdString();
+
+		// Replace the extension of the file name, if it has one
+		std::string dst_path = src_path;
+
+		if (const usz dot = dst_path.find_last_of('.'); dot != umax && dot > dst_path.find_last_of(fs::delim) + 1)
+		{
+			dst_path.resize(dot);
+		}
+
+		dst_path += ".rzi";
+
+		if (disc_image::get_image_type(src_path) != disc_image::image_type::iso)
+		{
+			std::cout << "Not an ISO image: " << src_path << std::endl;
+			return 1;
+		}
+
+		fs::file src(src_path);
+		fs::pending_file dst(dst_path);
+
+		if (!src || !dst.file)
+		{
+			std::cout << fmt::format("Failed to open files (%s)", fs::g_tls_error) << std::endl;
+			return 1;
+		}
+
+		std::cout << "Compressing " << src_path << " to " << dst_path << std::endl;
+
+		if (!disc_image::compress(src, dst.file) || !dst.commit())
+		{
+			std::cout << "Failed to compress " << src_path << std::endl;
+			return 1;
+		}
+
+		return 0;
+	}
+
+	if (parser.isSet(arg_build_caches))
+	{
+		headless_application::cache_build_settings settings{};
+		settings.memory_budget = parser.value(arg_cache_memory).toULongLong() << 20;
+
+		for (const QString& value : parser.values(build_caches_option))
+		{
+			const std::string path = value.toStdString();
+
+			if (fs::is_dir(path))
+			{
+				settings.paths.push_back(path);
+				continue;
+			}
+
+			// List of directories, one per line
+			const fs::file list(path);
+
+			if (!list)
+			{
+				report_fatal_error(fmt::format("Cannot open '%s' for building caches (%s)", path, fs::g_tls_error));
+			}
+
+			for (std::string& line : fmt::split(list.to_string(), {"\n", "\r"}))
+			{
+				if (line = fmt::trim(line); !line.empty() && !line.starts_with('#'))
+				{
+					settings.paths.push_back(std::move(line));
+				}
+			}
+		}
+
+		if (settings.paths.empty())
+		{
+			report_fatal_error("No game directories given for building caches.");
+		}
+
+		qobject_cast<headless_application*>(app.data())->StartCacheBuild(settings);
+		return app->exec();
+	}
+
 	// Force install firmware or pkg first if specified through command-line
 	if (parser.isSet(arg_installfw) || parser.isSet(arg_installpkg))
 	{
@@ -2,6 +2,8 @@
 #include "game_list_base.h"
 #include "localized.h"
 
+#include "Emu/System.h"
+
 #include <QDir>
 #include <QPainter>
 
@@ -49,7 +51,7 @@ void game_list_base::IconLoadFunction(game_info game, qreal device_pixel_ratio,
 	static std::unordered_set<std::string> warn_once_list;
 	static shared_mutex s_mtx;
 
-	if (game->icon.isNull() && (game->info.icon_path.empty() || !game->icon.load(QString::fromStdString(game->info.icon_path))))
+	if (game->icon.isNull() && (game->info.icon_path.empty() || !game->icon.load(QString::fromStdString(Emu.GetGameListIndex().get_icon(game->info.icon_path)))))
 	{
 		if (game_list_log.warning)
 		{
@@ -583,7 +583,7 @@ void game_list_frame::OnParsingFinished()
 		const Localized thread_localized;
 
 		const std::string sfo_dir = rpcs3::utils::get_sfo_dir_from_game_path(dir_or_elf);
-		const psf::registry psf = psf::load_object(sfo_dir + "/PARAM.SFO");
+		const psf::registry psf = Emu.GetGameListIndex().get_sfo(sfo_dir);
 		const std::string_view title_id = psf::get_string(psf, "TITLE_ID", "");
 
 		if (title_id.empty())
@@ -835,6 +835,9 @@ void game_list_frame::OnRefreshFinished()
 		m_game_data.push_back(g);
 	}
 
+	// Drop index entries of games which were not found during a complete refresh
+	Emu.GetGameListIndex().save(!m_refresh_watcher.isCanceled());
+
 	const Localized localized;
 	const std::string cat_unknown_localized = localized.category.unknown.toStdString();
 
@@ -8,6 +8,8 @@
 #include "persistent_settings.h"
 #include "qt_utils.h"
 
+#include "Emu/System.h"
+#include "Emu/system_utils.hpp"
 #include "Emu/vfs_config.h"
 #include "Utilities/StrUtil.h"
 
@@ -281,7 +283,20 @@ void game_list_table::populate(
 				}
 				else
 				{
-					game->info.size_on_disk = fs::get_dir_size(game->info.path, 1, cancel.get());
+					game_list_index& index = Emu.GetGameListIndex();
+					const std::string sfo_dir = rpcs3::utils::get_sfo_dir_from_game_path(game->info.path);
+
+					game->info.size_on_disk = index.get_size_on_disk(game->info.path, sfo_dir);
+
+					if (game->info.size_on_disk == umax)
+					{
+						game->info.size_on_disk = fs::get_dir_size(game->info.path, 1, cancel.get());
+
+						if (!cancel || !cancel->load())
+						{
+							index.set_size_on_disk(game->info.path, sfo_dir, game->info.size_on_disk);
+						}
+					}
 				}
 
 				if (!cancel || !cancel->load())
@@ -493,6 +493,7 @@ void gs_frame::toggle_recording()
 
 		m_video_encoder->set_audio_bitrate(g_cfg_recording.audio.audio_bps);
 		m_video_encoder->set_audio_codec(g_cfg_recording.audio.audio_codec);
+		m_video_encoder->set_max_queued_frames(8);
 		m_video_encoder->encode();
 
 		if (m_video_encoder->has_error)
@@ -787,6 +788,12 @@ bool gs_frame::can_consume_frame() const
 	return video_provider.can_consume_frame();
 }
 
+std::vector<u8> gs_frame::get_frame_buffer(usz size) const
+{
+	utils::video_provider& video_provider = g_fxo->get<utils::video_provider>();
+	return video_provider.get_frame_buffer(size);
+}
+
 void gs_frame::present_frame(std::vector<u8>& data, u32 pitch, u32 width, u32 height, bool is_bgra) const
 {
 	utils::video_provider& video_provider = g_fxo->get<utils::video_provider>();
@@ -591,7 +591,7 @@ void main_window::Boot(const std::string& path, const std::string& title_id, boo
 	else
 	{
 		gui_log.success("Boot successful.");
-		AddRecentAction(gui::Recent_Game(QString::fromStdString(Emu.GetBoot()), QString::fromStdString(Emu.GetTitleAndTitleID())), false);
+		AddRecentAction(gui::Recent_Game(QString::fromStdString(Emu.GetBootSourcePath()), QString::fromStdString(Emu.GetTitleAndTitleID())), false);
 	}
 
 	if (refresh_list)
@@ -617,6 +617,7 @@ void main_window::BootElf()
 		"SELF files (EBOOT.BIN *.self);;"
 		"BOOT files (*BOOT.BIN);;"
 		"BIN files (*.bin);;"
+		"Disc images (*.iso *.ISO *.rzi);;"
 		"All executable files (*.SAVESTAT.zst *.SAVESTAT.gz *.SAVESTAT *.sprx *.SPRX *.self *.SELF *.bin *.BIN *.prx *.PRX *.elf *.ELF *.o *.O);;"
 		"All files (*.*)"),
 		Q_NULLPTR, QFileDialog::DontResolveSymlinks);
@@ -3911,6 +3912,9 @@ void main_window::closeEvent(QCloseEvent* closeEvent)
 
 	SaveWindowState();
 
+	// Save the game list index before the emulator is destroyed
+	Emu.GetGameListIndex().save();
+
 	// Flush logs here as well
 	logs::listener::sync_all();
 
@@ -4210,7 +4214,7 @@ void main_window::dropEvent(QDropEvent* event)
 		else
 		{
 			gui_log.success("Elf Boot from drag and drop done: %s", path);
-			AddRecentAction(gui::Recent_Game(QString::fromStdString(Emu.GetBoot()), QString::fromStdString(Emu.GetTitleAndTitleID())), false);
+			AddRecentAction(gui::Recent_Game(QString::fromStdString(Emu.GetBootSourcePath()), QString::fromStdString(Emu.GetTitleAndTitleID())), false);
 		}
 
 		m_game_list_frame->Refresh(true);
@@ -0,0 +1,167 @@
+#include "stdafx.h"
+#include "primitive_benchmark.hpp"
+#include "rpcn_benchmark.hpp"
+#include "timer_benchmark.hpp"
+#include "Utilities/File.h"
+
+#include <charconv>
+#include <iostream>
+#include <map>
+
+namespace
+{
+	struct benchmark_args
+	{
+		std::string output_path;
+		std::map<std::string, std::string, std::less<>> options;
+
+		std::string_view get(std::string_view name, std::string_view def = {}) const
+		{
+			const auto found = options.find(name);
+			return found == options.end() ? def : std::string_view(found->second);
+		}
+
+		u32 get_u32(std::string_view name, u32 def) const
+		{
+			const std::string_view value = get(name);
+			u32 result = def;
+
+			if (!value.empty() && std::from_chars(value.data(), value.data() + value.size(), result).ec != std::errc{})
+			{
+				std::cerr << fmt::format("Invalid value for --%s: %s", name, value) << std::endl;
+				std::exit(1);
+			}
+
+			return result;
+		}
+
+		std::vector<u32> get_u32_list(std::string_view name) const
+		{
+			std::vector<u32> result;
+
+			for (const std::string& item : fmt::split(get(name), {","}))
+			{
+				u32 value = 0;
+
+				if (std::from_chars(item.data(), item.data() + item.size(), value).ec == std::errc{} && value)
+				{
+					result.push_back(value);
+				}
+			}
+
+			return result;
+		}
+	};
+
+	struct benchmark_info
+	{
+		std::string_view name;
+		std::string_view options;
+		std::string (*run)(const benchmark_args& args);
+	};
+
+	std::string run_primitives(const benchmark_args& args)
+	{
+		utils::primitive_benchmark_settings settings{};
+		settings.threads = args.get_u32_list("threads");
+		settings.duration_ms = std::max<u32>(args.get_u32("ms", 500), 1);
+		settings.filter = args.get("filter");
+
+		return utils::run_primitive_benchmarks(settings);
+	}
+
+	std::string run_timers(const benchmark_args& args)
+	{
+		utils::timer_benchmark_settings settings{};
+		settings.pending = args.get_u32("pending", settings.pending);
+		settings.threads = args.get_u32("threads", settings.threads);
+		settings.duration_ms = args.get_u32("ms", settings.duration_ms);
+		settings.filter = args.get("filter");
+
+		return utils::run_timer_benchmarks(settings);
+	}
+
+	std::string run_rpcn(const benchmark_args& args)
+	{
+		utils::rpcn_benchmark_settings settings{};
+		settings.depth = args.get_u32("depth", settings.depth);
+		settings.latency_us = args.get_u32("latency_us", settings.latency_us);
+		settings.duration_ms = args.get_u32("ms", settings.duration_ms);
+		settings.filter = args.get("filter");
+
+		return utils::run_rpcn_benchmarks(settings);
+	}
+
+	constexpr benchmark_info s_benchmarks[] =
+	{
+		{ "primitives", "[--threads=1,2,4] [--ms=500] [--filter=name]", &run_primitives },
+		{ "timers", "[--pending=100] [--threads=16] [--ms=500] [--filter=name]", &run_timers },
+		{ "rpcn", "[--depth=32] [--latency_us=0] [--ms=1000] [--filter=name]", &run_rpcn },
+	};
+
+	void print_usage()
+	{
+		std::cerr << "Usage: rpcs3_benchmark <benchmark> <output.json|-> [--option=value...]\n\nBenchmarks:\n";
+
+		for (const benchmark_info& info : s_benchmarks)
+		{
+			std::cerr << fmt::format("  %-12s %s\n", info.name, info.options);
+		}
+
+		std::cerr << std::flush;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		print_usage();
+		return 1;
+	}
+
+	const std::string_view name = argv[1];
+	const auto info = std::find_if(std::begin(s_benchmarks), std::end(s_benchmarks), [&](const benchmark_info& i) { return i.name == name; });
+
+	if (info == std::end(s_benchmarks))
+	{
+		print_usage();
+		return 1;
+	}
+
+	benchmark_args args{};
+	args.output_path = argv[2];
+
+	for (int i = 3; i < argc; i++)
+	{
+		const std::string_view arg = argv[i];
+		const usz eq = arg.find('=');
+
+		if (!arg.starts_with("--") || eq == umax)
+		{
+			print_usage();
+			return 1;
+		}
+
+		args.options.emplace(arg.substr(2, eq - 2), arg.substr(eq + 1));
+	}
+
+	const std::string report = info->run(args);
+
+	if (args.output_path == "-")
+	{
+		std::cout << report << std::endl;
+		return 0;
+	}
+
+	fs::pending_file file(args.output_path);
+
+	if (!file.file || (file.file.write(report), !file.commit()))
+	{
+		std::cerr << fmt::format("Failed to write '%s' (%s)", args.output_path, fs::g_tls_error) << std::endl;
+		return 1;
+	}
+
+	std::cout << fmt::format("Benchmark results written to %s", args.output_path) << std::endl;
+	return 0;
+}
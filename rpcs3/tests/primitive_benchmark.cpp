@@ -0,0 +1,514 @@
+#include "stdafx.h"
+#include "primitive_benchmark.hpp"
+#include "util/sysinfo.hpp"
+#include "util/serialization.hpp"
+#include "util/shared_ptr.hpp"
+#include "Utilities/Thread.h"
+#include "Utilities/lockless.h"
+#include "Utilities/mutex.h"
+#include "Utilities/cond.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+LOG_CHANNEL(bench_log, "BENCH");
+
+namespace utils
+{
+	namespace
+	{
+		using steady_clock = std::chrono::steady_clock;
+
+		// Every n-th call is timed, the number of samples per thread is limited
+		constexpr u32 c_sample_interval = 16;
+		constexpr usz c_max_samples = 1 << 16;
+
+		// Timeout for blocking waits, allows noticing the end of the measurement
+		constexpr atomic_wait_timeout c_wait_timeout{1'000'000};
+		constexpr u64 c_cond_timeout = 1000;
+
+		struct thread_result
+		{
+			u64 ops = 0;
+			std::vector<u32> samples; // Latency in nanoseconds
+
+			void sample(steady_clock::time_point start)
+			{
+				if (samples.size() < c_max_samples)
+				{
+					const s64 ns = std::chrono::duration_cast<std::chrono::nanoseconds>(steady_clock::now() - start).count();
+					samples.push_back(static_cast<u32>(std::min<s64>(ns, u32{umax})));
+				}
+			}
+		};
+
+		struct case_result
+		{
+			u64 ops = 0;
+			f64 seconds = 0;
+			std::vector<u32> samples;
+		};
+
+		struct bench_state
+		{
+			atomic_t<u32> stop{0};
+			atomic_t<u32> finished{0};
+		};
+
+		// Call op until stopped or max_ops is reached, every call counts as weight operations
+		template <typename F>
+		void timed_loop(thread_result& r, const bench_state& state, F&& op, u64 max_ops = umax, u32 weight = 1)
+		{
+			while (!state.stop && r.ops < max_ops)
+			{
+				for (u32 i = 1; i < c_sample_interval; i++)
+				{
+					op();
+				}
+
+				const auto start = steady_clock::now();
+				op();
+				r.sample(start);
+				r.ops += c_sample_interval * weight;
+			}
+		}
+
+		// Run func(index, result, state) on the specified number of threads until the duration expires or all threads return
+		template <typename F>
+		case_result run_threads(u32 count, u32 duration_ms, F&& func, const std::function<void()>& on_stop = {})
+		{
+			std::vector<thread_result> results(count);
+			bench_state state;
+			atomic_t<u32> index{0};
+			atomic_t<u32> ready{0};
+
+			steady_clock::time_point start, end;
+
+			{
+				named_thread_group workers("Benchmark Worker ", count, [&]()
+				{
+					const u32 i = index++;
+					ready++;
+
+					// Start all threads at once
+					while (ready < count)
+					{
+						std::this_thread::yield();
+					}
+
+					func(i, results[i], state);
+
+					state.finished++;
+					state.finished.notify_all();
+				});
+
+				while (ready < count)
+				{
+					std::this_thread::yield();
+				}
+
+				start = steady_clock::now();
+
+				const auto deadline = start + std::chrono::milliseconds(duration_ms);
+
+				for (auto now = start; now < deadline; now = steady_clock::now())
+				{
+					const u32 finished = state.finished;
+
+					if (finished >= count)
+					{
+						break;
+					}
+
+					state.finished.wait(finished, atomic_wait_timeout{static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count())});
+				}
+
+				state.stop.release(1);
+				end = steady_clock::now();
+
+				if (on_stop)
+				{
+					on_stop();
+				}
+			}
+
+			case_result result{};
+			result.seconds = std::chrono::duration<f64>(end - start).count();
+
+			for (thread_result& r : results)
+			{
+				result.ops += r.ops;
+				result.samples.insert(result.samples.end(), r.samples.begin(), r.samples.end());
+			}
+
+			return result;
+		}
+
+		// Multiple producers, one consumer draining the queue (ops: consumed items)
+		case_result bench_lf_queue(u32 threads, u32 duration_ms)
+		{
+			lf_queue<u64> queue;
+			atomic_t<u64> pushed{0};
+			atomic_t<u64> consumed{0};
+
+			return run_threads(threads, duration_ms, [&](u32 index, thread_result& r, const bench_state& state)
+			{
+				if (index == 0)
+				{
+					while (!state.stop)
+					{
+						if (!queue)
+						{
+							queue.wait();
+							continue;
+						}
+
+						u64 count = 0;
+
+						for ([[maybe_unused]] u64 value : queue.pop_all())
+						{
+							count++;
+						}
+
+						consumed += count;
+						r.ops += count;
+					}
+
+					return;
+				}
+
+				u64 local = 0;
+
+				timed_loop(r, state, [&]()
+				{
+					if (++local % 1024 == 0)
+					{
+						// Limit the amount of pending items
+						pushed += 1024;
+
+						while (pushed - consumed > 0x10000 && !state.stop)
+						{
+							std::this_thread::yield();
+						}
+					}
+
+					queue.push(local);
+				});
+
+				r.ops = 0;
+			}, [&]()
+			{
+				// Wake up the consumer
+				queue.push(0);
+			});
+		}
+
+		// Concurrent insertion into the list
+		case_result bench_lf_bunch(u32 threads, u32 duration_ms)
+		{
+			lf_bunch<u64> bunch;
+
+			return run_threads(threads, duration_ms, [&](u32, thread_result& r, const bench_state& state)
+			{
+				// Memory usage grows with every item
+				timed_loop(r, state, [&]()
+				{
+					bunch.push(r.ops);
+				}, (1u << 21) / threads);
+			});
+		}
+
+		case_result bench_shared_mutex(u32 threads, u32 duration_ms, u32 write_interval)
+		{
+			shared_mutex mutex;
+			u64 value = 0;
+
+			return run_threads(threads, duration_ms, [&](u32, thread_result& r, const bench_state& state)
+			{
+				u64 local = 0;
+				u64 sink = 0;
+
+				timed_loop(r, state, [&]()
+				{
+					if (++local % write_interval == 0)
+					{
+						mutex.lock();
+						value++;
+						mutex.unlock();
+					}
+					else
+					{
+						mutex.lock_shared();
+						sink += value;
+						mutex.unlock_shared();
+					}
+				});
+
+				static_cast<void>(sink);
+			});
+		}
+
+		// Threads are paired and pass the turn to each other (ops: round trips)
+		case_result bench_atomic_wait(u32 threads, u32 duration_ms)
+		{
+			struct alignas(64) pair_state
+			{
+				atomic_t<u32> turn{0};
+			};
+
+			std::vector<pair_state> pairs(threads / 2);
+
+			return run_threads(threads, duration_ms, [&](u32 index, thread_result& r, const bench_state& state)
+			{
+				if (index / 2 >= pairs.size())
+				{
+					return;
+				}
+
+				atomic_t<u32>& turn = pairs[index / 2].turn;
+
+				if (index % 2 == 0)
+				{
+					timed_loop(r, state, [&]()
+					{
+						turn.release(1);
+						turn.notify_one();
+
+						while (turn == 1 && !state.stop)
+						{
+							turn.wait(1, c_wait_timeout);
+						}
+					});
+
+					return;
+				}
+
+				while (!state.stop)
+				{
+					while (turn == 0 && !state.stop)
+					{
+						turn.wait(0, c_wait_timeout);
+					}
+
+					turn.release(0);
+					turn.notify_one();
+				}
+			});
+		}
+
+		// Same as above using cond_variable with shared_mutex
+		case_result bench_cond_variable(u32 threads, u32 duration_ms)
+		{
+			struct alignas(64) pair_state
+			{
+				shared_mutex mutex;
+				cond_variable cond;
+				u32 turn = 0;
+			};
+
+			std::vector<pair_state> pairs(threads / 2);
+
+			return run_threads(threads, duration_ms, [&](u32 index, thread_result& r, const bench_state& state)
+			{
+				if (index / 2 >= pairs.size())
+				{
+					return;
+				}
+
+				pair_state& pair = pairs[index / 2];
+
+				if (index % 2 == 0)
+				{
+					timed_loop(r, state, [&]()
+					{
+						pair.mutex.lock();
+						pair.turn = 1;
+						pair.cond.notify_all();
+
+						while (pair.turn == 1 && !state.stop)
+						{
+							pair.cond.wait(pair.mutex, c_cond_timeout);
+						}
+
+						pair.mutex.unlock();
+					});
+
+					return;
+				}
+
+				pair.mutex.lock();
+
+				while (!state.stop)
+				{
+					while (pair.turn == 0 && !state.stop)
+					{
+						pair.cond.wait(pair.mutex, c_cond_timeout);
+					}
+
+					pair.turn = 0;
+					pair.cond.notify_all();
+				}
+
+				pair.mutex.unlock();
+			});
+		}
+
+		case_result bench_atomic_ptr(u32 threads, u32 duration_ms, u32 write_interval)
+		{
+			atomic_ptr<u64> ptr;
+			ptr.store(make_shared<u64>(0));
+
+			return run_threads(threads, duration_ms, [&](u32, thread_result& r, const bench_state& state)
+			{
+				u64 local = 0;
+				u64 sink = 0;
+
+				timed_loop(r, state, [&]()
+				{
+					if (++local % write_interval == 0)
+					{
+						ptr.store(make_shared<u64>(local));
+					}
+					else
+					{
+						sink += *ptr.load();
+					}
+				});
+
+				static_cast<void>(sink);
+			});
+		}
+
+		// Every thread writes and reads back its own objects (ops: objects)
+		case_result bench_serial(u32 threads, u32 duration_ms)
+		{
+			constexpr u32 batch = 64;
+
+			return run_threads(threads, duration_ms, [&](u32, thread_result& r, const bench_state& state)
+			{
+				utils::serial ar;
+
+				u32 id = 0;
+				u64 value = 0;
+				std::vector<u32> list(64, 1);
+				std::string name = "benchmark object";
+
+				timed_loop(r, state, [&]()
+				{
+					ar.clear();
+
+					for (u32 i = 0; i < batch; i++)
+					{
+						ar(id, value, list, name);
+					}
+
+					ar.set_reading_state();
+
+					for (u32 i = 0; i < batch; i++)
+					{
+						ar(id, value, list, name);
+					}
+				}, umax, batch);
+			});
+		}
+
+		struct bench_case
+		{
+			std::string_view name;
+			u32 min_threads;
+			std::function<case_result(u32, u32)> run;
+		};
+
+		std::string json_escape(std::string_view str)
+		{
+			std::string result;
+
+			for (char c : str)
+			{
+				if (c == '"' || c == '\\')
+				{
+					result += '\\';
+				}
+
+				if (static_cast<u8>(c) >= 0x20)
+				{
+					result += c;
+				}
+			}
+
+			return result;
+		}
+	}
+
+	std::string run_primitive_benchmarks(const primitive_benchmark_settings& settings)
+	{
+		const u32 host_threads = utils::get_thread_count();
+
+		std::vector<u32> thread_counts = settings.threads;
+
+		if (thread_counts.empty())
+		{
+			for (u32 i = 1; i < host_threads; i *= 2)
+			{
+				thread_counts.push_back(i);
+			}
+
+			thread_counts.push_back(host_threads);
+		}
+
+		const bench_case cases[] =
+		{
+			{"lf_queue.mpsc", 2, bench_lf_queue},
+			{"lf_bunch.push", 1, bench_lf_bunch},
+			{"shared_mutex.exclusive", 1, [](u32 t, u32 d) { return bench_shared_mutex(t, d, 1); }},
+			{"shared_mutex.shared", 1, [](u32 t, u32 d) { return bench_shared_mutex(t, d, umax); }},
+			{"shared_mutex.mixed", 1, [](u32 t, u32 d) { return bench_shared_mutex(t, d, 16); }},
+			{"atomic_wait.pingpong", 2, bench_atomic_wait},
+			{"cond_variable.pingpong", 2, bench_cond_variable},
+			{"atomic_ptr.load", 1, [](u32 t, u32 d) { return bench_atomic_ptr(t, d, umax); }},
+			{"atomic_ptr.mixed", 1, [](u32 t, u32 d) { return bench_atomic_ptr(t, d, 16); }},
+			{"serial.roundtrip", 1, bench_serial},
+		};
+
+		std::string results;
+
+		for (const bench_case& _case : cases)
+		{
+			if (!settings.filter.empty() && _case.name.find(settings.filter) == umax)
+			{
+				continue;
+			}
+
+			for (u32 threads : thread_counts)
+			{
+				if (threads < _case.min_threads)
+				{
+					continue;
+				}
+
+				case_result result = _case.run(threads, settings.duration_ms);
+
+				std::sort(result.samples.begin(), result.samples.end());
+
+				const auto percentile = [&](usz p) -> u32
+				{
+					return result.samples.empty() ? 0 : result.samples[std::min(result.samples.size() * p / 100, result.samples.size() - 1)];
+				};
+
+				const f64 ops_per_sec = result.seconds > 0 ? result.ops / result.seconds : 0;
+
+				bench_log.notice("%s (%u threads): %.0f ops/s, p50=%uns, p99=%uns", _case.name, threads, ops_per_sec, percentile(50), percentile(99));
+
+				results += fmt::format("%s\n\t\t{\"case\": \"%s\", \"threads\": %u, \"ops\": %u, \"seconds\": %.6f, \"ops_per_sec\": %.1f, "
+					"\"latency_ns\": {\"samples\": %u, \"p50\": %u, \"p90\": %u, \"p99\": %u, \"max\": %u}}",
+					results.empty() ? "" : ",", _case.name, threads, result.ops, result.seconds, ops_per_sec,
+					result.samples.size(), percentile(50), percentile(90), percentile(99), result.samples.empty() ? 0 : result.samples.back());
+			}
+		}
+
+		return fmt::format("{\n\t\"cpu\": \"%s\",\n\t\"host_threads\": %u,\n\t\"duration_ms\": %u,\n\t\"sample_interval\": %u,\n\t\"results\": [%s\n\t]\n}\n",
+			json_escape(utils::get_cpu_brand()), host_threads, settings.duration_ms, c_sample_interval, results);
+	}
+}
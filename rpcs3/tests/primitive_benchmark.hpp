@@ -0,0 +1,19 @@
+#pragma once
+
+#include "util/types.hpp"
+
+#include <string>
+#include <vector>
+
+namespace utils
+{
+	struct primitive_benchmark_settings
+	{
+		std::vector<u32> threads; // Thread counts to measure (empty: powers of two up to the host thread count)
+		u32 duration_ms = 500; // Duration of every case and thread count
+		std::string filter; // Only run cases which contain this string
+	};
+
+	// Measure throughput and latency of the core synchronization and container primitives, returns a JSON report
+	std::string run_primitive_benchmarks(const primitive_benchmark_settings& settings);
+}
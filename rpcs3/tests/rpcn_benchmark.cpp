@@ -0,0 +1,240 @@
+#include "stdafx.h"
+#include "rpcn_benchmark.hpp"
+#include "rpcn_mock_server.hpp"
+#include "Emu/NP/rpcn_client.h"
+#include "Emu/NP/rpcn_config.h"
+#include "util/cpu_stats.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+LOG_CHANNEL(bench_log, "BENCH");
+
+namespace utils
+{
+	namespace
+	{
+		using steady_clock = std::chrono::steady_clock;
+
+		constexpr usz c_max_samples = 1 << 18;
+
+		struct case_result
+		{
+			u64 ops = 0;
+			f64 seconds = 0;
+			u64 cpu_ns = 0;
+			std::vector<u32> samples; // Time from sending a request to its completion in microseconds
+		};
+
+		u32 elapsed_us(steady_clock::time_point from, steady_clock::time_point to)
+		{
+			return static_cast<u32>(std::min<s64>(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count(), u32{umax}));
+		}
+
+		// One request at a time, as the synchronous commands are sent
+		case_result bench_blocking(rpcn::rpcn_client& client, u32 duration_ms)
+		{
+			case_result result{};
+			u32 req_id = 1;
+
+			const u64 cpu_start = cpu_stats::get_process_cpu_time();
+			const auto start = steady_clock::now();
+			const auto deadline = start + std::chrono::milliseconds(duration_ms);
+			auto end = start;
+
+			do
+			{
+				const auto sent = steady_clock::now();
+
+				if (!client.get_network_time(req_id++))
+				{
+					fmt::throw_exception("GetNetworkTime failed");
+				}
+
+				end = steady_clock::now();
+				result.ops++;
+
+				if (result.samples.size() < c_max_samples)
+				{
+					result.samples.push_back(elapsed_us(sent, end));
+				}
+			}
+			while (end < deadline);
+
+			result.seconds = std::chrono::duration<f64>(end - start).count();
+			result.cpu_ns = cpu_stats::get_process_cpu_time() - cpu_start;
+			return result;
+		}
+
+		// Keep depth requests in flight, every completion sends the next request from the reader thread
+		case_result bench_pipelined(rpcn::rpcn_client& client, u32 depth, u32 duration_ms)
+		{
+			case_result result{};
+			std::mutex samples_mutex;
+			atomic_t<u64> ops{0};
+			atomic_t<u32> req_id{1};
+			atomic_t<u32> in_flight{0};
+			atomic_t<u32> stop{0};
+			atomic_t<u32> failed{0};
+
+			const auto request_done = [&]()
+			{
+				if (in_flight.sub_fetch(1) == 0)
+				{
+					in_flight.notify_all();
+				}
+			};
+
+			std::function<void()> send_request;
+
+			send_request = [&]()
+			{
+				const auto sent = steady_clock::now();
+				in_flight++;
+
+				const bool queued = client.get_network_time_async(req_id++, [&, sent](u64 network_time)
+				{
+					const auto completed = steady_clock::now();
+
+					if (!network_time)
+					{
+						failed.release(1);
+					}
+					else
+					{
+						ops++;
+
+						std::lock_guard lock(samples_mutex);
+
+						if (result.samples.size() < c_max_samples)
+						{
+							result.samples.push_back(elapsed_us(sent, completed));
+						}
+					}
+
+					if (!stop && !failed)
+					{
+						send_request();
+					}
+
+					request_done();
+				});
+
+				if (!queued)
+				{
+					failed.release(1);
+					request_done();
+				}
+			};
+
+			const u64 cpu_start = cpu_stats::get_process_cpu_time();
+			const auto start = steady_clock::now();
+
+			for (u32 i = 0; i < depth; i++)
+			{
+				send_request();
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+			stop.release(1);
+
+			// The completions refer to this frame
+			while (const u32 count = in_flight)
+			{
+				in_flight.wait(count);
+			}
+
+			const auto end = steady_clock::now();
+
+			if (failed)
+			{
+				fmt::throw_exception("GetNetworkTime failed");
+			}
+
+			result.ops = ops;
+			result.seconds = std::chrono::duration<f64>(end - start).count();
+			result.cpu_ns = cpu_stats::get_process_cpu_time() - cpu_start;
+			return result;
+		}
+
+		struct bench_case
+		{
+			std::string_view name;
+			std::function<case_result(rpcn::rpcn_client&)> run;
+		};
+	}
+
+	std::string run_rpcn_benchmarks(const rpcn_benchmark_settings& settings)
+	{
+		const u32 depth = std::clamp<u32>(settings.depth, 1, 4096);
+		const u32 duration_ms = std::max<u32>(settings.duration_ms, 1);
+
+		rpcn::mock_server server(settings.latency_us);
+
+		if (!server.start())
+		{
+			fmt::throw_exception("Failed to start the mock RPCN server");
+		}
+
+		std::string results;
+		{
+			const auto client = rpcn::rpcn_client::get_instance();
+
+			// The configuration is loaded by the client, override it in memory only
+			g_cfg_rpcn.set_host(fmt::format("127.0.0.1:%u", server.get_port()));
+			g_cfg_rpcn.set_npid("Benchmark");
+			g_cfg_rpcn.set_password("Benchmark");
+			g_cfg_rpcn.set_token("");
+			g_cfg_rpcn.set_ipv6_support(false);
+
+			if (const auto state = client->wait_for_connection(); state != rpcn::rpcn_state::failure_no_failure)
+			{
+				fmt::throw_exception("Failed to connect to the mock RPCN server: %s", rpcn::rpcn_state_to_string(state));
+			}
+
+			if (const auto state = client->wait_for_authentified(); state != rpcn::rpcn_state::failure_no_failure)
+			{
+				fmt::throw_exception("Failed to login to the mock RPCN server: %s", rpcn::rpcn_state_to_string(state));
+			}
+
+			const bench_case cases[] =
+			{
+				{"blocking", [&](rpcn::rpcn_client& c) { return bench_blocking(c, duration_ms); }},
+				{"pipelined", [&](rpcn::rpcn_client& c) { return bench_pipelined(c, depth, duration_ms); }},
+			};
+
+			for (const bench_case& _case : cases)
+			{
+				if (!settings.filter.empty() && _case.name.find(settings.filter) == umax)
+				{
+					continue;
+				}
+
+				case_result result = _case.run(*client);
+
+				std::sort(result.samples.begin(), result.samples.end());
+
+				const auto percentile = [&](usz p) -> u32
+				{
+					return result.samples.empty() ? 0 : result.samples[std::min(result.samples.size() * p / 100, result.samples.size() - 1)];
+				};
+
+				const f64 ops_per_sec = result.seconds > 0 ? result.ops / result.seconds : 0;
+				const f64 cpu_us_per_op = result.ops ? result.cpu_ns / 1000. / result.ops : 0;
+
+				bench_log.notice("%s: %.0f requests/s, %.1f CPU us/request, round trip p50=%uus, p99=%uus", _case.name, ops_per_sec, cpu_us_per_op, percentile(50), percentile(99));
+
+				results += fmt::format("%s\n\t\t{\"case\": \"%s\", \"requests\": %u, \"seconds\": %.6f, \"requests_per_sec\": %.1f, \"cpu_us_per_request\": %.2f, "
+					"\"round_trip_us\": {\"samples\": %u, \"p50\": %u, \"p90\": %u, \"p99\": %u, \"max\": %u}}",
+					results.empty() ? "" : ",", _case.name, result.ops, result.seconds, ops_per_sec, cpu_us_per_op,
+					result.samples.size(), percentile(50), percentile(90), percentile(99), result.samples.empty() ? 0 : result.samples.back());
+			}
+		}
+
+		return fmt::format("{\n\t\"depth\": %u,\n\t\"latency_us\": %u,\n\t\"duration_ms\": %u,\n\t\"server_requests\": %u,\n\t\"results\": [%s\n\t]\n}\n",
+			depth, settings.latency_us, duration_ms, server.get_requests(), results);
+	}
+}
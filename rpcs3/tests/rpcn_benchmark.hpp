@@ -0,0 +1,20 @@
+#pragma once
+
+#include "util/types.hpp"
+
+#include <string>
+
+namespace utils
+{
+	struct rpcn_benchmark_settings
+	{
+		u32 depth = 32; // Requests in flight in the pipelined case
+		u32 latency_us = 0; // Delay added by the mock server to every reply
+		u32 duration_ms = 1000; // Duration of every case
+		std::string filter; // Only run cases which contain this string
+	};
+
+	// Connect the RPCN client to a local mock server and measure blocking requests against pipelined requests
+	// completed by callbacks, returns a JSON report
+	std::string run_rpcn_benchmarks(const rpcn_benchmark_settings& settings);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "util/types.hpp"
+#include "util/atomic.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif
+
+#ifdef __clang__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Wextern-c-compat"
+#endif
+#include <wolfssl/ssl.h>
+#ifdef __clang__
+#pragma GCC diagnostic pop
+#endif
+
+namespace rpcn
+{
+	// Local RPCN server used to measure the client offline. It listens on 127.0.0.1 and serves one TLS connection at a time:
+	// the protocol version is sent on connection, any login is accepted, GetNetworkTime and Terminate are answered
+	// and other requests are answered with ErrorType::Unsupported.
+	class mock_server
+	{
+	public:
+		// Replies are delayed by latency_us to emulate the round trip to a real server
+		explicit mock_server(u32 latency_us = 0);
+		~mock_server();
+
+		mock_server(const mock_server&) = delete;
+		mock_server& operator=(const mock_server&) = delete;
+
+		// Listen on an ephemeral port, returns false on failure
+		bool start();
+		void stop();
+
+		u16 get_port() const
+		{
+			return m_port;
+		}
+
+		// Requests received since the server was started
+		u64 get_requests() const
+		{
+			return m_requests;
+		}
+
+	private:
+#ifdef _WIN32
+		using socket_type = SOCKET;
+#else
+		using socket_type = int;
+#endif
+
+		void accept_thread();
+		void serve(socket_type sock);
+		void reply_thread(WOLFSSL* wssl);
+
+		std::vector<u8> handle_request(u16 command, u64 packet_id, const std::vector<u8>& data);
+
+		const u32 m_latency_us;
+
+		WOLFSSL_CTX* m_ctx = nullptr;
+		socket_type m_listen_socket{};
+		bool m_listening = false;
+		u16 m_port = 0;
+
+		atomic_t<bool> m_stop = false;
+		atomic_t<u64> m_requests = 0;
+		std::thread m_thread;
+
+		// Replies waiting for their delay to pass, sent in order
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::deque<std::pair<u64, std::vector<u8>>> m_replies; // due time in microseconds / packet
+		bool m_connection_closed = false;
+		socket_type m_client_socket{};
+		bool m_client_connected = false;
+	};
+}
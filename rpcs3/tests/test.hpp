@@ -0,0 +1,17 @@
+#pragma once
+
+#include "util/types.hpp"
+
+#include <source_location>
+#include <string_view>
+
+namespace test
+{
+	// Report a failed check with its location, returns the condition
+	bool check(bool condition, std::string_view what, std::source_location loc = std::source_location::current());
+}
+
+// Test cases, each reports its failures through test::check()
+void test_dmux_pamf();
+void test_gem_convert();
+void test_timeout_queue();
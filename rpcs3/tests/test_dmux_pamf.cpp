@@ -0,0 +1,553 @@
+#include "stdafx.h"
+#include "test.hpp"
+#include "Emu/Memory/vm_ptr.h"
+#include "Emu/Cell/ErrorCodes.h"
+#include "Emu/Cell/Modules/cellDmuxPamf.h"
+#include "Emu/Cell/Modules/cellPamf.h"
+#include "util/asm.hpp"
+
+#include <deque>
+
+// Demuxes generated PAMF streams without a PPU thread, the callbacks of the demuxer thread are replaced by the loop in demux_stream()
+
+namespace
+{
+	struct expected_au
+	{
+		std::vector<u8> data;
+		u64 pts = umax;
+		u64 dts = umax;
+		bool is_rap = false;
+	};
+
+	struct es_desc
+	{
+		std::string_view name;
+		DmuxPamfStreamType type;
+		u32 stream_id;
+		u32 private_stream_id;
+		u32 au_max_size;
+		u32 au_buf_size;
+		u32 max_payload; // Size of the PES payload chunks
+		std::vector<expected_au> aus;
+		std::vector<usz> entry_points; // Access units preceded by a private stream 2 packet
+	};
+
+	struct pes_packet
+	{
+		u32 stream_id;
+		u32 private_stream_id;
+		std::vector<u8> payload;
+		u64 pts = umax;
+		u64 dts = umax;
+		bool entry_point = false;
+	};
+
+	// Payload bytes never contain zeros, so they can't form a start code
+	void append_payload(std::vector<u8>& out, usz size, u32 seed)
+	{
+		for (usz i = 0; i < size; i++)
+		{
+			out.push_back(static_cast<u8>(1 + (seed * 31 + i * 7) % 250));
+		}
+	}
+
+	void append_timestamp(std::vector<u8>& out, u8 prefix, u64 ts)
+	{
+		out.push_back(static_cast<u8>(prefix << 4 | ((ts >> 29) & 0x0e) | 1));
+		out.push_back(static_cast<u8>(ts >> 22));
+		out.push_back(static_cast<u8>(((ts >> 14) & 0xfe) | 1));
+		out.push_back(static_cast<u8>(ts >> 7));
+		out.push_back(static_cast<u8>(ts << 1 | 1));
+	}
+
+	void append_be32(std::vector<u8>& out, u32 value)
+	{
+		out.insert(out.end(), { static_cast<u8>(value >> 24), static_cast<u8>(value >> 16), static_cast<u8>(value >> 8), static_cast<u8>(value) });
+	}
+
+	// Split the elementary stream into PES payloads, the time stamps of a packet belong to the first access unit starting in it
+	std::vector<pes_packet> packetize(const es_desc& es)
+	{
+		std::vector<u8> data;
+		std::vector<usz> au_starts;
+
+		for (const expected_au& au : es.aus)
+		{
+			au_starts.push_back(data.size());
+			data.insert(data.end(), au.data.begin(), au.data.end());
+		}
+
+		const bool is_video = es.type == DmuxPamfStreamType::avc || es.type == DmuxPamfStreamType::m2v;
+		const bool one_au_per_packet = es.type == DmuxPamfStreamType::lpcm;
+
+		std::vector<pes_packet> packets;
+		usz au_index = 0;
+
+		for (usz pos = 0; pos < data.size();)
+		{
+			while (au_index < au_starts.size() && au_starts[au_index] < pos)
+			{
+				au_index++;
+			}
+
+			usz end = one_au_per_packet ? pos + es.aus[au_index].data.size() : std::min(pos + es.max_payload, data.size());
+
+			if (is_video)
+			{
+				// Keep every start code within one packet
+				for (const usz start : au_starts)
+				{
+					if (start > pos && start < end && end < start + 6)
+					{
+						end = start;
+					}
+				}
+			}
+
+			pes_packet packet{ es.stream_id, es.private_stream_id, { data.begin() + pos, data.begin() + end } };
+
+			if (au_index < au_starts.size() && au_starts[au_index] < end)
+			{
+				packet.pts = es.aus[au_index].pts;
+				packet.dts = es.aus[au_index].dts;
+				packet.entry_point = std::count(es.entry_points.begin(), es.entry_points.end(), au_index) != 0;
+			}
+
+			packets.push_back(std::move(packet));
+			pos = end;
+		}
+
+		return packets;
+	}
+
+	void append_pack_header(std::vector<u8>& out)
+	{
+		append_be32(out, DMUX_PAMF_PACK_START_CODE);
+		out.insert(out.end(), { 0x44, 0x00, 0x04, 0x00, 0x04, 0x01, 0x01, 0x89, 0xc3, 0xf8 });
+	}
+
+	void append_pes_packet(std::vector<u8>& out, const pes_packet& packet)
+	{
+		if (packet.entry_point)
+		{
+			append_pack_header(out);
+			append_be32(out, DMUX_PAMF_PRIVATE_STREAM_2);
+			out.insert(out.end(), { 0x00, 0x02, 0xff, 0xff });
+		}
+
+		append_pack_header(out);
+
+		const bool has_pts = packet.pts != umax;
+		const bool has_dts = has_pts && packet.dts != umax;
+		const u32 header_size = has_dts ? 10 : has_pts ? 5 : 0;
+		const u32 private_header_size = packet.private_stream_id || packet.stream_id == 0xbd ? 4 : 0;
+		const u32 length = 3 + header_size + private_header_size + ::size32(packet.payload);
+
+		append_be32(out, 0x100 | packet.stream_id);
+		out.push_back(static_cast<u8>(length >> 8));
+		out.push_back(static_cast<u8>(length));
+		out.push_back(0x81);
+		out.push_back(has_dts ? 0xc0 : has_pts ? 0x80 : 0x00);
+		out.push_back(static_cast<u8>(header_size));
+
+		if (has_pts)
+		{
+			append_timestamp(out, has_dts ? 3 : 2, packet.pts);
+		}
+
+		if (has_dts)
+		{
+			append_timestamp(out, 1, packet.dts);
+		}
+
+		if (private_header_size)
+		{
+			out.insert(out.end(), { static_cast<u8>(packet.private_stream_id), 0x00, 0x00, 0x00 });
+		}
+
+		out.insert(out.end(), packet.payload.begin(), packet.payload.end());
+	}
+
+	// Interleave the packets of all elementary streams
+	std::vector<u8> mux(const std::vector<es_desc>& streams)
+	{
+		std::vector<std::vector<pes_packet>> packets;
+
+		for (const es_desc& es : streams)
+		{
+			packets.push_back(packetize(es));
+		}
+
+		std::vector<u8> out;
+
+		for (usz i = 0, remaining = 1; remaining; i++)
+		{
+			remaining = 0;
+
+			for (const auto& list : packets)
+			{
+				if (i < list.size())
+				{
+					append_pes_packet(out, list[i]);
+					remaining++;
+				}
+			}
+		}
+
+		append_be32(out, DMUX_PAMF_PROGRAM_END_CODE);
+		return out;
+	}
+
+	es_desc make_avc()
+	{
+		es_desc es{ "AVC", DmuxPamfStreamType::avc, 0xe0, 0, 0x20000, 0x40000, 2000 };
+
+		for (u32 i = 0; i < 40; i++)
+		{
+			expected_au au{};
+			const bool idr = i % 15 == 0;
+
+			// Access unit delimiter with a four byte start code
+			au.data = { 0, 0, 0, 1, 0x09, 0xf0 };
+
+			if (idr)
+			{
+				// SPS and PPS
+				au.data.insert(au.data.end(), { 0, 0, 0, 1, 0x67 });
+				append_payload(au.data, 12, i);
+				au.data.insert(au.data.end(), { 0, 0, 0, 1, 0x68 });
+				append_payload(au.data, 4, i);
+			}
+
+			au.data.insert(au.data.end(), { 0, 0, 1, static_cast<u8>(idr ? 0x65 : 0x41) });
+			append_payload(au.data, idr ? 30000 + i * 13 : 1000 + (i * 2791) % 17000, i);
+
+			au.pts = 90000 + i * 3003ull + 6006;
+			au.dts = 90000 + i * 3003ull;
+			au.is_rap = idr;
+			es.aus.push_back(std::move(au));
+		}
+
+		// A non-IDR access unit marked as entry point
+		es.entry_points.push_back(7);
+		es.aus[7].is_rap = true;
+
+		return es;
+	}
+
+	es_desc make_m2v()
+	{
+		es_desc es{ "M2V", DmuxPamfStreamType::m2v, 0xe1, 0, 0x20000, 0x40000, 2000 };
+
+		for (u32 i = 0; i < 30; i++)
+		{
+			expected_au au{};
+			const bool gop = i % 12 == 0;
+
+			if (gop)
+			{
+				// Sequence header and GOP header
+				au.data.insert(au.data.end(), { 0, 0, 1, 0xb3 });
+				append_payload(au.data, 8, i);
+				au.data.insert(au.data.end(), { 0, 0, 1, 0xb8 });
+				append_payload(au.data, 4, i);
+			}
+
+			// Picture header followed by two slices
+			au.data.insert(au.data.end(), { 0, 0, 1, 0x00 });
+			append_payload(au.data, 4, i);
+			au.data.insert(au.data.end(), { 0, 0, 1, 0x01 });
+			append_payload(au.data, 500 + (i * 1237) % 9000, i);
+			au.data.insert(au.data.end(), { 0, 0, 1, 0x02 });
+			append_payload(au.data, 300, i + 1);
+
+			au.pts = 180000 + i * 3003ull;
+			au.dts = 180000 + i * 3003ull - 3003;
+			au.is_rap = gop;
+			es.aus.push_back(std::move(au));
+		}
+
+		return es;
+	}
+
+	es_desc make_atracx()
+	{
+		// 0x5b * 8 + 8 bytes of audio data after the eight byte ATS header
+		es_desc es{ "ATRAC3plus", DmuxPamfStreamType::atracx, 0xbd, 0x00, 0x4000, 0x10000, 1500 };
+
+		for (u32 i = 0; i < 100; i++)
+		{
+			expected_au au{};
+			au.data = { 0x0f, 0xd0, 0x28, 0x5b, 0x01, 0x02, 0x03, 0x04 };
+			append_payload(au.data, 0x5b * 8 + 8, i);
+			au.pts = 90000 + i * 2089ull;
+			au.dts = au.pts;
+			au.is_rap = true;
+			es.aus.push_back(std::move(au));
+		}
+
+		return es;
+	}
+
+	es_desc make_ac3()
+	{
+		// 48 kHz at 64 kbit/s, 256 bytes per frame
+		es_desc es{ "AC3", DmuxPamfStreamType::ac3, 0xbd, 0x30, 0x4000, 0x10000, 1000 };
+
+		for (u32 i = 0; i < 80; i++)
+		{
+			expected_au au{};
+			au.data = { 0x0b, 0x77, 0x12, 0x34, 0x08 };
+			append_payload(au.data, 256 - 5, i);
+			au.pts = 90000 + i * 2880ull;
+			au.dts = au.pts;
+			au.is_rap = true;
+			es.aus.push_back(std::move(au));
+		}
+
+		return es;
+	}
+
+	es_desc make_lpcm()
+	{
+		es_desc es{ "LPCM", DmuxPamfStreamType::lpcm, 0xbd, 0x40, 0x4000, 0x10000, 0 };
+
+		for (u32 i = 0; i < 50; i++)
+		{
+			expected_au au{};
+			append_payload(au.data, 1920, i);
+			au.pts = 90000 + i * 1800ull;
+			au.dts = au.pts;
+			au.is_rap = true;
+			es.aus.push_back(std::move(au));
+		}
+
+		return es;
+	}
+
+	// Timestamps are only assigned to the first access unit starting in a PES packet
+	void clear_unsent_timestamps(es_desc& es)
+	{
+		std::vector<bool> has_ts(es.aus.size());
+
+		for (const pes_packet& packet : packetize(es))
+		{
+			if (packet.pts != umax)
+			{
+				const auto it = std::find_if(es.aus.begin(), es.aus.end(), [&](const expected_au& au) { return au.pts == packet.pts; });
+				has_ts[it - es.aus.begin()] = true;
+			}
+		}
+
+		for (usz i = 0; i < es.aus.size(); i++)
+		{
+			if (!has_ts[i])
+			{
+				es.aus[i].pts = umax;
+				es.aus[i].dts = umax;
+			}
+		}
+	}
+
+	struct delivered_au
+	{
+		u32 addr;
+		u32 size;
+	};
+
+	struct es_state
+	{
+		const es_desc* desc;
+		vm::ptr<DmuxPamfElementaryStream> es;
+		std::vector<expected_au> received;
+		std::deque<delivered_au> unreleased;
+	};
+
+	void accept_pending(es_state& state, usz max_unreleased)
+	{
+		const auto es = state.es;
+
+		while (es->au_pending)
+		{
+			const CellDmuxAuInfo& info = es->au_info.info;
+
+			expected_au au{};
+			au.data.assign(vm::_ptr<u8>(info.auAddr), vm::_ptr<u8>(info.auAddr) + info.auSize);
+			au.pts = info.ptsUpper == CODEC_TS_INVALID ? u64{umax} : u64{info.ptsUpper} << 32 | info.ptsLower;
+			au.dts = info.dtsUpper == CODEC_TS_INVALID ? u64{umax} : u64{info.dtsUpper} << 32 | info.dtsLower;
+			au.is_rap = es->au_info.is_rap;
+
+			state.received.push_back(std::move(au));
+			state.unreleased.push_back({ info.auAddr, info.auSize });
+
+			es->commit_pending();
+
+			// The consumer holds on to a few access units, like the access unit queue of cellDmux
+			while (state.unreleased.size() > max_unreleased)
+			{
+				es->release(state.unreleased.front().addr, state.unreleased.front().size);
+				state.unreleased.pop_front();
+			}
+		}
+	}
+
+	void release_all(es_state& state)
+	{
+		for (const delivered_au& au : state.unreleased)
+		{
+			state.es->release(au.addr, au.size);
+		}
+
+		state.unreleased.clear();
+	}
+
+	// Same order of operations as DmuxPamfContext::exec()
+	void demux_stream(std::vector<es_desc> streams, usz max_unreleased, std::string_view name)
+	{
+		for (es_desc& es : streams)
+		{
+			clear_unsent_timestamps(es);
+		}
+
+		const std::vector<u8> stream = mux(streams);
+
+		const u32 stream_addr = vm::alloc(::size32(stream), vm::main);
+		const u32 dmux_addr = vm::alloc(sizeof(DmuxPamfContext), vm::main);
+		ensure(stream_addr && dmux_addr);
+
+		std::memcpy(vm::base(stream_addr), stream.data(), stream.size());
+
+		const auto dmux = vm::ptr<DmuxPamfContext>::make(dmux_addr);
+		write_to_ptr(dmux.get_ptr(), DmuxPamfContext({}, {}, {}, false, 0, 0));
+
+		std::vector<es_state> states;
+		std::vector<u32> allocations{ stream_addr, dmux_addr };
+
+		for (usz i = 0; i < streams.size(); i++)
+		{
+			const es_desc& desc = streams[i];
+			const u32 es_addr = vm::alloc(utils::align(static_cast<u32>(sizeof(DmuxPamfElementaryStream)), 0x80) + desc.au_buf_size, vm::main);
+			ensure(es_addr);
+			allocations.push_back(es_addr);
+
+			const auto es = vm::ptr<DmuxPamfElementaryStream>::make(es_addr);
+			const auto au_buf = vm::ptr<u8>::make(es_addr + utils::align(static_cast<u32>(sizeof(DmuxPamfElementaryStream)), 0x80));
+
+			write_to_ptr(es.get_ptr(), DmuxPamfElementaryStream(dmux, desc.stream_id, desc.private_stream_id, desc.type, {}, {}, au_buf, desc.au_buf_size, desc.au_max_size));
+			es->lpcm_info = { CELL_DMUX_PAMF_FS_48K, 2, CELL_DMUX_PAMF_BITS_PER_SAMPLE_16 };
+
+			dmux->elementary_streams[i] = es;
+			states.push_back({ &desc, es });
+		}
+
+		dmux->stream_addr = vm::cptr<u8>::make(stream_addr);
+		dmux->stream_size = ::size32(stream);
+		dmux->stream_pos = 0;
+		dmux->stream_active = true;
+
+		while (dmux->stream_active)
+		{
+			dmux->waiting_for_consumer = false;
+
+			while (dmux->stream_active && !dmux->waiting_for_consumer && !dmux->has_pending_au())
+			{
+				if (dmux->stream_pos >= dmux->stream_size)
+				{
+					dmux->stream_active = false;
+					break;
+				}
+
+				if (!dmux->demux_packet())
+				{
+					break;
+				}
+			}
+
+			if (!test::check(!dmux->fatal_error_pending, "no fatal error"))
+			{
+				break;
+			}
+
+			const bool pending = dmux->has_pending_au();
+
+			for (es_state& state : states)
+			{
+				accept_pending(state, max_unreleased);
+			}
+
+			if (dmux->waiting_for_consumer)
+			{
+				// Nothing could be assembled without releasing memory first
+				if (!test::check(pending || std::any_of(states.begin(), states.end(), [](const es_state& s) { return !s.unreleased.empty(); }), "demuxer is not stuck"))
+				{
+					break;
+				}
+
+				for (es_state& state : states)
+				{
+					release_all(state);
+				}
+			}
+		}
+
+		// Flush, the remaining data is delivered as the last access unit
+		for (es_state& state : states)
+		{
+			if (state.es->au_size)
+			{
+				state.es->set_pending(state.es->au_size);
+				accept_pending(state, max_unreleased);
+			}
+
+			release_all(state);
+		}
+
+		for (const es_state& state : states)
+		{
+			const std::vector<expected_au>& expected = state.desc->aus;
+			const std::string_view es_name = state.desc->name;
+
+			test::check(state.received.size() == expected.size(), fmt::format("%s/%s: access unit count %u == %u", name, es_name, state.received.size(), expected.size()));
+
+			for (usz i = 0; i < std::min(state.received.size(), expected.size()); i++)
+			{
+				const expected_au& got = state.received[i];
+				const expected_au& exp = expected[i];
+
+				if (!test::check(got.data.size() == exp.data.size(), fmt::format("%s/%s: AU %u size 0x%x == 0x%x", name, es_name, i, got.data.size(), exp.data.size())) ||
+					!test::check(got.data == exp.data, fmt::format("%s/%s: AU %u data", name, es_name, i)) ||
+					!test::check(got.pts == exp.pts, fmt::format("%s/%s: AU %u PTS 0x%llx == 0x%llx", name, es_name, i, got.pts, exp.pts)) ||
+					!test::check(got.dts == exp.dts, fmt::format("%s/%s: AU %u DTS 0x%llx == 0x%llx", name, es_name, i, got.dts, exp.dts)) ||
+					!test::check(got.is_rap == exp.is_rap, fmt::format("%s/%s: AU %u RAP %d == %d", name, es_name, i, +got.is_rap, +exp.is_rap)))
+				{
+					break;
+				}
+			}
+		}
+
+		for (const u32 addr : allocations)
+		{
+			vm::dealloc(addr, vm::main);
+		}
+	}
+}
+
+void test_dmux_pamf()
+{
+	vm::init();
+
+	// Every stream on its own, the consumer releases the access units right away
+	for (const auto& make : { &make_avc, &make_m2v, &make_atracx, &make_ac3, &make_lpcm })
+	{
+		es_desc es = make();
+		const std::string name = fmt::format("%s only", es.name);
+		demux_stream({ std::move(es) }, 0, name);
+	}
+
+	// Interleaved streams with a lagging consumer, which makes the access unit buffers wrap around and fill up
+	demux_stream({ make_avc(), make_atracx(), make_lpcm() }, 4, "AVC+ATRAC3plus+LPCM");
+	demux_stream({ make_m2v(), make_ac3() }, 8, "M2V+AC3");
+
+	vm::close();
+}
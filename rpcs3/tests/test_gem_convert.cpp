@@ -0,0 +1,197 @@
+#include "stdafx.h"
+#include "test.hpp"
+#include "Emu/Cell/Modules/cellCamera.h"
+#include "Emu/Cell/Modules/cellGem.h"
+
+// Compares the vectorized camera frame conversions of cellGem byte for byte with plain per-pixel implementations
+
+namespace
+{
+	// Rounds the product like the vectorized code, which doesn't fuse multiplications and additions
+	f32 mul(f32 a, u8 b)
+	{
+		volatile f32 result = a * b;
+		return result;
+	}
+
+	// Conversion to s32 truncates, the low byte is kept
+	u8 to_u8(f32 value)
+	{
+		return static_cast<u8>(static_cast<s32>(value));
+	}
+
+	u8 ref_y(u8 r, u8 g, u8 b) { return to_u8(mul(0.299f, r) + mul(0.587f, g) + mul(0.114f, b)); }
+	u8 ref_u(u8 r, u8 g, u8 b) { return to_u8(-mul(0.14713f, r) - mul(0.28886f, g) + mul(0.436f, b)); }
+	u8 ref_v(u8 r, u8 g, u8 b) { return to_u8(mul(0.615f, r) - mul(0.51499f, g) - mul(0.10001f, b)); }
+
+	struct rgb
+	{
+		u8 r, g, b;
+	};
+
+	struct frame
+	{
+		CellCameraFormat format;
+		u32 width;
+		u32 height;
+		std::vector<u8> data;
+
+		// Colour of a pixel, a 2x2 block of the Bayer pattern (BG/GR) shares R and B, G comes from the row of the pixel
+		rgb pixel(u32 x, u32 y) const
+		{
+			if (format == CELL_CAMERA_RGBA)
+			{
+				const u8* src = &data[(y * width + x) * 4];
+				return { src[0], src[1], src[2] };
+			}
+
+			const u8* block0 = &data[(y & ~1u) * width + (x & ~1u)];
+			const u8* block1 = block0 + width;
+			return { block1[1], y % 2 ? block1[0] : block0[1], block0[0] };
+		}
+	};
+
+	std::vector<u8> reference(const frame& in, CellGemVideoConvertFormatEnum output_format, usz out_size)
+	{
+		std::vector<u8> out(out_size, 0xcd);
+
+		const u32 w = in.width;
+		const u32 h = in.height;
+
+		// Only the first pixel of each group of sub_x pixels is used for the chroma of YUV outputs
+		const auto yuv_planar = [&](u32 sub_x)
+		{
+			u8* dst_y = out.data();
+			u8* dst_u = dst_y + w * h;
+			u8* dst_v = dst_u + w / sub_x * h;
+
+			for (u32 y = 0; y < h; y++)
+			{
+				for (u32 x = 0; x < w; x++)
+				{
+					const rgb c = in.pixel(x, y);
+					dst_y[y * w + x] = ref_y(c.r, c.g, c.b);
+
+					if (x % sub_x == 0)
+					{
+						dst_u[y * (w / sub_x) + x / sub_x] = ref_u(c.r, c.g, c.b);
+						dst_v[y * (w / sub_x) + x / sub_x] = ref_v(c.r, c.g, c.b);
+					}
+				}
+			}
+		};
+
+		switch (output_format)
+		{
+		case CELL_GEM_RGBA_640x480:
+		{
+			for (u32 y = 0; y < h; y++)
+			{
+				for (u32 x = 0; x < w; x++)
+				{
+					const rgb c = in.pixel(x, y);
+					const u8 a = in.format == CELL_CAMERA_RGBA ? in.data[(y * w + x) * 4 + 3] : 255;
+					const u8 px[4] = { c.r, c.g, c.b, a };
+					std::memcpy(&out[(y * w + x) * 4], px, 4);
+				}
+			}
+			break;
+		}
+		case CELL_GEM_RGBA_320x240:
+		{
+			for (u32 y = 0; y < h / 2; y++)
+			{
+				for (u32 x = 0; x < w / 2; x++)
+				{
+					const rgb c = in.pixel(x * 2, y * 2);
+					const u8 a = in.format == CELL_CAMERA_RGBA ? in.data[(y * 2 * w + x * 2) * 4 + 3] : 255;
+					const u8 px[4] = { c.r, c.g, c.b, a };
+					std::memcpy(&out[(y * (w / 2) + x) * 4], px, 4);
+				}
+			}
+			break;
+		}
+		case CELL_GEM_YUV_640x480:
+		{
+			yuv_planar(1);
+			break;
+		}
+		case CELL_GEM_YUV422_640x480:
+		{
+			yuv_planar(2);
+			break;
+		}
+		case CELL_GEM_YUV411_640x480:
+		{
+			yuv_planar(4);
+			break;
+		}
+		case CELL_GEM_BAYER_RESTORED:
+		{
+			std::memcpy(out.data(), in.data.data(), out.size());
+			break;
+		}
+		default:
+		{
+			break;
+		}
+		}
+
+		return out;
+	}
+
+	frame make_frame(CellCameraFormat format, u32 width, u32 height)
+	{
+		frame result{ format, width, height, {} };
+		result.data.resize(usz{width} * height * (format == CELL_CAMERA_RGBA ? 4 : 1));
+
+		u32 seed = 0x12345678;
+
+		for (u8& byte : result.data)
+		{
+			seed = seed * 1103515245 + 12345;
+			byte = static_cast<u8>(seed >> 16);
+		}
+
+		return result;
+	}
+
+	void check_conversion(const frame& in, CellGemVideoConvertFormatEnum output_format, usz out_size)
+	{
+		const std::vector<u8> expected = reference(in, output_format, out_size);
+
+		std::vector<u8> out(out_size, 0xcd);
+
+		const bool ok = gem::convert_image_format(in.format, output_format, in.data, in.width, in.height, out.data(), ::size32(out), "test");
+		const std::string what = fmt::format("%s to %s (%ux%u)", in.format, output_format, in.width, in.height);
+
+		if (!test::check(ok, what + " failed"))
+		{
+			return;
+		}
+
+		const auto mismatch = std::mismatch(out.begin(), out.end(), expected.begin());
+		test::check(mismatch.first == out.end(), fmt::format("%s differs at byte %u", what, mismatch.first - out.begin()));
+	}
+}
+
+void test_gem_convert()
+{
+	// 640 columns only run the vectorized loops, 600 columns also run the scalar tails (the output sizes stay the same)
+	for (const auto& [width, height] : { std::pair<u32, u32>{640, 480}, std::pair<u32, u32>{600, 512} })
+	{
+		const frame raw8 = make_frame(CELL_CAMERA_RAW8, width, height);
+		const frame rgba = make_frame(CELL_CAMERA_RGBA, width, height);
+
+		for (const frame* in : { &raw8, &rgba })
+		{
+			check_conversion(*in, CELL_GEM_RGBA_640x480, 640 * 480 * 4);
+			check_conversion(*in, CELL_GEM_RGBA_320x240, 320 * 240 * 4);
+			check_conversion(*in, CELL_GEM_YUV_640x480, 640 * 480 * 3);
+			check_conversion(*in, CELL_GEM_YUV422_640x480, 640 * 480 * 2);
+			check_conversion(*in, CELL_GEM_YUV411_640x480, 640 * 480 + 320 * 240 * 2);
+		}
+
+		check_conversion(raw8, CELL_GEM_BAYER_RESTORED, 640 * 480);
+	}
+}
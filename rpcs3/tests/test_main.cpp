@@ -0,0 +1,61 @@
+#include "stdafx.h"
+#include "test.hpp"
+
+#include <iostream>
+
+namespace
+{
+	u32 s_failures = 0;
+
+	struct test_info
+	{
+		std::string_view name;
+		void (*run)();
+	};
+
+	constexpr test_info s_tests[] =
+	{
+		{ "dmux_pamf", &test_dmux_pamf },
+		{ "gem_convert", &test_gem_convert },
+		{ "timeout_queue", &test_timeout_queue },
+	};
+}
+
+bool test::check(bool condition, std::string_view what, std::source_location loc)
+{
+	if (!condition)
+	{
+		s_failures++;
+		std::cerr << fmt::format("%s:%u: check failed: %s", loc.file_name(), loc.line(), what) << std::endl;
+	}
+
+	return condition;
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::none_of(std::begin(s_tests), std::end(s_tests), [&](const test_info& info) { return info.name == argv[i]; }))
+		{
+			std::cerr << fmt::format("Unknown test: %s", argv[i]) << std::endl;
+			return 1;
+		}
+	}
+
+	// Run the named tests, or all of them
+	for (const test_info& info : s_tests)
+	{
+		if (argc > 1 && std::none_of(argv + 1, argv + argc, [&](const char* name) { return info.name == name; }))
+		{
+			continue;
+		}
+
+		const u32 failures = s_failures;
+		info.run();
+
+		std::cout << fmt::format("[%s] %s", s_failures == failures ? "PASS" : "FAIL", info.name) << std::endl;
+	}
+
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+#include "stdafx.h"
+
+#include <QString>
+
+#include <cstdio>
+#include <cstdlib>
+
+// Definitions which are provided by main.cpp in the emulator executable
+
+[[noreturn]] void report_fatal_error(std::string_view text, bool /*is_html*/ = false, bool /*include_help_text*/ = true)
+{
+	std::fprintf(stderr, "RPCS3: %.*s\n", static_cast<int>(text.size()), text.data());
+	std::fflush(stderr);
+	std::abort();
+}
+
+template <>
+void fmt_class_string<QString>::format(std::string& out, u64 arg)
+{
+	out += get_object(arg).toStdString();
+}
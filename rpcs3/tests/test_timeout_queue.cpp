@@ -0,0 +1,108 @@
+#include "stdafx.h"
+#include "test.hpp"
+#include "Emu/Cell/timeout_queue.hpp"
+
+#include <map>
+
+// Compares the scheduler timeout queue with a multimap, which keeps insertion order for equal times
+
+namespace
+{
+	struct item
+	{
+		u32 index = umax;
+		u32 id = 0;
+	};
+
+	constexpr u32 c_items = 64;
+
+	using queue_type = timeout_queue<item, c_items, &item::index>;
+}
+
+void test_timeout_queue()
+{
+	auto queue = std::make_unique<queue_type>();
+	std::vector<item> items(c_items);
+	std::multimap<u64, item*> expected;
+	std::vector<std::multimap<u64, item*>::iterator> positions(c_items, expected.end());
+
+	for (u32 i = 0; i < c_items; i++)
+	{
+		items[i].id = i;
+	}
+
+	const auto remove_expected = [&](item& it)
+	{
+		if (positions[it.id] != expected.end())
+		{
+			expected.erase(positions[it.id]);
+			positions[it.id] = expected.end();
+		}
+	};
+
+	u32 seed = 7;
+	u64 now = 0;
+
+	const auto next_random = [&]()
+	{
+		seed = seed * 1103515245 + 12345;
+		return seed >> 8;
+	};
+
+	for (u32 step = 0; step < 100000; step++)
+	{
+		item& it = items[next_random() % c_items];
+
+		switch (next_random() % 4)
+		{
+		case 0:
+		case 1:
+		{
+			// Few distinct times, so that the order of equal times is covered
+			const u64 time = now + next_random() % 16;
+
+			remove_expected(it);
+			positions[it.id] = expected.emplace(time, &it);
+
+			const bool is_first = queue->push(&it, time);
+			test::check(is_first == (positions[it.id] == expected.begin()), "push: earliest timeout mismatch");
+			break;
+		}
+		case 2:
+		{
+			const bool queued = positions[it.id] != expected.end();
+			remove_expected(it);
+
+			test::check(queue->remove(&it) == queued, "remove: queued state mismatch");
+			test::check(it.index == umax, "remove: position not reset");
+			break;
+		}
+		default:
+		{
+			now += next_random() % 4;
+
+			while (item* popped = queue->pop(now))
+			{
+				if (!test::check(!expected.empty() && expected.begin()->second == popped && expected.begin()->first <= now, "pop: order mismatch"))
+				{
+					return;
+				}
+
+				positions[popped->id] = expected.end();
+				expected.erase(expected.begin());
+			}
+
+			test::check(expected.empty() || expected.begin()->first > now, "pop: due timeout left in the queue");
+			break;
+		}
+		}
+
+		if (!test::check(queue->size() == expected.size() && queue->next_time() == (expected.empty() ? u64{umax} : expected.begin()->first), fmt::format("size or next time mismatch at step %u", step)))
+		{
+			return;
+		}
+	}
+
+	queue->clear();
+	test::check(queue->empty() && std::all_of(items.begin(), items.end(), [](const item& it) { return it.index == umax; }), "clear: positions not reset");
+}
@@ -0,0 +1,421 @@
+#include "stdafx.h"
+#include "timer_benchmark.hpp"
+#include "Emu/Cell/timeout_queue.hpp"
+#include "util/cpu_stats.hpp"
+#include "util/sysinfo.hpp"
+#include "Utilities/Thread.h"
+#include "Utilities/mutex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <thread>
+#include <unordered_map>
+
+LOG_CHANNEL(bench_log, "BENCH");
+
+namespace utils
+{
+	namespace
+	{
+		using steady_clock = std::chrono::steady_clock;
+
+		constexpr u32 c_max_pending = 4096;
+		constexpr u32 c_max_threads = 256;
+		constexpr usz c_max_samples = 1 << 18;
+
+		// Range of the timeouts in microseconds, similar to short lwcond waits and usleep calls
+		constexpr u64 c_min_timeout_us = 50;
+		constexpr u64 c_max_timeout_us = 2000;
+
+		struct random_timeouts
+		{
+			u64 seed = 1;
+
+			u64 next()
+			{
+				seed = seed * 6364136223846793005 + 1442695040888963407;
+				return seed >> 33;
+			}
+
+			u64 timeout_us()
+			{
+				return c_min_timeout_us + next() % (c_max_timeout_us - c_min_timeout_us);
+			}
+		};
+
+		struct case_result
+		{
+			u64 ops = 0;
+			f64 seconds = 0;
+			u64 cpu_ns = 0;
+			std::vector<u32> samples; // Lateness of the wakeups in nanoseconds
+		};
+
+		struct bench_timeout
+		{
+			u32 index = umax;
+		};
+
+		// Sorted with a linear search on insertion and removal, as the scheduler did originally
+		struct sorted_deque_queue
+		{
+			std::deque<std::pair<u64, bench_timeout*>> list;
+
+			void push(bench_timeout* ptr, u64 time)
+			{
+				for (auto it = list.cbegin();; it++)
+				{
+					if (it == list.cend() || it->first > time)
+					{
+						list.emplace(it, time, ptr);
+						break;
+					}
+				}
+			}
+
+			void remove(bench_timeout* ptr)
+			{
+				for (auto it = list.cbegin(); it != list.cend(); it++)
+				{
+					if (it->second == ptr)
+					{
+						list.erase(it);
+						break;
+					}
+				}
+			}
+
+			bench_timeout* pop(u64 now)
+			{
+				if (list.empty() || list.front().first > now)
+				{
+					return nullptr;
+				}
+
+				const auto ptr = list.front().second;
+				list.pop_front();
+				return ptr;
+			}
+		};
+
+		// Node based map with an index of the entries, as the scheduler did before the timeout queue
+		struct multimap_index_queue
+		{
+			std::multimap<u64, bench_timeout*> map;
+			std::unordered_map<bench_timeout*, decltype(map)::iterator> index;
+
+			void push(bench_timeout* ptr, u64 time)
+			{
+				index.emplace(ptr, map.emplace(time, ptr));
+			}
+
+			void remove(bench_timeout* ptr)
+			{
+				if (auto found = index.find(ptr); found != index.end())
+				{
+					map.erase(found->second);
+					index.erase(found);
+				}
+			}
+
+			bench_timeout* pop(u64 now)
+			{
+				if (map.empty() || map.begin()->first > now)
+				{
+					return nullptr;
+				}
+
+				const auto ptr = map.begin()->second;
+				index.erase(ptr);
+				map.erase(map.begin());
+				return ptr;
+			}
+		};
+
+		struct heap_queue
+		{
+			timeout_queue<bench_timeout, c_max_pending, &bench_timeout::index> queue;
+
+			void push(bench_timeout* ptr, u64 time)
+			{
+				queue.push(ptr, time);
+			}
+
+			void remove(bench_timeout* ptr)
+			{
+				queue.remove(ptr);
+			}
+
+			bench_timeout* pop(u64 now)
+			{
+				return queue.pop(now);
+			}
+		};
+
+		// Re-arm random timeouts as woken threads do, and let time pass so that the due ones expire (ops: operations on the queue)
+		template <typename Q>
+		case_result bench_queue(u32 pending, u32 duration_ms)
+		{
+			const auto queue = std::make_unique<Q>();
+			std::vector<bench_timeout> timeouts(pending);
+			random_timeouts random;
+			u64 now = 0;
+
+			for (bench_timeout& timeout : timeouts)
+			{
+				queue->push(&timeout, now + random.timeout_us());
+			}
+
+			case_result result{};
+
+			const u64 cpu_start = cpu_stats::get_process_cpu_time();
+			const auto start = steady_clock::now();
+			const auto deadline = start + std::chrono::milliseconds(duration_ms);
+			auto end = start;
+
+			do
+			{
+				for (u32 i = 0; i < 1024; i++)
+				{
+					if (i % 4)
+					{
+						// Most waits end early, the timeout is cancelled and armed again on the next wait
+						bench_timeout& timeout = timeouts[random.next() % pending];
+						queue->remove(&timeout);
+						queue->push(&timeout, now + random.timeout_us());
+						result.ops += 2;
+						continue;
+					}
+
+					now += 10;
+
+					while (const auto timeout = queue->pop(now))
+					{
+						queue->push(timeout, now + random.timeout_us());
+						result.ops += 2;
+					}
+				}
+			}
+			while ((end = steady_clock::now()) < deadline);
+
+			result.seconds = std::chrono::duration<f64>(end - start).count();
+			result.cpu_ns = cpu_stats::get_process_cpu_time() - cpu_start;
+			return result;
+		}
+
+		struct bench_waiter
+		{
+			u32 index = umax;
+			atomic_t<u32> woken{0};
+		};
+
+		enum class wakeup_mode
+		{
+			own_timeout, // Every thread waits with a timeout
+			shared_timer, // Threads wait without a timeout, one timer thread wakes them up
+			own_timeout_and_timer, // As lv2: threads wait with a timeout, the timer thread delivers it if the thread didn't wake up first
+		};
+
+		// Threads wait for random timeouts (ops: completed waits)
+		case_result bench_wakeup(u32 threads, u32 duration_ms, wakeup_mode mode)
+		{
+			const bool use_timer = mode != wakeup_mode::own_timeout;
+
+			const auto epoch = steady_clock::now();
+
+			const auto now_ns = [&]() -> u64
+			{
+				return std::chrono::duration_cast<std::chrono::nanoseconds>(steady_clock::now() - epoch).count();
+			};
+
+			std::vector<std::vector<u32>> samples(threads);
+			std::vector<bench_waiter> waiters(threads);
+			atomic_t<u64> ops{0};
+			atomic_t<u32> index{0};
+			atomic_t<u32> stop{0};
+			atomic_t<u32> finished{0};
+
+			// Same protocol as the lv2 timer thread wakeup
+			shared_mutex mutex;
+			const auto queue = std::make_unique<timeout_queue<bench_waiter, c_max_threads, &bench_waiter::index>>();
+			atomic_t<u32> signal{0};
+			atomic_t<u64> planned{umax};
+
+			const u64 cpu_start = cpu_stats::get_process_cpu_time();
+			u64 elapsed_ns = 0;
+
+			{
+				named_thread timer_thread("Benchmark Timer", [&]()
+				{
+					u32 old_signal = signal;
+					u64 sleep_ns = 0;
+
+					while (use_timer && finished < threads)
+					{
+						if (sleep_ns)
+						{
+							signal.wait(old_signal, atomic_wait_timeout{sleep_ns});
+						}
+
+						planned = u64{umax};
+						old_signal = signal;
+
+						const u64 now = now_ns();
+						u64 next = umax;
+						{
+							std::lock_guard lock(mutex);
+
+							while (const auto waiter = queue->pop(now))
+							{
+								waiter->woken.release(1);
+								waiter->woken.notify_one();
+							}
+
+							next = queue->next_time();
+						}
+
+						sleep_ns = next == umax ? u64{umax} : next - now;
+						planned = next;
+					}
+				});
+
+				named_thread_group workers("Benchmark Waiter ", threads, [&]()
+				{
+					const u32 i = index++;
+					bench_waiter& waiter = waiters[i];
+					random_timeouts random{i + 1u};
+
+					while (!stop)
+					{
+						const u64 deadline = now_ns() + random.timeout_us() * 1000;
+
+						if (use_timer)
+						{
+							waiter.woken.release(0);
+
+							bool first = false;
+							{
+								std::lock_guard lock(mutex);
+								first = queue->push(&waiter, deadline);
+							}
+
+							if (first && deadline < planned)
+							{
+								signal++;
+								signal.notify_one();
+							}
+						}
+
+						if (mode == wakeup_mode::shared_timer)
+						{
+							while (!waiter.woken)
+							{
+								waiter.woken.wait(0);
+							}
+						}
+						else
+						{
+							for (u64 now = now_ns(); now < deadline && !waiter.woken; now = now_ns())
+							{
+								waiter.woken.wait(0, atomic_wait_timeout{deadline - now});
+							}
+
+							if (use_timer)
+							{
+								// Woken up by its own timeout, cancel the one of the timer thread
+								std::lock_guard lock(mutex);
+								queue->remove(&waiter);
+							}
+						}
+
+						if (samples[i].size() < c_max_samples / threads)
+						{
+							samples[i].push_back(static_cast<u32>(std::min<u64>(now_ns() - deadline, u32{umax})));
+						}
+
+						ops++;
+					}
+
+					finished++;
+					signal++;
+					signal.notify_one();
+				});
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+				stop.release(1);
+				workers.join();
+				elapsed_ns = now_ns();
+			}
+
+			case_result result{};
+			result.ops = ops;
+			result.seconds = elapsed_ns / 1e9;
+			result.cpu_ns = cpu_stats::get_process_cpu_time() - cpu_start;
+
+			for (const auto& s : samples)
+			{
+				result.samples.insert(result.samples.end(), s.begin(), s.end());
+			}
+
+			return result;
+		}
+
+		struct bench_case
+		{
+			std::string_view name;
+			std::function<case_result(const timer_benchmark_settings&)> run;
+		};
+	}
+
+	std::string run_timer_benchmarks(const timer_benchmark_settings& settings)
+	{
+		const u32 pending = std::clamp<u32>(settings.pending, 1, c_max_pending);
+		const u32 threads = std::clamp<u32>(settings.threads, 1, c_max_threads);
+		const u32 duration_ms = std::max<u32>(settings.duration_ms, 1);
+
+		const bench_case cases[] =
+		{
+			{"queue.sorted_deque", [&](const auto&) { return bench_queue<sorted_deque_queue>(pending, duration_ms); }},
+			{"queue.multimap_index", [&](const auto&) { return bench_queue<multimap_index_queue>(pending, duration_ms); }},
+			{"queue.timeout_queue", [&](const auto&) { return bench_queue<heap_queue>(pending, duration_ms); }},
+			{"wakeup.own_timeout", [&](const auto&) { return bench_wakeup(threads, duration_ms, wakeup_mode::own_timeout); }},
+			{"wakeup.shared_timer", [&](const auto&) { return bench_wakeup(threads, duration_ms, wakeup_mode::shared_timer); }},
+			{"wakeup.own_timeout_and_timer", [&](const auto&) { return bench_wakeup(threads, duration_ms, wakeup_mode::own_timeout_and_timer); }},
+		};
+
+		std::string results;
+
+		for (const bench_case& _case : cases)
+		{
+			if (!settings.filter.empty() && _case.name.find(settings.filter) == umax)
+			{
+				continue;
+			}
+
+			case_result result = _case.run(settings);
+
+			std::sort(result.samples.begin(), result.samples.end());
+
+			const auto percentile = [&](usz p) -> u32
+			{
+				return result.samples.empty() ? 0 : result.samples[std::min(result.samples.size() * p / 100, result.samples.size() - 1)];
+			};
+
+			const f64 ops_per_sec = result.seconds > 0 ? result.ops / result.seconds : 0;
+			const f64 cpu_ns_per_op = result.ops ? static_cast<f64>(result.cpu_ns) / result.ops : 0;
+
+			bench_log.notice("%s: %.0f ops/s, %.1f CPU ns/op, late p50=%uns, p99=%uns", _case.name, ops_per_sec, cpu_ns_per_op, percentile(50), percentile(99));
+
+			results += fmt::format("%s\n\t\t{\"case\": \"%s\", \"ops\": %u, \"seconds\": %.6f, \"ops_per_sec\": %.1f, \"cpu_ns_per_op\": %.1f, "
+				"\"late_ns\": {\"samples\": %u, \"p50\": %u, \"p90\": %u, \"p99\": %u, \"max\": %u}}",
+				results.empty() ? "" : ",", _case.name, result.ops, result.seconds, ops_per_sec, cpu_ns_per_op,
+				result.samples.size(), percentile(50), percentile(90), percentile(99), result.samples.empty() ? 0 : result.samples.back());
+		}
+
+		return fmt::format("{\n\t\"host_threads\": %u,\n\t\"pending\": %u,\n\t\"threads\": %u,\n\t\"duration_ms\": %u,\n\t\"timeout_us\": [%u, %u],\n\t\"results\": [%s\n\t]\n}\n",
+			utils::get_thread_count(), pending, threads, duration_ms, c_min_timeout_us, c_max_timeout_us, results);
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "util/types.hpp"
+
+#include <string>
+
+namespace utils
+{
+	struct timer_benchmark_settings
+	{
+		u32 pending = 100; // Timeouts queued at once in the queue cases
+		u32 threads = 16; // Waiting threads in the wakeup cases
+		u32 duration_ms = 500; // Duration of every case
+		std::string filter; // Only run cases which contain this string
+	};
+
+	// Measure the scheduler timeout queue against its previous implementations, and the accuracy and CPU cost
+	// of timed waits done by every thread compared to a shared timer thread, returns a JSON report
+	std::string run_timer_benchmarks(const timer_benchmark_settings& settings);
+}
@@ -10,6 +10,7 @@
 #include "util/asm.hpp"
 #include "windows.h"
 #include "tlhelp32.h"
+#include "psapi.h"
 #ifdef _MSC_VER
 #pragma comment(lib, "pdh.lib")
 #endif
@@ -18,6 +19,8 @@
 #include "sstream"
 #include "stdlib.h"
 #include "sys/times.h"
+#include "sys/resource.h"
+#include "unistd.h"
 #endif
 
 #ifdef __APPLE__
@@ -458,6 +461,102 @@ namespace utils
 #else
 		// unimplemented
 		return 0;
+#endif
+	}
+
+	u64 cpu_stats::get_process_cpu_time() // static
+	{
+#ifdef _WIN32
+		FILETIME ftime, fsys, fusr;
+
+		if (!GetProcessTimes(GetCurrentProcess(), &ftime, &ftime, &fsys, &fusr))
+		{
+			return 0;
+		}
+
+		ULARGE_INTEGER sys, usr;
+		memcpy(&sys, &fsys, sizeof(FILETIME));
+		memcpy(&usr, &fusr, sizeof(FILETIME));
+
+		// 100ns units
+		return (sys.QuadPart + usr.QuadPart) * 100;
+#else
+		struct rusage usage;
+
+		if (getrusage(RUSAGE_SELF, &usage))
+		{
+			return 0;
+		}
+
+		return (static_cast<u64>(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1'000'000'000 +
+			(static_cast<u64>(usage.ru_utime.tv_usec) + usage.ru_stime.tv_usec) * 1'000;
+#endif
+	}
+
+	u64 cpu_stats::get_memory_usage() // static
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return 0;
+		}
+
+		return counters.WorkingSetSize;
+#elif defined(__APPLE__)
+		mach_task_basic_info_data_t info{};
+		mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+		if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+		{
+			return 0;
+		}
+
+		return info.resident_size;
+#elif defined(__linux__)
+		// Second field: resident pages
+		std::ifstream file("/proc/self/statm");
+		u64 size = 0, resident = 0;
+
+		if (!(file >> size >> resident))
+		{
+			return 0;
+		}
+
+		return resident * ::sysconf(_SC_PAGESIZE);
+#else
+		// Unimplemented, fall back to the peak
+		return get_peak_memory_usage();
+#endif
+	}
+
+	u64 cpu_stats::get_peak_memory_usage() // static
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return 0;
+		}
+
+		return counters.PeakWorkingSetSize;
+#else
+		struct rusage usage;
+
+		if (getrusage(RUSAGE_SELF, &usage))
+		{
+			return 0;
+		}
+
+#ifdef __APPLE__
+		// Reported in bytes
+		return usage.ru_maxrss;
+#else
+		// Reported in kilobytes
+		return static_cast<u64>(usage.ru_maxrss) * 1024;
+#endif
 #endif
 	}
 }
@@ -36,5 +36,14 @@ namespace utils
 		void get_per_core_usage(std::vector<double>& per_core_usage, double& total_usage);
 
 		static u32 get_current_thread_count();
+
+		// Get the CPU time (user and system) used by this process in nanoseconds
+		static u64 get_process_cpu_time();
+
+		// Get the resident memory of this process in bytes
+		static u64 get_memory_usage();
+
+		// Get the peak resident memory of this process in bytes
+		static u64 get_peak_memory_usage();
 	};
 }
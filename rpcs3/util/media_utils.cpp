@@ -834,6 +834,11 @@ namespace utils
 			m_thread.reset();
 		}
 
+		if (const u64 dropped = m_dropped_frames.exchange(0))
+		{
+			media_log.warning("video_encoder: Dropped %d frames because the encoder could not keep up", dropped);
+		}
+
 		std::scoped_lock lock(m_video_mtx, m_audio_mtx);
 		m_frames_to_encode.clear();
 		m_samples_to_encode.clear();
@@ -1192,6 +1197,10 @@ namespace utils
 				av.video.context->max_b_frames = m_max_b_frames;
 				av.video.stream->time_base = av.video.context->time_base;
 
+				// Let the codec pick its own thread count. Codecs without threading support ignore this.
+				av.video.context->thread_count = 0;
+				av.video.context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
 				if (int err = avcodec_open2(av.video.context, av.video.codec, nullptr); err != 0)
 				{
 					media_log.error("video_encoder: avcodec_open2 for video failed. Error: %d='%s'", err, av_error_to_string(err));
@@ -1309,92 +1318,249 @@ namespace utils
 			encoder_sample last_samples;
 			u32 leftover_sample_count = 0;
 
-			while ((thread_ctrl::state() != thread_state::aborting || m_flush) && !has_error)
+			// Video frames are converted to the output format on a separate thread, so that the conversion
+			// of the next frame overlaps with the encoding of the current one.
+			struct frame_pool
 			{
-				// Fetch video frame
-				encoder_frame frame_data;
-				bool got_frame = false;
+				std::vector<AVFrame*> frames;
+
+				~frame_pool()
+				{
+					for (AVFrame*& frame : frames)
+					{
+						av_frame_free(&frame);
+					}
+				}
+			} converted_frame_pool;
+
+			shared_mutex convert_mtx;
+			std::deque<AVFrame*> converted_frames; // Converted frames in presentation order
+			std::vector<AVFrame*> free_frames;     // Frames that can be used for the next conversion
+			atomic_t<u32> frames_in_flight = 0;    // Frames taken from m_frames_to_encode that were not encoded yet
+
+			if (av.video.context)
+			{
+				static constexpr u32 converted_frame_count = 3;
+
+				for (u32 i = 0; i < converted_frame_count && !has_error; i++)
 				{
-					m_video_mtx.lock();
+					AVFrame* frame = av_frame_alloc();
 
-					if (m_frames_to_encode.empty())
+					if (!frame)
 					{
-						m_video_mtx.unlock();
+						media_log.error("video_encoder: av_frame_alloc for converted video frame failed");
+						has_error = true;
+						break;
 					}
-					else
+
+					converted_frame_pool.frames.push_back(frame);
+
+					frame->format = av.video.context->pix_fmt;
+					frame->width = av.video.context->width;
+					frame->height = av.video.context->height;
+
+					if (int err = av_frame_get_buffer(frame, 0); err < 0)
 					{
-						frame_data = std::move(m_frames_to_encode.front());
-						m_frames_to_encode.pop_front();
-						m_video_mtx.unlock();
+						media_log.error("video_encoder: av_frame_get_buffer for converted video frame failed. Error: %d='%s'", err, av_error_to_string(err));
+						has_error = true;
+						break;
+					}
 
-						got_frame = true;
+					free_frames.push_back(frame);
+				}
+			}
 
-						// Calculate presentation timestamp.
-						const s64 pts = get_pts(frame_data.timestamp_ms);
+			named_thread<std::function<void()>> convert_thread("Video Convert Thread", [&]()
+			{
+				SwsContext* sws = nullptr;
+				s64 last_converted_pts = -1;
 
-						// We need to skip this frame if it has the same timestamp.
-						if (pts <= last_video_pts)
+				while (thread_ctrl::state() != thread_state::aborting && !has_error)
+				{
+					// Read the signal before checking for work, so that nothing queued after the checks is missed
+					const u32 signal = m_video_signal;
+
+					if (!av.video.context)
+					{
+						// There is no video stream, drain the queued frames so that flushing can complete
+						std::deque<encoder_frame> frames;
 						{
-							media_log.trace("video_encoder: skipping frame. last_pts=%d, pts=%d, timestamp_ms=%d", last_video_pts, pts, frame_data.timestamp_ms);
+							std::lock_guard lock(m_video_mtx);
+							frames.swap(m_frames_to_encode);
 						}
-						else if (av.video.context)
+
+						for (encoder_frame& frame_data : frames)
 						{
-							media_log.trace("video_encoder: adding new frame. timestamp_ms=%d", frame_data.timestamp_ms);
+							recycle_frame_buffer(std::move(frame_data.data));
+						}
 
-							if (int err = av_frame_make_writable(av.video.frame); err < 0)
-							{
-								media_log.error("video_encoder: av_frame_make_writable failed. Error: %d='%s'", err, av_error_to_string(err));
-								has_error = true;
-								break;
-							}
+						if (frames.empty())
+						{
+							thread_ctrl::wait_on(m_video_signal, signal);
+						}
 
-							u8* in_data[4]{};
-							int in_line[4]{};
+						continue;
+					}
 
-							const AVPixelFormat in_format = static_cast<AVPixelFormat>(frame_data.av_pixel_format);
+					// Wait for the encoder to hand back a frame
+					AVFrame* frame = nullptr;
+					{
+						std::lock_guard lock(convert_mtx);
 
-							if (int ret = av_image_fill_linesizes(in_line, in_format, frame_data.width); ret < 0)
-							{
-								fmt::throw_exception("video_encoder: av_image_fill_linesizes failed (ret=0x%x): %s", ret, utils::av_error_to_string(ret));
-							}
+						if (!free_frames.empty())
+						{
+							frame = free_frames.back();
+							free_frames.pop_back();
+						}
+					}
 
-							if (int ret = av_image_fill_pointers(in_data, in_format, frame_data.height, frame_data.data.data(), in_line); ret < 0)
-							{
-								fmt::throw_exception("video_encoder: av_image_fill_pointers failed (ret=0x%x): %s", ret, utils::av_error_to_string(ret));
-							}
+					if (!frame)
+					{
+						thread_ctrl::wait_on(m_video_signal, signal);
+						continue;
+					}
 
-							// Update the context in case the frame format has changed
-							av.sws = sws_getCachedContext(av.sws, frame_data.width, frame_data.height, in_format,
-							                              av.video.context->width, av.video.context->height, out_pix_format, SWS_BICUBIC, nullptr, nullptr, nullptr);
-							if (!av.sws)
-							{
-								media_log.error("video_encoder: sws_getCachedContext failed");
-								has_error = true;
-								break;
-							}
+					encoder_frame frame_data;
+					bool got_frame = false;
+					{
+						std::lock_guard lock(m_video_mtx);
 
-							if (int err = sws_scale(av.sws, in_data, in_line, 0, frame_data.height, av.video.frame->data, av.video.frame->linesize); err < 0)
-							{
-								media_log.error("video_encoder: sws_scale failed. Error: %d='%s'", err, av_error_to_string(err));
-								has_error = true;
-								break;
-							}
+						if (!m_frames_to_encode.empty())
+						{
+							frame_data = std::move(m_frames_to_encode.front());
+							m_frames_to_encode.pop_front();
+							frames_in_flight++;
+							got_frame = true;
+						}
+					}
 
-							av.video.frame->pts = pts;
+					const auto release_frame = [&]()
+					{
+						std::lock_guard lock(convert_mtx);
+						free_frames.push_back(frame);
+					};
 
-							if (int err = avcodec_send_frame(av.video.context, av.video.frame); err < 0)
-							{
-								media_log.error("video_encoder: avcodec_send_frame for video failed. Error: %d='%s'", err, av_error_to_string(err));
-								has_error = true;
-								break;
-							}
+					if (!got_frame)
+					{
+						release_frame();
+						thread_ctrl::wait_on(m_video_signal, signal);
+						continue;
+					}
+
+					// Calculate presentation timestamp.
+					const s64 pts = get_pts(frame_data.timestamp_ms);
+
+					// We need to skip this frame if it has the same timestamp.
+					if (pts <= last_converted_pts)
+					{
+						media_log.trace("video_encoder: skipping frame. last_pts=%d, pts=%d, timestamp_ms=%d", last_converted_pts, pts, frame_data.timestamp_ms);
+						recycle_frame_buffer(std::move(frame_data.data));
+						release_frame();
+						frames_in_flight--;
+						continue;
+					}
+
+					// The encoder may still reference the buffers of this frame
+					if (int err = av_frame_make_writable(frame); err < 0)
+					{
+						media_log.error("video_encoder: av_frame_make_writable failed. Error: %d='%s'", err, av_error_to_string(err));
+						has_error = true;
+						break;
+					}
+
+					u8* in_data[4]{};
+					int in_line[4]{};
+
+					const AVPixelFormat in_format = static_cast<AVPixelFormat>(frame_data.av_pixel_format);
+
+					if (int ret = av_image_fill_linesizes(in_line, in_format, frame_data.width); ret < 0)
+					{
+						fmt::throw_exception("video_encoder: av_image_fill_linesizes failed (ret=0x%x): %s", ret, utils::av_error_to_string(ret));
+					}
+
+					if (int ret = av_image_fill_pointers(in_data, in_format, frame_data.height, frame_data.data.data(), in_line); ret < 0)
+					{
+						fmt::throw_exception("video_encoder: av_image_fill_pointers failed (ret=0x%x): %s", ret, utils::av_error_to_string(ret));
+					}
+
+					// Update the context in case the frame format has changed
+					sws = sws_getCachedContext(sws, frame_data.width, frame_data.height, in_format,
+					                           av.video.context->width, av.video.context->height, out_pix_format, SWS_BICUBIC, nullptr, nullptr, nullptr);
+					if (!sws)
+					{
+						media_log.error("video_encoder: sws_getCachedContext failed");
+						has_error = true;
+						break;
+					}
+
+					if (int err = sws_scale(sws, in_data, in_line, 0, frame_data.height, frame->data, frame->linesize); err < 0)
+					{
+						media_log.error("video_encoder: sws_scale failed. Error: %d='%s'", err, av_error_to_string(err));
+						has_error = true;
+						break;
+					}
 
-							flush(av.video);
+					frame->pts = pts;
+					last_converted_pts = pts;
 
-							last_video_pts = av.video.frame->pts;
-							m_last_video_pts = last_video_pts;
+					// The source buffer can be lent out again
+					recycle_frame_buffer(std::move(frame_data.data));
+
+					std::lock_guard lock(convert_mtx);
+					converted_frames.push_back(frame);
+				}
+
+				if (sws)
+				{
+					sws_freeContext(sws);
+				}
+			});
+
+			while ((thread_ctrl::state() != thread_state::aborting || m_flush) && !has_error)
+			{
+				// Fetch converted video frame
+				AVFrame* converted_frame = nullptr;
+				bool got_frame = false;
+				{
+					std::lock_guard lock(convert_mtx);
+
+					if (!converted_frames.empty())
+					{
+						converted_frame = converted_frames.front();
+						converted_frames.pop_front();
+						got_frame = true;
+					}
+				}
+
+				if (converted_frame)
+				{
+					if (av.video.context)
+					{
+						media_log.trace("video_encoder: adding new frame. pts=%d", converted_frame->pts);
+
+						if (int err = avcodec_send_frame(av.video.context, converted_frame); err < 0)
+						{
+							media_log.error("video_encoder: avcodec_send_frame for video failed. Error: %d='%s'", err, av_error_to_string(err));
+							has_error = true;
+							break;
 						}
+
+						flush(av.video);
+
+						last_video_pts = converted_frame->pts;
+						m_last_video_pts = last_video_pts;
 					}
+
+					// Hand the frame back to the conversion stage
+					{
+						std::lock_guard lock(convert_mtx);
+						free_frames.push_back(converted_frame);
+					}
+
+					m_video_signal++;
+					m_video_signal.notify_one();
+
+					frames_in_flight--;
 				}
 
 				// Fetch audio sample
@@ -1590,7 +1756,13 @@ namespace utils
 
 				if (!got_frame && !got_sample)
 				{
-					if (m_flush)
+					const auto all_frames_encoded = [&]()
+					{
+						reader_lock lock(m_video_mtx);
+						return m_frames_to_encode.empty() && !frames_in_flight;
+					};
+
+					if (m_flush && all_frames_encoded())
 					{
 						m_flush = false;
 
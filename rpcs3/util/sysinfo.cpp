@@ -24,6 +24,8 @@
 
 #include <thread>
 #include <fstream>
+#include <algorithm>
+#include <bit>
 
 #include "util/asm.hpp"
 #include "util/fence.hpp"
@@ -382,6 +384,19 @@ bool utils::has_fma4()
 #endif
 }
 
+bool utils::has_sha()
+{
+#if defined(ARCH_X64)
+	// SHA extensions, the SHA-NI code paths also use SSE4.1
+	static const bool g_value = has_sse41() && get_cpuid(0, 0)[0] >= 0x7 && (get_cpuid(7, 0)[1] & 0x20000000) == 0x20000000;
+	return g_value;
+#elif defined(ARCH_ARM64) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+	return true;
+#else
+	return false;
+#endif
+}
+
 // The Zen4 based CPUs support VPERMI2B/VPERMT2B in a single uop.
 // Current Intel cpus (as of 2022) need 3 uops to execute these instructions.
 // Check for SSE4A (which intel doesn't doesn't support) as well as VBMI.
@@ -1037,6 +1052,283 @@ u32 utils::get_thread_count()
 	return g_count;
 }
 
+#ifdef __linux__
+// Read the first line of a sysfs file
+static std::string read_sysfs_line(const std::string& path)
+{
+	std::string line;
+	std::ifstream file(path);
+	std::getline(file, line);
+	return file.fail() ? std::string{} : line;
+}
+
+// Parse a CPU list like "0-3,8,10-11", CPUs above 63 are ignored
+static u64 parse_cpu_list(std::string_view list)
+{
+	u64 result = 0;
+
+	for (usz pos = 0; pos < list.size();)
+	{
+		const usz end = std::min(list.find(',', pos), list.size());
+		const std::string range{list.substr(pos, end - pos)};
+		pos = end + 1;
+
+		u32 first = 0, last = 0;
+		const int count = std::sscanf(range.c_str(), "%u-%u", &first, &last);
+
+		if (count <= 0)
+		{
+			continue;
+		}
+
+		if (count == 1)
+		{
+			last = first;
+		}
+
+		for (u32 i = first; i <= last && i < 64; i++)
+		{
+			result |= u64{1} << i;
+		}
+	}
+
+	return result;
+}
+#endif
+
+const utils::cpu_topology& utils::get_cpu_topology()
+{
+	static const cpu_topology g_topology = []()
+	{
+		cpu_topology result;
+
+		const u32 cpu_count = std::min<u32>(get_thread_count(), 64);
+
+		for (u32 i = 0; i < cpu_count; i++)
+		{
+			result.cpus.push_back({.id = i, .core = i});
+		}
+
+		// Mask of the CPUs in each cache domain, before deduplication
+		std::vector<u64> cpu_domain(cpu_count);
+
+#ifdef _WIN32
+		DWORD buffer_size = 0;
+		GetLogicalProcessorInformationEx(RelationAll, nullptr, &buffer_size);
+
+		std::vector<u8> buffer(buffer_size);
+
+		if (buffer_size && GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data()), &buffer_size))
+		{
+			u32 core_index = 0;
+			u32 max_efficiency_class = 0;
+			u32 cache_level = 0;
+			std::vector<u8> efficiency_class(cpu_count);
+
+			for (uptr ptr = reinterpret_cast<uptr>(buffer.data()), end = ptr + buffer_size; ptr < end;)
+			{
+				const auto info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(ptr);
+				ptr += info->Size;
+
+				switch (info->Relationship)
+				{
+				case RelationProcessorCore:
+				{
+					// Only processor group 0 is used by the affinity masks
+					const u64 mask = info->Processor.GroupMask[0].Group == 0 ? info->Processor.GroupMask[0].Mask : 0;
+
+					for (u32 i = 0; i < cpu_count; i++)
+					{
+						if (mask & (u64{1} << i))
+						{
+							result.cpus[i].core = core_index;
+							efficiency_class[i] = info->Processor.EfficiencyClass;
+						}
+					}
+
+					result.has_smt |= info->Processor.Flags == LTP_PC_SMT;
+					max_efficiency_class = std::max<u32>(max_efficiency_class, info->Processor.EfficiencyClass);
+					core_index++;
+					break;
+				}
+				case RelationCache:
+				{
+					const u32 level = info->Cache.Level;
+					const u64 mask = info->Cache.GroupMask.Group == 0 ? info->Cache.GroupMask.Mask : 0;
+
+					if (level < cache_level || (info->Cache.Type != CacheUnified && info->Cache.Type != CacheData))
+					{
+						break;
+					}
+
+					if (level > cache_level)
+					{
+						cache_level = level;
+						std::fill(cpu_domain.begin(), cpu_domain.end(), 0);
+					}
+
+					for (u32 i = 0; i < cpu_count; i++)
+					{
+						if (mask & (u64{1} << i))
+						{
+							cpu_domain[i] = mask;
+						}
+					}
+
+					break;
+				}
+				case RelationNumaNode:
+				{
+					const u64 mask = info->NumaNode.GroupMask.Group == 0 ? info->NumaNode.GroupMask.Mask : 0;
+
+					for (u32 i = 0; i < cpu_count; i++)
+					{
+						if (mask & (u64{1} << i))
+						{
+							result.cpus[i].numa_node = info->NumaNode.NodeNumber;
+						}
+					}
+
+					result.numa_nodes = std::max<u32>(result.numa_nodes, info->NumaNode.NodeNumber + 1);
+					break;
+				}
+				default:
+				{
+					break;
+				}
+				}
+			}
+
+			// Higher efficiency classes are faster
+			for (u32 i = 0; i < cpu_count; i++)
+			{
+				result.cpus[i].low_performance = efficiency_class[i] < max_efficiency_class;
+			}
+		}
+#elif defined(__linux__)
+		const std::string cpu_path = "/sys/devices/system/cpu/";
+
+		// Intel hybrid CPUs list their efficiency cores separately
+		const u64 atom_mask = parse_cpu_list(read_sysfs_line("/sys/devices/cpu_atom/cpus"));
+
+		std::vector<u32> capacity(cpu_count);
+		u32 max_capacity = 0;
+
+		for (u32 i = 0; i < cpu_count; i++)
+		{
+			const std::string path = fmt::format("%scpu%u/", cpu_path, i);
+			auto& cpu = result.cpus[i];
+
+			const u32 package = ::atoi(read_sysfs_line(path + "topology/physical_package_id").c_str());
+			const u32 core = ::atoi(read_sysfs_line(path + "topology/core_id").c_str());
+			cpu.core = package << 16 | core;
+
+			result.has_smt |= std::popcount(parse_cpu_list(read_sysfs_line(path + "topology/thread_siblings_list"))) > 1;
+
+			// Use the shared CPU list of the highest cache level
+			u32 cache_level = 0;
+
+			for (u32 index = 0; fs::is_dir(fmt::format("%scache/index%u", path, index)); index++)
+			{
+				const std::string cache_path = fmt::format("%scache/index%u/", path, index);
+				const u32 level = ::atoi(read_sysfs_line(cache_path + "level").c_str());
+
+				if (level > cache_level && read_sysfs_line(cache_path + "type") != "Instruction")
+				{
+					cache_level = level;
+					cpu_domain[i] = parse_cpu_list(read_sysfs_line(cache_path + "shared_cpu_list"));
+				}
+			}
+
+			// ARM big.LITTLE and some hybrid x86 systems expose a relative capacity, otherwise compare the maximum frequency
+			capacity[i] = ::atoi(read_sysfs_line(path + "cpu_capacity").c_str());
+
+			if (!capacity[i])
+			{
+				capacity[i] = ::atoi(read_sysfs_line(path + "cpufreq/cpuinfo_max_freq").c_str());
+			}
+
+			max_capacity = std::max(max_capacity, capacity[i]);
+			cpu.low_performance = !!(atom_mask & (u64{1} << i));
+		}
+
+		if (!atom_mask)
+		{
+			for (u32 i = 0; i < cpu_count; i++)
+			{
+				// Boost frequencies of the fastest cores differ slightly, only flag clearly slower cores
+				result.cpus[i].low_performance = capacity[i] && capacity[i] < max_capacity / 4 * 3;
+			}
+		}
+
+		for (u32 node = 0; node < 64 && fs::is_dir(fmt::format("/sys/devices/system/node/node%u", node)); node++)
+		{
+			const u64 mask = parse_cpu_list(read_sysfs_line(fmt::format("/sys/devices/system/node/node%u/cpulist", node)));
+
+			for (u32 i = 0; i < cpu_count; i++)
+			{
+				if (mask & (u64{1} << i))
+				{
+					result.cpus[i].numa_node = node;
+				}
+			}
+
+			result.numa_nodes = node + 1;
+		}
+#endif
+
+		const u64 all_mask = cpu_count >= 64 ? umax : (u64{1} << cpu_count) - 1;
+
+		for (u32 i = 0; i < cpu_count; i++)
+		{
+			// Unknown cache layout, assume a single domain
+			const u64 domain = cpu_domain[i] & all_mask ? cpu_domain[i] & all_mask : all_mask;
+
+			const auto found = std::find(result.cache_domains.begin(), result.cache_domains.end(), domain);
+			result.cpus[i].cache_domain = static_cast<u32>(found - result.cache_domains.begin());
+
+			if (found == result.cache_domains.end())
+			{
+				result.cache_domains.push_back(domain);
+			}
+
+			result.is_hybrid |= result.cpus[i].low_performance;
+		}
+
+		return result;
+	}();
+
+	return g_topology;
+}
+
+std::string utils::get_cpu_topology_string()
+{
+	const cpu_topology& topology = get_cpu_topology();
+
+	u64 low_performance = 0;
+
+	for (const auto& cpu : topology.cpus)
+	{
+		low_performance |= u64{cpu.low_performance} << cpu.id;
+	}
+
+	std::string result = fmt::format("%u logical CPUs, %u cache domains (", topology.cpus.size(), topology.cache_domains.size());
+
+	for (usz i = 0; i < topology.cache_domains.size(); i++)
+	{
+		fmt::append(result, "%s0x%x", i ? ", " : "", topology.cache_domains[i]);
+	}
+
+	fmt::append(result, "), %u NUMA nodes, SMT: %s", topology.numa_nodes, topology.has_smt);
+
+	if (topology.is_hybrid)
+	{
+		fmt::append(result, ", low-performance CPUs: 0x%x", low_performance);
+	}
+
+	return result;
+}
+
 u32 utils::get_cpu_family()
 {
 #if defined(ARCH_X64)
@@ -2,6 +2,7 @@
 
 #include "util/types.hpp"
 #include <string>
+#include <vector>
 
 namespace utils
 {
@@ -47,6 +48,8 @@ namespace utils
 
 	bool has_fma4();
 
+	bool has_sha();
+
 	bool has_fast_vperm2b();
 
 	bool has_erms();
@@ -87,6 +90,29 @@ namespace utils
 
 	u32 get_thread_count();
 
+	// Host CPU layout used for thread placement, only the first 64 logical CPUs are described
+	struct cpu_topology
+	{
+		struct logical_cpu
+		{
+			u32 id = 0;
+			u32 core = 0;         // Physical core, shared by SMT siblings
+			u32 cache_domain = 0; // Index in cache_domains
+			u32 numa_node = 0;
+			bool low_performance = false; // Efficiency core of a hybrid CPU
+		};
+
+		std::vector<logical_cpu> cpus;
+		std::vector<u64> cache_domains; // Logical CPUs sharing the last level cache
+		u32 numa_nodes = 1;
+		bool has_smt = false;
+		bool is_hybrid = false;
+	};
+
+	const cpu_topology& get_cpu_topology();
+
+	std::string get_cpu_topology_string();
+
 	u32 get_cpu_family();
 
 	u32 get_cpu_model();
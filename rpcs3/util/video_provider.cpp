@@ -119,7 +119,34 @@ namespace utils
 
 		const usz timestamp_ms = (elapsed_us - m_pause_time_us) / 1000;
 		const s64 pts = m_video_sink->get_pts(timestamp_ms);
-		return pts > m_last_video_pts_incoming;
+		if (pts <= m_last_video_pts_incoming)
+		{
+			return false;
+		}
+
+		if (!m_video_sink->can_add_frame())
+		{
+			// The encoder can't keep up, this frame will not be read back
+			m_video_sink->drop_frame();
+			return false;
+		}
+
+		return true;
+	}
+
+	std::vector<u8> video_provider::get_frame_buffer(usz size)
+	{
+		if (m_active)
+		{
+			reader_lock lock_video(m_video_mutex);
+
+			if (m_video_sink)
+			{
+				return m_video_sink->get_frame_buffer(size);
+			}
+		}
+
+		return std::vector<u8>(size);
 	}
 
 	void video_provider::present_frame(std::vector<u8>& data, u32 pitch, u32 width, u32 height, bool is_bgra)
@@ -153,6 +180,7 @@ namespace utils
 		// We can just skip this frame if it has the same timestamp.
 		if (pts <= m_last_video_pts_incoming)
 		{
+			m_video_sink->recycle_frame_buffer(std::move(data));
 			return;
 		}
 
@@ -160,6 +188,11 @@ namespace utils
 		{
 			m_last_video_pts_incoming = pts;
 		}
+		else
+		{
+			// The frame was dropped, so we can reuse the buffer right away
+			m_video_sink->recycle_frame_buffer(std::move(data));
+		}
 	}
 
 	void video_provider::present_samples(u8* buf, u32 sample_count, u16 channels)
@@ -26,10 +26,83 @@ namespace utils
 				return false;
 
 			std::lock_guard lock(m_video_mtx);
+
+			// Drop the frame if the encoder can't keep up. The producer must never be stalled by the encoder.
+			if (m_max_queued_frames && m_frames_to_encode.size() >= m_max_queued_frames)
+			{
+				m_dropped_frames++;
+				return false;
+			}
+
 			m_frames_to_encode.emplace_back(timestamp_ms, pitch, width, height, pixel_format, std::move(frame));
+
+			m_video_signal++;
+			m_video_signal.notify_one();
 			return true;
 		}
 
+		// Returns false if a new frame would be rejected anyway. Allows producers to skip the readback.
+		bool can_add_frame()
+		{
+			if (m_flush || m_paused)
+				return false;
+
+			if (!m_max_queued_frames)
+				return true;
+
+			reader_lock lock(m_video_mtx);
+			return m_frames_to_encode.size() < m_max_queued_frames;
+		}
+
+		// Counts a frame which the producer skipped because can_add_frame returned false
+		void drop_frame()
+		{
+			m_dropped_frames++;
+		}
+
+		// Lends a frame buffer of the requested size. It is handed back with add_frame or recycle_frame_buffer.
+		std::vector<u8> get_frame_buffer(usz size)
+		{
+			std::vector<u8> buffer;
+			{
+				std::lock_guard lock(m_pool_mtx);
+
+				if (!m_frame_pool.empty())
+				{
+					buffer = std::move(m_frame_pool.back());
+					m_frame_pool.pop_back();
+				}
+			}
+
+			buffer.resize(size);
+			return buffer;
+		}
+
+		// Returns a frame buffer to the pool once its contents have been consumed
+		void recycle_frame_buffer(std::vector<u8>&& buffer)
+		{
+			if (!buffer.capacity())
+				return;
+
+			std::lock_guard lock(m_pool_mtx);
+
+			if (m_frame_pool.size() < max_pooled_frames)
+			{
+				m_frame_pool.push_back(std::move(buffer));
+			}
+		}
+
+		// 0 means unlimited
+		void set_max_queued_frames(u32 max_queued_frames)
+		{
+			m_max_queued_frames = max_queued_frames;
+		}
+
+		u64 dropped_frames() const
+		{
+			return m_dropped_frames;
+		}
+
 		bool add_audio_samples(const u8* buf, u32 sample_count, u16 channels, usz timestamp_us)
 		{
 			// Do not allow new samples while flushing or paused
@@ -107,6 +180,12 @@ namespace utils
 		std::deque<encoder_frame> m_frames_to_encode;
 		shared_mutex m_audio_mtx;
 		std::deque<encoder_sample> m_samples_to_encode;
+		shared_mutex m_pool_mtx;
+		std::vector<std::vector<u8>> m_frame_pool;
+		static constexpr usz max_pooled_frames = 8;
+		atomic_t<u32> m_max_queued_frames = 0;
+		atomic_t<u64> m_dropped_frames = 0;
+		atomic_t<u32> m_video_signal = 0; // Incremented when a frame is queued or a frame buffer of the encoder is released
 		atomic_t<bool> m_paused = false;
 		atomic_t<bool> m_flush = false;
 		u32 m_framerate = 30;